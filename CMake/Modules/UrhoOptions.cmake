@@ -101,6 +101,12 @@ option(URHO3D_URHO2D "2D subsystem enabled" ${URHO3D_ENABLE_ALL})
 option(URHO3D_WEBP "WEBP support enabled" ${URHO3D_ENABLE_ALL})
 option(URHO3D_NETWORK "Networking subsystem enabled" ${URHO3D_ENABLE_ALL})
 option(URHO3D_PROFILING "Profiler support enabled" ${URHO3D_PROFILING_DEFAULT})
+# Replacing the global operator new/delete only covers the whole program when the engine is linked statically into it
+if (URHO3D_LIBRARY_TYPE STREQUAL STATIC)
+    option(URHO3D_MEMORY_TRACKING "Replace global operator new/delete to track heap usage per subsystem memory tag (static library only)" FALSE)
+else ()
+    set (URHO3D_MEMORY_TRACKING OFF)
+endif ()
 option(URHO3D_THREADING "Enable multithreading" ${URHO3D_THREADS_DEFAULT})
 if (ANDROID OR WEB OR IOS)
     set (URHO3D_TOOLS OFF)
@@ -112,6 +118,7 @@ option(URHO3D_EXTRAS "Build extra tools" ${URHO3D_EXTRAS_DEFAULT})
 option(URHO3D_SSE "Enable SSE instructions" ${URHO3D_ENABLE_ALL})
 option(URHO3D_SAMPLES "Build samples" ${URHO3D_ENABLE_ALL})
 option(URHO3D_LOGGING "Enable logging subsystem" ${URHO3D_LOGGING_DEFAULT})
+set(URHO3D_LOG_MIN_LEVEL 0 CACHE STRING "Lowest log level compiled in (0 = trace, 1 = debug, 2 = info, 3 = warning, 4 = error)")
 option(URHO3D_SYSTEMUI "Build SystemUI subsystem" ${URHO3D_DEVELOPER})
 option(URHO3D_PACKAGING "Package resources" ${URHO3D_RELEASE})
 option(URHO3D_FILEWATCHER "Watch filesystem for resource changes" ${URHO3D_DEVELOPER})
@@ -28,24 +28,40 @@
 namespace Urho3D
 {
 
-inline unsigned SDBMHash(unsigned hash, unsigned char c) { return c + (hash << 6u) + (hash << 16u) - hash; }
+inline unsigned FoldCase(char c)
+{
+    return (unsigned)(unsigned char)c - 'A' < 26u ? (unsigned)(unsigned char)c | 0x20u : (unsigned)(unsigned char)c;
+}
 
+// Must match StringHash::Calculate(): FNV-1a with ASCII-only case folding, starting from the offset basis unless a nonzero
+// seed continues a previous hash
 unsigned StringHashCalculate(const char* str, unsigned hash=0)
 {
-    if (!str)
+    if (!str || !*str)
         return hash;
 
+    if (!hash)
+        hash = 2166136261u;
     while (*str)
     {
-        // Perform the actual hashing as case-insensitive
-        char c = *str;
-        hash = SDBMHash(hash, (unsigned char)tolower(c));
+        hash = (hash ^ FoldCase(*str)) * 16777619u;
         ++str;
     }
 
     return hash;
 }
 
+// Return the string literal in an event parameter initializer, which is either "Name" or
+// Urho3D::StringHash(Urho3D::StringHash::CalculateConstexpr("Name"))
+std::string GetParamName(const std::string& value)
+{
+    auto start = value.find('"');
+    auto end = start == std::string::npos ? std::string::npos : value.find('"', start + 1);
+    if (end == std::string::npos)
+        return value;
+    return value.substr(start + 1, end - start - 1);
+}
+
 bool Urho3DCustomPassEarly::Visit(MetaEntity* entity, cppast::visitor_info info)
 {
     if (info.event == info.container_entity_exit)
@@ -88,8 +104,7 @@ bool Urho3DCustomPassEarly::Visit(MetaEntity* entity, cppast::visitor_info info)
                 // into single all-caps word while constant values use CamelCase.
                 for (auto& child : eventNamespace->children_)
                 {
-                    auto val = child->GetDefaultValue();
-                    child->name_ = val.substr(1, val.length() - 2);   // Get rid of quotes and prepend P.
+                    child->name_ = GetParamName(child->GetDefaultValue());
                 }
 
                 // Constant naming event is always named "Event" and added to same namespace where event parameters are.
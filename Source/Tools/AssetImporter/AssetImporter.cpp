@@ -40,6 +40,8 @@
 #ifdef URHO3D_PHYSICS
 #include <Urho3D/Physics/PhysicsWorld.h>
 #endif
+#include <Urho3D/Resource/Compress.h>
+#include <Urho3D/Resource/Image.h>
 #include <Urho3D/Resource/ResourceCache.h>
 #include <Urho3D/Resource/XMLFile.h>
 #include <Urho3D/Scene/Scene.h>
@@ -176,6 +178,10 @@ float importStartTime_ = 0.0f;
 float importEndTime_ = 0.0f;
 bool suppressFbxPivotNodes_ = true;
 
+CompressedFormat textureFormat_ = CF_DXT5;
+CompressionQuality textureQuality_ = COMPRESSION_NORMAL;
+bool generateTextureMips_ = true;
+
 int main(int argc, char** argv);
 void Run(const Vector<String>& arguments);
 void DumpNodes(aiNode* rootNode, unsigned level);
@@ -270,6 +276,7 @@ void Run(const Vector<String>& arguments)
             "dump        Dump scene node structure. No output file is generated\n"
             "lod         Combine several Urho3D models as LOD levels of the output model\n"
             "            Syntax: lod <dist0> <mdl0> <dist1 <mdl1> ... <output file>\n"
+            "texture     Block compress an image and save it as .dds or .ktx\n"
             "\n"
             "Options:\n"
             "-b          Save scene in binary format, default format is XML\n"
@@ -306,6 +313,10 @@ void Run(const Vector<String>& arguments)
             "-split <start> <end> (animation model only)\n"
             "            Split animation, will only import from start frame to end frame\n"
             "-np         Do not suppress $fbx pivot nodes (FBX files only)\n"
+            "-tf <fmt>   Texture compression format: BC1 (DXT1), BC2 (DXT3), BC3 (DXT5),\n"
+            "            BC4, BC5 or BC7. Default BC3\n"
+            "-tq <q>     Texture compression quality: fast, normal or high. Default normal\n"
+            "-nmip       Do not generate texture mip levels\n"
         );
     }
 
@@ -456,6 +467,20 @@ void Run(const Vector<String>& arguments)
                 checkUniqueModel_ = false;
             else if (argument == "bp")
                 moveToBindPose_ = true;
+            else if (argument == "tf" && !value.Empty())
+            {
+                textureFormat_ = ParseCompressedFormatName(value);
+                if (textureFormat_ == CF_NONE)
+                    ErrorExit("Unsupported texture compression format " + value);
+                ++i;
+            }
+            else if (argument == "tq" && !value.Empty())
+            {
+                textureQuality_ = ParseCompressionQualityName(value);
+                ++i;
+            }
+            else if (argument == "nmip")
+                generateTextureMips_ = false;
             else if (argument == "split")
             {
                 String value2 = i + 2 < arguments.Size() ? arguments[i + 2] : String::EMPTY;
@@ -612,6 +637,26 @@ void Run(const Vector<String>& arguments)
 
         CombineLods(lodDistances, modelNames, outFile);
     }
+    else if (command == "texture")
+    {
+        if (arguments.Size() < 3 || arguments[2][0] == '-')
+            ErrorExit("No output file defined");
+
+        String inFile = arguments[1];
+        String outFile = GetInternalPath(arguments[2]);
+
+        // Compress blocks on all cores
+        context_->GetSubsystem<WorkQueue>()->CreateThreads(GetNumLogicalCPUs() - 1);
+
+        SharedPtr<Image> image(new Image(context_));
+        if (!image->LoadFile(inFile))
+            ErrorExit("Could not open or decode input image " + inFile);
+
+        PrintLine("Compressing texture " + inFile);
+        SharedPtr<Image> compressed = image->Compress(textureFormat_, textureQuality_, generateTextureMips_);
+        if (!compressed || !compressed->SaveFile(outFile))
+            ErrorExit("Could not compress texture to " + outFile);
+    }
     else
         ErrorExit("Unrecognized command " + command);
 }
@@ -22,6 +22,9 @@
 
 #include <regex>
 
+#include <Urho3D/Resource/Compress.h>
+#include <Toolbox/Graphics/TextureCompression.h>
+
 #include "Editor.h"
 #include "AssetConverter.h"
 
@@ -114,6 +117,11 @@ bool AssetConverter::ConvertAsset(const String& resourceName, const SharedPtr<XM
                 if (ExecuteConverterPOpen(method, resourceName) != 0)
                     return false;
             }
+            else if (method.GetName() == "texture")
+            {
+                if (!ExecuteConverterTexture(method, resourceName))
+                    return false;
+            }
         }
     }
 
@@ -158,6 +166,23 @@ int AssetConverter::ExecuteConverterPOpen(const XMLElement& popen, const String&
     return process.Run();
 }
 
+bool AssetConverter::ExecuteConverterTexture(const XMLElement& texture, const String& resourceName)
+{
+    CompressedFormat format = ParseCompressedFormatName(texture.GetAttribute("format"));
+    if (format == CF_NONE)
+        return false;
+
+    CompressionQuality quality = ParseCompressionQualityName(texture.GetAttribute("quality"));
+    bool generateMips = !texture.HasAttribute("mips") || texture.GetBool("mips");
+
+    String output = texture.GetAttribute("output");
+    if (output.Empty())
+        output = "${resourceCachePath}/" + ReplaceExtension(GetFileName(resourceName), ".dds");
+    InsertVariables(resourceName, output);
+
+    return CompressTexture(context_, GetCache()->GetResourceFileName(resourceName), output, format, quality, generateMips);
+}
+
 void AssetConverter::DispatchChangedAssets()
 {
     if (checkTimer_.GetMSec(false) < 3000)
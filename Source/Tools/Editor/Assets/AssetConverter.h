@@ -58,6 +58,8 @@ protected:
     bool ConvertAsset(const String& resourceName, const SharedPtr<XMLFile>& rules);
     /// Executes external application.
     int ExecuteConverterPOpen(const XMLElement& popen, const String& resourceName);
+    /// Block compresses a texture. Returns true if successful.
+    bool ExecuteConverterTexture(const XMLElement& texture, const String& resourceName);
     /// Returns true if asset in the cache folder is missing or out of date.
     bool IsCacheOutOfDate(const String& resourceName);
     /// Return a list of converted assets in the cache.
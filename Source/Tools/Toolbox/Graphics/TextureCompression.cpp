@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2018 Rokas Kupstys
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/Image.h>
+
+#include "TextureCompression.h"
+
+namespace Urho3D
+{
+
+bool CompressTexture(Context* context, const String& sourcePath, const String& destPath, CompressedFormat format,
+    CompressionQuality quality, bool generateMips)
+{
+    if (!destPath.EndsWith(".dds", false) && !destPath.EndsWith(".ktx", false))
+    {
+        URHO3D_LOGERROR("Compressed texture must be saved as .dds or .ktx: " + destPath);
+        return false;
+    }
+
+    SharedPtr<Image> image(new Image(context));
+    if (!image->LoadFile(sourcePath))
+    {
+        URHO3D_LOGERROR("Failed to load image " + sourcePath);
+        return false;
+    }
+
+    SharedPtr<Image> compressed = image->Compress(format, quality, generateMips);
+    if (!compressed)
+        return false;
+
+    context->GetSubsystem<FileSystem>()->CreateDirsRecursive(GetPath(destPath));
+    return compressed->SaveFile(destPath);
+}
+
+}
@@ -28,6 +28,7 @@
 #include "../Audio/SoundSource3D.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/MemoryStats.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
 #include "../IO/Log.h"
@@ -48,7 +49,7 @@ const char* AUDIO_CATEGORY = "Audio";
 static const int MIN_BUFFERLENGTH = 20;
 static const int MIN_MIXRATE = 11025;
 static const int MAX_MIXRATE = 48000;
-static const StringHash SOUND_MASTER_HASH("Master");
+static const StringHash SOUND_MASTER_HASH = "Master"_sh;
 
 static void SDLAudioCallback(void* userdata, Uint8* stream, int len);
 
@@ -128,6 +129,8 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpo
 
 void Audio::Update(float timeStep)
 {
+    URHO3D_MEMORY_TAG(MEMTAG_AUDIO);
+
     if (!playing_)
         return;
 
@@ -264,6 +267,8 @@ void SDLAudioCallback(void* userdata, Uint8* stream, int len)
 
 void Audio::MixOutput(void* dest, unsigned samples)
 {
+    URHO3D_MEMORY_TAG(MEMTAG_AUDIO);
+
     if (!playing_ || !clipBuffer_)
     {
         memset(dest, 0, samples * (size_t)sampleSize_);
@@ -45,16 +45,24 @@ public struct StringHash
         return new StringHash(value);
     }
 
+    public const uint FnvOffsetBasis = 2166136261;
+    public const uint FnvPrime = 16777619;
+
     public static uint Calculate(string value, uint hash=0)
     {
-        // Perform the actual hashing as case-insensitive
-        var bytes = Encoding.UTF8.GetBytes(value.ToLower());
+        // Must match StringHash::Calculate(): FNV-1a over UTF-8 bytes with ASCII-only case folding. A nonzero seed continues
+        // a previous hash, so that chained hashing equals hashing the concatenated string
+        var bytes = Encoding.UTF8.GetBytes(value);
+        if (bytes.Length == 0)
+            return hash;
+        if (hash == 0)
+            hash = FnvOffsetBasis;
         foreach (var b in bytes)
-            hash = SDBMHash(hash, b);
+            hash = unchecked((hash ^ FoldCase(b)) * FnvPrime);
         return hash;
     }
 
-    public static uint SDBMHash(uint hash, byte c) { return c + (hash << 6) + (hash << 16) - hash; }
+    public static uint FoldCase(byte c) { return c >= 'A' && c <= 'Z' ? (uint)(c | 0x20) : c; }
 
     public override string ToString()
     {
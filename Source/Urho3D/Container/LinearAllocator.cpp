@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/LinearAllocator.h"
+
+#include <cassert>
+#include <cstdint>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Size of the chunk header, rounded up so that chunk data starts at the maximum fundamental alignment.
+static const unsigned CHUNK_HEADER_SIZE = (unsigned)((sizeof(LinearAllocatorChunk) + alignof(std::max_align_t) - 1) &
+    ~(alignof(std::max_align_t) - 1));
+
+static inline unsigned char* GetChunkData(LinearAllocatorChunk* chunk)
+{
+    return reinterpret_cast<unsigned char*>(chunk) + CHUNK_HEADER_SIZE;
+}
+
+LinearAllocator::LinearAllocator(unsigned chunkSize) :
+    chunk_(nullptr),
+    offset_(0),
+    chunkSize_(chunkSize ? chunkSize : LINEAR_ALLOCATOR_DEFAULT_CHUNK_SIZE),
+    used_(0),
+    peak_(0),
+    capacity_(0),
+    numAllocations_(0)
+{
+}
+
+LinearAllocator::~LinearAllocator()
+{
+    FreeChunks(nullptr);
+}
+
+void* LinearAllocator::Allocate(unsigned size, unsigned alignment)
+{
+    assert(alignment && !(alignment & (alignment - 1)));
+
+    if (chunk_)
+    {
+        auto base = reinterpret_cast<uintptr_t>(GetChunkData(chunk_));
+        uintptr_t aligned = (base + offset_ + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        auto newOffset = (unsigned)(aligned - base) + size;
+        if (newOffset <= chunk_->size_)
+        {
+            used_ += newOffset - offset_;
+            offset_ = newOffset;
+            peak_ = used_ > peak_ ? used_ : peak_;
+            ++numAllocations_;
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+
+    // Chunk data is aligned to the fundamental alignment, so only larger alignments need extra room
+    AddChunk(size + (alignment > alignof(std::max_align_t) ? alignment : 0));
+    return Allocate(size, alignment);
+}
+
+void LinearAllocator::Reset()
+{
+    MergeChunks();
+    offset_ = 0;
+    used_ = 0;
+    peak_ = 0;
+    numAllocations_ = 0;
+}
+
+void LinearAllocator::Rewind(const LinearAllocatorMarker& marker)
+{
+    // Rewinding to the start frees everything, so keep the capacity as a reset would, instead of allocating the chunks
+    // again on next use
+    if (!marker.chunk_ || !marker.used_)
+    {
+        MergeChunks();
+        offset_ = 0;
+        used_ = 0;
+        return;
+    }
+
+    FreeChunks(marker.chunk_);
+    offset_ = marker.offset_;
+    used_ = marker.used_;
+}
+
+void LinearAllocator::AddChunk(unsigned minSize)
+{
+    unsigned size = minSize > chunkSize_ ? minSize : chunkSize_;
+    auto* chunk = reinterpret_cast<LinearAllocatorChunk*>(new unsigned char[CHUNK_HEADER_SIZE + size]);
+    chunk->prev_ = chunk_;
+    chunk->size_ = size;
+    chunk_ = chunk;
+    offset_ = 0;
+    capacity_ += size;
+}
+
+void LinearAllocator::MergeChunks()
+{
+    // If the chunk size was exceeded, replace the chunks with one that can hold everything next time
+    if (chunk_ && chunk_->prev_)
+    {
+        unsigned capacity = capacity_;
+        FreeChunks(nullptr);
+        AddChunk(capacity);
+    }
+}
+
+void LinearAllocator::FreeChunks(LinearAllocatorChunk* keep)
+{
+    while (chunk_ && chunk_ != keep)
+    {
+        LinearAllocatorChunk* prev = chunk_->prev_;
+        capacity_ -= chunk_->size_;
+        delete[] reinterpret_cast<unsigned char*>(chunk_);
+        chunk_ = prev;
+    }
+}
+
+LinearAllocator& GetScratchAllocator()
+{
+    static thread_local LinearAllocator allocator;
+    return allocator;
+}
+
+LinearAllocator& GetFrameAllocator()
+{
+    static LinearAllocator allocator;
+    return allocator;
+}
+
+}
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace Urho3D
+{
+
+/// Default size of a linear allocator chunk.
+static const unsigned LINEAR_ALLOCATOR_DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+/// %Linear allocator chunk.
+struct LinearAllocatorChunk
+{
+    /// Previous chunk.
+    LinearAllocatorChunk* prev_;
+    /// Size of the data area.
+    unsigned size_;
+    /// Data follows.
+};
+
+/// Position in a linear allocator, used to free everything allocated after it.
+struct LinearAllocatorMarker
+{
+    /// Chunk.
+    LinearAllocatorChunk* chunk_;
+    /// Offset in the chunk.
+    unsigned offset_;
+    /// Bytes in use.
+    unsigned used_;
+};
+
+/// %Allocator that hands out memory by bumping an offset within chunks and frees everything at once. Destructors of objects allocated from it are never called, so only use it for trivially destructible data. Not thread-safe.
+class URHO3D_API LinearAllocator
+{
+public:
+    /// Construct with chunk size.
+    explicit LinearAllocator(unsigned chunkSize = LINEAR_ALLOCATOR_DEFAULT_CHUNK_SIZE);
+    /// Destruct. Free all chunks.
+    ~LinearAllocator();
+
+    /// Prevent copy construction.
+    LinearAllocator(const LinearAllocator& rhs) = delete;
+    /// Prevent assignment.
+    LinearAllocator& operator =(const LinearAllocator& rhs) = delete;
+
+    /// Allocate memory with the given alignment, which must be a power of two.
+    void* Allocate(unsigned size, unsigned alignment = alignof(std::max_align_t));
+    /// Free everything. When memory had to be spread over several chunks, they are merged into one large enough for all of it.
+    void Reset();
+    /// Return the current position.
+    LinearAllocatorMarker GetMarker() const { return {chunk_, offset_, used_}; }
+    /// Free everything allocated after a position.
+    void Rewind(const LinearAllocatorMarker& marker);
+
+    /// Allocate an uninitialized array.
+    template <class T> T* AllocateArray(unsigned count) { return static_cast<T*>(Allocate((unsigned)(count * sizeof(T)), alignof(T))); }
+
+    /// Allocate and construct an object.
+    template <class T, typename... Args> T* New(Args&&... args)
+    {
+        return new(Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /// Return bytes currently allocated.
+    unsigned GetUsed() const { return used_; }
+
+    /// Return highest number of bytes allocated between resets.
+    unsigned GetPeak() const { return peak_; }
+
+    /// Return total size of the chunks.
+    unsigned GetCapacity() const { return capacity_; }
+
+    /// Return number of allocations since the last reset.
+    unsigned GetNumAllocations() const { return numAllocations_; }
+
+private:
+    /// Add a chunk that can hold at least the given size.
+    void AddChunk(unsigned minSize);
+    /// Replace several chunks with one of their total size.
+    void MergeChunks();
+    /// Free chunks down to but not including the given chunk.
+    void FreeChunks(LinearAllocatorChunk* keep);
+
+    /// Current chunk.
+    LinearAllocatorChunk* chunk_;
+    /// Offset in the current chunk.
+    unsigned offset_;
+    /// Chunk size.
+    unsigned chunkSize_;
+    /// Bytes in use.
+    unsigned used_;
+    /// Peak bytes in use.
+    unsigned peak_;
+    /// Total size of chunks.
+    unsigned capacity_;
+    /// Number of allocations since the last reset.
+    unsigned numAllocations_;
+};
+
+/// Rewinds a linear allocator to its position at construction when going out of scope.
+class URHO3D_API LinearAllocatorScope
+{
+public:
+    /// Construct and remember the position.
+    explicit LinearAllocatorScope(LinearAllocator& allocator) :
+        allocator_(allocator),
+        marker_(allocator.GetMarker())
+    {
+    }
+
+    /// Destruct. Free everything allocated within the scope.
+    ~LinearAllocatorScope() { allocator_.Rewind(marker_); }
+
+    /// Prevent copy construction.
+    LinearAllocatorScope(const LinearAllocatorScope& rhs) = delete;
+    /// Prevent assignment.
+    LinearAllocatorScope& operator =(const LinearAllocatorScope& rhs) = delete;
+
+    /// Return the allocator.
+    LinearAllocator& GetAllocator() const { return allocator_; }
+
+private:
+    /// Allocator.
+    LinearAllocator& allocator_;
+    /// Position at construction.
+    LinearAllocatorMarker marker_;
+};
+
+/// Return the scratch allocator of the calling thread. Use within a LinearAllocatorScope so that memory is returned when done.
+URHO3D_API LinearAllocator& GetScratchAllocator();
+/// Return the frame allocator, which the engine resets at the end of each frame. Main thread only. Use within a LinearAllocatorScope when the memory is not needed until the end of the frame.
+URHO3D_API LinearAllocator& GetFrameAllocator();
+
+}
@@ -156,10 +156,8 @@ public:
         T* ptr = ptr_;
         if (ptr_)
         {
-            RefCount* refCount = RefCountPtr();
-            ++refCount->refs_; // 2 refs
-            Reset(); // 1 ref
-            --refCount->refs_; // 0 refs
+            ptr_ = nullptr;
+            ptr->ReleaseRefNoDelete();
         }
         return ptr;
     }
@@ -438,7 +436,7 @@ public:
     bool NotNull() const { return refCount_ != nullptr; }
 
     /// Return the object's reference count, or 0 if null pointer or if object has expired.
-    int Refs() const { return (refCount_ && refCount_->refs_ >= 0) ? refCount_->refs_ : 0; }
+    int Refs() const { return Expired() ? 0 : ptr_->Refs(); }
 
     /// Return the object's weak reference count.
     int WeakRefs() const
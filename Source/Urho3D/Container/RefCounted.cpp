@@ -29,56 +29,69 @@
 namespace Urho3D
 {
 
-RefCounted::RefCounted() :
-    refCount_(new RefCount())
-{
-    // Hold a weak ref to self to avoid possible double delete of the refcount
-    (refCount_->weakRefs_)++;
-}
+RefCounted::RefCounted() = default;
 
 RefCounted::~RefCounted()
 {
-    assert(refCount_);
-    assert(refCount_->refs_ == 0);
-    assert(refCount_->weakRefs_ > 0);
+    assert(refs_.load(std::memory_order_relaxed) == 0);
+    refs_.store(-1, std::memory_order_relaxed);
+
+    RefCount* refCount = refCount_.load(std::memory_order_acquire);
+    if (refCount)
+    {
+        assert(refCount->weakRefs_ > 0);
 
-    // Mark object as expired, release the self weak ref and delete the refcount if no other weak refs exist
-    refCount_->refs_ = -1;
-    (refCount_->weakRefs_)--;
-    if (!refCount_->weakRefs_)
-        delete refCount_;
+        // Mark object as expired, release the self weak ref and delete the refcount if no other weak refs exist
+        refCount->refs_ = -1;
+        (refCount->weakRefs_)--;
+        if (!refCount->weakRefs_)
+            delete refCount;
 
-    refCount_ = nullptr;
+        refCount_.store(nullptr, std::memory_order_relaxed);
+    }
 }
 
-void RefCounted::AddRef()
+void RefCounted::ReleaseRefNoDelete()
 {
-    assert(refCount_->refs_ >= 0);
-    (refCount_->refs_)++;
+    assert(refs_.load(std::memory_order_relaxed) > 0);
+    refs_.fetch_sub(1, std::memory_order_relaxed);
 }
 
-void RefCounted::ReleaseRef()
+int RefCounted::WeakRefs() const
 {
-    assert(refCount_->refs_ > 0);
-    (refCount_->refs_)--;
-    if (!refCount_->refs_)
-    {
-        if (deleter_ != nullptr)
-            deleter_(this, deleterUserData_);
-        else
-            delete this;
-    }
+    // Subtract one to not return the internally held reference
+    RefCount* refCount = refCount_.load(std::memory_order_acquire);
+    return refCount ? refCount->weakRefs_ - 1 : 0;
 }
 
-int RefCounted::Refs() const
+void RefCounted::SetThreadShared(bool enable)
 {
-    return refCount_->refs_;
+    threadShared_ = enable;
 }
 
-int RefCounted::WeakRefs() const
+RefCount* RefCounted::AllocateRefCount()
 {
-    // Subtract one to not return the internally held reference
-    return refCount_->weakRefs_ - 1;
+    auto* refCount = new RefCount();
+    // Hold a weak ref to self to avoid possible double delete of the refcount
+    (refCount->weakRefs_)++;
+
+    // Threads taking the first weak reference at the same time race to install the structure. The losers use the winner's
+    RefCount* installed = nullptr;
+    if (!refCount_.compare_exchange_strong(installed, refCount, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        delete refCount;
+        return installed;
+    }
+
+    return refCount;
+}
+
+void RefCounted::DeleteSelf()
+{
+    if (deleter_ != nullptr)
+        deleter_(this, deleterUserData_);
+    else
+        delete this;
 }
 
 void RefCounted::SetDeleter(void (* deleter)(RefCounted*, void*), void* userData)
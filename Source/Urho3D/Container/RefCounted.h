@@ -28,6 +28,9 @@
 #include <Urho3D/Urho3D.h>
 #endif
 
+#include <atomic>
+#include <cassert>
+
 namespace Urho3D
 {
 
@@ -49,32 +52,65 @@ struct RefCount
         weakRefs_ = -1;
     }
 
-    /// Reference count. If below zero, the object has been destroyed.
+    /// Reference count. If below zero, the object has been destroyed. RefCounted objects keep their count internally and leave this at zero while alive.
     int refs_;
     /// Weak reference count.
     int weakRefs_;
 };
 
-/// Base class for intrusively reference-counted objects. These are noncopyable and non-assignable.
+/// Base class for intrusively reference-counted objects. These are noncopyable and non-assignable. The reference count lives in the object; the structure for weak references is only allocated when first needed.
 class URHO3D_API RefCounted
 {
 public:
-    /// Construct. Allocate the reference count structure and set an initial self weak reference.
+    /// Construct.
     RefCounted();
     /// Destruct. Mark as expired and also delete the reference count structure if no outside weak references exist.
     virtual ~RefCounted();
 
     /// Increment reference count. Can also be called outside of a SharedPtr for traditional reference counting.
-    void AddRef();
+    void AddRef()
+    {
+        assert(refs_.load(std::memory_order_relaxed) >= 0);
+        if (threadShared_)
+            refs_.fetch_add(1, std::memory_order_relaxed);
+        else
+            refs_.store(refs_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
     /// Decrement reference count and delete self if no more references. Can also be called outside of a SharedPtr for traditional reference counting.
-    void ReleaseRef();
+    void ReleaseRef()
+    {
+        assert(refs_.load(std::memory_order_relaxed) > 0);
+        int refs;
+        if (threadShared_)
+            refs = refs_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        else
+        {
+            refs = refs_.load(std::memory_order_relaxed) - 1;
+            refs_.store(refs, std::memory_order_relaxed);
+        }
+        if (!refs)
+            DeleteSelf();
+    }
+
+    /// Decrement reference count without deleting self when it reaches zero. Used to hand the object over to scripting language ownership.
+    void ReleaseRefNoDelete();
     /// Return reference count.
-    int Refs() const;
+    int Refs() const { return refs_.load(std::memory_order_relaxed); }
     /// Return weak reference count.
     int WeakRefs() const;
 
-    /// Return pointer to the reference count structure.
-    RefCount* RefCountPtr() { return refCount_; }
+    /// Return pointer to the reference count structure, allocating it on first use. Safe to call from several threads at once.
+    RefCount* RefCountPtr()
+    {
+        RefCount* refCount = refCount_.load(std::memory_order_acquire);
+        return refCount ? refCount : AllocateRefCount();
+    }
+
+    /// Set whether strong references may be added and released from several threads at once, which makes them use atomic operations. Weak references remain single-threaded.
+    void SetThreadShared(bool enable);
+    /// Return whether strong references use atomic operations.
+    bool IsThreadShared() const { return threadShared_; }
 
     /// Set a custom deleter function which will be in charge of deallocating object.
     void SetDeleter(void(*deleter)(RefCounted* instance, void* userData), void* userData = nullptr);
@@ -87,8 +123,17 @@ private:
     /// Prevent assignment.
     RefCounted& operator =(const RefCounted& rhs);
 
-    /// Pointer to the reference count structure.
-    RefCount* refCount_;
+    /// Allocate the reference count structure with an initial self weak reference and install it, unless another thread installed one first. Return the installed structure.
+    RefCount* AllocateRefCount();
+    /// Delete self, using the custom deleter if set.
+    void DeleteSelf();
+
+    /// Pointer to the reference count structure. Null until a weak reference is made.
+    std::atomic<RefCount*> refCount_{};
+    /// Reference count.
+    std::atomic<int> refs_{};
+    /// Whether the reference count is modified atomically.
+    bool threadShared_{};
 
     /// Custom pointer that will be passed to deleter when object refcount reaches zero.
     void* deleterUserData_ = nullptr;
@@ -0,0 +1,379 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Vector.h"
+
+namespace Urho3D
+{
+
+/// Handle to a value in a slot map. Unlike the plain ID, it detects that the value has been removed even if the ID has since been reused.
+template <class T> struct SlotHandle
+{
+    /// Construct null.
+    SlotHandle() = default;
+
+    /// Construct from ID and generation.
+    SlotHandle(unsigned id, unsigned generation) :
+        id_(id),
+        generation_(generation)
+    {
+    }
+
+    /// Test for equality with another handle.
+    bool operator ==(const SlotHandle<T>& rhs) const { return id_ == rhs.id_ && generation_ == rhs.generation_; }
+
+    /// Test for inequality with another handle.
+    bool operator !=(const SlotHandle<T>& rhs) const { return !(*this == rhs); }
+
+    /// Return whether is null.
+    bool IsNull() const { return !id_; }
+
+    /// Return hash value for HashSet & HashMap.
+    unsigned ToHash() const { return id_ * 31 + generation_; }
+
+    /// ID.
+    unsigned id_{};
+    /// Generation of the slot when the handle was made.
+    unsigned generation_{};
+};
+
+/// Map from IDs within a range to pointers. Values live in pages of slots indexed directly by ID through a two-level page directory, allocated on demand and freed when empty, and are also kept in dense arrays for iteration. Each slot has a generation counter that changes whenever its value is removed, to detect stale handles. Removed IDs can optionally be recycled. They are handed out oldest first, so that a plain ID held elsewhere after its value was removed stays unused for as long as possible.
+template <class T> class SlotMap
+{
+public:
+    /// Construct with the range of valid IDs and whether to recycle removed IDs.
+    SlotMap(unsigned firstID, unsigned lastID, bool recycleIDs) :
+        firstID_(firstID),
+        lastID_(lastID),
+        recycleIDs_(recycleIDs)
+    {
+    }
+
+    /// Destruct.
+    ~SlotMap()
+    {
+        for (unsigned i = 0; i < tables_.Size(); ++i)
+        {
+            if (tables_[i])
+            {
+                for (unsigned j = 0; j < TABLE_SIZE; ++j)
+                    delete tables_[i]->pages_[j];
+                delete tables_[i];
+            }
+        }
+    }
+
+    /// Prevent copy construction.
+    SlotMap(const SlotMap<T>& rhs) = delete;
+    /// Prevent assignment.
+    SlotMap<T>& operator =(const SlotMap<T>& rhs) = delete;
+
+    /// Insert a value at an ID. Inserting null removes the value. Return the value it replaced, or null.
+    T* Insert(unsigned id, T* value)
+    {
+        if (!value)
+        {
+            T* previous = Get(id);
+            Erase(id);
+            return previous;
+        }
+
+        Slot* slot = AcquireSlot(id);
+        if (!slot)
+            return nullptr;
+
+        T* previous = slot->value_;
+        if (previous == value)
+            return nullptr;
+
+        if (previous)
+        {
+            // Replacing counts as removal for handles to the previous value
+            ++slot->generation_;
+            values_[slot->index_] = value;
+        }
+        else
+        {
+            slot->index_ = values_.Size();
+            values_.Push(value);
+            ids_.Push(id);
+            ++GetPage(id)->count_;
+        }
+
+        slot->value_ = value;
+        return previous;
+    }
+
+    /// Remove the value at an ID. Return true if there was one.
+    bool Erase(unsigned id)
+    {
+        Slot* slot = GetSlot(id);
+        if (!slot || !slot->value_)
+            return false;
+
+        // Move the last value into the removed one's place in the dense arrays
+        const unsigned index = slot->index_;
+        const unsigned lastID = ids_.Back();
+        values_[index] = values_.Back();
+        ids_[index] = lastID;
+        GetSlot(lastID)->index_ = index;
+        values_.Pop();
+        ids_.Pop();
+
+        slot->value_ = nullptr;
+        ++slot->generation_;
+
+        if (!--GetPage(id)->count_)
+            FreePage(id);
+
+        if (recycleIDs_)
+            recycledIDs_.Push(id);
+        return true;
+    }
+
+    /// Remove all values and recycled IDs.
+    void Clear()
+    {
+        for (unsigned i = 0; i < ids_.Size(); ++i)
+        {
+            if (GetPage(ids_[i]))
+                FreePage(ids_[i]);
+        }
+        values_.Clear();
+        ids_.Clear();
+        ClearRecycledIDs();
+    }
+
+    /// Forget recycled IDs, so that new IDs are handed out by the caller's own scheme.
+    void ClearRecycledIDs()
+    {
+        recycledIDs_.Clear();
+        recycledHead_ = 0;
+    }
+
+    /// Take the oldest recycled ID that is still free. Return 0 if none.
+    unsigned TakeRecycledID()
+    {
+        while (recycledHead_ < recycledIDs_.Size())
+        {
+            const unsigned id = recycledIDs_[recycledHead_++];
+
+            // Compact once the consumed part dominates
+            if (recycledHead_ >= recycledIDs_.Size() / 2 && recycledHead_ >= 64)
+            {
+                recycledIDs_.Erase(0, recycledHead_);
+                recycledHead_ = 0;
+            }
+
+            // The ID may have been taken explicitly since it was removed
+            if (!Contains(id))
+                return id;
+        }
+
+        ClearRecycledIDs();
+        return 0;
+    }
+
+    /// Return the value at an ID, or null.
+    T* Get(unsigned id) const
+    {
+        const Slot* slot = GetSlot(id);
+        return slot ? slot->value_ : nullptr;
+    }
+
+    /// Return the value of a handle, or null if it has been removed.
+    T* Get(const SlotHandle<T>& handle) const
+    {
+        const Slot* slot = GetSlot(handle.id_);
+        return slot && slot->generation_ == handle.generation_ ? slot->value_ : nullptr;
+    }
+
+    /// Return a handle to the value at an ID, or a null handle if there is none.
+    SlotHandle<T> GetHandle(unsigned id) const
+    {
+        const Slot* slot = GetSlot(id);
+        return slot && slot->value_ ? SlotHandle<T>(id, slot->generation_) : SlotHandle<T>();
+    }
+
+    /// Return whether there is a value at an ID.
+    bool Contains(unsigned id) const { return Get(id) != nullptr; }
+
+    /// Return the values in unspecified order.
+    const PODVector<T*>& GetValues() const { return values_; }
+
+    /// Return the IDs in the same order as the values.
+    const PODVector<unsigned>& GetIDs() const { return ids_; }
+
+    /// Return number of values.
+    unsigned Size() const { return values_.Size(); }
+
+    /// Return whether has no values.
+    bool Empty() const { return values_.Empty(); }
+
+private:
+    /// Number of ID bits covered by a page.
+    static const unsigned PAGE_SIZE_BITS = 10;
+    /// Number of slots in a page.
+    static const unsigned PAGE_SIZE = 1u << PAGE_SIZE_BITS;
+    /// Number of page bits covered by a page table. Together with the pages, the at most 2048 tables cover all 32-bit IDs.
+    static const unsigned TABLE_SIZE_BITS = 11;
+    /// Number of pages in a page table.
+    static const unsigned TABLE_SIZE = 1u << TABLE_SIZE_BITS;
+
+    /// Slot of an ID.
+    struct Slot
+    {
+        /// Value or null.
+        T* value_;
+        /// Generation, changed whenever a value is removed.
+        unsigned generation_;
+        /// Index of the value in the dense arrays.
+        unsigned index_;
+    };
+
+    /// Page of slots.
+    struct Page
+    {
+        /// Slots.
+        Slot slots_[PAGE_SIZE];
+        /// Number of values.
+        unsigned count_;
+    };
+
+    /// Table of pages.
+    struct PageTable
+    {
+        /// Pages or null.
+        Page* pages_[TABLE_SIZE];
+        /// Number of allocated pages.
+        unsigned count_;
+    };
+
+    /// Return the page of an ID, or null if out of range or not allocated.
+    Page* GetPage(unsigned id) const
+    {
+        if (id < firstID_ || id > lastID_)
+            return nullptr;
+
+        const unsigned offset = id - firstID_;
+        const unsigned table = offset >> (PAGE_SIZE_BITS + TABLE_SIZE_BITS);
+        return table < tables_.Size() && tables_[table] ? tables_[table]->pages_[(offset >> PAGE_SIZE_BITS) & (TABLE_SIZE - 1)] :
+            nullptr;
+    }
+
+    /// Return the slot of an ID, or null if out of range or its page is not allocated.
+    Slot* GetSlot(unsigned id) const
+    {
+        Page* page = GetPage(id);
+        return page ? &page->slots_[(id - firstID_) & (PAGE_SIZE - 1)] : nullptr;
+    }
+
+    /// Return the slot of an ID, allocating its page if necessary. Return null if out of range.
+    Slot* AcquireSlot(unsigned id)
+    {
+        if (id < firstID_ || id > lastID_)
+            return nullptr;
+
+        // Tables are allocated only for the ID ranges in use, so that a single high ID does not grow a flat directory
+        const unsigned offset = id - firstID_;
+        const unsigned table = offset >> (PAGE_SIZE_BITS + TABLE_SIZE_BITS);
+        if (table >= tables_.Size())
+        {
+            const unsigned oldSize = tables_.Size();
+            tables_.Resize(table + 1);
+            for (unsigned i = oldSize; i <= table; ++i)
+                tables_[i] = nullptr;
+        }
+        if (!tables_[table])
+        {
+            tables_[table] = new PageTable();
+            for (unsigned i = 0; i < TABLE_SIZE; ++i)
+                tables_[table]->pages_[i] = nullptr;
+            tables_[table]->count_ = 0;
+        }
+
+        PageTable* pageTable = tables_[table];
+        Page*& page = pageTable->pages_[(offset >> PAGE_SIZE_BITS) & (TABLE_SIZE - 1)];
+        if (!page)
+        {
+            // Start above any generation handed out from freed pages so that old handles stay stale
+            page = new Page();
+            for (unsigned i = 0; i < PAGE_SIZE; ++i)
+            {
+                page->slots_[i].value_ = nullptr;
+                page->slots_[i].generation_ = pageGeneration_;
+                page->slots_[i].index_ = 0;
+            }
+            page->count_ = 0;
+            ++pageTable->count_;
+        }
+
+        return &page->slots_[offset & (PAGE_SIZE - 1)];
+    }
+
+    /// Free the page of an ID, remembering the highest generation it had. Free its table too if left empty.
+    void FreePage(unsigned id)
+    {
+        const unsigned offset = id - firstID_;
+        const unsigned table = offset >> (PAGE_SIZE_BITS + TABLE_SIZE_BITS);
+        PageTable* pageTable = tables_[table];
+        Page*& page = pageTable->pages_[(offset >> PAGE_SIZE_BITS) & (TABLE_SIZE - 1)];
+
+        for (unsigned i = 0; i < PAGE_SIZE; ++i)
+        {
+            if (page->slots_[i].generation_ >= pageGeneration_)
+                pageGeneration_ = page->slots_[i].generation_ + 1;
+        }
+        delete page;
+        page = nullptr;
+
+        if (!--pageTable->count_)
+        {
+            delete pageTable;
+            tables_[table] = nullptr;
+        }
+    }
+
+    /// Page tables, allocated on demand.
+    PODVector<PageTable*> tables_;
+    /// Values.
+    PODVector<T*> values_;
+    /// IDs of the values.
+    PODVector<unsigned> ids_;
+    /// Removed IDs, oldest first, starting from the head index.
+    PODVector<unsigned> recycledIDs_;
+    /// Index of the oldest recycled ID not yet taken.
+    unsigned recycledHead_{};
+    /// Generation of the slots of new pages.
+    unsigned pageGeneration_{};
+    /// First valid ID.
+    unsigned firstID_;
+    /// Last valid ID.
+    unsigned lastID_;
+    /// Whether removed IDs are recycled.
+    bool recycleIDs_;
+};
+
+}
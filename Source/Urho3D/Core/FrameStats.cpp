@@ -0,0 +1,488 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/FrameStats.h"
+#include "../Core/Thread.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+
+#include <chrono>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Value of a metric recorded by one thread during the current frame.
+struct FrameStatsThreadValue
+{
+    /// Metric name. Copied on the first record only.
+    String name_;
+    /// Accumulated or last set value.
+    double value_{};
+    /// Whether recorded on the current frame.
+    bool active_{};
+};
+
+/// Values and trace events recorded by one thread during the current frame.
+struct FrameStatsThreadBuffer
+{
+    /// Mutex, taken by the owning thread when recording and by the main thread when merging, so practically uncontended.
+    Mutex mutex_;
+    /// Values by metric. Kept between frames, so that recording does not allocate in steady state.
+    HashMap<FrameMetricKey, FrameStatsThreadValue> values_;
+    /// Trace events recorded while tracing.
+    Vector<FrameTraceEvent> traceEvents_;
+    /// Thread ID.
+    ThreadID threadID_;
+    /// Thread index for trace events. The main thread is always 0.
+    unsigned threadIndex_;
+};
+
+/// Buffer of the calling thread in the frame statistics instance that last used it.
+struct FrameStatsThreadCache
+{
+    /// Instance ID.
+    unsigned ownerID_;
+    /// Buffer.
+    FrameStatsThreadBuffer* buffer_;
+};
+
+static std::atomic<unsigned> nextFrameStatsID{1};
+static thread_local FrameStatsThreadCache threadCache{};
+
+static long long GetClockUSec()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* metricTypeNames[] =
+{
+    "timing",
+    "counter",
+    "gauge"
+};
+
+static bool CompareSummaries(const FrameMetricSummary& lhs, const FrameMetricSummary& rhs)
+{
+    if (lhs.type_ != rhs.type_)
+        return lhs.type_ < rhs.type_;
+    return lhs.name_ < rhs.name_;
+}
+
+static float Percentile(const PODVector<float>& sorted, float percentile)
+{
+    // Nearest-rank method
+    auto rank = (unsigned)CeilToInt(percentile * sorted.Size());
+    return sorted[Clamp(rank, 1U, sorted.Size()) - 1];
+}
+
+static String EscapeJSON(const String& str)
+{
+    String ret;
+    ret.Reserve(str.Length());
+    for (unsigned i = 0; i < str.Length(); ++i)
+    {
+        char c = str[i];
+        if (c == '"' || c == '\\')
+            ret += '\\';
+        if ((unsigned char)c >= 0x20)
+            ret += c;
+    }
+    return ret;
+}
+
+static String EscapeCSV(const String& str)
+{
+    if (!str.Contains(',') && !str.Contains('"'))
+        return str;
+    return "\"" + str.Replaced("\"", "\"\"") + "\"";
+}
+
+FrameStats::FrameStats(Context* context) :
+    Object(context),
+    id_(nextFrameStatsID.fetch_add(1, std::memory_order_relaxed)),
+    timeBase_(GetClockUSec()),
+    windowSize_(FRAME_STATS_DEFAULT_WINDOW),
+    enabled_(true),
+    tracing_(false)
+{
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(FrameStats, HandleEndFrame));
+}
+
+FrameStats::~FrameStats()
+{
+    for (unsigned i = 0; i < threadBuffers_.Size(); ++i)
+        delete threadBuffers_[i];
+}
+
+void FrameStats::SetEnabled(bool enable)
+{
+    enabled_.store(enable, std::memory_order_relaxed);
+}
+
+void FrameStats::SetWindowSize(unsigned frames)
+{
+    MutexLock lock(mutex_);
+
+    windowSize_ = Max(frames, 1U);
+    for (HashMap<FrameMetricKey, FrameMetric>::Iterator i = metrics_.Begin(); i != metrics_.End(); ++i)
+    {
+        i->second_.samples_.Clear();
+        i->second_.next_ = 0;
+    }
+}
+
+void FrameStats::Clear()
+{
+    MutexLock lock(mutex_);
+    metrics_.Clear();
+}
+
+void FrameStats::AddTiming(const char* name, StringHash nameHash, long long usec)
+{
+    if (IsEnabled())
+        Record(name, nameHash, FRAME_METRIC_TIMING, (double)usec, IsTracing() ? GetTimeUSec() - usec : 0);
+}
+
+void FrameStats::AddCounter(const char* name, StringHash nameHash, double delta)
+{
+    if (IsEnabled())
+        Record(name, nameHash, FRAME_METRIC_COUNTER, delta, 0);
+}
+
+void FrameStats::SetGauge(const char* name, StringHash nameHash, double value)
+{
+    if (IsEnabled())
+        Record(name, nameHash, FRAME_METRIC_GAUGE, value, 0);
+}
+
+void FrameStats::EndFrame()
+{
+    long long now = GetTimeUSec();
+
+    MutexLock lock(mutex_);
+
+    if (!IsEnabled())
+    {
+        frameStart_ = now;
+        return;
+    }
+
+    MergeThreadBuffers();
+
+    static const StringHash frameHash("Frame");
+    FrameMetric& frame = GetMetric("Frame", frameHash, FRAME_METRIC_TIMING);
+    frame.current_ = (now - frameStart_) * 0.001;
+    frame.active_ = true;
+    if (IsTracing())
+        AddTraceEvent("Frame", FRAME_METRIC_TIMING, frameStart_, (double)(now - frameStart_), 0);
+    frameStart_ = now;
+
+    for (HashMap<FrameMetricKey, FrameMetric>::Iterator i = metrics_.Begin(); i != metrics_.End(); ++i)
+    {
+        FrameMetric& metric = i->second_;
+        // Counters sample zero on frames they were not touched; timings skip such frames
+        if (!metric.active_ && metric.type_ != FRAME_METRIC_COUNTER)
+            continue;
+
+        if (metric.samples_.Size() < windowSize_)
+            metric.samples_.Push((float)metric.current_);
+        else
+            metric.samples_[metric.next_] = (float)metric.current_;
+        metric.next_ = (metric.next_ + 1) % windowSize_;
+
+        if (IsTracing() && metric.type_ != FRAME_METRIC_TIMING)
+            AddTraceEvent(metric.name_, metric.type_, now, metric.current_, 0);
+
+        // Gauges keep their value until set again
+        if (metric.type_ != FRAME_METRIC_GAUGE)
+        {
+            metric.current_ = 0.0;
+            metric.active_ = false;
+        }
+    }
+}
+
+void FrameStats::StartTrace(unsigned maxEvents)
+{
+    long long now = GetTimeUSec();
+
+    MutexLock lock(mutex_);
+    traceEvents_.Clear();
+    maxTraceEvents_ = maxEvents;
+    traceStart_ = now;
+    tracing_.store(true, std::memory_order_relaxed);
+}
+
+void FrameStats::StopTrace()
+{
+    MutexLock lock(mutex_);
+    tracing_.store(false, std::memory_order_relaxed);
+}
+
+bool FrameStats::SaveTrace(const String& fileName) const
+{
+    String json = "{\"traceEvents\":[\n";
+    {
+        MutexLock lock(mutex_);
+
+        json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Main\"}},\n";
+        for (unsigned i = 1; i <= numThreads_; ++i)
+            json.AppendWithFormat("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}},\n", i, i);
+
+        for (unsigned i = 0; i < traceEvents_.Size(); ++i)
+        {
+            const FrameTraceEvent& event = traceEvents_[i];
+            json += "{\"name\":\"" + EscapeJSON(event.name_) + "\",\"pid\":0,\"tid\":" + String(event.thread_) + ",\"ts\":" +
+                String(event.start_);
+            if (event.type_ == FRAME_METRIC_TIMING)
+                json += ",\"ph\":\"X\",\"dur\":" + String((long long)event.value_) + "}";
+            else
+                json += ",\"ph\":\"C\",\"args\":{\"value\":" + String(event.value_) + "}}";
+            json += i + 1 < traceEvents_.Size() ? ",\n" : "\n";
+        }
+    }
+    json += "]}\n";
+
+    File file(context_);
+    if (!file.Open(fileName, FILE_WRITE))
+        return false;
+    return file.Write(json.CString(), json.Length()) == json.Length();
+}
+
+bool FrameStats::SaveCSV(const String& fileName) const
+{
+    Vector<FrameMetricSummary> summaries;
+    GetSummaries(summaries);
+
+    String csv = "name,type,samples,min,avg,p50,p95,p99,max\n";
+    for (unsigned i = 0; i < summaries.Size(); ++i)
+    {
+        const FrameMetricSummary& summary = summaries[i];
+        csv += EscapeCSV(summary.name_) + "," + metricTypeNames[summary.type_] + "," + String(summary.samples_) + "," +
+            String(summary.min_) + "," + String(summary.avg_) + "," + String(summary.p50_) + "," + String(summary.p95_) + "," +
+            String(summary.p99_) + "," + String(summary.max_) + "\n";
+    }
+
+    File file(context_);
+    if (!file.Open(fileName, FILE_WRITE))
+        return false;
+    return file.Write(csv.CString(), csv.Length()) == csv.Length();
+}
+
+bool FrameStats::GetSummary(const String& name, FrameMetricType type, FrameMetricSummary& summary) const
+{
+    MutexLock lock(mutex_);
+
+    HashMap<FrameMetricKey, FrameMetric>::ConstIterator i = metrics_.Find(FrameMetricKey(name, type));
+    if (i == metrics_.End())
+        return false;
+
+    ComputeSummary(i->second_, summary);
+    return true;
+}
+
+void FrameStats::GetSummaries(Vector<FrameMetricSummary>& summaries) const
+{
+    {
+        MutexLock lock(mutex_);
+
+        summaries.Resize(metrics_.Size());
+        unsigned index = 0;
+        for (HashMap<FrameMetricKey, FrameMetric>::ConstIterator i = metrics_.Begin(); i != metrics_.End(); ++i)
+            ComputeSummary(i->second_, summaries[index++]);
+    }
+
+    Sort(summaries.Begin(), summaries.End(), CompareSummaries);
+}
+
+unsigned FrameStats::GetNumTraceEvents() const
+{
+    MutexLock lock(mutex_);
+    return traceEvents_.Size();
+}
+
+long long FrameStats::GetTimeUSec() const
+{
+    return GetClockUSec() - timeBase_;
+}
+
+void FrameStats::Record(const char* name, StringHash nameHash, FrameMetricType type, double value, long long start)
+{
+    FrameStatsThreadBuffer* buffer = GetThreadBuffer();
+    MutexLock lock(buffer->mutex_);
+
+    FrameStatsThreadValue& entry = buffer->values_[FrameMetricKey(nameHash, type)];
+    if (entry.name_.Empty())
+        entry.name_ = name;
+    if (type == FRAME_METRIC_GAUGE)
+        entry.value_ = value;
+    else
+        entry.value_ += value;
+    entry.active_ = true;
+
+    if (type == FRAME_METRIC_TIMING && IsTracing())
+    {
+        FrameTraceEvent event;
+        event.name_ = entry.name_;
+        event.start_ = start;
+        event.value_ = value;
+        event.thread_ = buffer->threadIndex_;
+        event.type_ = type;
+        buffer->traceEvents_.Push(event);
+    }
+}
+
+FrameStatsThreadBuffer* FrameStats::GetThreadBuffer()
+{
+    if (threadCache.ownerID_ == id_)
+        return threadCache.buffer_;
+
+    MutexLock lock(mutex_);
+
+    ThreadID threadID = Thread::GetCurrentThreadID();
+    FrameStatsThreadBuffer* buffer = nullptr;
+    for (unsigned i = 0; i < threadBuffers_.Size(); ++i)
+    {
+        if (threadBuffers_[i]->threadID_ == threadID)
+        {
+            buffer = threadBuffers_[i];
+            break;
+        }
+    }
+
+    if (!buffer)
+    {
+        buffer = new FrameStatsThreadBuffer();
+        buffer->threadID_ = threadID;
+        buffer->threadIndex_ = Thread::IsMainThread() ? 0 : ++numThreads_;
+        threadBuffers_.Push(buffer);
+    }
+
+    threadCache.ownerID_ = id_;
+    threadCache.buffer_ = buffer;
+    return buffer;
+}
+
+void FrameStats::MergeThreadBuffers()
+{
+    for (unsigned i = 0; i < threadBuffers_.Size(); ++i)
+    {
+        FrameStatsThreadBuffer* buffer = threadBuffers_[i];
+        MutexLock lock(buffer->mutex_);
+
+        for (HashMap<FrameMetricKey, FrameStatsThreadValue>::Iterator j = buffer->values_.Begin(); j != buffer->values_.End(); ++j)
+        {
+            FrameStatsThreadValue& entry = j->second_;
+            if (!entry.active_)
+                continue;
+
+            FrameMetric& metric = GetMetric(entry.name_, j->first_.name_, j->first_.type_);
+            if (metric.type_ == FRAME_METRIC_TIMING)
+                metric.current_ += entry.value_ * 0.001;
+            else if (metric.type_ == FRAME_METRIC_COUNTER)
+                metric.current_ += entry.value_;
+            else
+                metric.current_ = entry.value_;
+            metric.active_ = true;
+
+            entry.value_ = 0.0;
+            entry.active_ = false;
+        }
+
+        for (unsigned j = 0; j < buffer->traceEvents_.Size(); ++j)
+        {
+            const FrameTraceEvent& event = buffer->traceEvents_[j];
+            // Skip events recorded before the capture started
+            if (IsTracing() && event.start_ >= traceStart_)
+                AddTraceEvent(event.name_, event.type_, event.start_, event.value_, event.thread_);
+        }
+        buffer->traceEvents_.Clear();
+    }
+}
+
+FrameMetric& FrameStats::GetMetric(const String& name, StringHash nameHash, FrameMetricType type)
+{
+    FrameMetric& metric = metrics_[FrameMetricKey(nameHash, type)];
+    if (metric.name_.Empty())
+    {
+        metric.name_ = name;
+        metric.type_ = type;
+    }
+    return metric;
+}
+
+void FrameStats::AddTraceEvent(const String& name, FrameMetricType type, long long start, double value, unsigned thread)
+{
+    if (traceEvents_.Size() >= maxTraceEvents_)
+    {
+        URHO3D_LOGWARNING("Frame statistics trace capture is full, stopping");
+        tracing_.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    FrameTraceEvent event;
+    event.name_ = name;
+    event.start_ = start - traceStart_;
+    event.value_ = value;
+    event.thread_ = thread;
+    event.type_ = type;
+    traceEvents_.Push(event);
+}
+
+void FrameStats::ComputeSummary(const FrameMetric& metric, FrameMetricSummary& summary) const
+{
+    summary.name_ = metric.name_;
+    summary.type_ = metric.type_;
+    summary.samples_ = metric.samples_.Size();
+    if (metric.samples_.Empty())
+    {
+        summary.min_ = summary.avg_ = summary.p50_ = summary.p95_ = summary.p99_ = summary.max_ = 0.0f;
+        return;
+    }
+
+    PODVector<float> sorted = metric.samples_;
+    Sort(sorted.Begin(), sorted.End());
+
+    double sum = 0.0;
+    for (unsigned i = 0; i < sorted.Size(); ++i)
+        sum += sorted[i];
+
+    summary.min_ = sorted.Front();
+    summary.avg_ = (float)(sum / sorted.Size());
+    summary.p50_ = Percentile(sorted, 0.50f);
+    summary.p95_ = Percentile(sorted, 0.95f);
+    summary.p99_ = Percentile(sorted, 0.99f);
+    summary.max_ = sorted.Back();
+}
+
+void FrameStats::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    EndFrame();
+}
+
+}
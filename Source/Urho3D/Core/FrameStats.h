@@ -0,0 +1,278 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Core/Mutex.h"
+#include "../Core/Object.h"
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+/// Default number of frames in the rolling window.
+static const unsigned FRAME_STATS_DEFAULT_WINDOW = 300;
+
+/// Frame statistics metric type.
+enum FrameMetricType
+{
+    /// Time spent in a scope, summed per frame, in milliseconds. Frames where the scope was not entered are not sampled.
+    FRAME_METRIC_TIMING = 0,
+    /// Value accumulated over the frame and reset at its end.
+    FRAME_METRIC_COUNTER,
+    /// Last value set, sampled at the end of each frame.
+    FRAME_METRIC_GAUGE
+};
+
+/// Key of a metric. Metrics of different types may share a name.
+struct FrameMetricKey
+{
+    /// Construct undefined.
+    FrameMetricKey() = default;
+
+    /// Construct with name hash and type.
+    FrameMetricKey(StringHash name, FrameMetricType type) :
+        name_(name),
+        type_(type)
+    {
+    }
+
+    /// Test for equality with another key.
+    bool operator ==(const FrameMetricKey& rhs) const { return name_ == rhs.name_ && type_ == rhs.type_; }
+
+    /// Test for inequality with another key.
+    bool operator !=(const FrameMetricKey& rhs) const { return name_ != rhs.name_ || type_ != rhs.type_; }
+
+    /// Return hash value for HashSet & HashMap.
+    unsigned ToHash() const { return name_.Value() * 31 + type_; }
+
+    /// Metric name hash.
+    StringHash name_;
+    /// Metric type.
+    FrameMetricType type_{FRAME_METRIC_TIMING};
+};
+
+/// Aggregated statistics of a metric over the rolling window.
+struct URHO3D_API FrameMetricSummary
+{
+    /// Metric name.
+    String name_;
+    /// Metric type.
+    FrameMetricType type_{FRAME_METRIC_TIMING};
+    /// Number of frames sampled.
+    unsigned samples_{};
+    /// Minimum value.
+    float min_{};
+    /// Average value.
+    float avg_{};
+    /// Median value.
+    float p50_{};
+    /// 95th percentile value.
+    float p95_{};
+    /// 99th percentile value.
+    float p99_{};
+    /// Maximum value.
+    float max_{};
+};
+
+/// Per-frame metric with a rolling window of samples.
+struct FrameMetric
+{
+    /// Metric name.
+    String name_;
+    /// Metric type.
+    FrameMetricType type_{FRAME_METRIC_TIMING};
+    /// Value of the current frame.
+    double current_{};
+    /// Whether the current frame has a value.
+    bool active_{};
+    /// Ring buffer of per-frame samples.
+    PODVector<float> samples_;
+    /// Next sample index in the ring buffer.
+    unsigned next_{};
+};
+
+/// Scope timing or counter event captured for trace export.
+struct FrameTraceEvent
+{
+    /// Metric name.
+    String name_;
+    /// Start time in microseconds since the capture began.
+    long long start_;
+    /// Duration in microseconds, or value for counters and gauges.
+    double value_;
+    /// Thread index.
+    unsigned thread_;
+    /// Metric type.
+    FrameMetricType type_;
+};
+
+struct FrameStatsThreadBuffer;
+
+/// Always available frame statistics subsystem. Aggregates scope timings, counters and gauges over a rolling window of frames and exports them as CSV or Chrome trace JSON. All recording functions are thread-safe. Each thread accumulates into its own buffer, which is merged at the end of the frame, so that threads do not contend.
+class URHO3D_API FrameStats : public Object
+{
+    URHO3D_OBJECT(FrameStats, Object);
+
+public:
+    /// Construct.
+    explicit FrameStats(Context* context);
+    /// Destruct.
+    ~FrameStats() override;
+
+    /// Enable or disable recording. Enabled by default.
+    void SetEnabled(bool enable);
+    /// Set number of frames in the rolling window. Clears collected samples.
+    void SetWindowSize(unsigned frames);
+    /// Clear all metrics.
+    void Clear();
+
+    /// Add time spent in a scope on the current frame.
+    void AddTiming(const String& name, long long usec) { AddTiming(name.CString(), StringHash(name), usec); }
+    /// Add time spent in a scope on the current frame, with the name hash calculated in advance.
+    void AddTiming(const char* name, StringHash nameHash, long long usec);
+    /// Add to a counter on the current frame.
+    void AddCounter(const String& name, double delta = 1.0) { AddCounter(name.CString(), StringHash(name), delta); }
+    /// Add to a counter on the current frame, with the name hash calculated in advance.
+    void AddCounter(const char* name, StringHash nameHash, double delta = 1.0);
+    /// Set a gauge value.
+    void SetGauge(const String& name, double value) { SetGauge(name.CString(), StringHash(name), value); }
+    /// Set a gauge value, with the name hash calculated in advance.
+    void SetGauge(const char* name, StringHash nameHash, double value);
+    /// Finish the current frame and sample all metrics. Called automatically at the end of each frame.
+    void EndFrame();
+
+    /// Begin capturing trace events, keeping at most the given number of events.
+    void StartTrace(unsigned maxEvents = 1000000);
+    /// Stop capturing trace events. Captured events are kept until the next capture starts.
+    void StopTrace();
+    /// Save captured trace events as Chrome trace JSON, viewable in chrome://tracing or Perfetto. Return true if successful.
+    bool SaveTrace(const String& fileName) const;
+    /// Save summaries of all metrics as CSV. Return true if successful.
+    bool SaveCSV(const String& fileName) const;
+
+    /// Return summary of a metric over the rolling window. Return false if the metric does not exist.
+    bool GetSummary(const String& name, FrameMetricType type, FrameMetricSummary& summary) const;
+    /// Return summaries of all metrics over the rolling window, sorted by type and name.
+    void GetSummaries(Vector<FrameMetricSummary>& summaries) const;
+
+    /// Return whether recording is enabled.
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /// Return number of frames in the rolling window.
+    unsigned GetWindowSize() const { return windowSize_; }
+
+    /// Return whether trace events are being captured.
+    bool IsTracing() const { return tracing_.load(std::memory_order_relaxed); }
+
+    /// Return number of captured trace events.
+    unsigned GetNumTraceEvents() const;
+
+    /// Return microseconds since construction. Used as the time base of trace events. Does not lock.
+    long long GetTimeUSec() const;
+
+private:
+    /// Record a value into the calling thread's buffer. Timings and counters accumulate, gauges replace.
+    void Record(const char* name, StringHash nameHash, FrameMetricType type, double value, long long start);
+    /// Return the calling thread's buffer, creating it if necessary.
+    FrameStatsThreadBuffer* GetThreadBuffer();
+    /// Merge the values and trace events recorded by the threads. Must be called with the mutex held.
+    void MergeThreadBuffers();
+    /// Return metric, creating it if necessary. Must be called with the mutex held.
+    FrameMetric& GetMetric(const String& name, StringHash nameHash, FrameMetricType type);
+    /// Capture a trace event. Must be called with the mutex held.
+    void AddTraceEvent(const String& name, FrameMetricType type, long long start, double value, unsigned thread);
+    /// Compute summary of a metric.
+    void ComputeSummary(const FrameMetric& metric, FrameMetricSummary& summary) const;
+    /// Handle end of frame.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Metrics by name hash and type.
+    HashMap<FrameMetricKey, FrameMetric> metrics_;
+    /// Captured trace events.
+    Vector<FrameTraceEvent> traceEvents_;
+    /// Per-thread buffers of values recorded during the current frame.
+    PODVector<FrameStatsThreadBuffer*> threadBuffers_;
+    /// Mutex for the metrics, trace events and the list of thread buffers.
+    mutable Mutex mutex_;
+    /// Unique ID of this instance, which identifies it in the threads' cached buffer pointers.
+    unsigned id_;
+    /// Clock time at construction in microseconds.
+    long long timeBase_;
+    /// Number of threads other than the main thread that have recorded values.
+    unsigned numThreads_{};
+    /// Time of the previous frame end in microseconds.
+    long long frameStart_{};
+    /// Time the trace capture started in microseconds.
+    long long traceStart_{};
+    /// Maximum number of trace events.
+    unsigned maxTraceEvents_{};
+    /// Number of frames in the rolling window.
+    unsigned windowSize_;
+    /// Recording enabled flag.
+    std::atomic<bool> enabled_;
+    /// Trace capture flag.
+    std::atomic<bool> tracing_;
+};
+
+/// Measures the time spent in a scope and adds it to the frame statistics.
+class URHO3D_API FrameStatsScope
+{
+public:
+    /// Begin measuring. The name must stay valid until the end of the scope.
+    FrameStatsScope(FrameStats* stats, const char* name, StringHash nameHash) :
+        stats_(stats && stats->IsEnabled() ? stats : nullptr),
+        name_(name),
+        nameHash_(nameHash),
+        start_(stats_ ? stats_->GetTimeUSec() : 0)
+    {
+    }
+
+    /// End measuring.
+    ~FrameStatsScope()
+    {
+        if (stats_)
+            stats_->AddTiming(name_, nameHash_, stats_->GetTimeUSec() - start_);
+    }
+
+private:
+    /// Frame statistics subsystem.
+    FrameStats* stats_;
+    /// Scope name.
+    const char* name_;
+    /// Scope name hash.
+    StringHash nameHash_;
+    /// Start time in microseconds.
+    long long start_;
+};
+
+}
+
+#define URHO3D_FRAME_STATS_CONCAT_IMPL(a, b) a##b
+#define URHO3D_FRAME_STATS_CONCAT(a, b) URHO3D_FRAME_STATS_CONCAT_IMPL(a, b)
+/// Measure the rest of the enclosing scope into the frame statistics. The name must be a string literal, which is hashed at compile time. Requires access to context_.
+#define URHO3D_FRAME_STATS_SCOPE(name) \
+    static constexpr Urho3D::StringHash URHO3D_FRAME_STATS_CONCAT(frameStatsName_, __LINE__)(Urho3D::StringHash::CalculateConstexpr(name)); \
+    Urho3D::FrameStatsScope URHO3D_FRAME_STATS_CONCAT(frameStatsScope_, __LINE__)(context_->GetSubsystem<Urho3D::FrameStats>(), name, \
+        URHO3D_FRAME_STATS_CONCAT(frameStatsName_, __LINE__))
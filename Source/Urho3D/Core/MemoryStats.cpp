@@ -0,0 +1,192 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/MemoryStats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// DebugNew.h is deliberately not included, as this file replaces the global allocation functions
+
+namespace Urho3D
+{
+
+static const char* memoryTagNames[] =
+{
+    "General",
+    "Graphics",
+    "Scene",
+    "Physics",
+    "Resource",
+    "Network",
+    "UI",
+    "Audio",
+    nullptr
+};
+
+static thread_local MemoryTag currentTag = MEMTAG_GENERAL;
+
+#ifdef URHO3D_MEMORY_TRACKING
+/// Counters of one tag, kept on their own cache line so that threads allocating under different tags do not contend.
+struct alignas(64) MemoryTagCounters
+{
+    /// Bytes currently allocated.
+    std::atomic<long long> bytes_;
+    /// Number of live allocations.
+    std::atomic<long long> allocations_;
+    /// Number of allocations in total.
+    std::atomic<long long> totalAllocations_;
+};
+
+/// Header stored in front of each tracked allocation. Sized to keep the fundamental alignment of the returned memory.
+struct alignas(std::max_align_t) MemoryAllocationHeader
+{
+    /// Requested size.
+    size_t size_;
+    /// Tag the allocation was made under.
+    MemoryTag tag_;
+};
+
+static MemoryTagCounters memoryTagCounters[MAX_MEMORY_TAGS];
+
+static void* TrackedAllocate(size_t size)
+{
+    auto* header = static_cast<MemoryAllocationHeader*>(malloc(sizeof(MemoryAllocationHeader) + size));
+    if (!header)
+        return nullptr;
+
+    header->size_ = size;
+    header->tag_ = currentTag;
+    MemoryTagCounters& counters = memoryTagCounters[header->tag_];
+    counters.bytes_.fetch_add((long long)size, std::memory_order_relaxed);
+    counters.allocations_.fetch_add(1, std::memory_order_relaxed);
+    counters.totalAllocations_.fetch_add(1, std::memory_order_relaxed);
+    return header + 1;
+}
+
+static void TrackedFree(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    // Freed memory is credited to the tag it was allocated under, whichever thread or tag frees it
+    MemoryAllocationHeader* header = static_cast<MemoryAllocationHeader*>(ptr) - 1;
+    MemoryTagCounters& counters = memoryTagCounters[header->tag_];
+    counters.bytes_.fetch_sub((long long)header->size_, std::memory_order_relaxed);
+    counters.allocations_.fetch_sub(1, std::memory_order_relaxed);
+    free(header);
+}
+#endif
+
+MemoryTag SetMemoryTag(MemoryTag tag)
+{
+    MemoryTag previous = currentTag;
+    currentTag = tag;
+    return previous;
+}
+
+MemoryTag GetMemoryTag()
+{
+    return currentTag;
+}
+
+MemoryTagStats GetMemoryTagStats(MemoryTag tag)
+{
+    MemoryTagStats stats{};
+#ifdef URHO3D_MEMORY_TRACKING
+    if (tag < MAX_MEMORY_TAGS)
+    {
+        const MemoryTagCounters& counters = memoryTagCounters[tag];
+        stats.bytes_ = counters.bytes_.load(std::memory_order_relaxed);
+        stats.allocations_ = counters.allocations_.load(std::memory_order_relaxed);
+        stats.totalAllocations_ = counters.totalAllocations_.load(std::memory_order_relaxed);
+    }
+#endif
+    return stats;
+}
+
+const char* GetMemoryTagName(MemoryTag tag)
+{
+    return tag < MAX_MEMORY_TAGS ? memoryTagNames[tag] : "";
+}
+
+bool IsMemoryTrackingEnabled()
+{
+#ifdef URHO3D_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+}
+
+#ifdef URHO3D_MEMORY_TRACKING
+void* operator new(size_t size)
+{
+    void* ptr = Urho3D::TrackedAllocate(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    void* ptr = Urho3D::TrackedAllocate(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return Urho3D::TrackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return Urho3D::TrackedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    Urho3D::TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    Urho3D::TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    Urho3D::TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    Urho3D::TrackedFree(ptr);
+}
+#endif
@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+namespace Urho3D
+{
+
+/// Subsystem that heap allocations are attributed to.
+enum MemoryTag
+{
+    MEMTAG_GENERAL = 0,
+    MEMTAG_GRAPHICS,
+    MEMTAG_SCENE,
+    MEMTAG_PHYSICS,
+    MEMTAG_RESOURCE,
+    MEMTAG_NETWORK,
+    MEMTAG_UI,
+    MEMTAG_AUDIO,
+    MAX_MEMORY_TAGS
+};
+
+/// Heap usage attributed to a memory tag.
+struct MemoryTagStats
+{
+    /// Bytes currently allocated.
+    long long bytes_;
+    /// Number of live allocations.
+    long long allocations_;
+    /// Number of allocations made in total. The growth of this between frames is the allocator traffic.
+    long long totalAllocations_;
+};
+
+/// Set the memory tag of the calling thread and return the previous one.
+URHO3D_API MemoryTag SetMemoryTag(MemoryTag tag);
+/// Return the memory tag of the calling thread.
+URHO3D_API MemoryTag GetMemoryTag();
+/// Return heap usage attributed to a memory tag. All zero unless built with URHO3D_MEMORY_TRACKING.
+URHO3D_API MemoryTagStats GetMemoryTagStats(MemoryTag tag);
+/// Return name of a memory tag.
+URHO3D_API const char* GetMemoryTagName(MemoryTag tag);
+/// Return whether heap allocations are being tracked, which requires building with URHO3D_MEMORY_TRACKING.
+URHO3D_API bool IsMemoryTrackingEnabled();
+
+/// Attributes heap allocations made by the calling thread to a memory tag for the duration of a scope.
+class URHO3D_API MemoryTagScope
+{
+public:
+    /// Construct and set the tag.
+    explicit MemoryTagScope(MemoryTag tag) :
+        previous_(SetMemoryTag(tag))
+    {
+    }
+
+    /// Destruct and restore the previous tag.
+    ~MemoryTagScope() { SetMemoryTag(previous_); }
+
+private:
+    /// Previous tag.
+    MemoryTag previous_;
+};
+
+}
+
+#ifdef URHO3D_MEMORY_TRACKING
+#   define URHO3D_MEMORY_TAG_CONCAT_IMPL(a, b) a##b
+#   define URHO3D_MEMORY_TAG_CONCAT(a, b) URHO3D_MEMORY_TAG_CONCAT_IMPL(a, b)
+#   define URHO3D_MEMORY_TAG(tag) Urho3D::MemoryTagScope URHO3D_MEMORY_TAG_CONCAT(memoryTagScope_, __LINE__)(tag)
+#else
+#   define URHO3D_MEMORY_TAG(tag)
+#endif
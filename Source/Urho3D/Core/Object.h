@@ -437,8 +437,12 @@ URHO3D_API StringHashRegister& GetEventNameRegister();
 
 /// Describe an event's hash ID and begin a namespace in which to define its parameters.
 #define URHO3D_EVENT(eventID, eventName) static const Urho3D::StringHash eventID(Urho3D::GetEventNameRegister().RegisterString(#eventName)); namespace eventName
-/// Describe an event's parameter hash ID. Should be used inside an event namespace.
+/// Describe an event's parameter hash ID. Should be used inside an event namespace. Hashed at compile time unless the name must be registered for reversing.
+#ifdef URHO3D_HASH_DEBUG
 #define URHO3D_PARAM(paramID, paramName) static const Urho3D::StringHash paramID = #paramName
+#else
+#define URHO3D_PARAM(paramID, paramName) static constexpr Urho3D::StringHash paramID = Urho3D::StringHash(Urho3D::StringHash::CalculateConstexpr(#paramName))
+#endif
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function.
 #define URHO3D_HANDLER(className, function) (new Urho3D::EventHandlerImpl<className>(this, &className::function))
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function, and also defines a userdata pointer.
@@ -57,6 +57,7 @@ StringHash StringHashRegister::RegisterString(const StringHash& hash, const char
     }
     else if (iter->second_.Compare(string, false) != 0)
     {
+        ++numCollisions_;
         URHO3D_LOGWARNINGF("StringHash collision detected! Both \"%s\" and \"%s\" have hash #%s",
             string, iter->second_.CString(), hash.ToString().CString());
     }
@@ -99,6 +100,20 @@ bool StringHashRegister::Contains(const StringHash& hash) const
     return contains;
 }
 
+bool StringHashRegister::HasCollision(const StringHash& hash, const char* string) const
+{
+    if (mutex_)
+        mutex_->Acquire();
+
+    auto iter = map_.Find(hash);
+    const bool collision = iter != map_.End() && iter->second_.Compare(string, false) != 0;
+
+    if (mutex_)
+        mutex_->Release();
+
+    return collision;
+}
+
 const String& StringHashRegister::GetString(const StringHash& hash) const
 {
     auto iter = map_.Find(hash);
@@ -48,6 +48,10 @@ public:
     String GetStringCopy(const StringHash& hash) const;
     /// Return whether the string in contained in the register.
     bool Contains(const StringHash& hash) const;
+    /// Return whether a different string with the same hash is already registered.
+    bool HasCollision(const StringHash& hash, const char* string) const;
+    /// Return number of collisions detected by RegisterString.
+    unsigned GetNumCollisions() const { return numCollisions_; }
 
     /// Return String for given StringHash. Return value is unsafe to use if RegisterString is called from other threads.
     const String& GetString(const StringHash& hash) const;
@@ -59,6 +63,8 @@ private:
     StringMap map_;
     /// Mutex.
     UniquePtr<Mutex> mutex_;
+    /// Number of collisions detected.
+    unsigned numCollisions_{};
 };
 
 }
@@ -27,7 +27,10 @@
 
 #pragma once
 
-#if defined(_MSC_VER) && defined(_DEBUG)
+// Disabled when building with URHO3D_MEMORY_TRACKING, as the debug CRT's allocation functions would bypass the tracked global
+// operator new.
+
+#if defined(_MSC_VER) && defined(_DEBUG) && !defined(URHO3D_MEMORY_TRACKING)
 
 #define _CRTDBG_MAP_ALLOC
 
@@ -23,8 +23,11 @@
 #include "../Precompiled.h"
 
 #include "../Audio/Audio.h"
+#include "../Container/LinearAllocator.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/FrameStats.h"
+#include "../Core/MemoryStats.h"
 #include "../Core/Profiler.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/WorkQueue.h"
@@ -37,6 +40,7 @@
 #include "../Engine/EngineDefs.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../Input/Input.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -128,6 +132,7 @@ Engine::Engine(Context* context) :
     // Create subsystems which do not depend on engine initialization or startup parameters
     context_->RegisterSubsystem(new Time(context_));
     context_->RegisterSubsystem(new WorkQueue(context_));
+    context_->RegisterSubsystem(new FrameStats(context_));
 #ifdef URHO3D_PROFILING
     context_->RegisterSubsystem(new Profiler(context_));
 #endif
@@ -166,6 +171,7 @@ Engine::Engine(Context* context) :
 #endif
 
     SubscribeToEvent(E_EXITREQUESTED, URHO3D_HANDLER(Engine, HandleExitRequested));
+    SubscribeToEvent(E_CONSOLECOMMAND, URHO3D_HANDLER(Engine, HandleConsoleCommand));
 }
 
 Engine::~Engine() = default;
@@ -187,6 +193,8 @@ bool Engine::Initialize(const VariantMap& parameters)
 
     URHO3D_PROFILE("InitEngine");
 
+    frameStatsFileName_ = GetParameter(parameters, EP_FRAME_STATS_FILE, String::EMPTY).GetString();
+
     // Set headless mode
     headless_ = GetParameter(parameters, EP_HEADLESS, false).GetBool();
 
@@ -195,6 +203,7 @@ bool Engine::Initialize(const VariantMap& parameters)
     {
         context_->RegisterSubsystem(new Graphics(context_));
         context_->RegisterSubsystem(new Renderer(context_));
+        context_->RegisterSubsystem(new TextureStreaming(context_));
         context_->graphics_ = context_->GetSubsystem<Graphics>();
         context_->renderer_ = context_->GetSubsystem<Renderer>();
     }
@@ -315,6 +324,11 @@ bool Engine::Initialize(const VariantMap& parameters)
     if (HasParameter(parameters, EP_TOUCH_EMULATION))
         GetSubsystem<Input>()->SetTouchEmulation(GetParameter(parameters, EP_TOUCH_EMULATION).GetBool());
 
+#ifdef URHO3D_PHYSICS
+    if (HasParameter(parameters, EP_COLLISION_CACHE_DIR))
+        PhysicsWorld::config.collisionCacheDir_ = AddTrailingSlash(GetParameter(parameters, EP_COLLISION_CACHE_DIR).GetString());
+#endif
+
     // Initialize network
 #ifdef URHO3D_NETWORK
     if (HasParameter(parameters, EP_PACKAGE_CACHE_DIR))
@@ -533,9 +547,13 @@ void Engine::RunFrame()
 
     Render();
     URHO3D_PROFILE_END();
+    UpdateFrameStats();
     ApplyFrameLimit();
 
     time->EndFrame();
+
+    // Memory handed out by the frame allocator is only valid until the end of the frame
+    GetFrameAllocator().Reset();
 }
 
 Console* Engine::CreateConsole()
@@ -702,9 +720,38 @@ void Engine::DumpMemory()
 #endif
 }
 
+void Engine::DumpMemoryStats()
+{
+#ifdef URHO3D_LOGGING
+    if (IsMemoryTrackingEnabled())
+    {
+        MemoryTagStats total{};
+        URHO3D_LOGRAW("Heap usage by memory tag:\n");
+        for (unsigned i = 0; i < MAX_MEMORY_TAGS; ++i)
+        {
+            MemoryTagStats stats = GetMemoryTagStats((MemoryTag)i);
+            URHO3D_LOGRAW(String(GetMemoryTagName((MemoryTag)i)) + ": " + String(stats.bytes_) + " bytes in " +
+                String(stats.allocations_) + " blocks, " + String(stats.totalAllocations_) + " allocations in total\n");
+            total.bytes_ += stats.bytes_;
+            total.allocations_ += stats.allocations_;
+            total.totalAllocations_ += stats.totalAllocations_;
+        }
+        URHO3D_LOGRAW("Total: " + String(total.bytes_) + " bytes in " + String(total.allocations_) + " blocks, " +
+            String(total.totalAllocations_) + " allocations in total\n");
+    }
+    else
+        URHO3D_LOGRAW("Heap usage by memory tag requires building with URHO3D_MEMORY_TRACKING\n");
+
+    const LinearAllocator& frameAllocator = GetFrameAllocator();
+    URHO3D_LOGRAW("Frame allocator: " + String(frameAllocator.GetPeak()) + " bytes peak, " + String(frameAllocator.GetCapacity()) +
+        " bytes capacity\n\n");
+#endif
+}
+
 void Engine::Update()
 {
     URHO3D_PROFILE("Update");
+    URHO3D_FRAME_STATS_SCOPE("Update");
 
     // Logic update event
     using namespace Update;
@@ -729,6 +776,8 @@ void Engine::Render()
         return;
 
     URHO3D_PROFILE("Render");
+    URHO3D_FRAME_STATS_SCOPE("Render");
+    URHO3D_MEMORY_TAG(MEMTAG_GRAPHICS);
 
     // If device is lost, BeginFrame will fail and we skip rendering
     auto* graphics = GetSubsystem<Graphics>();
@@ -836,6 +885,11 @@ VariantMap Engine::ParseParameters(const Vector<String>& arguments)
                 ret[EP_FRAME_LIMITER] = false;
             else if (argument == "flushgpu")
                 ret[EP_FLUSH_GPU] = true;
+            else if (argument == "framestats" && !value.Empty())
+            {
+                ret[EP_FRAME_STATS_FILE] = value;
+                ++i;
+            }
             else if (argument == "gl2")
                 ret[EP_FORCE_GL2] = true;
             else if (argument == "landscape")
@@ -1016,8 +1070,84 @@ void Engine::HandleExitRequested(StringHash eventType, VariantMap& eventData)
     }
 }
 
+void Engine::HandleConsoleCommand(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ConsoleCommand;
+    if (eventData[P_ID].GetString() != GetTypeName())
+        return;
+
+    const String command = eventData[P_COMMAND].GetString().Trimmed();
+    if (command == "memory")
+        DumpMemoryStats();
+    else if (command == "resources")
+        DumpResources();
+    else
+        URHO3D_LOGERROR("Unknown command " + command + ", available commands are: memory, resources");
+}
+
+void Engine::UpdateFrameStats()
+{
+    auto* frameStats = GetSubsystem<FrameStats>();
+    if (!frameStats->IsEnabled())
+        return;
+
+    if (!headless_)
+    {
+        auto* renderer = GetSubsystem<Renderer>();
+        frameStats->SetGauge("Batches", renderer->GetNumBatches());
+        // Visible drawables of all views: geometries and lights
+        frameStats->SetGauge("Drawables", renderer->GetNumGeometries(true) + renderer->GetNumLights(true));
+        frameStats->SetGauge("Primitives", renderer->GetNumPrimitives());
+        frameStats->SetGauge("Views", renderer->GetNumViews());
+        frameStats->SetGauge("Geometries", renderer->GetNumGeometries(true));
+        frameStats->SetGauge("Lights", renderer->GetNumLights(true));
+        frameStats->SetGauge("Shadowmaps", renderer->GetNumShadowMaps(true));
+    }
+
+#ifdef URHO3D_NETWORK
+    auto* network = GetSubsystem<Network>();
+    if (network)
+    {
+        float bytesIn = 0.0f;
+        float bytesOut = 0.0f;
+        if (Connection* serverConnection = network->GetServerConnection())
+        {
+            bytesIn += serverConnection->GetBytesInPerSec();
+            bytesOut += serverConnection->GetBytesOutPerSec();
+        }
+        const Vector<SharedPtr<Connection> > clientConnections = network->GetClientConnections();
+        for (unsigned i = 0; i < clientConnections.Size(); ++i)
+        {
+            bytesIn += clientConnections[i]->GetBytesInPerSec();
+            bytesOut += clientConnections[i]->GetBytesOutPerSec();
+        }
+        frameStats->SetGauge("NetBytesInPerSec", bytesIn);
+        frameStats->SetGauge("NetBytesOutPerSec", bytesOut);
+    }
+#endif
+
+    frameStats->SetGauge("FrameAllocatorPeakBytes", GetFrameAllocator().GetPeak());
+    if (IsMemoryTrackingEnabled())
+    {
+        for (unsigned i = 0; i < MAX_MEMORY_TAGS; ++i)
+        {
+            MemoryTagStats stats = GetMemoryTagStats((MemoryTag)i);
+            frameStats->SetGauge(String("Heap") + GetMemoryTagName((MemoryTag)i), (double)stats.bytes_);
+        }
+    }
+}
+
 void Engine::DoExit()
 {
+    if (!frameStatsFileName_.Empty())
+    {
+        auto* frameStats = GetSubsystem<FrameStats>();
+        if (frameStats->SaveCSV(frameStatsFileName_))
+            URHO3D_LOGINFO("Saved frame statistics to " + frameStatsFileName_);
+        else
+            URHO3D_LOGERROR("Failed to save frame statistics to " + frameStatsFileName_);
+    }
+
     auto* graphics = GetSubsystem<Graphics>();
     if (graphics)
         graphics->Close();
@@ -74,6 +74,8 @@ public:
     void DumpResources(bool dumpFileName = false);
     /// Dump information of all memory allocations to the log. Supported in MSVC debug mode only.
     void DumpMemory();
+    /// Dump heap usage per memory tag and frame allocator usage to the log. Heap usage requires building with URHO3D_MEMORY_TRACKING.
+    void DumpMemoryStats();
 
     /// Get timestep of the next frame. Updated by ApplyFrameLimit().
     float GetNextTimeStep() const { return timeStep_; }
@@ -123,8 +125,12 @@ public:
 private:
     /// Handle exit requested event. Auto-exit if enabled.
     void HandleExitRequested(StringHash eventType, VariantMap& eventData);
+    /// Handle console command event.
+    void HandleConsoleCommand(StringHash eventType, VariantMap& eventData);
     /// Actually perform the exit actions.
     void DoExit();
+    /// Sample engine gauges into the frame statistics.
+    void UpdateFrameStats();
 
     /// Frame update timer.
     HiresTimer frameTimer_;
@@ -142,6 +148,8 @@ private:
     unsigned maxInactiveFps_;
     /// Pause when minimized flag.
     bool pauseMinimized_;
+    /// File to save frame statistics to on exit.
+    String frameStatsFileName_;
 #ifdef URHO3D_TESTING
     /// Time out counter for testing.
     long long timeOut_;
@@ -32,12 +32,14 @@ namespace Urho3D
 // Engine parameters
 static const String EP_AUTOLOAD_PATHS = "AutoloadPaths";
 static const String EP_BORDERLESS = "Borderless";
+static const String EP_COLLISION_CACHE_DIR = "CollisionCacheDir";
 static const String EP_DUMP_SHADERS = "DumpShaders";
 static const String EP_EVENT_PROFILER = "EventProfiler";
 static const String EP_EXTERNAL_WINDOW = "ExternalWindow";
 static const String EP_FLUSH_GPU = "FlushGPU";
 static const String EP_FORCE_GL2 = "ForceGL2";
 static const String EP_FRAME_LIMITER = "FrameLimiter";
+static const String EP_FRAME_STATS_FILE = "FrameStatsFile";
 static const String EP_FULL_SCREEN = "FullScreen";
 static const String EP_HEADLESS = "Headless";
 static const String EP_HIGH_DPI = "HighDPI";
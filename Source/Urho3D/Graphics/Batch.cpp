@@ -27,6 +27,7 @@
 #include "../Graphics/Graphics.h"
 #include "../Graphics/GraphicsImpl.h"
 #include "../Graphics/Material.h"
+#include "../Graphics/RenderCommandBuffer.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/ShaderVariation.h"
 #include "../Graphics/Technique.h"
@@ -159,6 +160,273 @@ void CalculateSpotMatrix(Matrix4& dest, Light* light)
     dest = texAdjust * spotProj * spotView;
 }
 
+static void BuildZoneShaderParameters(ShaderParameterBlock& block, Zone* zone, Camera* camera)
+{
+    block.AddParameter(VSP_AMBIENTSTARTCOLOR, zone->GetAmbientStartColor());
+    block.AddParameter(VSP_AMBIENTENDCOLOR, zone->GetAmbientEndColor().ToVector4() - zone->GetAmbientStartColor().ToVector4());
+
+    const BoundingBox& box = zone->GetBoundingBox();
+    Vector3 boxSize = box.Size();
+    Matrix3x4 adjust(Matrix3x4::IDENTITY);
+    adjust.SetScale(Vector3(1.0f / boxSize.x_, 1.0f / boxSize.y_, 1.0f / boxSize.z_));
+    adjust.SetTranslation(Vector3(0.5f, 0.5f, 0.5f));
+    Matrix3x4 zoneTransform = adjust * zone->GetInverseWorldTransform();
+    block.AddParameter(VSP_ZONE, zoneTransform);
+
+    block.AddParameter(PSP_AMBIENTCOLOR, zone->GetAmbientColor());
+    block.AddParameter(PSP_ZONEMIN, zone->GetBoundingBox().min_);
+    block.AddParameter(PSP_ZONEMAX, zone->GetBoundingBox().max_);
+
+    float farClip = camera->GetFarClip();
+    float fogStart = Min(zone->GetFogStart(), farClip);
+    float fogEnd = Min(zone->GetFogEnd(), farClip);
+    if (fogStart >= fogEnd * (1.0f - M_LARGE_EPSILON))
+        fogStart = fogEnd * (1.0f - M_LARGE_EPSILON);
+    float fogRange = Max(fogEnd - fogStart, M_EPSILON);
+    Vector4 fogParams(fogEnd / farClip, farClip / fogRange, 0.0f, 0.0f);
+
+    Node* zoneNode = zone->GetNode();
+    if (zone->GetHeightFog() && zoneNode)
+    {
+        Vector3 worldFogHeightVec = zoneNode->GetWorldTransform() * Vector3(0.0f, zone->GetFogHeight(), 0.0f);
+        fogParams.z_ = worldFogHeightVec.y_;
+        fogParams.w_ = zone->GetFogHeightScale() / Max(zoneNode->GetWorldScale().y_, M_EPSILON);
+    }
+
+    block.AddParameter(PSP_FOGPARAMS, fogParams);
+}
+
+static void BuildLightShaderParameters(ShaderParameterBlock& block, LightBatchQueue* lightQueue, Camera* camera,
+    Renderer* renderer)
+{
+    Light* light = lightQueue->light_;
+    Texture2D* shadowMap = lightQueue->shadowMap_;
+    Node* lightNode = light->GetNode();
+    float atten = 1.0f / Max(light->GetRange(), M_EPSILON);
+    Vector3 lightDir(lightNode->GetWorldRotation() * Vector3::BACK);
+    Vector4 lightPos(lightNode->GetWorldPosition(), atten);
+
+    block.AddParameter(VSP_LIGHTDIR, lightDir);
+    block.AddParameter(VSP_LIGHTPOS, lightPos);
+
+    // The same light matrices are used by the vertex and pixel shaders. Spot lights need two even without cascades
+    Matrix4 lightMatrices[MAX_CASCADE_SPLITS > 2 ? MAX_CASCADE_SPLITS : 2];
+    unsigned numLightMatrixFloats = 0;
+    switch (light->GetLightType())
+    {
+    case LIGHT_DIRECTIONAL:
+        {
+            unsigned numSplits = Min(MAX_CASCADE_SPLITS, lightQueue->shadowSplits_.Size());
+
+            for (unsigned i = 0; i < numSplits; ++i)
+                CalculateShadowMatrix(lightMatrices[i], lightQueue, i, renderer);
+
+            numLightMatrixFloats = 16 * numSplits;
+        }
+        break;
+
+    case LIGHT_SPOT:
+        {
+            CalculateSpotMatrix(lightMatrices[0], light);
+            bool isShadowed = shadowMap != nullptr;
+            if (isShadowed)
+                CalculateShadowMatrix(lightMatrices[1], lightQueue, 0, renderer);
+
+            numLightMatrixFloats = isShadowed ? 32 : 16;
+        }
+        break;
+
+    case LIGHT_POINT:
+        {
+            lightMatrices[0] = Matrix4(lightNode->GetWorldRotation().RotationMatrix());
+            // HLSL compiler will pack the parameters as if the matrix is only 3x4, so must be careful to not overwrite
+            // the next parameter
+#ifdef URHO3D_OPENGL
+            numLightMatrixFloats = 16;
+#else
+            numLightMatrixFloats = 12;
+#endif
+        }
+        break;
+    }
+
+    block.AddParameter(VSP_LIGHTMATRICES, lightMatrices[0].Data(), numLightMatrixFloats);
+
+    float fade = 1.0f;
+    float fadeEnd = light->GetDrawDistance();
+    float fadeStart = light->GetFadeDistance();
+
+    // Do fade calculation for light if both fade & draw distance defined
+    if (light->GetLightType() != LIGHT_DIRECTIONAL && fadeEnd > 0.0f && fadeStart > 0.0f && fadeStart < fadeEnd)
+        fade = Min(1.0f - (light->GetDistance() - fadeStart) / (fadeEnd - fadeStart), 1.0f);
+
+    // Negative lights will use subtract blending, so write absolute RGB values to the shader parameter
+    block.AddParameter(PSP_LIGHTCOLOR, Color(light->GetEffectiveColor().Abs(), light->GetEffectiveSpecularIntensity()) * fade);
+    block.AddParameter(PSP_LIGHTDIR, lightDir);
+    block.AddParameter(PSP_LIGHTPOS, lightPos);
+    block.AddParameter(PSP_LIGHTRAD, light->GetRadius());
+    block.AddParameter(PSP_LIGHTLENGTH, light->GetLength());
+    block.AddParameter(PSP_LIGHTMATRICES, lightMatrices[0].Data(), numLightMatrixFloats);
+
+    // Set shadow mapping shader parameters
+    if (shadowMap)
+    {
+        {
+            // Calculate point light shadow sampling offsets (unrolled cube map)
+            auto faceWidth = (unsigned)(shadowMap->GetWidth() / 2);
+            auto faceHeight = (unsigned)(shadowMap->GetHeight() / 3);
+            auto width = (float)shadowMap->GetWidth();
+            auto height = (float)shadowMap->GetHeight();
+#ifdef URHO3D_OPENGL
+            float mulX = (float)(faceWidth - 3) / width;
+            float mulY = (float)(faceHeight - 3) / height;
+            float addX = 1.5f / width;
+            float addY = 1.5f / height;
+#else
+            float mulX = (float)(faceWidth - 4) / width;
+            float mulY = (float)(faceHeight - 4) / height;
+            float addX = 2.5f / width;
+            float addY = 2.5f / height;
+#endif
+            // If using 4 shadow samples, offset the position diagonally by half pixel
+            if (renderer->GetShadowQuality() == SHADOWQUALITY_PCF_16BIT || renderer->GetShadowQuality() == SHADOWQUALITY_PCF_24BIT)
+            {
+                addX -= 0.5f / width;
+                addY -= 0.5f / height;
+            }
+            block.AddParameter(PSP_SHADOWCUBEADJUST, Vector4(mulX, mulY, addX, addY));
+        }
+
+        {
+            // Calculate shadow camera depth parameters for point light shadows and shadow fade parameters for
+            //  directional light shadows, stored in the same uniform
+            Camera* shadowCamera = lightQueue->shadowSplits_[0].shadowCamera_;
+            float nearClip = shadowCamera->GetNearClip();
+            float farClip = shadowCamera->GetFarClip();
+            float q = farClip / (farClip - nearClip);
+            float r = -q * nearClip;
+
+            const CascadeParameters& parameters = light->GetShadowCascade();
+            float viewFarClip = camera->GetFarClip();
+            float shadowRange = parameters.GetShadowRange();
+            float fadeStart = parameters.fadeStart_ * shadowRange / viewFarClip;
+            float fadeEnd = shadowRange / viewFarClip;
+            float fadeRange = fadeEnd - fadeStart;
+
+            block.AddParameter(PSP_SHADOWDEPTHFADE, Vector4(q, r, fadeStart, 1.0f / fadeRange));
+        }
+
+        {
+            float intensity = light->GetShadowIntensity();
+            float fadeStart = light->GetShadowFadeDistance();
+            float fadeEnd = light->GetShadowDistance();
+            if (fadeStart > 0.0f && fadeEnd > 0.0f && fadeEnd > fadeStart)
+                intensity =
+                    Lerp(intensity, 1.0f, Clamp((light->GetDistance() - fadeStart) / (fadeEnd - fadeStart), 0.0f, 1.0f));
+            float pcfValues = (1.0f - intensity);
+            float samples = 1.0f;
+            if (renderer->GetShadowQuality() == SHADOWQUALITY_PCF_16BIT || renderer->GetShadowQuality() == SHADOWQUALITY_PCF_24BIT)
+                samples = 4.0f;
+            block.AddParameter(PSP_SHADOWINTENSITY, Vector4(pcfValues / samples, intensity, 0.0f, 0.0f));
+        }
+
+        float sizeX = 1.0f / (float)shadowMap->GetWidth();
+        float sizeY = 1.0f / (float)shadowMap->GetHeight();
+        block.AddParameter(PSP_SHADOWMAPINVSIZE, Vector2(sizeX, sizeY));
+
+        Vector4 lightSplits(M_LARGE_VALUE, M_LARGE_VALUE, M_LARGE_VALUE, M_LARGE_VALUE);
+        if (lightQueue->shadowSplits_.Size() > 1)
+            lightSplits.x_ = lightQueue->shadowSplits_[0].farSplit_ / camera->GetFarClip();
+        if (lightQueue->shadowSplits_.Size() > 2)
+            lightSplits.y_ = lightQueue->shadowSplits_[1].farSplit_ / camera->GetFarClip();
+        if (lightQueue->shadowSplits_.Size() > 3)
+            lightSplits.z_ = lightQueue->shadowSplits_[2].farSplit_ / camera->GetFarClip();
+
+        block.AddParameter(PSP_SHADOWSPLITS, lightSplits);
+
+        block.AddParameter(PSP_VSMSHADOWPARAMS, renderer->GetVSMShadowParameters());
+
+        if (light->GetShadowBias().normalOffset_ > 0.0f)
+        {
+            Vector4 normalOffsetScale(Vector4::ZERO);
+
+            // Scale normal offset strength with the width of the shadow camera view
+            if (light->GetLightType() != LIGHT_DIRECTIONAL)
+            {
+                Camera* shadowCamera = lightQueue->shadowSplits_[0].shadowCamera_;
+                normalOffsetScale.x_ = 2.0f * tanf(shadowCamera->GetFov() * M_DEGTORAD * 0.5f) * shadowCamera->GetFarClip();
+            }
+            else
+            {
+                normalOffsetScale.x_ = lightQueue->shadowSplits_[0].shadowCamera_->GetOrthoSize();
+                if (lightQueue->shadowSplits_.Size() > 1)
+                    normalOffsetScale.y_ = lightQueue->shadowSplits_[1].shadowCamera_->GetOrthoSize();
+                if (lightQueue->shadowSplits_.Size() > 2)
+                    normalOffsetScale.z_ = lightQueue->shadowSplits_[2].shadowCamera_->GetOrthoSize();
+                if (lightQueue->shadowSplits_.Size() > 3)
+                    normalOffsetScale.w_ = lightQueue->shadowSplits_[3].shadowCamera_->GetOrthoSize();
+            }
+
+            normalOffsetScale *= light->GetShadowBias().normalOffset_;
+#ifdef GL_ES_VERSION_2_0
+            normalOffsetScale *= renderer->GetMobileNormalOffsetMul();
+#endif
+            block.AddParameter(VSP_NORMALOFFSETSCALE, normalOffsetScale);
+            block.AddParameter(PSP_NORMALOFFSETSCALE, normalOffsetScale);
+        }
+    }
+}
+
+static void BuildVertexLightShaderParameters(ShaderParameterBlock& block, LightBatchQueue* lightQueue)
+{
+    Vector4 vertexLights[MAX_VERTEX_LIGHTS * 3];
+    const PODVector<Light*>& lights = lightQueue->vertexLights_;
+
+    for (unsigned i = 0; i < lights.Size(); ++i)
+    {
+        Light* vertexLight = lights[i];
+        Node* vertexLightNode = vertexLight->GetNode();
+        LightType type = vertexLight->GetLightType();
+
+        // Attenuation
+        float invRange, cutoff, invCutoff;
+        if (type == LIGHT_DIRECTIONAL)
+            invRange = 0.0f;
+        else
+            invRange = 1.0f / Max(vertexLight->GetRange(), M_EPSILON);
+        if (type == LIGHT_SPOT)
+        {
+            cutoff = Cos(vertexLight->GetFov() * 0.5f);
+            invCutoff = 1.0f / (1.0f - cutoff);
+        }
+        else
+        {
+            cutoff = -1.0f;
+            invCutoff = 1.0f;
+        }
+
+        // Color
+        float fade = 1.0f;
+        float fadeEnd = vertexLight->GetDrawDistance();
+        float fadeStart = vertexLight->GetFadeDistance();
+
+        // Do fade calculation for light if both fade & draw distance defined
+        if (vertexLight->GetLightType() != LIGHT_DIRECTIONAL && fadeEnd > 0.0f && fadeStart > 0.0f && fadeStart < fadeEnd)
+            fade = Min(1.0f - (vertexLight->GetDistance() - fadeStart) / (fadeEnd - fadeStart), 1.0f);
+
+        Color color = vertexLight->GetEffectiveColor() * fade;
+        vertexLights[i * 3] = Vector4(color.r_, color.g_, color.b_, invRange);
+
+        // Direction
+        vertexLights[i * 3 + 1] = Vector4(-(vertexLightNode->GetWorldDirection()), cutoff);
+
+        // Position
+        vertexLights[i * 3 + 2] = Vector4(vertexLightNode->GetWorldPosition(), invCutoff);
+    }
+
+    block.AddParameter(VSP_VERTEXLIGHTS, vertexLights[0].Data(), lights.Size() * 3 * 4);
+}
+
 void Batch::CalculateSortKey()
 {
     auto shaderID = (unsigned)(
@@ -269,40 +537,12 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
         zoneHash += 0x80000000;
     if (zone_ && graphics->NeedParameterUpdate(SP_ZONE, reinterpret_cast<const void*>(zoneHash)))
     {
-        graphics->SetShaderParameter(VSP_AMBIENTSTARTCOLOR, zone_->GetAmbientStartColor());
-        graphics->SetShaderParameter(VSP_AMBIENTENDCOLOR,
-            zone_->GetAmbientEndColor().ToVector4() - zone_->GetAmbientStartColor().ToVector4());
-
-        const BoundingBox& box = zone_->GetBoundingBox();
-        Vector3 boxSize = box.Size();
-        Matrix3x4 adjust(Matrix3x4::IDENTITY);
-        adjust.SetScale(Vector3(1.0f / boxSize.x_, 1.0f / boxSize.y_, 1.0f / boxSize.z_));
-        adjust.SetTranslation(Vector3(0.5f, 0.5f, 0.5f));
-        Matrix3x4 zoneTransform = adjust * zone_->GetInverseWorldTransform();
-        graphics->SetShaderParameter(VSP_ZONE, zoneTransform);
-
-        graphics->SetShaderParameter(PSP_AMBIENTCOLOR, zone_->GetAmbientColor());
-        graphics->SetShaderParameter(PSP_FOGCOLOR, overrideFogColorToBlack ? Color::BLACK : zone_->GetFogColor());
-        graphics->SetShaderParameter(PSP_ZONEMIN, zone_->GetBoundingBox().min_);
-        graphics->SetShaderParameter(PSP_ZONEMAX, zone_->GetBoundingBox().max_);
-
-        float farClip = camera->GetFarClip();
-        float fogStart = Min(zone_->GetFogStart(), farClip);
-        float fogEnd = Min(zone_->GetFogEnd(), farClip);
-        if (fogStart >= fogEnd * (1.0f - M_LARGE_EPSILON))
-            fogStart = fogEnd * (1.0f - M_LARGE_EPSILON);
-        float fogRange = Max(fogEnd - fogStart, M_EPSILON);
-        Vector4 fogParams(fogEnd / farClip, farClip / fogRange, 0.0f, 0.0f);
-
-        Node* zoneNode = zone_->GetNode();
-        if (zone_->GetHeightFog() && zoneNode)
-        {
-            Vector3 worldFogHeightVec = zoneNode->GetWorldTransform() * Vector3(0.0f, zone_->GetFogHeight(), 0.0f);
-            fogParams.z_ = worldFogHeightVec.y_;
-            fogParams.w_ = zone_->GetFogHeightScale() / Max(zoneNode->GetWorldScale().y_, M_EPSILON);
-        }
+        ShaderParameterBlock& block = view->GetShaderParameterBlock(zone_, camera);
+        if (block.IsEmpty())
+            BuildZoneShaderParameters(block, zone_, camera);
 
-        graphics->SetShaderParameter(PSP_FOGPARAMS, fogParams);
+        graphics->SetShaderParameters(block);
+        graphics->SetShaderParameter(PSP_FOGCOLOR, overrideFogColorToBlack ? Color::BLACK : zone_->GetFogColor());
     }
 
     // Set light-related shader parameters
@@ -310,276 +550,20 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
     {
         if (light && graphics->NeedParameterUpdate(SP_LIGHT, lightQueue_))
         {
-            Node* lightNode = light->GetNode();
-            float atten = 1.0f / Max(light->GetRange(), M_EPSILON);
-            Vector3 lightDir(lightNode->GetWorldRotation() * Vector3::BACK);
-            Vector4 lightPos(lightNode->GetWorldPosition(), atten);
-
-            graphics->SetShaderParameter(VSP_LIGHTDIR, lightDir);
-            graphics->SetShaderParameter(VSP_LIGHTPOS, lightPos);
-
-            if (graphics->HasShaderParameter(VSP_LIGHTMATRICES))
-            {
-                switch (light->GetLightType())
-                {
-                case LIGHT_DIRECTIONAL:
-                    {
-                        Matrix4 shadowMatrices[MAX_CASCADE_SPLITS];
-                        unsigned numSplits = Min(MAX_CASCADE_SPLITS, lightQueue_->shadowSplits_.Size());
-
-                        for (unsigned i = 0; i < numSplits; ++i)
-                            CalculateShadowMatrix(shadowMatrices[i], lightQueue_, i, renderer);
-
-                        graphics->SetShaderParameter(VSP_LIGHTMATRICES, shadowMatrices[0].Data(), 16 * numSplits);
-                    }
-                    break;
-
-                case LIGHT_SPOT:
-                    {
-                        Matrix4 shadowMatrices[2];
-
-                        CalculateSpotMatrix(shadowMatrices[0], light);
-                        bool isShadowed = shadowMap && graphics->HasTextureUnit(TU_SHADOWMAP);
-                        if (isShadowed)
-                            CalculateShadowMatrix(shadowMatrices[1], lightQueue_, 0, renderer);
-
-                        graphics->SetShaderParameter(VSP_LIGHTMATRICES, shadowMatrices[0].Data(), isShadowed ? 32 : 16);
-                    }
-                    break;
-
-                case LIGHT_POINT:
-                    {
-                        Matrix4 lightVecRot(lightNode->GetWorldRotation().RotationMatrix());
-                        // HLSL compiler will pack the parameters as if the matrix is only 3x4, so must be careful to not overwrite
-                        // the next parameter
-#ifdef URHO3D_OPENGL
-                        graphics->SetShaderParameter(VSP_LIGHTMATRICES, lightVecRot.Data(), 16);
-#else
-                        graphics->SetShaderParameter(VSP_LIGHTMATRICES, lightVecRot.Data(), 12);
-#endif
-                    }
-                    break;
-                }
-            }
-
-            float fade = 1.0f;
-            float fadeEnd = light->GetDrawDistance();
-            float fadeStart = light->GetFadeDistance();
-
-            // Do fade calculation for light if both fade & draw distance defined
-            if (light->GetLightType() != LIGHT_DIRECTIONAL && fadeEnd > 0.0f && fadeStart > 0.0f && fadeStart < fadeEnd)
-                fade = Min(1.0f - (light->GetDistance() - fadeStart) / (fadeEnd - fadeStart), 1.0f);
+            ShaderParameterBlock& block = view->GetShaderParameterBlock(lightQueue_, camera);
+            if (block.IsEmpty())
+                BuildLightShaderParameters(block, lightQueue_, camera, renderer);
 
-            // Negative lights will use subtract blending, so write absolute RGB values to the shader parameter
-            graphics->SetShaderParameter(PSP_LIGHTCOLOR, Color(light->GetEffectiveColor().Abs(),
-                light->GetEffectiveSpecularIntensity()) * fade);
-            graphics->SetShaderParameter(PSP_LIGHTDIR, lightDir);
-            graphics->SetShaderParameter(PSP_LIGHTPOS, lightPos);
-            graphics->SetShaderParameter(PSP_LIGHTRAD, light->GetRadius());
-            graphics->SetShaderParameter(PSP_LIGHTLENGTH, light->GetLength());
-
-            if (graphics->HasShaderParameter(PSP_LIGHTMATRICES))
-            {
-                switch (light->GetLightType())
-                {
-                case LIGHT_DIRECTIONAL:
-                    {
-                        Matrix4 shadowMatrices[MAX_CASCADE_SPLITS];
-                        unsigned numSplits = Min(MAX_CASCADE_SPLITS, lightQueue_->shadowSplits_.Size());
-
-                        for (unsigned i = 0; i < numSplits; ++i)
-                            CalculateShadowMatrix(shadowMatrices[i], lightQueue_, i, renderer);
-
-                        graphics->SetShaderParameter(PSP_LIGHTMATRICES, shadowMatrices[0].Data(), 16 * numSplits);
-                    }
-                    break;
-
-                case LIGHT_SPOT:
-                    {
-                        Matrix4 shadowMatrices[2];
-
-                        CalculateSpotMatrix(shadowMatrices[0], light);
-                        bool isShadowed = lightQueue_->shadowMap_ != nullptr;
-                        if (isShadowed)
-                            CalculateShadowMatrix(shadowMatrices[1], lightQueue_, 0, renderer);
-
-                        graphics->SetShaderParameter(PSP_LIGHTMATRICES, shadowMatrices[0].Data(), isShadowed ? 32 : 16);
-                    }
-                    break;
-
-                case LIGHT_POINT:
-                    {
-                        Matrix4 lightVecRot(lightNode->GetWorldRotation().RotationMatrix());
-                        // HLSL compiler will pack the parameters as if the matrix is only 3x4, so must be careful to not overwrite
-                        // the next parameter
-#ifdef URHO3D_OPENGL
-                        graphics->SetShaderParameter(PSP_LIGHTMATRICES, lightVecRot.Data(), 16);
-#else
-                        graphics->SetShaderParameter(PSP_LIGHTMATRICES, lightVecRot.Data(), 12);
-#endif
-                    }
-                    break;
-                }
-            }
-
-            // Set shadow mapping shader parameters
-            if (shadowMap)
-            {
-                {
-                    // Calculate point light shadow sampling offsets (unrolled cube map)
-                    auto faceWidth = (unsigned)(shadowMap->GetWidth() / 2);
-                    auto faceHeight = (unsigned)(shadowMap->GetHeight() / 3);
-                    auto width = (float)shadowMap->GetWidth();
-                    auto height = (float)shadowMap->GetHeight();
-#ifdef URHO3D_OPENGL
-                    float mulX = (float)(faceWidth - 3) / width;
-                    float mulY = (float)(faceHeight - 3) / height;
-                    float addX = 1.5f / width;
-                    float addY = 1.5f / height;
-#else
-                    float mulX = (float)(faceWidth - 4) / width;
-                    float mulY = (float)(faceHeight - 4) / height;
-                    float addX = 2.5f / width;
-                    float addY = 2.5f / height;
-#endif
-                    // If using 4 shadow samples, offset the position diagonally by half pixel
-                    if (renderer->GetShadowQuality() == SHADOWQUALITY_PCF_16BIT || renderer->GetShadowQuality() == SHADOWQUALITY_PCF_24BIT)
-                    {
-                        addX -= 0.5f / width;
-                        addY -= 0.5f / height;
-                    }
-                    graphics->SetShaderParameter(PSP_SHADOWCUBEADJUST, Vector4(mulX, mulY, addX, addY));
-                }
-
-                {
-                    // Calculate shadow camera depth parameters for point light shadows and shadow fade parameters for
-                    //  directional light shadows, stored in the same uniform
-                    Camera* shadowCamera = lightQueue_->shadowSplits_[0].shadowCamera_;
-                    float nearClip = shadowCamera->GetNearClip();
-                    float farClip = shadowCamera->GetFarClip();
-                    float q = farClip / (farClip - nearClip);
-                    float r = -q * nearClip;
-
-                    const CascadeParameters& parameters = light->GetShadowCascade();
-                    float viewFarClip = camera->GetFarClip();
-                    float shadowRange = parameters.GetShadowRange();
-                    float fadeStart = parameters.fadeStart_ * shadowRange / viewFarClip;
-                    float fadeEnd = shadowRange / viewFarClip;
-                    float fadeRange = fadeEnd - fadeStart;
-
-                    graphics->SetShaderParameter(PSP_SHADOWDEPTHFADE, Vector4(q, r, fadeStart, 1.0f / fadeRange));
-                }
-
-                {
-                    float intensity = light->GetShadowIntensity();
-                    float fadeStart = light->GetShadowFadeDistance();
-                    float fadeEnd = light->GetShadowDistance();
-                    if (fadeStart > 0.0f && fadeEnd > 0.0f && fadeEnd > fadeStart)
-                        intensity =
-                            Lerp(intensity, 1.0f, Clamp((light->GetDistance() - fadeStart) / (fadeEnd - fadeStart), 0.0f, 1.0f));
-                    float pcfValues = (1.0f - intensity);
-                    float samples = 1.0f;
-                    if (renderer->GetShadowQuality() == SHADOWQUALITY_PCF_16BIT || renderer->GetShadowQuality() == SHADOWQUALITY_PCF_24BIT)
-                        samples = 4.0f;
-                    graphics->SetShaderParameter(PSP_SHADOWINTENSITY, Vector4(pcfValues / samples, intensity, 0.0f, 0.0f));
-                }
-
-                float sizeX = 1.0f / (float)shadowMap->GetWidth();
-                float sizeY = 1.0f / (float)shadowMap->GetHeight();
-                graphics->SetShaderParameter(PSP_SHADOWMAPINVSIZE, Vector2(sizeX, sizeY));
-
-                Vector4 lightSplits(M_LARGE_VALUE, M_LARGE_VALUE, M_LARGE_VALUE, M_LARGE_VALUE);
-                if (lightQueue_->shadowSplits_.Size() > 1)
-                    lightSplits.x_ = lightQueue_->shadowSplits_[0].farSplit_ / camera->GetFarClip();
-                if (lightQueue_->shadowSplits_.Size() > 2)
-                    lightSplits.y_ = lightQueue_->shadowSplits_[1].farSplit_ / camera->GetFarClip();
-                if (lightQueue_->shadowSplits_.Size() > 3)
-                    lightSplits.z_ = lightQueue_->shadowSplits_[2].farSplit_ / camera->GetFarClip();
-
-                graphics->SetShaderParameter(PSP_SHADOWSPLITS, lightSplits);
-
-                if (graphics->HasShaderParameter(PSP_VSMSHADOWPARAMS))
-                    graphics->SetShaderParameter(PSP_VSMSHADOWPARAMS, renderer->GetVSMShadowParameters());
-
-                if (light->GetShadowBias().normalOffset_ > 0.0f)
-                {
-                    Vector4 normalOffsetScale(Vector4::ZERO);
-
-                    // Scale normal offset strength with the width of the shadow camera view
-                    if (light->GetLightType() != LIGHT_DIRECTIONAL)
-                    {
-                        Camera* shadowCamera = lightQueue_->shadowSplits_[0].shadowCamera_;
-                        normalOffsetScale.x_ = 2.0f * tanf(shadowCamera->GetFov() * M_DEGTORAD * 0.5f) * shadowCamera->GetFarClip();
-                    }
-                    else
-                    {
-                        normalOffsetScale.x_ = lightQueue_->shadowSplits_[0].shadowCamera_->GetOrthoSize();
-                        if (lightQueue_->shadowSplits_.Size() > 1)
-                            normalOffsetScale.y_ = lightQueue_->shadowSplits_[1].shadowCamera_->GetOrthoSize();
-                        if (lightQueue_->shadowSplits_.Size() > 2)
-                            normalOffsetScale.z_ = lightQueue_->shadowSplits_[2].shadowCamera_->GetOrthoSize();
-                        if (lightQueue_->shadowSplits_.Size() > 3)
-                            normalOffsetScale.w_ = lightQueue_->shadowSplits_[3].shadowCamera_->GetOrthoSize();
-                    }
-
-                    normalOffsetScale *= light->GetShadowBias().normalOffset_;
-#ifdef GL_ES_VERSION_2_0
-                    normalOffsetScale *= renderer->GetMobileNormalOffsetMul();
-#endif
-                    graphics->SetShaderParameter(VSP_NORMALOFFSETSCALE, normalOffsetScale);
-                    graphics->SetShaderParameter(PSP_NORMALOFFSETSCALE, normalOffsetScale);
-                }
-            }
+            graphics->SetShaderParameters(block);
         }
         else if (lightQueue_->vertexLights_.Size() && graphics->HasShaderParameter(VSP_VERTEXLIGHTS) &&
                  graphics->NeedParameterUpdate(SP_LIGHT, lightQueue_))
         {
-            Vector4 vertexLights[MAX_VERTEX_LIGHTS * 3];
-            const PODVector<Light*>& lights = lightQueue_->vertexLights_;
+            ShaderParameterBlock& block = view->GetShaderParameterBlock(lightQueue_, camera);
+            if (block.IsEmpty())
+                BuildVertexLightShaderParameters(block, lightQueue_);
 
-            for (unsigned i = 0; i < lights.Size(); ++i)
-            {
-                Light* vertexLight = lights[i];
-                Node* vertexLightNode = vertexLight->GetNode();
-                LightType type = vertexLight->GetLightType();
-
-                // Attenuation
-                float invRange, cutoff, invCutoff;
-                if (type == LIGHT_DIRECTIONAL)
-                    invRange = 0.0f;
-                else
-                    invRange = 1.0f / Max(vertexLight->GetRange(), M_EPSILON);
-                if (type == LIGHT_SPOT)
-                {
-                    cutoff = Cos(vertexLight->GetFov() * 0.5f);
-                    invCutoff = 1.0f / (1.0f - cutoff);
-                }
-                else
-                {
-                    cutoff = -1.0f;
-                    invCutoff = 1.0f;
-                }
-
-                // Color
-                float fade = 1.0f;
-                float fadeEnd = vertexLight->GetDrawDistance();
-                float fadeStart = vertexLight->GetFadeDistance();
-
-                // Do fade calculation for light if both fade & draw distance defined
-                if (vertexLight->GetLightType() != LIGHT_DIRECTIONAL && fadeEnd > 0.0f && fadeStart > 0.0f && fadeStart < fadeEnd)
-                    fade = Min(1.0f - (vertexLight->GetDistance() - fadeStart) / (fadeEnd - fadeStart), 1.0f);
-
-                Color color = vertexLight->GetEffectiveColor() * fade;
-                vertexLights[i * 3] = Vector4(color.r_, color.g_, color.b_, invRange);
-
-                // Direction
-                vertexLights[i * 3 + 1] = Vector4(-(vertexLightNode->GetWorldDirection()), cutoff);
-
-                // Position
-                vertexLights[i * 3 + 2] = Vector4(vertexLightNode->GetWorldPosition(), invCutoff);
-            }
-
-            graphics->SetShaderParameter(VSP_VERTEXLIGHTS, vertexLights[0].Data(), lights.Size() * 3 * 4);
+            graphics->SetShaderParameters(block);
         }
     }
 
@@ -597,11 +581,7 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
     if (material_)
     {
         if (graphics->NeedParameterUpdate(SP_MATERIAL, reinterpret_cast<const void*>(material_->GetShaderParameterHash())))
-        {
-            const HashMap<StringHash, MaterialShaderParameter>& parameters = material_->GetShaderParameters();
-            for (HashMap<StringHash, MaterialShaderParameter>::ConstIterator i = parameters.Begin(); i != parameters.End(); ++i)
-                graphics->SetShaderParameter(i->first_, i->second_.value_);
-        }
+            graphics->SetShaderParameters(material_->GetShaderParameterBlock());
 
         const HashMap<TextureUnit, SharedPtr<Texture> >& textures = material_->GetTextures();
         for (HashMap<TextureUnit, SharedPtr<Texture> >::ConstIterator i = textures.Begin(); i != textures.End(); ++i)
@@ -642,6 +622,134 @@ void Batch::Draw(View* view, Camera* camera, bool allowDepthWrite) const
     }
 }
 
+void Batch::RecordPrepare(RenderCommandBuffer& buffer, Renderer* renderer, bool setModelTransform) const
+{
+    if (!vertexShader_ || !pixelShader_)
+        return;
+
+    Camera* camera = buffer.GetCamera();
+    Light* light = lightQueue_ ? lightQueue_->light_ : nullptr;
+    Texture2D* shadowMap = lightQueue_ ? lightQueue_->shadowMap_ : nullptr;
+
+    buffer.SetShaders(vertexShader_, pixelShader_);
+
+    // Record pass / material-specific renderstates
+    if (pass_ && material_)
+    {
+        RenderStateCommand state{};
+        state.blendMode_ = pass_->GetBlendMode();
+        // Turn additive blending into subtract if the light is negative
+        if (light && light->IsNegative())
+        {
+            if (state.blendMode_ == BLEND_ADD)
+                state.blendMode_ = BLEND_SUBTRACT;
+            else if (state.blendMode_ == BLEND_ADDALPHA)
+                state.blendMode_ = BLEND_SUBTRACTALPHA;
+        }
+        state.alphaToCoverage_ = pass_->GetAlphaToCoverage() || material_->GetAlphaToCoverage();
+        state.lineAntiAlias_ = material_->GetLineAntiAlias();
+
+        bool isShadowPass = pass_->GetIndex() == Technique::shadowPassIndex;
+        state.cullMode_ = pass_->GetCullMode();
+        // Get cull mode from material if pass doesn't override it
+        if (state.cullMode_ == MAX_CULLMODES)
+            state.cullMode_ = isShadowPass ? material_->GetShadowCullMode() : material_->GetCullMode();
+        // Check whether the camera reverses culling due to vertical flipping or reflection
+        if (camera && camera->GetReverseCulling())
+        {
+            if (state.cullMode_ == CULL_CW)
+                state.cullMode_ = CULL_CCW;
+            else if (state.cullMode_ == CULL_CCW)
+                state.cullMode_ = CULL_CW;
+        }
+
+        if (!isShadowPass)
+        {
+            const BiasParameters& depthBias = material_->GetDepthBias();
+            state.constantBias_ = depthBias.constantBias_;
+            state.slopeScaledBias_ = depthBias.slopeScaledBias_;
+            state.setDepthBias_ = true;
+        }
+
+        // Use the "least filled" fill mode combined from camera & material
+        state.fillMode_ = (FillMode)(Max(camera->GetFillMode(), material_->GetFillMode()));
+        state.depthTest_ = pass_->GetDepthTestMode();
+        state.depthWrite_ = pass_->GetDepthWrite();
+        buffer.SetRenderState(state);
+    }
+
+    buffer.SetCameraParameters();
+
+    if (setModelTransform)
+        buffer.SetModelParameters(worldTransform_, numWorldTransforms_, geometryType_);
+
+    if (zone_)
+    {
+        if (ShaderParameterBlock* block = buffer.SetZoneParameters(zone_))
+            BuildZoneShaderParameters(*block, zone_, camera);
+    }
+
+    if (lightQueue_)
+    {
+        if (light)
+        {
+            if (ShaderParameterBlock* block = buffer.SetLightParameters(lightQueue_))
+                BuildLightShaderParameters(*block, lightQueue_, camera, renderer);
+        }
+        else if (lightQueue_->vertexLights_.Size())
+        {
+            if (ShaderParameterBlock* block = buffer.SetVertexLightParameters(lightQueue_))
+                BuildVertexLightShaderParameters(*block, lightQueue_);
+        }
+    }
+
+    // Record zone texture
+#ifndef GL_ES_VERSION_2_0
+    if (zone_)
+        buffer.SetTexture(TU_ZONE, zone_->GetZoneTexture());
+#else
+    // On OpenGL ES set the zone texture to the environment unit instead
+    if (zone_ && zone_->GetZoneTexture())
+        buffer.SetTexture(TU_ENVIRONMENT, zone_->GetZoneTexture());
+#endif
+
+    // Record material-specific shader parameters and textures
+    if (material_)
+    {
+        buffer.SetMaterialParameters(material_);
+
+        const HashMap<TextureUnit, SharedPtr<Texture> >& textures = material_->GetTextures();
+        for (HashMap<TextureUnit, SharedPtr<Texture> >::ConstIterator i = textures.Begin(); i != textures.End(); ++i)
+            buffer.SetTexture(i->first_, i->second_.Get());
+    }
+
+    // Record light-related textures
+    if (light)
+    {
+        if (shadowMap)
+            buffer.SetTexture(TU_SHADOWMAP, shadowMap);
+
+        Texture* rampTexture = light->GetRampTexture();
+        if (!rampTexture)
+            rampTexture = renderer->GetDefaultLightRamp();
+        buffer.SetTexture(TU_LIGHTRAMP, rampTexture);
+
+        Texture* shapeTexture = light->GetShapeTexture();
+        if (!shapeTexture && light->GetLightType() == LIGHT_SPOT)
+            shapeTexture = renderer->GetDefaultLightSpot();
+        buffer.SetTexture(TU_LIGHTSHAPE, shapeTexture);
+    }
+}
+
+void Batch::Record(RenderCommandBuffer& buffer, Renderer* renderer) const
+{
+    if (!geometry_->IsEmpty())
+    {
+        RecordPrepare(buffer, renderer, true);
+        buffer.Draw(geometry_);
+    }
+}
+
 void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
 {
     // Do not use up buffer space if not going to draw as instanced
@@ -711,6 +819,20 @@ void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
     }
 }
 
+void BatchGroup::Record(RenderCommandBuffer& buffer, Renderer* renderer) const
+{
+    if (instances_.Size() && !geometry_->IsEmpty())
+    {
+        // Draw as individual objects if instancing not supported or could not fill the instancing buffer
+        VertexBuffer* instanceBuffer = renderer->GetInstancingBuffer();
+        if (geometryType_ != GEOM_INSTANCED || startIndex_ == M_MAX_UNSIGNED)
+            instanceBuffer = nullptr;
+
+        Batch::RecordPrepare(buffer, renderer, false);
+        buffer.DrawInstances(geometry_, &instances_[0], instances_.Size(), startIndex_, instanceBuffer);
+    }
+}
+
 unsigned BatchGroupKey::ToHash() const
 {
     return (unsigned)((size_t)zone_ / sizeof(Zone) + (size_t)lightQueue_ / sizeof(LightBatchQueue) + (size_t)pass_ / sizeof(Pass) +
@@ -888,6 +1010,26 @@ void BatchQueue::Draw(View* view, Camera* camera, bool markToStencil, bool using
     }
 }
 
+void BatchQueue::Record(RenderCommandBuffer& buffer, Renderer* renderer) const
+{
+    // Instanced
+    for (PODVector<BatchGroup*>::ConstIterator i = sortedBatchGroups_.Begin(); i != sortedBatchGroups_.End(); ++i)
+    {
+        BatchGroup* group = *i;
+        buffer.SetStencilRef(group->lightMask_);
+        group->Record(buffer, renderer);
+    }
+    // Non-instanced
+    for (PODVector<Batch*>::ConstIterator i = sortedBatches_.Begin(); i != sortedBatches_.End(); ++i)
+    {
+        Batch* batch = *i;
+        buffer.SetStencilRef(batch->lightMask_);
+        // If drawing an alpha batch, we can optimize fillrate by scissor test
+        buffer.SetLightScissor(!batch->isBase_ && batch->lightQueue_ ? batch->lightQueue_->light_ : nullptr);
+        batch->Record(buffer, renderer);
+    }
+}
+
 unsigned BatchQueue::GetNumInstances() const
 {
     unsigned total = 0;
@@ -901,4 +1043,19 @@ unsigned BatchQueue::GetNumInstances() const
     return total;
 }
 
+bool ShadowMapCacheKey::operator ==(const ShadowMapCacheKey& rhs) const
+{
+    if (numSplits_ != rhs.numSplits_ || constantBias_ != rhs.constantBias_ || slopeScaledBias_ != rhs.slopeScaledBias_)
+        return false;
+
+    for (unsigned i = 0; i < numSplits_; ++i)
+    {
+        if (numCasters_[i] != rhs.numCasters_[i] || casterHashes_[i] != rhs.casterHashes_[i] ||
+            viewports_[i] != rhs.viewports_[i] || views_[i] != rhs.views_[i] || projections_[i] != rhs.projections_[i])
+            return false;
+    }
+
+    return true;
+}
+
 }
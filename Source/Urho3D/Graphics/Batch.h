@@ -24,6 +24,7 @@
 
 #include "../Container/Ptr.h"
 #include "../Graphics/Drawable.h"
+#include "../Graphics/Light.h"
 #include "../Graphics/Material.h"
 #include "../Math/MathDefs.h"
 #include "../Math/Matrix3x4.h"
@@ -39,6 +40,8 @@ class Light;
 class Material;
 class Matrix3x4;
 class Pass;
+class RenderCommandBuffer;
+class Renderer;
 class ShaderVariation;
 class Texture2D;
 class VertexBuffer;
@@ -73,6 +76,10 @@ struct Batch
     void Prepare(View* view, Camera* camera, bool setModelTransform, bool allowDepthWrite) const;
     /// Prepare and draw.
     void Draw(View* view, Camera* camera, bool allowDepthWrite) const;
+    /// Record the commands to prepare for rendering into a command buffer. Does not access the graphics context.
+    void RecordPrepare(RenderCommandBuffer& buffer, Renderer* renderer, bool setModelTransform) const;
+    /// Record the commands to prepare and draw into a command buffer. Does not access the graphics context.
+    void Record(RenderCommandBuffer& buffer, Renderer* renderer) const;
 
     /// State sorting key.
     unsigned long long sortKey_{};
@@ -167,6 +174,8 @@ struct BatchGroup : public Batch
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
     /// Prepare and draw.
     void Draw(View* view, Camera* camera, bool allowDepthWrite) const;
+    /// Record the commands to prepare and draw into a command buffer. Does not access the graphics context.
+    void Record(RenderCommandBuffer& buffer, Renderer* renderer) const;
 
     /// Instance data.
     PODVector<InstanceData> instances_;
@@ -238,6 +247,8 @@ public:
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
     /// Draw.
     void Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const;
+    /// Record the draw commands into a command buffer, to be executed later with the same result as Draw. Does not access the graphics context, so queues may be recorded in parallel.
+    void Record(RenderCommandBuffer& buffer, Renderer* renderer) const;
     /// Return the combined amount of instances.
     unsigned GetNumInstances() const;
 
@@ -280,14 +291,57 @@ struct ShadowBatchQueue
     Camera* shadowCamera_{};
     /// Shadow map viewport.
     IntRect shadowViewport_;
-    /// Shadow caster draw calls.
+    /// Shadow caster draw calls. When the light's shadow map is cached, only the dynamic casters.
     BatchQueue shadowBatches_;
+    /// Static shadow caster draw calls, drawn into the cached shadow map when it is out of date.
+    BatchQueue staticShadowBatches_;
     /// Directional light cascade near split distance.
     float nearSplit_{};
     /// Directional light cascade far split distance.
     float farSplit_{};
 };
 
+/// Shadow cameras and static shadow casters that a cached shadow map is rendered with.
+struct ShadowMapCacheKey
+{
+    /// Test for equality with another key.
+    bool operator ==(const ShadowMapCacheKey& rhs) const;
+    /// Test for inequality with another key.
+    bool operator !=(const ShadowMapCacheKey& rhs) const { return !(*this == rhs); }
+
+    /// Number of shadow splits.
+    unsigned numSplits_{};
+    /// Shadow camera view matrices.
+    Matrix3x4 views_[MAX_LIGHT_SPLITS];
+    /// Shadow camera projection matrices.
+    Matrix4 projections_[MAX_LIGHT_SPLITS];
+    /// Shadow map viewports.
+    IntRect viewports_[MAX_LIGHT_SPLITS];
+    /// Order independent hashes of the static casters and their geometries and materials.
+    unsigned long long casterHashes_[MAX_LIGHT_SPLITS]{};
+    /// Numbers of static casters.
+    unsigned numCasters_[MAX_LIGHT_SPLITS]{};
+    /// Constant depth bias.
+    float constantBias_{};
+    /// Slope scaled depth bias.
+    float slopeScaledBias_{};
+};
+
+/// Shadow map of a light's static shadow casters, kept between frames.
+struct CachedShadowMap
+{
+    /// Light the shadow map belongs to. Detects a new light created at the address of a destroyed one.
+    WeakPtr<Light> light_;
+    /// Shadow map depth texture.
+    SharedPtr<Texture2D> texture_;
+    /// Shadow cameras and casters the texture is rendered with.
+    ShadowMapCacheKey key_;
+    /// Frame number on which a view last used the cached shadow map.
+    unsigned frameNumber_{};
+    /// Whether the texture contents match the key.
+    bool valid_{};
+};
+
 /// Queue for light related draw calls.
 struct LightBatchQueue
 {
@@ -297,6 +351,8 @@ struct LightBatchQueue
     bool negative_;
     /// Shadow map depth texture.
     Texture2D* shadowMap_;
+    /// Cached shadow map of the static casters, or null if not used. When there are no dynamic casters, it is also the shadow map.
+    CachedShadowMap* shadowMapCache_;
     /// Lit geometry draw calls, base (replace blend mode)
     BatchQueue litBaseBatches_;
     /// Lit geometry draw calls, non-base (additive)
@@ -36,6 +36,7 @@
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
+#include "../Math/TriangleBVH.h"
 #include "../Resource/ResourceCache.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
@@ -760,6 +761,33 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
         }
     }
 
+    // If the geometry's triangle BVH was built from the same positions, visit only the faces near the decal frustum.
+    // The candidates are in ascending order, so the resulting decal is identical to a full scan
+    if (const TriangleBVH* bvh = geometry->GetTriangleBVH())
+    {
+        const unsigned char* bvhVertexData;
+        const unsigned char* bvhIndexData;
+        unsigned bvhVertexSize;
+        unsigned bvhIndexSize;
+        const PODVector<VertexElement>* elements;
+        geometry->GetRawData(bvhVertexData, bvhVertexSize, bvhIndexData, bvhIndexSize, elements);
+
+        if (bvhVertexData == positionData && bvhVertexSize == positionStride)
+        {
+            PODVector<unsigned> triangles;
+            bvh->GetTriangles(triangles, BoundingBox(frustum));
+
+            for (unsigned i = 0; i < triangles.Size(); ++i)
+            {
+                unsigned i0, i1, i2;
+                bvh->GetTriangleVertices(triangles[i], i0, i1, i2);
+                GetFace(faces, target, batchIndex, i0, i1, i2, positionData, normalData, skinningData, positionStride, normalStride,
+                    skinningStride, frustum, decalNormal, normalCutoff);
+            }
+            return;
+        }
+    }
+
     if (indexData)
     {
         unsigned indexStart = geometry->GetIndexStart();
@@ -729,6 +729,25 @@ bool Graphics::ResolveToTexture(Texture2D* texture)
     return true;
 }
 
+bool Graphics::CopyTexture(Texture2D* destination, Texture2D* source)
+{
+    if (!destination || !source || destination == source)
+        return false;
+    if (destination->GetWidth() != source->GetWidth() || destination->GetHeight() != source->GetHeight() ||
+        destination->GetFormat() != source->GetFormat() || source->GetMultiSample() > 1)
+        return false;
+
+    auto* sourceResource = (ID3D11Resource*)source->GetGPUObject();
+    auto* destResource = (ID3D11Resource*)destination->GetGPUObject();
+    if (!sourceResource || !destResource)
+        return false;
+
+    URHO3D_PROFILE("CopyTexture");
+
+    impl_->deviceContext_->CopyResource(destResource, sourceResource);
+    return true;
+}
+
 bool Graphics::ResolveToTexture(TextureCube* texture)
 {
     if (!texture)
@@ -1216,6 +1235,30 @@ void Graphics::SetShaderParameter(StringHash param, const Matrix3x4& matrix)
     buffer->SetParameter(i->second_.offset_, sizeof(Matrix3x4), &matrix);
 }
 
+void Graphics::SetShaderParameters(const ShaderParameterBlock& block)
+{
+    if (!impl_->shaderProgram_)
+        return;
+
+    const PODVector<ShaderParameterBlockEntry>& entries = block.GetEntries();
+    const ShaderParameter* const* infos = impl_->shaderProgram_->GetBlockParameters(block);
+    for (unsigned i = 0; i < entries.Size(); ++i)
+    {
+        const ShaderParameter* info = infos[i];
+        if (!info)
+            continue;
+
+        ConstantBuffer* buffer = info->bufferPtr_;
+        if (!buffer->IsDirty())
+            impl_->dirtyConstantBuffers_.Push(buffer);
+        buffer->SetParameter(info->offset_, (unsigned)(entries[i].size_ * sizeof(float)), block.GetData(entries[i]));
+    }
+
+    const Vector<Pair<StringHash, Variant> >& variants = block.GetVariantParameters();
+    for (unsigned i = 0; i < variants.Size(); ++i)
+        SetShaderParameter(variants[i].first_, variants[i].second_);
+}
+
 bool Graphics::NeedParameterUpdate(ShaderParameterGroup group, const void* source)
 {
     if ((unsigned)(size_t)shaderParameterSources_[group] == M_MAX_UNSIGNED || shaderParameterSources_[group] != source)
@@ -1713,6 +1756,15 @@ unsigned Graphics::GetFormat(CompressedFormat format) const
     case CF_DXT5:
         return DXGI_FORMAT_BC3_UNORM;
 
+    case CF_BC4:
+        return DXGI_FORMAT_BC4_UNORM;
+
+    case CF_BC5:
+        return DXGI_FORMAT_BC5_UNORM;
+
+    case CF_BC7:
+        return bptcTextureSupport_ ? DXGI_FORMAT_BC7_UNORM : 0;
+
     default:
         return 0;
     }
@@ -2282,10 +2334,14 @@ void Graphics::CheckFeatureSupport()
 {
     anisotropySupport_ = true;
     dxtTextureSupport_ = true;
+    rgtcTextureSupport_ = true;
+    // BC7 requires feature level 11
+    bptcTextureSupport_ = impl_->GetDevice()->GetFeatureLevel() >= D3D_FEATURE_LEVEL_11_0;
     lightPrepassSupport_ = true;
     deferredSupport_ = true;
     hardwareShadowSupport_ = true;
     instancingSupport_ = true;
+    textureCopySupport_ = true;
     shadowMapFormat_ = DXGI_FORMAT_R16_TYPELESS;
     hiresShadowMapFormat_ = DXGI_FORMAT_R32_TYPELESS;
     dummyColorFormat_ = DXGI_FORMAT_UNKNOWN;
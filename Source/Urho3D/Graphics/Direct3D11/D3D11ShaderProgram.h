@@ -25,6 +25,7 @@
 #include "../../Container/HashMap.h"
 #include "../../Graphics/ConstantBuffer.h"
 #include "../../Graphics/Graphics.h"
+#include "../../Graphics/ShaderParameterBlock.h"
 #include "../../Graphics/ShaderVariation.h"
 
 namespace Urho3D
@@ -77,12 +78,24 @@ public:
     {
     }
 
+    /// Return the info for the parameters of a shader parameter block, null for parameters that do not exist.
+    const ShaderParameter* const* GetBlockParameters(const ShaderParameterBlock& block)
+    {
+        return blockParameters_.Get(block, [this](StringHash param)
+        {
+            HashMap<StringHash, ShaderParameter>::ConstIterator i = parameters_.Find(param);
+            return i != parameters_.End() ? &i->second_ : nullptr;
+        });
+    }
+
     /// Combined parameters from the vertex and pixel shader.
     HashMap<StringHash, ShaderParameter> parameters_;
     /// Vertex shader constant buffers.
     SharedPtr<ConstantBuffer> vsConstantBuffers_[MAX_SHADER_PARAMETER_GROUPS];
     /// Pixel shader constant buffers.
     SharedPtr<ConstantBuffer> psConstantBuffers_[MAX_SHADER_PARAMETER_GROUPS];
+    /// Shader parameters of shader parameter block layouts.
+    ShaderParameterBlockBindings blockParameters_;
 };
 
 }
@@ -79,7 +79,8 @@ bool Texture::GetParametersDirty() const
 
 bool Texture::IsCompressed() const
 {
-    return format_ == DXGI_FORMAT_BC1_UNORM || format_ == DXGI_FORMAT_BC2_UNORM || format_ == DXGI_FORMAT_BC3_UNORM;
+    return format_ == DXGI_FORMAT_BC1_UNORM || format_ == DXGI_FORMAT_BC2_UNORM || format_ == DXGI_FORMAT_BC3_UNORM ||
+           format_ == DXGI_FORMAT_BC4_UNORM || format_ == DXGI_FORMAT_BC5_UNORM || format_ == DXGI_FORMAT_BC7_UNORM;
 }
 
 unsigned Texture::GetRowDataSize(int width) const
@@ -112,10 +113,13 @@ unsigned Texture::GetRowDataSize(int width) const
         return (unsigned)(width * 16);
 
     case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC4_UNORM:
         return (unsigned)(((width + 3) >> 2) * 8);
 
     case DXGI_FORMAT_BC2_UNORM:
     case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC7_UNORM:
         return (unsigned)(((width + 3) >> 2) * 16);
 
     default:
@@ -190,6 +194,8 @@ unsigned Texture::GetSRGBFormat(unsigned format)
         return DXGI_FORMAT_BC2_UNORM_SRGB;
     else if (format == DXGI_FORMAT_BC3_UNORM)
         return DXGI_FORMAT_BC3_UNORM_SRGB;
+    else if (format == DXGI_FORMAT_BC7_UNORM)
+        return DXGI_FORMAT_BC7_UNORM_SRGB;
     else
         return format;
 }
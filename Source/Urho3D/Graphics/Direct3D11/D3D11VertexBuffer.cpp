@@ -74,6 +74,7 @@ bool VertexBuffer::SetData(const void* data)
 
     if (shadowData_ && data != shadowData_.Get())
         memcpy(shadowData_.Get(), data, vertexCount_ * vertexSize_);
+    ++dataRevision_;
 
     if (object_.ptr_)
     {
@@ -133,6 +134,7 @@ bool VertexBuffer::SetDataRange(const void* data, unsigned start, unsigned count
 
     if (shadowData_ && shadowData_.Get() + start * vertexSize_ != data)
         memcpy(shadowData_.Get() + start * vertexSize_, data, count * vertexSize_);
+    ++dataRevision_;
 
     if (object_.ptr_)
     {
@@ -860,6 +860,12 @@ bool Graphics::ResolveToTexture(Texture2D* texture)
         return true;
 }
 
+bool Graphics::CopyTexture(Texture2D* destination, Texture2D* source)
+{
+    // Depth textures can not be copied on Direct3D9
+    return false;
+}
+
 bool Graphics::ResolveToTexture(TextureCube* texture)
 {
     if (!texture || !texture->GetRenderSurface(FACE_POSITIVE_X) || !texture->GetGPUObject() || texture->GetMultiSample() < 2)
@@ -1360,6 +1366,33 @@ void Graphics::SetShaderParameter(StringHash param, const Matrix3x4& matrix)
         impl_->device_->SetPixelShaderConstantF(i->second_.register_, matrix.Data(), 3);
 }
 
+void Graphics::SetShaderParameters(const ShaderParameterBlock& block)
+{
+    if (!impl_->shaderProgram_)
+        return;
+
+    const PODVector<ShaderParameterBlockEntry>& entries = block.GetEntries();
+    const ShaderParameter* const* infos = impl_->shaderProgram_->GetBlockParameters(block);
+    for (unsigned i = 0; i < entries.Size(); ++i)
+    {
+        const ShaderParameter* info = infos[i];
+        if (!info)
+            continue;
+
+        // Block values are padded to whole registers
+        const float* data = block.GetData(entries[i]);
+        unsigned registers = (entries[i].size_ + 3) / 4;
+        if (info->type_ == VS)
+            impl_->device_->SetVertexShaderConstantF(info->register_, data, registers);
+        else
+            impl_->device_->SetPixelShaderConstantF(info->register_, data, registers);
+    }
+
+    const Vector<Pair<StringHash, Variant> >& variants = block.GetVariantParameters();
+    for (unsigned i = 0; i < variants.Size(); ++i)
+        SetShaderParameter(variants[i].first_, variants[i].second_);
+}
+
 bool Graphics::NeedParameterUpdate(ShaderParameterGroup group, const void* source)
 {
     if ((unsigned)(size_t)shaderParameterSources_[group] == M_MAX_UNSIGNED || shaderParameterSources_[group] != source)
@@ -80,6 +80,7 @@ bool IndexBuffer::SetData(const void* data)
 
     if (shadowData_ && data != shadowData_.Get())
         memcpy(shadowData_.Get(), data, indexCount_ * indexSize_);
+    ++dataRevision_;
 
     if (object_.ptr_)
     {
@@ -132,6 +133,7 @@ bool IndexBuffer::SetDataRange(const void* data, unsigned start, unsigned count,
 
     if (shadowData_ && shadowData_.Get() + start * indexSize_ != data)
         memcpy(shadowData_.Get() + start * indexSize_, data, count * indexSize_);
+    ++dataRevision_;
 
     if (object_.ptr_)
     {
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../../Container/HashMap.h"
+#include "../../Graphics/ShaderParameterBlock.h"
 #include "../../Graphics/ShaderVariation.h"
 
 namespace Urho3D
@@ -47,8 +48,20 @@ public:
         parameters_.Rehash(NextPowerOfTwo(parameters_.Size()));
     }
 
+    /// Return the info for the parameters of a shader parameter block, null for parameters that do not exist.
+    const ShaderParameter* const* GetBlockParameters(const ShaderParameterBlock& block)
+    {
+        return blockParameters_.Get(block, [this](StringHash param)
+        {
+            HashMap<StringHash, ShaderParameter>::ConstIterator i = parameters_.Find(param);
+            return i != parameters_.End() ? &i->second_ : nullptr;
+        });
+    }
+
     /// Combined parameters from the vertex and pixel shader.
     HashMap<StringHash, ShaderParameter> parameters_;
+    /// Shader parameters of shader parameter block layouts.
+    ShaderParameterBlockBindings blockParameters_;
 };
 
 }
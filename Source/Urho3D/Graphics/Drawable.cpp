@@ -73,6 +73,7 @@ Drawable::Drawable(Context* context, unsigned char drawableFlags) :
     shadowMask_(DEFAULT_SHADOWMASK),
     zoneMask_(DEFAULT_ZONEMASK),
     viewFrameNumber_(0),
+    updateFrameNumber_(0),
     distance_(0.0f),
     lodDistance_(0.0f),
     drawDistance_(0.0f),
@@ -77,6 +77,8 @@ struct FrameInfo
     IntVector2 viewSize_;
     /// Camera being used.
     Camera* camera_;
+    /// Occlusion buffer of the view, or null if occlusion is not in use.
+    OcclusionBuffer* occlusionBuffer_{};
 };
 
 /// Source data for a 3D geometry draw call.
@@ -141,6 +143,8 @@ public:
 
     /// Return the geometry for a specific LOD level.
     virtual Geometry* GetLodGeometry(unsigned batchIndex, unsigned level);
+    /// Return batches for rendering into a shadow map split. Is called from the main thread after UpdateBatches(). Default returns the view batches.
+    virtual const Vector<SourceBatch>& GetShadowBatches(const FrameInfo& frame, Camera* shadowCamera) { return batches_; }
 
     /// Return number of occlusion geometry triangles.
     virtual unsigned GetNumOccluderTriangles() { return 0; }
@@ -270,6 +274,9 @@ public:
     /// Return whether is in view on the current frame. Called by View.
     bool IsInView(const FrameInfo& frame, bool anyCamera = false) const;
 
+    /// Return frame number on which the drawable was last moved, resized or updated by the octree.
+    unsigned GetUpdateFrameNumber() const { return updateFrameNumber_; }
+
     /// Return whether has a base pass.
     bool HasBasePass(unsigned batchIndex) const { return (basePassFlags_ & (1u << batchIndex)) != 0; }
 
@@ -361,6 +368,8 @@ protected:
     unsigned zoneMask_;
     /// Last visible frame number.
     unsigned viewFrameNumber_;
+    /// Last octree update frame number.
+    unsigned updateFrameNumber_;
     /// Current distance to camera.
     float distance_;
     /// LOD scaled distance.
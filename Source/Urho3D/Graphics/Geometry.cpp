@@ -28,12 +28,16 @@
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
 #include "../Math/Ray.h"
+#include "../Math/TriangleBVH.h"
 
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+/// Minimum number of triangles for building a triangle BVH. Smaller geometries are raycast linearly.
+static const unsigned MIN_BVH_TRIANGLES = 64;
+
 Geometry::Geometry(Context* context) :
     Object(context),
     primitiveType_(TRIANGLE_LIST),
@@ -43,7 +47,9 @@ Geometry::Geometry(Context* context) :
     vertexCount_(0),
     rawVertexSize_(0),
     rawIndexSize_(0),
-    lodDistance_(0.0f)
+    lodDistance_(0.0f),
+    triangleBVHVertexRevision_(0),
+    triangleBVHIndexRevision_(0)
 {
     SetNumVertexBuffers(1);
 }
@@ -60,6 +66,7 @@ bool Geometry::SetNumVertexBuffers(unsigned num)
 
     unsigned oldSize = vertexBuffers_.Size();
     vertexBuffers_.Resize(num);
+    ResetTriangleBVH();
 
     return true;
 }
@@ -73,12 +80,14 @@ bool Geometry::SetVertexBuffer(unsigned index, VertexBuffer* buffer)
     }
 
     vertexBuffers_[index] = buffer;
+    ResetTriangleBVH();
     return true;
 }
 
 void Geometry::SetIndexBuffer(IndexBuffer* buffer)
 {
     indexBuffer_ = buffer;
+    ResetTriangleBVH();
 }
 
 bool Geometry::SetDrawRange(PrimitiveType type, unsigned indexStart, unsigned indexCount, bool getUsedVertexRange)
@@ -95,6 +104,9 @@ bool Geometry::SetDrawRange(PrimitiveType type, unsigned indexStart, unsigned in
         return false;
     }
 
+    if (type != primitiveType_ || indexStart != indexStart_ || indexCount != indexCount_)
+        ResetTriangleBVH();
+
     primitiveType_ = type;
     indexStart_ = indexStart;
     indexCount_ = indexCount;
@@ -136,6 +148,10 @@ bool Geometry::SetDrawRange(PrimitiveType type, unsigned indexStart, unsigned in
         indexCount = 0;
     }
 
+    if (type != primitiveType_ || indexStart != indexStart_ || indexCount != indexCount_ || vertexStart != vertexStart_ ||
+        vertexCount != vertexCount_)
+        ResetTriangleBVH();
+
     primitiveType_ = type;
     indexStart_ = indexStart;
     indexCount_ = indexCount;
@@ -158,6 +174,7 @@ void Geometry::SetRawVertexData(const SharedArrayPtr<unsigned char>& data, const
     rawVertexData_ = data;
     rawVertexSize_ = VertexBuffer::GetVertexSize(elements);
     rawElements_ = elements;
+    ResetTriangleBVH();
 }
 
 void Geometry::SetRawVertexData(const SharedArrayPtr<unsigned char>& data, unsigned elementMask)
@@ -165,12 +182,14 @@ void Geometry::SetRawVertexData(const SharedArrayPtr<unsigned char>& data, unsig
     rawVertexData_ = data;
     rawVertexSize_ = VertexBuffer::GetVertexSize(elementMask);
     rawElements_ = VertexBuffer::GetElements(elementMask);
+    ResetTriangleBVH();
 }
 
 void Geometry::SetRawIndexData(const SharedArrayPtr<unsigned char>& data, unsigned indexSize)
 {
     rawIndexData_ = data;
     rawIndexSize_ = indexSize;
+    ResetTriangleBVH();
 }
 
 void Geometry::Draw(Graphics* graphics)
@@ -322,10 +341,50 @@ float Geometry::GetHitDistance(const Ray& ray, Vector3* outNormal, Vector2* outU
         outUV = nullptr;
     }
 
+    if (const TriangleBVH* bvh = GetTriangleBVH())
+    {
+        Vector3 barycentric;
+        unsigned triangle;
+        float distance = bvh->HitDistance(ray, outNormal, outUV ? &barycentric : nullptr, &triangle);
+
+        if (outUV)
+        {
+            if (triangle == M_MAX_UNSIGNED)
+                *outUV = Vector2::ZERO;
+            else
+            {
+                // Interpolate the UV coordinate using barycentric coordinate
+                unsigned i0, i1, i2;
+                bvh->GetTriangleVertices(triangle, i0, i1, i2);
+                const Vector2& uv0 = *((const Vector2*)(&vertexData[uvOffset + i0 * vertexSize]));
+                const Vector2& uv1 = *((const Vector2*)(&vertexData[uvOffset + i1 * vertexSize]));
+                const Vector2& uv2 = *((const Vector2*)(&vertexData[uvOffset + i2 * vertexSize]));
+                *outUV = Vector2(uv0.x_ * barycentric.x_ + uv1.x_ * barycentric.y_ + uv2.x_ * barycentric.z_,
+                    uv0.y_ * barycentric.x_ + uv1.y_ * barycentric.y_ + uv2.y_ * barycentric.z_);
+            }
+        }
+
+        return distance;
+    }
+
     return indexData ? ray.HitDistance(vertexData, vertexSize, indexData, indexSize, indexStart_, indexCount_, outNormal, outUV,
         uvOffset) : ray.HitDistance(vertexData, vertexSize, vertexStart_, vertexCount_, outNormal, outUV, uvOffset);
 }
 
+void Geometry::GetHitDistances(const Ray* rays, unsigned numRays, float* outDistances) const
+{
+    if (const TriangleBVH* bvh = GetTriangleBVH())
+    {
+        for (unsigned i = 0; i < numRays; i += BVH_PACKET_SIZE)
+            bvh->HitDistance(rays + i, Min(numRays - i, BVH_PACKET_SIZE), outDistances + i);
+    }
+    else
+    {
+        for (unsigned i = 0; i < numRays; ++i)
+            outDistances[i] = GetHitDistance(rays[i]);
+    }
+}
+
 bool Geometry::IsInside(const Ray& ray) const
 {
     const unsigned char* vertexData;
@@ -340,4 +399,56 @@ bool Geometry::IsInside(const Ray& ray) const
                          ray.InsideGeometry(vertexData, vertexSize, vertexStart_, vertexCount_)) : false;
 }
 
+const TriangleBVH* Geometry::GetTriangleBVH() const
+{
+    if (primitiveType_ != TRIANGLE_LIST)
+        return nullptr;
+
+    const unsigned char* vertexData;
+    const unsigned char* indexData;
+    unsigned vertexSize;
+    unsigned indexSize;
+    const PODVector<VertexElement>* elements;
+
+    GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+
+    if (!vertexData || !elements || VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) != 0)
+        return nullptr;
+    if ((indexData ? indexCount_ : vertexCount_) < MIN_BVH_TRIANGLES * 3)
+        return nullptr;
+
+    // Dynamic buffers are rewritten too often for the BVH to pay off
+    VertexBuffer* vertexBuffer = !rawVertexData_ && vertexBuffers_.Size() ? vertexBuffers_[0].Get() : nullptr;
+    IndexBuffer* indexBuffer = !rawIndexData_ && indexData ? indexBuffer_.Get() : nullptr;
+    if ((vertexBuffer && vertexBuffer->IsDynamic()) || (indexBuffer && indexBuffer->IsDynamic()))
+        return nullptr;
+
+    unsigned vertexRevision = vertexBuffer ? vertexBuffer->GetDataRevision() : 0;
+    unsigned indexRevision = indexBuffer ? indexBuffer->GetDataRevision() : 0;
+
+    MutexLock lock(triangleBVHMutex_);
+
+    if (!triangleBVH_ || vertexRevision != triangleBVHVertexRevision_ || indexRevision != triangleBVHIndexRevision_)
+    {
+        if (!triangleBVH_)
+            triangleBVH_ = new TriangleBVH();
+
+        if (indexData)
+            triangleBVH_->Define(vertexData, vertexSize, indexData, indexSize, indexStart_, indexCount_);
+        else
+            triangleBVH_->Define(vertexData, vertexSize, vertexStart_, vertexCount_);
+
+        triangleBVHVertexRevision_ = vertexRevision;
+        triangleBVHIndexRevision_ = indexRevision;
+    }
+
+    return triangleBVH_.Get();
+}
+
+void Geometry::ResetTriangleBVH()
+{
+    MutexLock lock(triangleBVHMutex_);
+    triangleBVH_.Reset();
+}
+
 }
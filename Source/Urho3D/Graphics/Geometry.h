@@ -23,6 +23,8 @@
 #pragma once
 
 #include "../Container/ArrayPtr.h"
+#include "../Container/Ptr.h"
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Graphics/GraphicsDefs.h"
 
@@ -31,6 +33,7 @@ namespace Urho3D
 
 class IndexBuffer;
 class Ray;
+class TriangleBVH;
 class Graphics;
 class VertexBuffer;
 
@@ -106,13 +109,21 @@ public:
         unsigned& indexSize, const PODVector<VertexElement>*& elements) const;
     /// Return ray hit distance or infinity if no hit. Requires raw data to be set. Optionally return hit normal and hit uv coordinates at intersect point.
     float GetHitDistance(const Ray& ray, Vector3* outNormal = nullptr, Vector2* outUV = nullptr) const;
+    /// Return hit distances of several rays, or infinity for rays that do not hit. Requires raw data to be set. Rays are traversed in packets when the triangle BVH is available.
+    void GetHitDistances(const Ray* rays, unsigned numRays, float* outDistances) const;
     /// Return whether or not the ray is inside geometry.
     bool IsInside(const Ray& ray) const;
 
     /// Return whether has empty draw range.
     bool IsEmpty() const { return indexCount_ == 0 && vertexCount_ == 0; }
 
+    /// Return the triangle BVH of the draw range for CPU-side queries, building it on first use. Return null if the geometry has no suitable raw data, is dynamic or has too few triangles for a BVH to pay off.
+    const TriangleBVH* GetTriangleBVH() const;
+
 private:
+    /// Release the triangle BVH. Called when buffers or the draw range change.
+    void ResetTriangleBVH();
+
     /// Vertex buffers.
     Vector<SharedPtr<VertexBuffer> > vertexBuffers_;
     /// Index buffer.
@@ -139,6 +150,14 @@ private:
     unsigned rawVertexSize_;
     /// Raw index data override size.
     unsigned rawIndexSize_;
+    /// Triangle BVH built on demand.
+    mutable UniquePtr<TriangleBVH> triangleBVH_;
+    /// Vertex data revision the triangle BVH was built from.
+    mutable unsigned triangleBVHVertexRevision_;
+    /// Index data revision the triangle BVH was built from.
+    mutable unsigned triangleBVHIndexRevision_;
+    /// Mutex for building the triangle BVH from concurrent queries.
+    mutable Mutex triangleBVHMutex_;
 };
 
 }
@@ -40,6 +40,7 @@
 #include "../Graphics/Shader.h"
 #include "../Graphics/ShaderPrecache.h"
 #include "../Graphics/Skybox.h"
+#include "../Graphics/StaticModelCloud.h"
 #include "../Graphics/StaticModelGroup.h"
 #include "../Graphics/Technique.h"
 #include "../Graphics/Terrain.h"
@@ -413,6 +414,7 @@ void RegisterGraphicsLibrary(Context* context)
     Light::RegisterObject(context);
     StaticModel::RegisterObject(context);
     StaticModelGroup::RegisterObject(context);
+    StaticModelCloud::RegisterObject(context);
     Skybox::RegisterObject(context);
     AnimatedModel::RegisterObject(context);
     AnimationController::RegisterObject(context);
@@ -46,6 +46,7 @@ class GPUObject;
 class GraphicsImpl;
 class RenderSurface;
 class Shader;
+class ShaderParameterBlock;
 class ShaderPrecache;
 class ShaderProgram;
 class ShaderVariation;
@@ -132,6 +133,8 @@ public:
     bool ResolveToTexture(Texture2D* texture);
     /// Resolve a multisampled cube texture on itself.
     bool ResolveToTexture(TextureCube* texture);
+    /// Copy the contents of a non-multisampled texture to another with the same size, format and usage. Return true if successful.
+    bool CopyTexture(Texture2D* destination, Texture2D* source);
     /// Draw non-indexed geometry.
     void Draw(PrimitiveType type, unsigned vertexStart, unsigned vertexCount);
     /// Draw indexed geometry.
@@ -178,6 +181,8 @@ public:
     void SetShaderParameter(StringHash param, const Matrix3x4& matrix);
     /// Set shader constant from a variant. Supported variant types: bool, float, vector2, vector3, vector4, color.
     void SetShaderParameter(StringHash param, const Variant& value);
+    /// Set all shader constants of a shader parameter block.
+    void SetShaderParameters(const ShaderParameterBlock& block);
     /// Check whether a shader parameter group needs update. Does not actually check whether parameters exist in the shaders.
     bool NeedParameterUpdate(ShaderParameterGroup group, const void* source);
     /// Check whether a shader parameter exists on the currently set shaders.
@@ -366,6 +371,9 @@ public:
     /// Return whether sRGB conversion on rendertarget writing is supported.
     bool GetSRGBWriteSupport() const { return sRGBWriteSupport_; }
 
+    /// Return whether copying rendertarget and depth textures on the GPU is supported.
+    bool GetTextureCopySupport() const { return textureCopySupport_; }
+
     /// Return supported fullscreen resolutions (third component is refreshRate). Will be empty if listing the resolutions is not supported on the platform (e.g. Web).
     PODVector<IntVector3> GetResolutions(int monitor) const;
     /// Return supported multisampling levels.
@@ -684,6 +692,10 @@ private:
     bool etcTextureSupport_{};
     /// PVRTC formats support flag.
     bool pvrtcTextureSupport_{};
+    /// RGTC (BC4 and BC5) formats support flag.
+    bool rgtcTextureSupport_{};
+    /// BPTC (BC7) format support flag.
+    bool bptcTextureSupport_{};
     /// Hardware shadow map depth compare support flag.
     bool hardwareShadowSupport_{};
     /// Instancing support flag.
@@ -692,6 +704,8 @@ private:
     bool sRGBSupport_{};
     /// sRGB conversion on write support flag.
     bool sRGBWriteSupport_{};
+    /// GPU texture copy support flag.
+    bool textureCopySupport_{};
     /// Number of primitives this frame.
     unsigned numPrimitives_{};
     /// Number of batches this frame.
@@ -33,62 +33,62 @@ namespace Urho3D
 // The extern keyword is required when building Urho3D.dll for Windows platform
 // The keyword is not required for other platforms but it does no harm, aside from warning from static analyzer
 
-extern URHO3D_API const StringHash VSP_AMBIENTSTARTCOLOR("AmbientStartColor");
-extern URHO3D_API const StringHash VSP_AMBIENTENDCOLOR("AmbientEndColor");
-extern URHO3D_API const StringHash VSP_BILLBOARDROT("BillboardRot");
-extern URHO3D_API const StringHash VSP_CAMERAPOS("CameraPos");
-extern URHO3D_API const StringHash VSP_CLIPPLANE("ClipPlane");
-extern URHO3D_API const StringHash VSP_NEARCLIP("NearClip");
-extern URHO3D_API const StringHash VSP_FARCLIP("FarClip");
-extern URHO3D_API const StringHash VSP_DEPTHMODE("DepthMode");
-extern URHO3D_API const StringHash VSP_DELTATIME("DeltaTime");
-extern URHO3D_API const StringHash VSP_ELAPSEDTIME("ElapsedTime");
-extern URHO3D_API const StringHash VSP_FRUSTUMSIZE("FrustumSize");
-extern URHO3D_API const StringHash VSP_GBUFFEROFFSETS("GBufferOffsets");
-extern URHO3D_API const StringHash VSP_LIGHTDIR("LightDir");
-extern URHO3D_API const StringHash VSP_LIGHTPOS("LightPos");
-extern URHO3D_API const StringHash VSP_NORMALOFFSETSCALE("NormalOffsetScale");
-extern URHO3D_API const StringHash VSP_MODEL("Model");
-extern URHO3D_API const StringHash VSP_VIEW("View");
-extern URHO3D_API const StringHash VSP_VIEWINV("ViewInv");
-extern URHO3D_API const StringHash VSP_VIEWPROJ("ViewProj");
-extern URHO3D_API const StringHash VSP_UOFFSET("UOffset");
-extern URHO3D_API const StringHash VSP_VOFFSET("VOffset");
-extern URHO3D_API const StringHash VSP_ZONE("Zone");
-extern URHO3D_API const StringHash VSP_LIGHTMATRICES("LightMatrices");
-extern URHO3D_API const StringHash VSP_SKINMATRICES("SkinMatrices");
-extern URHO3D_API const StringHash VSP_VERTEXLIGHTS("VertexLights");
-extern URHO3D_API const StringHash PSP_AMBIENTCOLOR("AmbientColor");
-extern URHO3D_API const StringHash PSP_CAMERAPOS("CameraPosPS");
-extern URHO3D_API const StringHash PSP_DELTATIME("DeltaTimePS");
-extern URHO3D_API const StringHash PSP_DEPTHRECONSTRUCT("DepthReconstruct");
-extern URHO3D_API const StringHash PSP_ELAPSEDTIME("ElapsedTimePS");
-extern URHO3D_API const StringHash PSP_FOGCOLOR("FogColor");
-extern URHO3D_API const StringHash PSP_FOGPARAMS("FogParams");
-extern URHO3D_API const StringHash PSP_GBUFFERINVSIZE("GBufferInvSize");
-extern URHO3D_API const StringHash PSP_LIGHTCOLOR("LightColor");
-extern URHO3D_API const StringHash PSP_LIGHTDIR("LightDirPS");
-extern URHO3D_API const StringHash PSP_LIGHTPOS("LightPosPS");
-extern URHO3D_API const StringHash PSP_NORMALOFFSETSCALE("NormalOffsetScalePS");
-extern URHO3D_API const StringHash PSP_MATDIFFCOLOR("MatDiffColor");
-extern URHO3D_API const StringHash PSP_MATEMISSIVECOLOR("MatEmissiveColor");
-extern URHO3D_API const StringHash PSP_MATENVMAPCOLOR("MatEnvMapColor");
-extern URHO3D_API const StringHash PSP_MATSPECCOLOR("MatSpecColor");
-extern URHO3D_API const StringHash PSP_NEARCLIP("NearClipPS");
-extern URHO3D_API const StringHash PSP_FARCLIP("FarClipPS");
-extern URHO3D_API const StringHash PSP_SHADOWCUBEADJUST("ShadowCubeAdjust");
-extern URHO3D_API const StringHash PSP_SHADOWDEPTHFADE("ShadowDepthFade");
-extern URHO3D_API const StringHash PSP_SHADOWINTENSITY("ShadowIntensity");
-extern URHO3D_API const StringHash PSP_SHADOWMAPINVSIZE("ShadowMapInvSize");
-extern URHO3D_API const StringHash PSP_SHADOWSPLITS("ShadowSplits");
-extern URHO3D_API const StringHash PSP_LIGHTMATRICES("LightMatricesPS");
-extern URHO3D_API const StringHash PSP_VSMSHADOWPARAMS("VSMShadowParams");
-extern URHO3D_API const StringHash PSP_ROUGHNESS("Roughness");
-extern URHO3D_API const StringHash PSP_METALLIC("Metallic");
-extern URHO3D_API const StringHash PSP_LIGHTRAD("LightRad");
-extern URHO3D_API const StringHash PSP_LIGHTLENGTH("LightLength");
-extern URHO3D_API const StringHash PSP_ZONEMIN("ZoneMin");
-extern URHO3D_API const StringHash PSP_ZONEMAX("ZoneMax");
+extern URHO3D_API const StringHash VSP_AMBIENTSTARTCOLOR = "AmbientStartColor"_sh;
+extern URHO3D_API const StringHash VSP_AMBIENTENDCOLOR = "AmbientEndColor"_sh;
+extern URHO3D_API const StringHash VSP_BILLBOARDROT = "BillboardRot"_sh;
+extern URHO3D_API const StringHash VSP_CAMERAPOS = "CameraPos"_sh;
+extern URHO3D_API const StringHash VSP_CLIPPLANE = "ClipPlane"_sh;
+extern URHO3D_API const StringHash VSP_NEARCLIP = "NearClip"_sh;
+extern URHO3D_API const StringHash VSP_FARCLIP = "FarClip"_sh;
+extern URHO3D_API const StringHash VSP_DEPTHMODE = "DepthMode"_sh;
+extern URHO3D_API const StringHash VSP_DELTATIME = "DeltaTime"_sh;
+extern URHO3D_API const StringHash VSP_ELAPSEDTIME = "ElapsedTime"_sh;
+extern URHO3D_API const StringHash VSP_FRUSTUMSIZE = "FrustumSize"_sh;
+extern URHO3D_API const StringHash VSP_GBUFFEROFFSETS = "GBufferOffsets"_sh;
+extern URHO3D_API const StringHash VSP_LIGHTDIR = "LightDir"_sh;
+extern URHO3D_API const StringHash VSP_LIGHTPOS = "LightPos"_sh;
+extern URHO3D_API const StringHash VSP_NORMALOFFSETSCALE = "NormalOffsetScale"_sh;
+extern URHO3D_API const StringHash VSP_MODEL = "Model"_sh;
+extern URHO3D_API const StringHash VSP_VIEW = "View"_sh;
+extern URHO3D_API const StringHash VSP_VIEWINV = "ViewInv"_sh;
+extern URHO3D_API const StringHash VSP_VIEWPROJ = "ViewProj"_sh;
+extern URHO3D_API const StringHash VSP_UOFFSET = "UOffset"_sh;
+extern URHO3D_API const StringHash VSP_VOFFSET = "VOffset"_sh;
+extern URHO3D_API const StringHash VSP_ZONE = "Zone"_sh;
+extern URHO3D_API const StringHash VSP_LIGHTMATRICES = "LightMatrices"_sh;
+extern URHO3D_API const StringHash VSP_SKINMATRICES = "SkinMatrices"_sh;
+extern URHO3D_API const StringHash VSP_VERTEXLIGHTS = "VertexLights"_sh;
+extern URHO3D_API const StringHash PSP_AMBIENTCOLOR = "AmbientColor"_sh;
+extern URHO3D_API const StringHash PSP_CAMERAPOS = "CameraPosPS"_sh;
+extern URHO3D_API const StringHash PSP_DELTATIME = "DeltaTimePS"_sh;
+extern URHO3D_API const StringHash PSP_DEPTHRECONSTRUCT = "DepthReconstruct"_sh;
+extern URHO3D_API const StringHash PSP_ELAPSEDTIME = "ElapsedTimePS"_sh;
+extern URHO3D_API const StringHash PSP_FOGCOLOR = "FogColor"_sh;
+extern URHO3D_API const StringHash PSP_FOGPARAMS = "FogParams"_sh;
+extern URHO3D_API const StringHash PSP_GBUFFERINVSIZE = "GBufferInvSize"_sh;
+extern URHO3D_API const StringHash PSP_LIGHTCOLOR = "LightColor"_sh;
+extern URHO3D_API const StringHash PSP_LIGHTDIR = "LightDirPS"_sh;
+extern URHO3D_API const StringHash PSP_LIGHTPOS = "LightPosPS"_sh;
+extern URHO3D_API const StringHash PSP_NORMALOFFSETSCALE = "NormalOffsetScalePS"_sh;
+extern URHO3D_API const StringHash PSP_MATDIFFCOLOR = "MatDiffColor"_sh;
+extern URHO3D_API const StringHash PSP_MATEMISSIVECOLOR = "MatEmissiveColor"_sh;
+extern URHO3D_API const StringHash PSP_MATENVMAPCOLOR = "MatEnvMapColor"_sh;
+extern URHO3D_API const StringHash PSP_MATSPECCOLOR = "MatSpecColor"_sh;
+extern URHO3D_API const StringHash PSP_NEARCLIP = "NearClipPS"_sh;
+extern URHO3D_API const StringHash PSP_FARCLIP = "FarClipPS"_sh;
+extern URHO3D_API const StringHash PSP_SHADOWCUBEADJUST = "ShadowCubeAdjust"_sh;
+extern URHO3D_API const StringHash PSP_SHADOWDEPTHFADE = "ShadowDepthFade"_sh;
+extern URHO3D_API const StringHash PSP_SHADOWINTENSITY = "ShadowIntensity"_sh;
+extern URHO3D_API const StringHash PSP_SHADOWMAPINVSIZE = "ShadowMapInvSize"_sh;
+extern URHO3D_API const StringHash PSP_SHADOWSPLITS = "ShadowSplits"_sh;
+extern URHO3D_API const StringHash PSP_LIGHTMATRICES = "LightMatricesPS"_sh;
+extern URHO3D_API const StringHash PSP_VSMSHADOWPARAMS = "VSMShadowParams"_sh;
+extern URHO3D_API const StringHash PSP_ROUGHNESS = "Roughness"_sh;
+extern URHO3D_API const StringHash PSP_METALLIC = "Metallic"_sh;
+extern URHO3D_API const StringHash PSP_LIGHTRAD = "LightRad"_sh;
+extern URHO3D_API const StringHash PSP_LIGHTLENGTH = "LightLength"_sh;
+extern URHO3D_API const StringHash PSP_ZONEMIN = "ZoneMin"_sh;
+extern URHO3D_API const StringHash PSP_ZONEMAX = "ZoneMax"_sh;
 
 extern URHO3D_API const Vector3 DOT_SCALE(1 / 3.0f, 1 / 3.0f, 1 / 3.0f);
 
@@ -44,7 +44,8 @@ IndexBuffer::IndexBuffer(Context* context, bool forceHeadless) :
     lockScratchData_(nullptr),
     shadowed_(false),
     dynamic_(false),
-    discardLock_(false)
+    discardLock_(false),
+    dataRevision_(0)
 {
     // Force shadowing mode if graphics subsystem does not exist
     if (!graphics_)
@@ -85,6 +86,7 @@ bool IndexBuffer::SetSize(unsigned indexCount, bool largeIndices, bool dynamic)
         shadowData_ = new unsigned char[indexCount_ * indexSize_];
     else
         shadowData_.Reset();
+    ++dataRevision_;
 
     return Create();
 }
@@ -87,6 +87,9 @@ public:
     /// Return shared array pointer to the CPU memory shadow data.
     SharedArrayPtr<unsigned char> GetShadowDataShared() const { return shadowData_; }
 
+    /// Return shadow data revision. Incremented whenever the shadow data is resized or rewritten.
+    unsigned GetDataRevision() const { return dataRevision_; }
+
 private:
     /// Create buffer.
     bool Create();
@@ -117,6 +120,8 @@ private:
     bool shadowed_;
     /// Discard lock flag. Used by OpenGL only.
     bool discardLock_;
+    /// Shadow data revision.
+    unsigned dataRevision_;
 };
 
 }
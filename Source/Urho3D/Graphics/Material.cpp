@@ -1153,6 +1153,7 @@ SharedPtr<Material> Material::Clone(const String& cloneName) const
     ret->pixelShaderDefines_ = pixelShaderDefines_;
     ret->shaderParameters_ = shaderParameters_;
     ret->shaderParameterHash_ = shaderParameterHash_;
+    ret->shaderParameterBlock_ = shaderParameterBlock_;
     ret->textures_ = textures_;
     ret->depthBias_ = depthBias_;
     ret->alphaToCoverage_ = alphaToCoverage_;
@@ -1285,11 +1286,13 @@ void Material::ResetToDefaults()
 void Material::RefreshShaderParameterHash()
 {
     VectorBuffer temp;
+    shaderParameterBlock_.Clear();
     for (HashMap<StringHash, MaterialShaderParameter>::ConstIterator i = shaderParameters_.Begin();
          i != shaderParameters_.End(); ++i)
     {
         temp.WriteStringHash(i->first_);
         temp.WriteVariant(i->second_.value_);
+        shaderParameterBlock_.AddParameter(i->first_, i->second_.value_);
     }
 
     shaderParameterHash_ = 0;
@@ -24,6 +24,7 @@
 
 #include "../Graphics/GraphicsDefs.h"
 #include "../Graphics/Light.h"
+#include "../Graphics/ShaderParameterBlock.h"
 #include "../Math/Vector4.h"
 #include "../Resource/Resource.h"
 #include "../Scene/ValueAnimationInfo.h"
@@ -255,6 +256,9 @@ public:
     /// Return shader parameter hash value. Used as an optimization to avoid setting shader parameters unnecessarily.
     unsigned GetShaderParameterHash() const { return shaderParameterHash_; }
 
+    /// Return shader parameters converted for setting them all at once.
+    const ShaderParameterBlock& GetShaderParameterBlock() const { return shaderParameterBlock_; }
+
     /// Return name for texture unit.
     static String GetTextureUnitName(TextureUnit unit);
     /// Parse a shader parameter value from a string. Retunrs either a bool, a float, or a 2 to 4-component vector.
@@ -268,7 +272,7 @@ private:
 
     /// Reset to defaults.
     void ResetToDefaults();
-    /// Recalculate shader parameter hash.
+    /// Recalculate shader parameter hash and rebuild the shader parameter block.
     void RefreshShaderParameterHash();
     /// Recalculate the memory used by the material.
     void RefreshMemoryUse();
@@ -287,6 +291,8 @@ private:
     HashMap<TextureUnit, SharedPtr<Texture> > textures_;
     /// %Shader parameters.
     HashMap<StringHash, MaterialShaderParameter> shaderParameters_;
+    /// %Shader parameters converted for setting them all at once.
+    ShaderParameterBlock shaderParameterBlock_;
     /// %Shader parameters animation infos.
     HashMap<StringHash, SharedPtr<ShaderParameterAnimationInfo> > shaderParameterAnimationInfos_;
     /// Vertex shader defines.
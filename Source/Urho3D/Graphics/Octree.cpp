@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/LinearAllocator.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
@@ -34,6 +35,10 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -45,6 +50,16 @@ namespace Urho3D
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
+/// Number of rays traversed together in batched raycasts.
+static const unsigned RAY_PACKET_SIZE = 4;
+/// Minimum number of rays per work item in batched raycasts.
+static const unsigned MIN_RAYS_PER_WORK_ITEM = 64;
+/// Relative tolerance of the packet bounding box test, which keeps it conservative compared to Ray::HitDistance.
+static const float RAY_PACKET_TOLERANCE = 0.0001f;
+/// Minimum number of drawables per work item when finding reinsertion destinations.
+static const unsigned MIN_DRAWABLES_PER_REINSERT_WORK_ITEM = 256;
+/// Maximum number of not yet created octants in a reinsertion path.
+static const unsigned MAX_REINSERT_PATH_LENGTH = 21;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
@@ -63,11 +78,180 @@ void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
     }
 }
 
+void FindReinsertionsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* octree = reinterpret_cast<Octree*>(item->aux_);
+    OctreeReinsertion* reinsertions = octree->reinsertions_;
+    auto start = (unsigned)(reinterpret_cast<OctreeReinsertion*>(item->start_) - reinsertions);
+    auto end = (unsigned)(reinterpret_cast<OctreeReinsertion*>(item->end_) - reinsertions);
+
+    octree->FindReinsertions(start, end);
+}
+
+/// Return bounding box of a child octant.
+static BoundingBox GetChildOctantBox(const BoundingBox& box, unsigned index)
+{
+    Vector3 newMin = box.min_;
+    Vector3 newMax = box.max_;
+    Vector3 oldCenter = box.Center();
+
+    if (index & 1u)
+        newMin.x_ = oldCenter.x_;
+    else
+        newMax.x_ = oldCenter.x_;
+
+    if (index & 2u)
+        newMin.y_ = oldCenter.y_;
+    else
+        newMax.y_ = oldCenter.y_;
+
+    if (index & 4u)
+        newMin.z_ = oldCenter.z_;
+    else
+        newMax.z_ = oldCenter.z_;
+
+    return BoundingBox(newMin, newMax);
+}
+
+/// Return index of the child octant a bounding box center falls into.
+static unsigned GetChildOctantIndex(const Vector3& boxCenter, const Vector3& octantCenter)
+{
+    unsigned x = boxCenter.x_ < octantCenter.x_ ? 0 : 1;
+    unsigned y = boxCenter.y_ < octantCenter.y_ ? 0 : 2;
+    unsigned z = boxCenter.z_ < octantCenter.z_ ? 0 : 4;
+    return x + y + z;
+}
+
+/// Check if a drawable object's bounding box fits an octant, given the octant's bounds and subdivision level.
+static bool CheckOctantFit(const BoundingBox& box, const BoundingBox& octantBox, const Vector3& halfSize, unsigned level,
+    unsigned numLevels)
+{
+    Vector3 boxSize = box.Size();
+
+    // If max split level, size always OK, otherwise check that box is at least half size of octant
+    if (level >= numLevels || boxSize.x_ >= halfSize.x_ || boxSize.y_ >= halfSize.y_ || boxSize.z_ >= halfSize.z_)
+        return true;
+    // Also check if the box can not fit a child octant's culling box, in that case size OK (must insert here)
+    else
+    {
+        if (box.min_.x_ <= octantBox.min_.x_ - 0.5f * halfSize.x_ ||
+            box.max_.x_ >= octantBox.max_.x_ + 0.5f * halfSize.x_ ||
+            box.min_.y_ <= octantBox.min_.y_ - 0.5f * halfSize.y_ ||
+            box.max_.y_ >= octantBox.max_.y_ + 0.5f * halfSize.y_ ||
+            box.min_.z_ <= octantBox.min_.z_ - 0.5f * halfSize.z_ ||
+            box.max_.z_ >= octantBox.max_.z_ + 0.5f * halfSize.z_)
+            return true;
+    }
+
+    // Bounding box too small, should create a child octant
+    return false;
+}
+
 inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
 }
 
+inline bool CompareRayHitCandidates(const Pair<float, Drawable*>& lhs, const Pair<float, Drawable*>& rhs)
+{
+    return lhs.first_ < rhs.first_;
+}
+
+/// Packet of rays of a batched ray query, in structure of arrays layout for testing bounding boxes against all rays at once.
+struct RayBatchPacket
+{
+    /// Construct from up to RAY_PACKET_SIZE rays. Unused lanes repeat the first ray.
+    RayBatchPacket(const RayBatchOctreeQuery& query, const Ray* rays, unsigned numRays, PODVector<Pair<float, Drawable*> >* candidates) :
+        query_(query),
+        rays_(rays),
+        candidates_(candidates)
+    {
+        for (unsigned i = 0; i < RAY_PACKET_SIZE; ++i)
+        {
+            const Ray& ray = rays[i < numRays ? i : 0];
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                float direction = ray.direction_.Data()[j];
+                origin_[j][i] = ray.origin_.Data()[j];
+                // Avoid infinities, which would produce NaNs for rays starting on a box plane
+                invDirection_[j][i] = Abs(direction) >= 1e-20f ? 1.0f / direction : (direction < 0.0f ? -1e20f : 1e20f);
+            }
+        }
+    }
+
+    /// Return mask of the rays in the input mask which may hit a bounding box within the query distance.
+    unsigned HitMask(const BoundingBox& box, unsigned rayMask) const
+    {
+#ifdef URHO3D_SSE
+        __m128 nearDistance = _mm_setzero_ps();
+        __m128 farDistance = _mm_set1_ps(query_.maxDistance_);
+        for (unsigned j = 0; j < 3; ++j)
+        {
+            __m128 origin = _mm_loadu_ps(origin_[j]);
+            __m128 invDirection = _mm_loadu_ps(invDirection_[j]);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min_.Data()[j]), origin), invDirection);
+            __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max_.Data()[j]), origin), invDirection);
+            nearDistance = _mm_max_ps(nearDistance, _mm_min_ps(t1, t2));
+            farDistance = _mm_min_ps(farDistance, _mm_max_ps(t1, t2));
+        }
+        // Widen the accepted range by the tolerance: far + (|far| + 1) * tolerance
+        __m128 absFar = _mm_andnot_ps(_mm_set1_ps(-0.0f), farDistance);
+        farDistance = _mm_add_ps(farDistance, _mm_mul_ps(_mm_add_ps(absFar, _mm_set1_ps(1.0f)), _mm_set1_ps(RAY_PACKET_TOLERANCE)));
+        return (unsigned)_mm_movemask_ps(_mm_cmple_ps(nearDistance, farDistance)) & rayMask;
+#else
+        unsigned hitMask = 0;
+        for (unsigned i = 0; i < RAY_PACKET_SIZE; ++i)
+        {
+            if (!(rayMask & (1u << i)))
+                continue;
+
+            float nearDistance = 0.0f;
+            float farDistance = query_.maxDistance_;
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                float t1 = (box.min_.Data()[j] - origin_[j][i]) * invDirection_[j][i];
+                float t2 = (box.max_.Data()[j] - origin_[j][i]) * invDirection_[j][i];
+                nearDistance = Max(nearDistance, Min(t1, t2));
+                farDistance = Min(farDistance, Max(t1, t2));
+            }
+            if (nearDistance <= farDistance + (Abs(farDistance) + 1.0f) * RAY_PACKET_TOLERANCE)
+                hitMask |= 1u << i;
+        }
+        return hitMask;
+#endif
+    }
+
+    /// Query.
+    const RayBatchOctreeQuery& query_;
+    /// Rays of the packet.
+    const Ray* rays_;
+    /// Candidate drawables and their bounding box hit distances for each ray.
+    PODVector<Pair<float, Drawable*> >* candidates_;
+    /// Ray origins per axis.
+    float origin_[3][RAY_PACKET_SIZE];
+    /// Inverse ray directions per axis.
+    float invDirection_[3][RAY_PACKET_SIZE];
+};
+
+/// Batched ray query work item data.
+struct RayBatchWorkData
+{
+    /// Octree.
+    const Octree* octree_;
+    /// Query.
+    RayBatchOctreeQuery* query_;
+};
+
+void RaycastSingleBatchWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* data = reinterpret_cast<RayBatchWorkData*>(item->aux_);
+    RayQueryResult* results = data->query_->result_.Buffer();
+    auto start = (unsigned)(reinterpret_cast<RayQueryResult*>(item->start_) - results);
+    auto end = (unsigned)(reinterpret_cast<RayQueryResult*>(item->end_) - results);
+
+    data->octree_->RaycastSingleBatch(*data->query_, start, end);
+}
+
 Octant::Octant(const BoundingBox& box, unsigned level, Octant* parent, Octree* root, unsigned index) :
     level_(level),
     parent_(parent),
@@ -101,26 +285,7 @@ Octant* Octant::GetOrCreateChild(unsigned index)
     if (children_[index])
         return children_[index];
 
-    Vector3 newMin = worldBoundingBox_.min_;
-    Vector3 newMax = worldBoundingBox_.max_;
-    Vector3 oldCenter = worldBoundingBox_.Center();
-
-    if (index & 1u)
-        newMin.x_ = oldCenter.x_;
-    else
-        newMax.x_ = oldCenter.x_;
-
-    if (index & 2u)
-        newMin.y_ = oldCenter.y_;
-    else
-        newMax.y_ = oldCenter.y_;
-
-    if (index & 4u)
-        newMin.z_ = oldCenter.z_;
-    else
-        newMax.z_ = oldCenter.z_;
-
-    children_[index] = new Octant(BoundingBox(newMin, newMax), level_ + 1, this, root_, index);
+    children_[index] = new Octant(GetChildOctantBox(worldBoundingBox_, index), level_ + 1, this, root_, index);
     return children_[index];
 }
 
@@ -155,38 +320,31 @@ void Octant::InsertDrawable(Drawable* drawable)
         }
     }
     else
-    {
-        Vector3 boxCenter = box.Center();
-        unsigned x = boxCenter.x_ < center_.x_ ? 0 : 1;
-        unsigned y = boxCenter.y_ < center_.y_ ? 0 : 2;
-        unsigned z = boxCenter.z_ < center_.z_ ? 0 : 4;
-
-        GetOrCreateChild(x + y + z)->InsertDrawable(drawable);
-    }
+        GetOrCreateChild(GetChildOctantIndex(box.Center(), center_))->InsertDrawable(drawable);
 }
 
 bool Octant::CheckDrawableFit(const BoundingBox& box) const
 {
-    Vector3 boxSize = box.Size();
+    return CheckOctantFit(box, worldBoundingBox_, halfSize_, level_, root_->GetNumLevels());
+}
 
-    // If max split level, size always OK, otherwise check that box is at least half size of octant
-    if (level_ >= root_->GetNumLevels() || boxSize.x_ >= halfSize_.x_ || boxSize.y_ >= halfSize_.y_ ||
-        boxSize.z_ >= halfSize_.z_)
-        return true;
-    // Also check if the box can not fit a child octant's culling box, in that case size OK (must insert here)
-    else
+void Octant::RemoveMovedDrawables()
+{
+    unsigned numKept = 0;
+    for (unsigned i = 0; i < drawables_.Size(); ++i)
     {
-        if (box.min_.x_ <= worldBoundingBox_.min_.x_ - 0.5f * halfSize_.x_ ||
-            box.max_.x_ >= worldBoundingBox_.max_.x_ + 0.5f * halfSize_.x_ ||
-            box.min_.y_ <= worldBoundingBox_.min_.y_ - 0.5f * halfSize_.y_ ||
-            box.max_.y_ >= worldBoundingBox_.max_.y_ + 0.5f * halfSize_.y_ ||
-            box.min_.z_ <= worldBoundingBox_.min_.z_ - 0.5f * halfSize_.z_ ||
-            box.max_.z_ >= worldBoundingBox_.max_.z_ + 0.5f * halfSize_.z_)
-            return true;
+        Drawable* drawable = drawables_[i];
+        if (drawable->GetOctant() == this)
+            drawables_[numKept++] = drawable;
     }
 
-    // Bounding box too small, should create a child octant
-    return false;
+    unsigned numRemoved = drawables_.Size() - numKept;
+    if (numRemoved)
+    {
+        drawables_.Resize(numKept);
+        // May delete this octant, so must be last
+        DecDrawableCount(numRemoved);
+    }
 }
 
 void Octant::ResetRoot()
@@ -226,6 +384,29 @@ void Octant::Initialize(const BoundingBox& box)
     cullingBox_ = BoundingBox(worldBoundingBox_.min_ - halfSize_, worldBoundingBox_.max_ + halfSize_);
 }
 
+Octant* Octant::FindExistingInsertOctant(const BoundingBox& box, bool occludee, bool& fits)
+{
+    // Same descent as InsertDrawable, but without creating child octants
+    Octant* octant = this;
+    if (this == root_)
+        fits = !occludee || cullingBox_.IsInside(box) != INSIDE || CheckDrawableFit(box);
+    else
+        fits = CheckDrawableFit(box);
+
+    Vector3 boxCenter = box.Center();
+    while (!fits)
+    {
+        Octant* child = octant->children_[GetChildOctantIndex(boxCenter, octant->center_)];
+        if (!child)
+            break;
+
+        octant = child;
+        fits = octant->CheckDrawableFit(box);
+    }
+
+    return octant;
+}
+
 void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
 {
     if (this != root_)
@@ -308,6 +489,49 @@ void Octant::GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*
     }
 }
 
+void Octant::GetDrawablesInternal(RayBatchPacket& packet, unsigned rayMask) const
+{
+    rayMask = packet.HitMask(cullingBox_, rayMask);
+    if (!rayMask)
+        return;
+
+    const RayBatchOctreeQuery& query = packet.query_;
+
+    if (drawables_.Size())
+    {
+        auto** start = const_cast<Drawable**>(&drawables_[0]);
+        Drawable** end = start + drawables_.Size();
+
+        while (start != end)
+        {
+            Drawable* drawable = *start++;
+
+            if ((drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_))
+            {
+                const BoundingBox& box = drawable->GetWorldBoundingBox();
+                unsigned hitMask = packet.HitMask(box, rayMask);
+
+                for (unsigned i = 0; hitMask; ++i, hitMask >>= 1)
+                {
+                    if (!(hitMask & 1u))
+                        continue;
+
+                    // Use the exact hit distance so that candidates are ordered as in RaycastSingle
+                    float distance = packet.rays_[i].HitDistance(box);
+                    if (distance < query.maxDistance_)
+                        packet.candidates_[i].Push(MakePair(distance, drawable));
+                }
+            }
+        }
+    }
+
+    for (auto child : children_)
+    {
+        if (child)
+            child->GetDrawablesInternal(packet, rayMask);
+    }
+}
+
 Octree::Octree(Context* context) :
     Component(context),
     Octant(BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), 0, nullptr, this),
@@ -443,25 +667,72 @@ void Octree::Update(const FrameInfo& frame)
     {
         URHO3D_PROFILE("ReinsertToOctree");
 
-        for (PODVector<Drawable*>::Iterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+        // Find the destinations first without modifying the octree, in worker threads if there are many drawables. The
+        // temporary arrays come from the frame allocator and are released when done, also when the engine is not
+        // resetting the frame allocator
+        unsigned numDrawables = drawableUpdates_.Size();
+        LinearAllocatorScope scope(GetFrameAllocator());
+        reinsertions_ = scope.GetAllocator().AllocateArray<OctreeReinsertion>(numDrawables);
+
+        auto* queue = GetSubsystem<WorkQueue>();
+        unsigned numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
+        unsigned drawablesPerItem = Max(numDrawables / numWorkItems, MIN_DRAWABLES_PER_REINSERT_WORK_ITEM);
+
+        if (numWorkItems == 1 || numDrawables <= drawablesPerItem)
+            FindReinsertions(0, numDrawables);
+        else
         {
-            Drawable* drawable = *i;
+            // Drawable update finished handlers (for example IK) may have dirtied node transforms after the threaded update.
+            // Calculate the world bounding boxes here, so that the workers only read cached data instead of updating shared
+            // node transforms concurrently
+            for (PODVector<Drawable*>::ConstIterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+                (*i)->GetWorldBoundingBox();
+
+            for (unsigned start = 0; start < numDrawables; start += drawablesPerItem)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = FindReinsertionsWork;
+                item->aux_ = this;
+                item->start_ = reinsertions_ + start;
+                item->end_ = reinsertions_ + Min(start + drawablesPerItem, numDrawables);
+                queue->AddWorkItem(item);
+            }
+
+            queue->Complete(M_MAX_UNSIGNED);
+        }
+
+        // Add the drawables to their destinations in update order. Removal from the old octants is deferred, so that no
+        // octant is deleted while the destinations refer to it, and each old octant is then compacted only once
+        auto** reinsertedFrom = scope.GetAllocator().AllocateArray<Octant*>(numDrawables);
+        unsigned numReinsertedFrom = 0;
+        for (unsigned i = 0; i < numDrawables; ++i)
+        {
+            Drawable* drawable = drawableUpdates_[i];
             drawable->updateQueued_ = false;
-            Octant* octant = drawable->GetOctant();
-            const BoundingBox& box = drawable->GetWorldBoundingBox();
+            drawable->updateFrameNumber_ = frame.frameNumber_;
 
-            // Skip if no octant or does not belong to this octree anymore
-            if (!octant || octant->GetRoot() != this)
-                continue;
-            // Skip if still fits the current octant
-            if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
+            const OctreeReinsertion& reinsertion = reinsertions_[i];
+            Octant* octant = reinsertion.octant_;
+            if (!octant)
                 continue;
 
-            InsertDrawable(drawable);
+            for (unsigned j = 0; j < reinsertion.pathLength_; ++j)
+                octant = octant->GetOrCreateChild((unsigned)(reinsertion.path_ >> (j * 3)) & 7u);
+
+            const BoundingBox& box = drawable->GetWorldBoundingBox();
+            if (reinsertion.pathLength_ == MAX_REINSERT_PATH_LENGTH)
+            {
+                Vector3 boxCenter = box.Center();
+                while (!octant->CheckDrawableFit(box))
+                    octant = octant->GetOrCreateChild(GetChildOctantIndex(boxCenter, octant->GetWorldBoundingBox().Center()));
+            }
+
+            reinsertedFrom[numReinsertedFrom++] = drawable->GetOctant();
+            octant->AddDrawable(drawable);
 
 #ifdef _DEBUG
             // Verify that the drawable will be culled correctly
-            octant = drawable->GetOctant();
             if (octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
             {
                 URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
@@ -469,11 +740,71 @@ void Octree::Update(const FrameInfo& frame)
             }
 #endif
         }
+
+        if (numReinsertedFrom)
+        {
+            // An octant with drawables still to remove can not become empty, so the pointers stay valid until processed
+            Sort(RandomAccessIterator<Octant*>(reinsertedFrom), RandomAccessIterator<Octant*>(reinsertedFrom + numReinsertedFrom));
+            for (unsigned i = 0; i < numReinsertedFrom; ++i)
+            {
+                if (!i || reinsertedFrom[i] != reinsertedFrom[i - 1])
+                    reinsertedFrom[i]->RemoveMovedDrawables();
+            }
+        }
+
+        reinsertions_ = nullptr;
     }
 
     drawableUpdates_.Clear();
 }
 
+void Octree::FindReinsertions(unsigned start, unsigned end)
+{
+    for (unsigned i = start; i < end; ++i)
+    {
+        Drawable* drawable = drawableUpdates_[i];
+        OctreeReinsertion& reinsertion = reinsertions_[i];
+        reinsertion.octant_ = nullptr;
+        reinsertion.path_ = 0;
+        reinsertion.pathLength_ = 0;
+
+        Octant* octant = drawable->GetOctant();
+        const BoundingBox& box = drawable->GetWorldBoundingBox();
+
+        // Skip if no octant or does not belong to this octree anymore
+        if (!octant || octant->GetRoot() != this)
+            continue;
+        // Skip if still fits the current octant
+        if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
+            continue;
+
+        bool fits;
+        Octant* destination = FindExistingInsertOctant(box, drawable->IsOccludee(), fits);
+
+        if (!fits)
+        {
+            // Continue the descent through octants that do not exist yet, recording the child indices
+            BoundingBox octantBox = destination->GetWorldBoundingBox();
+            unsigned level = destination->GetLevel();
+            Vector3 boxCenter = box.Center();
+
+            while (!fits && reinsertion.pathLength_ < MAX_REINSERT_PATH_LENGTH)
+            {
+                unsigned index = GetChildOctantIndex(boxCenter, octantBox.Center());
+                octantBox = GetChildOctantBox(octantBox, index);
+                ++level;
+                reinsertion.path_ |= (unsigned long long)index << (reinsertion.pathLength_ * 3);
+                ++reinsertion.pathLength_;
+                fits = CheckOctantFit(box, octantBox, 0.5f * octantBox.Size(), level, numLevels_);
+            }
+        }
+
+        // Skip if the descent ends in the current octant
+        if (destination != octant || reinsertion.pathLength_)
+            reinsertion.octant_ = destination;
+    }
+}
+
 void Octree::AddManualDrawable(Drawable* drawable)
 {
     if (!drawable || drawable->GetOctant())
@@ -547,6 +878,103 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
     }
 }
 
+void Octree::RaycastSingleBatch(RayBatchOctreeQuery& query) const
+{
+    URHO3D_PROFILE("RaycastBatch");
+
+    unsigned numRays = query.rays_.Size();
+    query.result_.Resize(numRays);
+    if (!numRays)
+        return;
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numWorkItems = queue && Thread::IsMainThread() ? queue->GetNumThreads() + 1 : 1; // Worker threads + main thread
+    // Drawables that moved since the last update have stale world bounding boxes and transforms, which testing them
+    // recalculates. Do not let several workers write the same cached data
+    if (!drawableUpdates_.Empty() || !threadedDrawableUpdates_.Empty())
+        numWorkItems = 1;
+    // Use several items per thread to balance rays of uneven cost, in whole packets
+    unsigned raysPerItem = Max(numRays / (numWorkItems * 4), MIN_RAYS_PER_WORK_ITEM);
+    raysPerItem = (raysPerItem + RAY_PACKET_SIZE - 1) / RAY_PACKET_SIZE * RAY_PACKET_SIZE;
+
+    if (numWorkItems == 1 || numRays <= raysPerItem)
+    {
+        RaycastSingleBatch(query, 0, numRays);
+        return;
+    }
+
+    RayBatchWorkData data;
+    data.octree_ = this;
+    data.query_ = &query;
+
+    // Each ray writes only its own result, so the outcome does not depend on how the batch is split
+    for (unsigned start = 0; start < numRays; start += raysPerItem)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = RaycastSingleBatchWork;
+        item->aux_ = &data;
+        item->start_ = query.result_.Buffer() + start;
+        item->end_ = query.result_.Buffer() + Min(start + raysPerItem, numRays);
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+void Octree::RaycastSingleBatch(RayBatchOctreeQuery& query, unsigned start, unsigned end) const
+{
+    PODVector<Pair<float, Drawable*> > candidates[RAY_PACKET_SIZE];
+    PODVector<RayQueryResult> results;
+
+    for (unsigned packetStart = start; packetStart < end; packetStart += RAY_PACKET_SIZE)
+    {
+        unsigned numRays = Min(end - packetStart, RAY_PACKET_SIZE);
+        for (unsigned i = 0; i < numRays; ++i)
+            candidates[i].Clear();
+
+        // Gather candidate drawables of all rays in one traversal
+        RayBatchPacket packet(query, &query.rays_[packetStart], numRays, candidates);
+        GetDrawablesInternal(packet, (1u << numRays) - 1);
+
+        for (unsigned i = 0; i < numRays; ++i)
+        {
+            // Test candidates in order of increasing hit distance to AABB and early-out, as in RaycastSingle
+            PODVector<Pair<float, Drawable*> >& rayCandidates = candidates[i];
+            Sort(rayCandidates.Begin(), rayCandidates.End(), CompareRayHitCandidates);
+
+            results.Clear();
+            RayOctreeQuery rayQuery(results, query.rays_[packetStart + i], query.level_, query.maxDistance_,
+                query.drawableFlags_, query.viewMask_);
+
+            float closestHit = M_INFINITY;
+            for (PODVector<Pair<float, Drawable*> >::ConstIterator j = rayCandidates.Begin(); j != rayCandidates.End(); ++j)
+            {
+                if (j->first_ >= Min(closestHit, query.maxDistance_))
+                    break;
+
+                unsigned oldSize = results.Size();
+                j->second_->ProcessRayQuery(rayQuery, results);
+                if (results.Size() > oldSize)
+                    closestHit = Min(closestHit, results.Back().distance_);
+            }
+
+            RayQueryResult& result = query.result_[packetStart + i];
+            if (results.Size())
+            {
+                if (results.Size() > 1)
+                    Sort(results.Begin(), results.End(), CompareRayQueryResults);
+                result = results[0];
+            }
+            else
+            {
+                result = RayQueryResult();
+                result.distance_ = M_INFINITY;
+            }
+        }
+    }
+}
+
 void Octree::QueueUpdate(Drawable* drawable)
 {
     Scene* scene = GetScene();
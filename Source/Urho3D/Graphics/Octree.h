@@ -31,6 +31,7 @@ namespace Urho3D
 {
 
 class Octree;
+struct RayBatchPacket;
 
 static const int NUM_OCTANTS = 8;
 static const unsigned ROOT_INDEX = M_MAX_UNSIGNED;
@@ -52,6 +53,8 @@ public:
     void InsertDrawable(Drawable* drawable);
     /// Check if a drawable object fits.
     bool CheckDrawableFit(const BoundingBox& box) const;
+    /// Remove drawable objects that have been added to another octant without removing them from this one. May delete this octant if it becomes empty.
+    void RemoveMovedDrawables();
 
     /// Add a drawable object to this octant.
     void AddDrawable(Drawable* drawable)
@@ -107,6 +110,10 @@ protected:
     void GetDrawablesInternal(RayOctreeQuery& query) const;
     /// Return drawable objects only for a threaded ray query, called internally.
     void GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*>& drawables) const;
+    /// Return drawable objects hit by the rays of a packet in a batched ray query, called internally.
+    void GetDrawablesInternal(RayBatchPacket& packet, unsigned rayMask) const;
+    /// Return the deepest existing octant on the way to where InsertDrawable would place a bounding box, and whether it belongs in that octant. Does not modify the octree.
+    Octant* FindExistingInsertOctant(const BoundingBox& box, bool occludee, bool& fits);
 
     /// Increase drawable object count recursively.
     void IncDrawableCount()
@@ -117,11 +124,11 @@ protected:
     }
 
     /// Decrease drawable object count recursively and remove octant if it becomes empty.
-    void DecDrawableCount()
+    void DecDrawableCount(unsigned count = 1)
     {
         Octant* parent = parent_;
 
-        --numDrawables_;
+        numDrawables_ -= count;
         if (!numDrawables_)
         {
             if (parent)
@@ -129,7 +136,7 @@ protected:
         }
 
         if (parent)
-            parent->DecDrawableCount();
+            parent->DecDrawableCount(count);
     }
 
     /// World bounding box.
@@ -156,11 +163,25 @@ protected:
     unsigned index_;
 };
 
+/// Destination of a drawable object being reinserted to the octree, found before the octree is modified.
+struct OctreeReinsertion
+{
+    /// Deepest existing octant on the way to the destination, or null if the drawable stays in its current octant.
+    Octant* octant_;
+    /// Indices of the child octants to create below the existing octant, three bits per level from the lowest bits up.
+    unsigned long long path_;
+    /// Number of child octants to create. At the maximum, the descent continues from the last one.
+    unsigned pathLength_;
+};
+
 /// %Octree component. Should be added only to the root scene node
 class URHO3D_API Octree : public Component, public Octant
 {
     URHO3D_OBJECT(Octree, Component);
 
+    friend void RaycastSingleBatchWork(const WorkItem* item, unsigned threadIndex);
+    friend void FindReinsertionsWork(const WorkItem* item, unsigned threadIndex);
+
 public:
     /// Construct.
     explicit Octree(Context* context);
@@ -187,6 +208,8 @@ public:
     void Raycast(RayOctreeQuery& query) const;
     /// Return the closest drawable object by a ray query.
     void RaycastSingle(RayOctreeQuery& query) const;
+    /// Return the closest drawable object for each ray of a batched ray query. Rays are traversed in packets and the batch is split over worker threads; results do not depend on the thread count. Runs on the calling thread only while drawables have moved since the last octree update, as testing them refreshes their world transforms. Drawables must not be modified during the call.
+    void RaycastSingleBatch(RayBatchOctreeQuery& query) const;
 
     /// Return subdivision levels.
     unsigned GetNumLevels() const { return numLevels_; }
@@ -203,11 +226,17 @@ private:
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
     /// Update octree size.
     void UpdateOctreeSize() { SetSize(worldBoundingBox_, numLevels_); }
+    /// Process a range of rays of a batched ray query.
+    void RaycastSingleBatch(RayBatchOctreeQuery& query, unsigned start, unsigned end) const;
+    /// Find reinsertion destinations for a range of the drawable objects that require update. Does not modify the octree.
+    void FindReinsertions(unsigned start, unsigned end);
 
     /// Drawable objects that require update.
     PODVector<Drawable*> drawableUpdates_;
     /// Drawable objects that were inserted during threaded update phase.
     PODVector<Drawable*> threadedDrawableUpdates_;
+    /// Reinsertion destinations of the drawable objects that require update. Allocated from the frame allocator during Update().
+    OctreeReinsertion* reinsertions_{};
     /// Mutex for octree reinsertions.
     Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
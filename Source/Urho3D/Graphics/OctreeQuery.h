@@ -266,6 +266,41 @@ private:
     PODVector<RayQueryResult> resultStorage_;
 };
 
+/// Batched raycast octree query, returning the closest hit of each ray.
+class URHO3D_API RayBatchOctreeQuery
+{
+public:
+    /// Construct with rays and query parameters.
+    RayBatchOctreeQuery(PODVector<RayQueryResult>& result, const PODVector<Ray>& rays, RayQueryLevel level = RAY_TRIANGLE,
+        float maxDistance = M_INFINITY, unsigned char drawableFlags = DRAWABLE_ANY, unsigned viewMask = DEFAULT_VIEWMASK) :
+        result_(result),
+        rays_(rays),
+        drawableFlags_(drawableFlags),
+        viewMask_(viewMask),
+        maxDistance_(maxDistance),
+        level_(level)
+    {
+    }
+
+    /// Prevent copy construction.
+    RayBatchOctreeQuery(const RayBatchOctreeQuery& rhs) = delete;
+    /// Prevent assignment.
+    RayBatchOctreeQuery& operator =(const RayBatchOctreeQuery& rhs) = delete;
+
+    /// Result vector reference. Holds one result per ray in the same order; rays without a hit have a null drawable and infinite distance.
+    PODVector<RayQueryResult>& result_;
+    /// Rays.
+    const PODVector<Ray>& rays_;
+    /// Drawable flags to include.
+    unsigned char drawableFlags_;
+    /// Drawable layers to include.
+    unsigned viewMask_;
+    /// Maximum ray distance.
+    float maxDistance_;
+    /// Raycast detail level.
+    RayQueryLevel level_;
+};
+
 class URHO3D_API AllContentOctreeQuery : public OctreeQuery
 {
 public:
@@ -793,6 +793,88 @@ bool Graphics::ResolveToTexture(Texture2D* texture)
 #endif
 }
 
+bool Graphics::CopyTexture(Texture2D* destination, Texture2D* source)
+{
+#ifndef GL_ES_VERSION_2_0
+    if (!textureCopySupport_ || !destination || !source || destination == source)
+        return false;
+    if (destination->GetWidth() != source->GetWidth() || destination->GetHeight() != source->GetHeight() ||
+        destination->GetFormat() != source->GetFormat() || source->GetMultiSample() > 1)
+        return false;
+    if (!destination->GetGPUObjectName() || !source->GetGPUObjectName())
+        return false;
+
+    URHO3D_PROFILE("CopyTexture");
+
+    // Use the resolve FBOs to not disturb the currently set rendertarget(s)
+    if (!impl_->resolveSrcFBO_)
+        impl_->resolveSrcFBO_ = CreateFramebuffer();
+    if (!impl_->resolveDestFBO_)
+        impl_->resolveDestFBO_ = CreateFramebuffer();
+
+    // Depth textures are copied through depth attachments, with the color buffers disabled for framebuffer completeness
+    bool depth = source->GetUsage() == TEXTURE_DEPTHSTENCIL;
+    int width = source->GetWidth();
+    int height = source->GetHeight();
+
+    if (!gl3Support)
+    {
+        GLenum attachment = depth ? GL_DEPTH_ATTACHMENT_EXT : GL_COLOR_ATTACHMENT0_EXT;
+        glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, impl_->resolveSrcFBO_);
+        glFramebufferTexture2DEXT(GL_READ_FRAMEBUFFER_EXT, attachment, GL_TEXTURE_2D, source->GetGPUObjectName(), 0);
+        glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, impl_->resolveDestFBO_);
+        glFramebufferTexture2DEXT(GL_DRAW_FRAMEBUFFER_EXT, attachment, GL_TEXTURE_2D, destination->GetGPUObjectName(), 0);
+        if (depth)
+        {
+            glReadBuffer(GL_NONE);
+            glDrawBuffer(GL_NONE);
+        }
+        glBlitFramebufferEXT(0, 0, width, height, 0, 0, width, height, depth ? GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT,
+            GL_NEAREST);
+        if (depth)
+        {
+            glFramebufferTexture2DEXT(GL_READ_FRAMEBUFFER_EXT, attachment, GL_TEXTURE_2D, 0, 0);
+            glFramebufferTexture2DEXT(GL_DRAW_FRAMEBUFFER_EXT, attachment, GL_TEXTURE_2D, 0, 0);
+            glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+            glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+        }
+        glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, 0);
+        glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, 0);
+    }
+    else
+    {
+        GLenum attachment = depth ? GL_DEPTH_ATTACHMENT : GL_COLOR_ATTACHMENT0;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, impl_->resolveSrcFBO_);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, attachment, GL_TEXTURE_2D, source->GetGPUObjectName(), 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, impl_->resolveDestFBO_);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, attachment, GL_TEXTURE_2D, destination->GetGPUObjectName(), 0);
+        if (depth)
+        {
+            glReadBuffer(GL_NONE);
+            glDrawBuffer(GL_NONE);
+        }
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, depth ? GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT,
+            GL_NEAREST);
+        if (depth)
+        {
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, attachment, GL_TEXTURE_2D, 0, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, attachment, GL_TEXTURE_2D, 0, 0);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+            glDrawBuffer(GL_COLOR_ATTACHMENT0);
+        }
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    }
+
+    // Restore previously bound FBO
+    BindFramebuffer(impl_->boundFBO_);
+    return true;
+#else
+    // Not supported on GLES
+    return false;
+#endif
+}
+
 bool Graphics::ResolveToTexture(TextureCube* texture)
 {
 #ifndef GL_ES_VERSION_2_0
@@ -1476,6 +1558,71 @@ void Graphics::SetShaderParameter(StringHash param, const Matrix3x4& matrix)
     }
 }
 
+void Graphics::SetShaderParameters(const ShaderParameterBlock& block)
+{
+    if (!impl_->shaderProgram_)
+        return;
+
+    const PODVector<ShaderParameterBlockEntry>& entries = block.GetEntries();
+    const ShaderParameter* const* infos = impl_->shaderProgram_->GetBlockParameters(block);
+    for (unsigned i = 0; i < entries.Size(); ++i)
+    {
+        const ShaderParameter* info = infos[i];
+        if (!info)
+            continue;
+
+        const ShaderParameterBlockEntry& entry = entries[i];
+        const float* data = block.GetData(entry);
+        if (info->bufferPtr_)
+        {
+            ConstantBuffer* buffer = info->bufferPtr_;
+            if (!buffer->IsDirty())
+                impl_->dirtyConstantBuffers_.Push(buffer);
+            buffer->SetParameter(info->offset_, (unsigned)(entry.size_ * sizeof(float)), data);
+            continue;
+        }
+
+        // Check the uniform type to avoid mismatch. Single values may set a uniform with fewer components
+        switch (info->glType_)
+        {
+        case GL_FLOAT:
+            glUniform1fv(info->location_, entry.array_ ? entry.size_ : 1, data);
+            break;
+
+        case GL_FLOAT_VEC2:
+            if (entry.size_ >= 2)
+                glUniform2fv(info->location_, entry.array_ ? entry.size_ / 2 : 1, data);
+            break;
+
+        case GL_FLOAT_VEC3:
+            if (entry.size_ >= 3)
+                glUniform3fv(info->location_, entry.array_ ? entry.size_ / 3 : 1, data);
+            break;
+
+        case GL_FLOAT_VEC4:
+            if (entry.size_ >= 4)
+                glUniform4fv(info->location_, entry.array_ ? entry.size_ / 4 : 1, data);
+            break;
+
+        case GL_FLOAT_MAT3:
+            if (entry.array_ && entry.size_ >= 9)
+                glUniformMatrix3fv(info->location_, entry.size_ / 9, GL_FALSE, data);
+            break;
+
+        case GL_FLOAT_MAT4:
+            if (entry.size_ >= 16)
+                glUniformMatrix4fv(info->location_, entry.array_ ? entry.size_ / 16 : 1, GL_FALSE, data);
+            break;
+
+        default: break;
+        }
+    }
+
+    const Vector<Pair<StringHash, Variant> >& variants = block.GetVariantParameters();
+    for (unsigned i = 0; i < variants.Size(); ++i)
+        SetShaderParameter(variants[i].first_, variants[i].second_);
+}
+
 bool Graphics::NeedParameterUpdate(ShaderParameterGroup group, const void* source)
 {
     return impl_->shaderProgram_ ? impl_->shaderProgram_->NeedParameterUpdate(group, source) : false;
@@ -2100,6 +2247,16 @@ unsigned Graphics::GetFormat(CompressedFormat format) const
     case CF_DXT5:
         return dxtTextureSupport_ ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
 #endif
+#ifndef GL_ES_VERSION_2_0
+    case CF_BC4:
+        return rgtcTextureSupport_ ? GL_COMPRESSED_RED_RGTC1 : 0;
+
+    case CF_BC5:
+        return rgtcTextureSupport_ ? GL_COMPRESSED_RG_RGTC2 : 0;
+
+    case CF_BC7:
+        return bptcTextureSupport_ ? GL_COMPRESSED_RGBA_BPTC_UNORM : 0;
+#endif
 #ifdef GL_ES_VERSION_2_0
     case CF_ETC1:
         return etcTextureSupport_ ? GL_ETC1_RGB8_OES : 0;
@@ -2780,9 +2937,12 @@ void Graphics::CheckFeatureSupport()
         // Work around GLEW failure to check extensions properly from a GL3 context
         instancingSupport_ = glDrawElementsInstanced != nullptr && glVertexAttribDivisor != nullptr;
         dxtTextureSupport_ = true;
+        rgtcTextureSupport_ = true;
+        bptcTextureSupport_ = GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
         anisotropySupport_ = true;
         sRGBSupport_ = true;
         sRGBWriteSupport_ = true;
+        textureCopySupport_ = true;
 
         glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, &numSupportedRTs);
     }
@@ -2790,9 +2950,12 @@ void Graphics::CheckFeatureSupport()
     {
         instancingSupport_ = GLEW_ARB_instanced_arrays != 0;
         dxtTextureSupport_ = GLEW_EXT_texture_compression_s3tc != 0;
+        rgtcTextureSupport_ = GLEW_ARB_texture_compression_rgtc != 0;
+        bptcTextureSupport_ = GLEW_ARB_texture_compression_bptc != 0;
         anisotropySupport_ = GLEW_EXT_texture_filter_anisotropic != 0;
         sRGBSupport_ = GLEW_EXT_texture_sRGB != 0;
         sRGBWriteSupport_ = GLEW_EXT_framebuffer_sRGB != 0;
+        textureCopySupport_ = GLEW_EXT_framebuffer_blit != 0;
 
         glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS_EXT, &numSupportedRTs);
     }
@@ -88,6 +88,7 @@ bool IndexBuffer::SetData(const void* data)
 
     if (shadowData_ && data != shadowData_.Get())
         memcpy(shadowData_.Get(), data, indexCount_ * (size_t)indexSize_);
+    ++dataRevision_;
 
     if (object_.name_)
     {
@@ -135,6 +136,7 @@ bool IndexBuffer::SetDataRange(const void* data, unsigned start, unsigned count,
 
     if (shadowData_ && shadowData_.Get() + start * indexSize_ != data)
         memcpy(shadowData_.Get() + start * indexSize_, data, count * (size_t)indexSize_);
+    ++dataRevision_;
 
     if (object_.name_)
     {
@@ -100,6 +100,7 @@ void ShaderProgram::Release()
         object_.name_ = 0;
         linkerOutput_.Clear();
         shaderParameters_.Clear();
+        blockParameters_.Clear();
         vertexAttributes_.Clear();
         usedVertexAttributes_ = 0;
 
@@ -341,6 +342,11 @@ const ShaderParameter* ShaderProgram::GetParameter(StringHash param) const
         return nullptr;
 }
 
+const ShaderParameter* const* ShaderProgram::GetBlockParameters(const ShaderParameterBlock& block)
+{
+    return blockParameters_.Get(block, [this](StringHash param) { return GetParameter(param); });
+}
+
 bool ShaderProgram::NeedParameterUpdate(ShaderParameterGroup group, const void* source)
 {
     // If global framenumber has changed, invalidate all per-program parameter sources now
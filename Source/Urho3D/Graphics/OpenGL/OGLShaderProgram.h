@@ -26,6 +26,7 @@
 #include "../../Container/RefCounted.h"
 #include "../../Graphics/GPUObject.h"
 #include "../../Graphics/GraphicsDefs.h"
+#include "../../Graphics/ShaderParameterBlock.h"
 #include "../../Graphics/ShaderVariation.h"
 
 namespace Urho3D
@@ -63,6 +64,8 @@ public:
 
     /// Return the info for a shader parameter, or null if does not exist.
     const ShaderParameter* GetParameter(StringHash param) const;
+    /// Return the info for the parameters of a shader parameter block, null for parameters that do not exist.
+    const ShaderParameter* const* GetBlockParameters(const ShaderParameterBlock& block);
 
     /// Return linker output.
     const String& GetLinkerOutput() const { return linkerOutput_; }
@@ -93,6 +96,8 @@ private:
     WeakPtr<ShaderVariation> pixelShader_;
     /// Shader parameters.
     HashMap<StringHash, ShaderParameter> shaderParameters_;
+    /// Shader parameters of shader parameter block layouts.
+    ShaderParameterBlockBindings blockParameters_;
     /// Texture unit use.
     bool useTextureUnits_[MAX_TEXTURE_UNITS]{};
     /// Vertex attributes.
@@ -180,6 +180,10 @@ bool Texture::GetParametersDirty() const
 
 bool Texture::IsCompressed() const
 {
+#ifndef GL_ES_VERSION_2_0
+    if (format_ == GL_COMPRESSED_RED_RGTC1 || format_ == GL_COMPRESSED_RG_RGTC2 || format_ == GL_COMPRESSED_RGBA_BPTC_UNORM)
+        return true;
+#endif
     return format_ == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT || format_ == GL_COMPRESSED_RGBA_S3TC_DXT3_EXT ||
            format_ == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT || format_ == GL_ETC1_RGB8_OES ||
            format_ == COMPRESSED_RGB_PVRTC_4BPPV1_IMG || format_ == COMPRESSED_RGBA_PVRTC_4BPPV1_IMG ||
@@ -223,6 +227,13 @@ unsigned Texture::GetRowDataSize(int width) const
 
     case GL_RGBA32F_ARB:
         return (unsigned)(width * 16);
+
+    case GL_COMPRESSED_RED_RGTC1:
+        return ((unsigned)(width + 3) >> 2u) * 8;
+
+    case GL_COMPRESSED_RG_RGTC2:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        return ((unsigned)(width + 3) >> 2u) * 16;
 #endif
 
     case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
@@ -319,6 +330,8 @@ unsigned Texture::GetSRGBFormat(unsigned format)
         return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
     case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
         return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
     default:
         return format;
     }
@@ -91,6 +91,7 @@ bool VertexBuffer::SetData(const void* data)
 
     if (shadowData_ && data != shadowData_.Get())
         memcpy(shadowData_.Get(), data, vertexCount_ * (size_t)vertexSize_);
+    ++dataRevision_;
 
     if (object_.name_)
     {
@@ -138,6 +139,7 @@ bool VertexBuffer::SetDataRange(const void* data, unsigned start, unsigned count
 
     if (shadowData_ && shadowData_.Get() + start * vertexSize_ != data)
         memcpy(shadowData_.Get() + start * vertexSize_, data, count * (size_t)vertexSize_);
+    ++dataRevision_;
 
     if (object_.name_)
     {
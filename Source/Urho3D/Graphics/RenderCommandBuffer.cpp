@@ -0,0 +1,433 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Graphics/Batch.h"
+#include "../Graphics/Camera.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/RenderCommandBuffer.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/VertexBuffer.h"
+#include "../Graphics/View.h"
+#include "../Graphics/Zone.h"
+#include "../Scene/Node.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+void RenderCommandBuffer::Reset(Camera* camera, bool usingLightOptimization)
+{
+    data_.Clear();
+    blockIndices_.Clear();
+    numBlocks_ = 0;
+    camera_ = camera;
+    usingLightOptimization_ = usingLightOptimization;
+
+    // The scissor test is disabled when execution begins, while the stencil reference is unknown
+    vertexShader_ = nullptr;
+    pixelShader_ = nullptr;
+    hasRenderState_ = false;
+    stencilRef_ = -1;
+    scissorLight_ = nullptr;
+    hasCameraParameters_ = false;
+    worldTransform_ = nullptr;
+    for (auto& source : parameterSources_)
+        source = nullptr;
+    for (bool& hasTexture : hasTextures_)
+        hasTexture = false;
+}
+
+void RenderCommandBuffer::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
+{
+    if (vs == vertexShader_ && ps == pixelShader_)
+        return;
+
+    RenderShadersCommand command{vs, ps};
+    Write(RCMD_SHADERS, command);
+    vertexShader_ = vs;
+    pixelShader_ = ps;
+
+    // Shader parameter sources and texture unit use depend on the shaders, so must record them again
+    hasCameraParameters_ = false;
+    worldTransform_ = nullptr;
+    for (auto& source : parameterSources_)
+        source = nullptr;
+    for (bool& hasTexture : hasTextures_)
+        hasTexture = false;
+}
+
+void RenderCommandBuffer::SetRenderState(const RenderStateCommand& state)
+{
+    if (hasRenderState_ && state == renderState_)
+        return;
+
+    Write(RCMD_RENDERSTATE, state);
+    renderState_ = state;
+    hasRenderState_ = true;
+    // Zone parameters depend on the blend mode
+    parameterSources_[RCMD_ZONE] = nullptr;
+}
+
+void RenderCommandBuffer::SetStencilRef(unsigned char lightMask)
+{
+    if (stencilRef_ == lightMask)
+        return;
+
+    Write(RCMD_STENCILREF, lightMask);
+    stencilRef_ = lightMask;
+}
+
+void RenderCommandBuffer::SetLightScissor(Light* light)
+{
+    if (usingLightOptimization_ || light == scissorLight_)
+        return;
+
+    Write(RCMD_LIGHTSCISSOR, light);
+    scissorLight_ = light;
+}
+
+void RenderCommandBuffer::SetCameraParameters()
+{
+    if (hasCameraParameters_)
+        return;
+
+    Write(RCMD_CAMERA);
+    hasCameraParameters_ = true;
+}
+
+void RenderCommandBuffer::SetModelParameters(const Matrix3x4* worldTransform, unsigned numWorldTransforms, GeometryType geometryType)
+{
+    if (worldTransform == worldTransform_)
+        return;
+
+    RenderModelCommand command{worldTransform, numWorldTransforms, geometryType};
+    Write(RCMD_MODEL, command);
+    worldTransform_ = worldTransform;
+}
+
+ShaderParameterBlock* RenderCommandBuffer::SetZoneParameters(Zone* zone)
+{
+    return SetParameterBlock(RCMD_ZONE, zone);
+}
+
+ShaderParameterBlock* RenderCommandBuffer::SetLightParameters(LightBatchQueue* lightQueue)
+{
+    return SetParameterBlock(RCMD_LIGHT, lightQueue);
+}
+
+ShaderParameterBlock* RenderCommandBuffer::SetVertexLightParameters(LightBatchQueue* lightQueue)
+{
+    return SetParameterBlock(RCMD_VERTEXLIGHTS, lightQueue);
+}
+
+void RenderCommandBuffer::SetMaterialParameters(Material* material)
+{
+    if (material == parameterSources_[RCMD_MATERIAL])
+        return;
+
+    Write(RCMD_MATERIAL, material);
+    parameterSources_[RCMD_MATERIAL] = material;
+}
+
+void RenderCommandBuffer::SetTexture(TextureUnit unit, Texture* texture)
+{
+    if (hasTextures_[unit] && textures_[unit] == texture)
+        return;
+
+    RenderTextureCommand command{unit, texture};
+    Write(RCMD_TEXTURE, command);
+    textures_[unit] = texture;
+    hasTextures_[unit] = true;
+}
+
+void RenderCommandBuffer::Draw(Geometry* geometry)
+{
+    Write(RCMD_DRAW, geometry);
+}
+
+void RenderCommandBuffer::DrawInstances(Geometry* geometry, const InstanceData* instances, unsigned numInstances,
+    unsigned startIndex, VertexBuffer* instanceBuffer)
+{
+    RenderInstancesCommand command{geometry, instances, numInstances, startIndex, instanceBuffer};
+    Write(instanceBuffer ? RCMD_DRAWINSTANCED : RCMD_DRAWINSTANCES, command);
+    // Drawing one by one sets the model transforms
+    if (!instanceBuffer)
+        worldTransform_ = nullptr;
+}
+
+ShaderParameterBlock* RenderCommandBuffer::SetParameterBlock(RecordedCommandType type, void* source)
+{
+    if (source == parameterSources_[type])
+        return nullptr;
+
+    parameterSources_[type] = source;
+
+    ShaderParameterBlock* newBlock = nullptr;
+    HashMap<void*, unsigned>::Iterator i = blockIndices_.Find(source);
+    if (i == blockIndices_.End())
+    {
+        if (numBlocks_ == blocks_.Size())
+            blocks_.Resize(numBlocks_ + 1);
+        newBlock = &blocks_[numBlocks_];
+        newBlock->Clear();
+        i = blockIndices_.Insert(MakePair(source, numBlocks_++));
+    }
+
+    RenderParameterCommand command{source, i->second_};
+    Write(type, command);
+    return newBlock;
+}
+
+/// Read a command's data and advance the read position.
+template <class T> static void ReadCommand(const unsigned char*& data, T& command)
+{
+    memcpy(&command, data, sizeof(T));
+    data += sizeof(T);
+}
+
+void RenderCommandBuffer::Execute(View* view, bool markToStencil, bool allowDepthWrite) const
+{
+    Graphics* graphics = view->GetGraphics();
+    Renderer* renderer = view->GetRenderer();
+
+    // If View has set up its own light optimizations, do not disturb the stencil/scissor test settings
+    if (!usingLightOptimization_)
+    {
+        graphics->SetScissorTest(false);
+
+        // During G-buffer rendering, mark opaque pixels' lightmask to stencil buffer if requested
+        if (!markToStencil)
+            graphics->SetStencilTest(false);
+    }
+
+    const unsigned char* data = data_.Buffer();
+    const unsigned char* end = data + data_.Size();
+    while (data < end)
+    {
+        auto type = (RecordedCommandType)*data++;
+        switch (type)
+        {
+        case RCMD_SHADERS:
+            {
+                RenderShadersCommand command;
+                ReadCommand(data, command);
+                graphics->SetShaders(command.vertexShader_, command.pixelShader_);
+            }
+            break;
+
+        case RCMD_RENDERSTATE:
+            {
+                RenderStateCommand command;
+                ReadCommand(data, command);
+                graphics->SetBlendMode(command.blendMode_, command.alphaToCoverage_);
+                graphics->SetLineAntiAlias(command.lineAntiAlias_);
+                graphics->SetCullMode(command.cullMode_);
+                if (command.setDepthBias_)
+                    graphics->SetDepthBias(command.constantBias_, command.slopeScaledBias_);
+                graphics->SetFillMode(command.fillMode_);
+                graphics->SetDepthTest(command.depthTest_);
+                graphics->SetDepthWrite(command.depthWrite_ && allowDepthWrite);
+            }
+            break;
+
+        case RCMD_STENCILREF:
+            {
+                unsigned char lightMask;
+                ReadCommand(data, lightMask);
+                if (markToStencil)
+                    graphics->SetStencilTest(true, CMP_ALWAYS, OP_REF, OP_KEEP, OP_KEEP, lightMask);
+            }
+            break;
+
+        case RCMD_LIGHTSCISSOR:
+            {
+                Light* light;
+                ReadCommand(data, light);
+                if (light)
+                    renderer->OptimizeLightByScissor(light, camera_);
+                else
+                    graphics->SetScissorTest(false);
+            }
+            break;
+
+        case RCMD_CAMERA:
+            {
+                // Set global (per-frame) shader parameters
+                if (graphics->NeedParameterUpdate(SP_FRAME, nullptr))
+                    view->SetGlobalShaderParameters();
+
+                // Set camera & viewport shader parameters
+                auto cameraHash = (unsigned)(size_t)camera_;
+                IntRect viewport = graphics->GetViewport();
+                IntVector2 viewSize = IntVector2(viewport.Width(), viewport.Height());
+                auto viewportHash = (unsigned)viewSize.x_ | (unsigned)viewSize.y_ << 16u;
+                if (graphics->NeedParameterUpdate(SP_CAMERA, reinterpret_cast<const void*>(cameraHash + viewportHash)))
+                {
+                    view->SetCameraShaderParameters(camera_);
+                    // During renderpath commands the G-Buffer or viewport texture is assumed to always be viewport-sized
+                    view->SetGBufferShaderParameters(viewSize, IntRect(0, 0, viewSize.x_, viewSize.y_));
+                }
+            }
+            break;
+
+        case RCMD_MODEL:
+            {
+                RenderModelCommand command;
+                ReadCommand(data, command);
+                if (graphics->NeedParameterUpdate(SP_OBJECT, command.worldTransform_))
+                {
+                    if (command.geometryType_ == GEOM_SKINNED)
+                    {
+                        graphics->SetShaderParameter(VSP_SKINMATRICES, reinterpret_cast<const float*>(command.worldTransform_),
+                            12 * command.numWorldTransforms_);
+                    }
+                    else
+                        graphics->SetShaderParameter(VSP_MODEL, *command.worldTransform_);
+
+                    // Set the orientation for billboards, either from the object itself or from the camera
+                    if (command.geometryType_ == GEOM_BILLBOARD)
+                    {
+                        if (command.numWorldTransforms_ > 1)
+                            graphics->SetShaderParameter(VSP_BILLBOARDROT, command.worldTransform_[1].RotationMatrix());
+                        else
+                            graphics->SetShaderParameter(VSP_BILLBOARDROT, camera_->GetNode()->GetWorldRotation().RotationMatrix());
+                    }
+                }
+            }
+            break;
+
+        case RCMD_ZONE:
+            {
+                RenderParameterCommand command;
+                ReadCommand(data, command);
+                auto* zone = static_cast<Zone*>(command.source_);
+
+                // If the pass is additive, override fog color to black so that shaders do not need a separate additive path
+                BlendMode blend = graphics->GetBlendMode();
+                bool overrideFogColorToBlack = blend == BLEND_ADD || blend == BLEND_ADDALPHA;
+                auto zoneHash = (unsigned)(size_t)zone;
+                if (overrideFogColorToBlack)
+                    zoneHash += 0x80000000;
+                if (graphics->NeedParameterUpdate(SP_ZONE, reinterpret_cast<const void*>(zoneHash)))
+                {
+                    graphics->SetShaderParameters(blocks_[command.block_]);
+                    graphics->SetShaderParameter(PSP_FOGCOLOR, overrideFogColorToBlack ? Color::BLACK : zone->GetFogColor());
+                }
+            }
+            break;
+
+        case RCMD_LIGHT:
+            {
+                RenderParameterCommand command;
+                ReadCommand(data, command);
+                if (graphics->NeedParameterUpdate(SP_LIGHT, command.source_))
+                    graphics->SetShaderParameters(blocks_[command.block_]);
+            }
+            break;
+
+        case RCMD_VERTEXLIGHTS:
+            {
+                RenderParameterCommand command;
+                ReadCommand(data, command);
+                if (graphics->HasShaderParameter(VSP_VERTEXLIGHTS) && graphics->NeedParameterUpdate(SP_LIGHT, command.source_))
+                    graphics->SetShaderParameters(blocks_[command.block_]);
+            }
+            break;
+
+        case RCMD_MATERIAL:
+            {
+                Material* material;
+                ReadCommand(data, material);
+                if (graphics->NeedParameterUpdate(SP_MATERIAL, reinterpret_cast<const void*>(material->GetShaderParameterHash())))
+                    graphics->SetShaderParameters(material->GetShaderParameterBlock());
+            }
+            break;
+
+        case RCMD_TEXTURE:
+            {
+                RenderTextureCommand command;
+                ReadCommand(data, command);
+                if (graphics->HasTextureUnit(command.unit_))
+                    graphics->SetTexture(command.unit_, command.texture_);
+            }
+            break;
+
+        case RCMD_DRAW:
+            {
+                Geometry* geometry;
+                ReadCommand(data, geometry);
+                geometry->Draw(graphics);
+            }
+            break;
+
+        case RCMD_DRAWINSTANCED:
+            {
+                RenderInstancesCommand command;
+                ReadCommand(data, command);
+                Geometry* geometry = command.geometry_;
+
+                // Get the geometry vertex buffers, then add the instancing stream buffer
+                // Hack: use a const_cast to avoid dynamic allocation of new temp vectors
+                auto& vertexBuffers = const_cast<Vector<SharedPtr<VertexBuffer> >&>(geometry->GetVertexBuffers());
+                vertexBuffers.Push(SharedPtr<VertexBuffer>(command.instanceBuffer_));
+
+                graphics->SetIndexBuffer(geometry->GetIndexBuffer());
+                graphics->SetVertexBuffers(vertexBuffers, command.startIndex_);
+                graphics->DrawInstanced(geometry->GetPrimitiveType(), geometry->GetIndexStart(), geometry->GetIndexCount(),
+                    geometry->GetVertexStart(), geometry->GetVertexCount(), command.numInstances_);
+
+                // Remove the instancing buffer & element mask now
+                vertexBuffers.Pop();
+            }
+            break;
+
+        case RCMD_DRAWINSTANCES:
+            {
+                RenderInstancesCommand command;
+                ReadCommand(data, command);
+                Geometry* geometry = command.geometry_;
+
+                graphics->SetIndexBuffer(geometry->GetIndexBuffer());
+                graphics->SetVertexBuffers(geometry->GetVertexBuffers());
+
+                for (unsigned i = 0; i < command.numInstances_; ++i)
+                {
+                    const InstanceData& instance = command.instances_[i];
+                    if (graphics->NeedParameterUpdate(SP_OBJECT, instance.worldTransform_))
+                        graphics->SetShaderParameter(VSP_MODEL, *instance.worldTransform_);
+
+                    graphics->Draw(geometry->GetPrimitiveType(), geometry->GetIndexStart(), geometry->GetIndexCount(),
+                        geometry->GetVertexStart(), geometry->GetVertexCount());
+                }
+            }
+            break;
+        }
+    }
+}
+
+}
@@ -0,0 +1,254 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Graphics/GraphicsDefs.h"
+#include "../Graphics/ShaderParameterBlock.h"
+
+namespace Urho3D
+{
+
+class Camera;
+class Geometry;
+class Light;
+class Material;
+class Matrix3x4;
+class ShaderVariation;
+class Texture;
+class VertexBuffer;
+class View;
+class Zone;
+struct InstanceData;
+struct LightBatchQueue;
+
+/// Render command type.
+enum RecordedCommandType
+{
+    RCMD_SHADERS = 0,
+    RCMD_RENDERSTATE,
+    RCMD_STENCILREF,
+    RCMD_LIGHTSCISSOR,
+    RCMD_CAMERA,
+    RCMD_MODEL,
+    RCMD_ZONE,
+    RCMD_LIGHT,
+    RCMD_VERTEXLIGHTS,
+    RCMD_MATERIAL,
+    RCMD_TEXTURE,
+    RCMD_DRAW,
+    RCMD_DRAWINSTANCED,
+    RCMD_DRAWINSTANCES
+};
+
+/// Shaders render command.
+struct RenderShadersCommand
+{
+    /// Vertex shader.
+    ShaderVariation* vertexShader_;
+    /// Pixel shader.
+    ShaderVariation* pixelShader_;
+};
+
+/// Render states set by a render command. Mirrors what Batch sets from its pass and material.
+struct RenderStateCommand
+{
+    /// Test for equality with another render state.
+    bool operator ==(const RenderStateCommand& rhs) const
+    {
+        return blendMode_ == rhs.blendMode_ && cullMode_ == rhs.cullMode_ && fillMode_ == rhs.fillMode_ &&
+            depthTest_ == rhs.depthTest_ && constantBias_ == rhs.constantBias_ && slopeScaledBias_ == rhs.slopeScaledBias_ &&
+            alphaToCoverage_ == rhs.alphaToCoverage_ && lineAntiAlias_ == rhs.lineAntiAlias_ && depthWrite_ == rhs.depthWrite_ &&
+            setDepthBias_ == rhs.setDepthBias_;
+    }
+
+    /// Test for inequality with another render state.
+    bool operator !=(const RenderStateCommand& rhs) const { return !(*this == rhs); }
+
+    /// Blend mode.
+    BlendMode blendMode_;
+    /// Cull mode, already reversed if the camera requires.
+    CullMode cullMode_;
+    /// Fill mode.
+    FillMode fillMode_;
+    /// Depth test mode.
+    CompareMode depthTest_;
+    /// Constant depth bias.
+    float constantBias_;
+    /// Slope scaled depth bias.
+    float slopeScaledBias_;
+    /// Alpha-to-coverage flag.
+    bool alphaToCoverage_;
+    /// Line antialiasing flag.
+    bool lineAntiAlias_;
+    /// Depth write flag. Combined with whether depth write is allowed when executing.
+    bool depthWrite_;
+    /// Whether to set the depth bias. Shadow passes leave the bias set by the view.
+    bool setDepthBias_;
+};
+
+/// Model transform render command.
+struct RenderModelCommand
+{
+    /// World transforms.
+    const Matrix3x4* worldTransform_;
+    /// Number of world transforms.
+    unsigned numWorldTransforms_;
+    /// Geometry type.
+    GeometryType geometryType_;
+};
+
+/// Parameter block render command for a zone, light or vertex lights.
+struct RenderParameterCommand
+{
+    /// Parameter source, which is a zone or a light batch queue.
+    void* source_;
+    /// Index of the parameter block in the command buffer.
+    unsigned block_;
+};
+
+/// Texture render command.
+struct RenderTextureCommand
+{
+    /// Texture unit.
+    TextureUnit unit_;
+    /// Texture, may be null.
+    Texture* texture_;
+};
+
+/// Instanced draw render command.
+struct RenderInstancesCommand
+{
+    /// Geometry.
+    Geometry* geometry_;
+    /// Instances.
+    const InstanceData* instances_;
+    /// Number of instances.
+    unsigned numInstances_;
+    /// Start index in the instancing buffer.
+    unsigned startIndex_;
+    /// Instancing buffer, or null to draw the instances one by one.
+    VertexBuffer* instanceBuffer_;
+};
+
+/// Compact stream of draw, state and shader parameter commands recorded from a batch queue without touching the graphics context, and executed later on the main thread. Recording does not depend on other command buffers, so several may be recorded in parallel.
+class URHO3D_API RenderCommandBuffer
+{
+public:
+    /// Remove all commands and begin recording for a camera. When using light optimization, scissor and stencil state are left to the caller.
+    void Reset(Camera* camera, bool usingLightOptimization);
+
+    /// Record setting shaders. Filtered if unchanged.
+    void SetShaders(ShaderVariation* vs, ShaderVariation* ps);
+    /// Record setting render states. Filtered if unchanged.
+    void SetRenderState(const RenderStateCommand& state);
+    /// Record setting the stencil reference value used when marking lights to stencil. Filtered if unchanged.
+    void SetStencilRef(unsigned char lightMask);
+    /// Record setting the scissor test for a light, or disabling it if null. Filtered if unchanged. Ignored when using light optimization.
+    void SetLightScissor(Light* light);
+    /// Record setting global and camera shader parameters. Filtered if shaders are unchanged.
+    void SetCameraParameters();
+    /// Record setting model transform shader parameters. Filtered if unchanged.
+    void SetModelParameters(const Matrix3x4* worldTransform, unsigned numWorldTransforms, GeometryType geometryType);
+    /// Record setting zone shader parameters. Return the block to fill if it does not exist yet, null otherwise.
+    ShaderParameterBlock* SetZoneParameters(Zone* zone);
+    /// Record setting per-pixel light shader parameters. Return the block to fill if it does not exist yet, null otherwise.
+    ShaderParameterBlock* SetLightParameters(LightBatchQueue* lightQueue);
+    /// Record setting vertex light shader parameters. Return the block to fill if it does not exist yet, null otherwise.
+    ShaderParameterBlock* SetVertexLightParameters(LightBatchQueue* lightQueue);
+    /// Record setting material shader parameters. Filtered if unchanged.
+    void SetMaterialParameters(Material* material);
+    /// Record setting a texture if the shaders use the unit. Filtered if unchanged.
+    void SetTexture(TextureUnit unit, Texture* texture);
+    /// Record drawing a geometry.
+    void Draw(Geometry* geometry);
+    /// Record drawing instances of a geometry, either from the instancing buffer or one by one.
+    void DrawInstances(Geometry* geometry, const InstanceData* instances, unsigned numInstances, unsigned startIndex,
+        VertexBuffer* instanceBuffer);
+
+    /// Execute the commands. Must be called from the main thread with the render targets and viewport set.
+    void Execute(View* view, bool markToStencil, bool allowDepthWrite) const;
+
+    /// Return the camera recorded for.
+    Camera* GetCamera() const { return camera_; }
+
+    /// Return size of the encoded commands in bytes.
+    unsigned GetSize() const { return data_.Size(); }
+
+    /// Return whether has no commands.
+    bool IsEmpty() const { return data_.Empty(); }
+
+private:
+    /// Append a command.
+    template <class T> void Write(RecordedCommandType type, const T& command)
+    {
+        unsigned offset = data_.Size();
+        data_.Resize(offset + 1 + sizeof(T));
+        data_[offset] = (unsigned char)type;
+        memcpy(&data_[offset + 1], &command, sizeof(T));
+    }
+
+    /// Append a command without data.
+    void Write(RecordedCommandType type) { data_.Push((unsigned char)type); }
+
+    /// Record a parameter block command and return the block to fill if it is new.
+    ShaderParameterBlock* SetParameterBlock(RecordedCommandType type, void* source);
+
+    /// Encoded commands.
+    PODVector<unsigned char> data_;
+    /// Parameter blocks of zones and lights. Blocks beyond the used count are kept for reuse.
+    Vector<ShaderParameterBlock> blocks_;
+    /// Block indices by source.
+    HashMap<void*, unsigned> blockIndices_;
+    /// Number of used parameter blocks.
+    unsigned numBlocks_{};
+    /// Camera.
+    Camera* camera_{};
+    /// Whether scissor and stencil state are left to the caller.
+    bool usingLightOptimization_{};
+    /// Last recorded vertex shader.
+    ShaderVariation* vertexShader_{};
+    /// Last recorded pixel shader.
+    ShaderVariation* pixelShader_{};
+    /// Last recorded render state.
+    RenderStateCommand renderState_{};
+    /// Whether a render state has been recorded.
+    bool hasRenderState_{};
+    /// Last recorded stencil reference value, or -1 if none.
+    int stencilRef_{};
+    /// Last recorded scissor light.
+    Light* scissorLight_{};
+    /// Whether camera parameters have been recorded since the shaders changed.
+    bool hasCameraParameters_{};
+    /// Last recorded model transforms since the shaders changed.
+    const Matrix3x4* worldTransform_{};
+    /// Last recorded parameter sources by type since the shaders or render state changed.
+    const void* parameterSources_[RCMD_MATERIAL + 1]{};
+    /// Last recorded textures since the shaders changed.
+    Texture* textures_[MAX_TEXTURE_UNITS]{};
+    /// Whether textures have been recorded for the units since the shaders changed.
+    bool hasTextures_[MAX_TEXTURE_UNITS]{};
+};
+
+}
@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/CoreEvents.h"
+#include "../Core/MemoryStats.h"
 #include "../Core/Profiler.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DebugRenderer.h"
@@ -443,6 +444,13 @@ void Renderer::SetReuseShadowMaps(bool enable)
     reuseShadowMaps_ = enable;
 }
 
+void Renderer::SetShadowMapCaching(bool enable)
+{
+    shadowMapCaching_ = enable;
+    if (!enable)
+        cachedShadowMaps_.Clear();
+}
+
 void Renderer::SetMaxShadowMaps(int shadowMaps)
 {
     if (shadowMaps < 1)
@@ -647,6 +655,7 @@ unsigned Renderer::GetNumOccluders(bool allViews) const
 void Renderer::Update(float timeStep)
 {
     URHO3D_PROFILE("UpdateViews");
+    URHO3D_MEMORY_TAG(MEMTAG_GRAPHICS);
 
     views_.Clear();
     preparedViews_.Clear();
@@ -691,6 +700,8 @@ void Renderer::Update(float timeStep)
 
 void Renderer::Render()
 {
+    URHO3D_MEMORY_TAG(MEMTAG_GRAPHICS);
+
     // Engine does not render when window is closed or device is lost
     assert(graphics_ && graphics_->IsInitialized() && !graphics_->IsDeviceLost());
 
@@ -993,6 +1004,44 @@ Texture2D* Renderer::GetShadowMap(Light* light, Camera* camera, unsigned viewWid
     return newShadowMap;
 }
 
+CachedShadowMap* Renderer::GetCachedShadowMap(Light* light, Texture2D* shadowMap)
+{
+    if (!light || !shadowMap)
+        return nullptr;
+
+    CachedShadowMap& cache = cachedShadowMaps_[light];
+    if (cache.light_.Get() != light)
+    {
+        // The light that the entry was created for has been destroyed
+        cache.light_ = light;
+        cache.key_ = ShadowMapCacheKey();
+        cache.valid_ = false;
+    }
+    Texture2D* texture = cache.texture_;
+    if (!texture || texture->GetWidth() != shadowMap->GetWidth() || texture->GetHeight() != shadowMap->GetHeight() ||
+        texture->GetFormat() != shadowMap->GetFormat())
+    {
+        // Create with the same settings as the shadow map, sharing its dummy color rendertarget if any
+        cache.texture_ = new Texture2D(context_);
+        cache.texture_->SetNumLevels(1);
+        cache.valid_ = false;
+        if (!cache.texture_->SetSize(shadowMap->GetWidth(), shadowMap->GetHeight(), shadowMap->GetFormat(), shadowMap->GetUsage(),
+            shadowMap->GetMultiSample()))
+        {
+            cachedShadowMaps_.Erase(light);
+            return nullptr;
+        }
+        cache.texture_->SetFilterMode(shadowMap->GetFilterMode());
+        cache.texture_->SetShadowCompare(shadowMap->GetShadowCompare());
+        RenderSurface* linkedColor = shadowMap->GetRenderSurface()->GetLinkedRenderTarget();
+        if (linkedColor)
+            cache.texture_->GetRenderSurface()->SetLinkedRenderTarget(linkedColor);
+    }
+
+    cache.texture_->ResetUseTimer();
+    return &cache;
+}
+
 Texture* Renderer::GetScreenBuffer(int width, int height, unsigned format, int multiSample, bool autoResolve, bool cubemap, bool filtered, bool srgb,
     unsigned persistentKey)
 {
@@ -1561,6 +1610,16 @@ void Renderer::RemoveUnusedBuffers()
             screenBuffers_.Erase(current);
         }
     }
+
+    for (HashMap<Light*, CachedShadowMap>::Iterator i = cachedShadowMaps_.Begin(); i != cachedShadowMaps_.End();)
+    {
+        HashMap<Light*, CachedShadowMap>::Iterator current = i++;
+        if (current->second_.light_.Expired() || current->second_.texture_->GetUseTimer() > MAX_BUFFER_AGE)
+        {
+            URHO3D_LOGTRACE("Removed unused cached shadow map");
+            cachedShadowMaps_.Erase(current);
+        }
+    }
 }
 
 void Renderer::ResetShadowMapAllocations()
@@ -1900,6 +1959,7 @@ void Renderer::ResetShadowMaps()
     shadowMaps_.Clear();
     shadowMapAllocations_.Clear();
     colorShadowMaps_.Clear();
+    cachedShadowMaps_.Clear();
 }
 
 void Renderer::ResetBuffers()
@@ -1983,7 +2043,7 @@ void Renderer::BlurShadowMap(View* view, Texture2D* shadowMap, float blurScale)
     view->SetGBufferShaderParameters(IntVector2(shadowMap->GetWidth(), shadowMap->GetHeight()), IntRect(0, 0, shadowMap->GetWidth(), shadowMap->GetHeight()));
 
     // Horizontal blur of the shadow map
-    static const StringHash blurOffsetParam("BlurOffsets");
+    static const StringHash blurOffsetParam = "BlurOffsets"_sh;
 
     graphics_->SetShaderParameter(blurOffsetParam, Vector2(shadowSoftness_ * blurScale / shadowMap->GetWidth(), 0.0f));
     graphics_->SetTexture(TU_DIFFUSE, shadowMap);
@@ -222,6 +222,8 @@ public:
     void SetReuseShadowMaps(bool enable);
     /// Set maximum number of shadow maps created for one resolution. Only has effect if reuse of shadow maps is disabled.
     void SetMaxShadowMaps(int shadowMaps);
+    /// Set caching of static shadow casters' shadow maps between frames. Costs an extra shadow map per shadowed light, and only has effect with depth texture shadow maps. Default false.
+    void SetShadowMapCaching(bool enable);
     /// Set dynamic instancing on/off. When on (default), drawables using the same static-type geometry and material will be automatically combined to an instanced draw call.
     void SetDynamicInstancing(bool enable);
     /// Set number of extra instancing buffer elements. Default is 0. Extra 4-vectors are available through TEXCOORD7 and further.
@@ -238,6 +240,8 @@ public:
     void SetOccluderSizeThreshold(float screenSize);
     /// Set whether to thread occluder rendering. Default false.
     void SetThreadedOcclusion(bool enable);
+    /// Set whether to record the draw commands of batch queues in worker threads before executing them. Default true. Has no effect without worker threads.
+    void SetThreadedCommandRecording(bool enable) { threadedCommandRecording_ = enable; }
     /// Set shadow depth bias multiplier for mobile platforms to counteract possible worse shadow map precision. Default 1.0 (no effect.)
     void SetMobileShadowBiasMul(float mul);
     /// Set shadow depth bias addition for mobile platforms to counteract possible worse shadow map precision. Default 0.0 (no effect.)
@@ -301,6 +305,9 @@ public:
     /// Return whether shadow maps are reused.
     bool GetReuseShadowMaps() const { return reuseShadowMaps_; }
 
+    /// Return whether static shadow casters' shadow maps are cached.
+    bool GetShadowMapCaching() const { return shadowMapCaching_; }
+
     /// Return maximum number of shadow maps per resolution.
     int GetMaxShadowMaps() const { return maxShadowMaps_; }
 
@@ -328,6 +335,9 @@ public:
     /// Return whether occlusion rendering is threaded.
     bool GetThreadedOcclusion() const { return threadedOcclusion_; }
 
+    /// Return whether draw commands are recorded in worker threads.
+    bool GetThreadedCommandRecording() const { return threadedCommandRecording_; }
+
     /// Return shadow depth bias multiplier for mobile platforms.
     float GetMobileShadowBiasMul() const { return mobileShadowBiasMul_; }
 
@@ -396,6 +406,8 @@ public:
     Geometry* GetQuadGeometry();
     /// Allocate a shadow map. If shadow map reuse is disabled, a different map is returned each time.
     Texture2D* GetShadowMap(Light* light, Camera* camera, unsigned viewWidth, unsigned viewHeight);
+    /// Return the cached static shadow map of a light, matching the size and format of the light's shadow map this frame. Return null if it could not be created.
+    CachedShadowMap* GetCachedShadowMap(Light* light, Texture2D* shadowMap);
     /// Allocate a rendertarget or depth-stencil texture for deferred rendering or postprocessing. Should only be called during actual rendering, not before.
     Texture* GetScreenBuffer
         (int width, int height, unsigned format, int multiSample, bool autoResolve, bool cubemap, bool filtered, bool srgb, unsigned persistentKey = 0);
@@ -504,6 +516,8 @@ private:
     HashMap<int, SharedPtr<Texture2D> > colorShadowMaps_;
     /// Shadow map allocations by resolution.
     HashMap<int, PODVector<Light*> > shadowMapAllocations_;
+    /// Cached static shadow maps by light.
+    HashMap<Light*, CachedShadowMap> cachedShadowMaps_;
     /// Instance of shadow map filter
     Object* shadowMapFilterInstance_{};
     /// Function pointer of shadow map filter
@@ -588,12 +602,16 @@ private:
     bool drawShadows_{true};
     /// Shadow map reuse flag.
     bool reuseShadowMaps_{true};
+    /// Static shadow map caching flag.
+    bool shadowMapCaching_{};
     /// Dynamic instancing flag.
     bool dynamicInstancing_{true};
     /// Number of extra instancing data elements.
     int numExtraInstancingBufferElements_{};
     /// Threaded occlusion rendering flag.
     bool threadedOcclusion_{};
+    /// Threaded draw command recording flag.
+    bool threadedCommandRecording_{true};
     /// Shaders need reloading flag.
     bool shadersDirty_{true};
     /// Initialized flag.
@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Graphics/ShaderParameterBlock.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Parameter name sequences of the shader parameter block layouts by layout index.
+static Vector<PODVector<StringHash> > layoutNames;
+/// Layout indices by hash of the parameter names.
+static HashMap<unsigned, PODVector<unsigned> > layoutsByHash;
+
+void ShaderParameterBlock::Clear()
+{
+    entries_.Clear();
+    data_.Clear();
+    variantParameters_.Clear();
+    layout_ = M_MAX_UNSIGNED;
+}
+
+void ShaderParameterBlock::AddParameter(StringHash param, const float* data, unsigned count)
+{
+    if (count)
+        memcpy(AddEntry(param, count, true), data, count * sizeof(float));
+}
+
+void ShaderParameterBlock::AddParameter(StringHash param, float value)
+{
+    *AddEntry(param, 1, false) = value;
+}
+
+void ShaderParameterBlock::AddParameter(StringHash param, const Color& color)
+{
+    memcpy(AddEntry(param, 4, false), color.Data(), 4 * sizeof(float));
+}
+
+void ShaderParameterBlock::AddParameter(StringHash param, const Vector2& vector)
+{
+    memcpy(AddEntry(param, 2, false), vector.Data(), 2 * sizeof(float));
+}
+
+void ShaderParameterBlock::AddParameter(StringHash param, const Vector3& vector)
+{
+    memcpy(AddEntry(param, 3, false), vector.Data(), 3 * sizeof(float));
+}
+
+void ShaderParameterBlock::AddParameter(StringHash param, const Vector4& vector)
+{
+    memcpy(AddEntry(param, 4, false), vector.Data(), 4 * sizeof(float));
+}
+
+void ShaderParameterBlock::AddParameter(StringHash param, const Matrix3x4& matrix)
+{
+#ifdef URHO3D_OPENGL
+    // Expand to a full Matrix4, as OpenGL sets 3x4 matrices
+    float* dest = AddEntry(param, 16, false);
+    memcpy(dest, matrix.Data(), 12 * sizeof(float));
+    dest[15] = 1.0f;
+#else
+    memcpy(AddEntry(param, 12, false), matrix.Data(), 12 * sizeof(float));
+#endif
+}
+
+void ShaderParameterBlock::AddParameter(StringHash param, const Matrix4& matrix)
+{
+    memcpy(AddEntry(param, 16, false), matrix.Data(), 16 * sizeof(float));
+}
+
+void ShaderParameterBlock::AddParameter(StringHash param, const Variant& value)
+{
+    switch (value.GetType())
+    {
+    case VAR_BOOL:
+    case VAR_INT:
+    case VAR_MATRIX3:
+        variantParameters_.Push(MakePair(param, value));
+        layout_ = M_MAX_UNSIGNED;
+        break;
+
+    case VAR_FLOAT:
+    case VAR_DOUBLE:
+        AddParameter(param, value.GetFloat());
+        break;
+
+    case VAR_VECTOR2:
+        AddParameter(param, value.GetVector2());
+        break;
+
+    case VAR_VECTOR3:
+        AddParameter(param, value.GetVector3());
+        break;
+
+    case VAR_VECTOR4:
+        AddParameter(param, value.GetVector4());
+        break;
+
+    case VAR_COLOR:
+        AddParameter(param, value.GetColor());
+        break;
+
+    case VAR_MATRIX3X4:
+        AddParameter(param, value.GetMatrix3x4());
+        break;
+
+    case VAR_MATRIX4:
+        AddParameter(param, value.GetMatrix4());
+        break;
+
+    case VAR_BUFFER:
+        {
+            const PODVector<unsigned char>& buffer = value.GetBuffer();
+            if (buffer.Size() >= sizeof(float))
+                AddParameter(param, reinterpret_cast<const float*>(&buffer[0]), buffer.Size() / sizeof(float));
+        }
+        break;
+
+    default:
+        // Unsupported parameter type, do nothing
+        break;
+    }
+}
+
+unsigned ShaderParameterBlock::GetLayout() const
+{
+    if (layout_ != M_MAX_UNSIGNED)
+        return layout_;
+
+    unsigned hash = entries_.Size();
+    for (unsigned i = 0; i < entries_.Size(); ++i)
+        hash = hash * 31 + entries_[i].name_.Value();
+
+    PODVector<unsigned>& layouts = layoutsByHash[hash];
+    for (unsigned i = 0; i < layouts.Size(); ++i)
+    {
+        const PODVector<StringHash>& names = layoutNames[layouts[i]];
+        bool match = names.Size() == entries_.Size();
+        for (unsigned j = 0; match && j < names.Size(); ++j)
+            match = names[j] == entries_[j].name_;
+
+        if (match)
+        {
+            layout_ = layouts[i];
+            return layout_;
+        }
+    }
+
+    layout_ = layoutNames.Size();
+    layouts.Push(layout_);
+    layoutNames.Resize(layout_ + 1);
+    PODVector<StringHash>& names = layoutNames.Back();
+    names.Resize(entries_.Size());
+    for (unsigned i = 0; i < entries_.Size(); ++i)
+        names[i] = entries_[i].name_;
+
+    return layout_;
+}
+
+float* ShaderParameterBlock::AddEntry(StringHash param, unsigned size, bool array)
+{
+    ShaderParameterBlockEntry entry;
+    entry.name_ = param;
+    entry.offset_ = data_.Size();
+    entry.size_ = size;
+    entry.array_ = array;
+    entries_.Push(entry);
+    layout_ = M_MAX_UNSIGNED;
+
+    data_.Resize(entry.offset_ + ((size + 3) & ~3u));
+    float* dest = &data_[entry.offset_];
+    memset(dest, 0, (data_.Size() - entry.offset_) * sizeof(float));
+    return dest;
+}
+
+}
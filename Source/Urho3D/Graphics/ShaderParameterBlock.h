@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Core/Variant.h"
+
+namespace Urho3D
+{
+
+struct ShaderParameter;
+
+/// Parameter of a shader parameter block.
+struct ShaderParameterBlockEntry
+{
+    /// Parameter name hash.
+    StringHash name_;
+    /// Offset of the value in the float data of the block. Values start at four float boundaries and are padded with zeros.
+    unsigned offset_;
+    /// Number of floats in the value.
+    unsigned size_;
+    /// Whether the value is an array rather than a single vector or matrix.
+    bool array_;
+};
+
+/// %Set of shader parameters converted to floats once, to be set together by Graphics::SetShaderParameters. The program's parameters for the entries are looked up on first use of the block's layout, so setting a block copies the values without hashing their names.
+class URHO3D_API ShaderParameterBlock
+{
+public:
+    /// Remove all parameters.
+    void Clear();
+    /// Add float constants.
+    void AddParameter(StringHash param, const float* data, unsigned count);
+    /// Add float constant.
+    void AddParameter(StringHash param, float value);
+    /// Add color constant.
+    void AddParameter(StringHash param, const Color& color);
+    /// Add 2D vector constant.
+    void AddParameter(StringHash param, const Vector2& vector);
+    /// Add 3D vector constant.
+    void AddParameter(StringHash param, const Vector3& vector);
+    /// Add 4D vector constant.
+    void AddParameter(StringHash param, const Vector4& vector);
+    /// Add 3x4 matrix constant.
+    void AddParameter(StringHash param, const Matrix3x4& matrix);
+    /// Add 4x4 matrix constant.
+    void AddParameter(StringHash param, const Matrix4& matrix);
+    /// Add constant from a variant. Integer, boolean and 3x3 matrix values are kept as variants and set individually.
+    void AddParameter(StringHash param, const Variant& value);
+
+    /// Return parameters stored as floats.
+    const PODVector<ShaderParameterBlockEntry>& GetEntries() const { return entries_; }
+
+    /// Return float data of a parameter.
+    const float* GetData(const ShaderParameterBlockEntry& entry) const { return &data_[entry.offset_]; }
+
+    /// Return parameters stored as variants.
+    const Vector<Pair<StringHash, Variant> >& GetVariantParameters() const { return variantParameters_; }
+
+    /// Return whether has no parameters.
+    bool IsEmpty() const { return entries_.Empty() && variantParameters_.Empty(); }
+
+    /// Return layout index. Blocks with the same parameter names in the same order share a layout. Main thread only.
+    unsigned GetLayout() const;
+
+private:
+    /// Add a parameter and return its zero-filled float data.
+    float* AddEntry(StringHash param, unsigned size, bool array);
+
+    /// Parameters stored as floats.
+    PODVector<ShaderParameterBlockEntry> entries_;
+    /// Float data of the parameters.
+    PODVector<float> data_;
+    /// Parameters stored as variants.
+    Vector<Pair<StringHash, Variant> > variantParameters_;
+    /// Layout index, assigned on first use after the parameters change.
+    mutable unsigned layout_{M_MAX_UNSIGNED};
+};
+
+/// Shader parameters of a shader program matching the entries of shader parameter block layouts.
+class URHO3D_API ShaderParameterBlockBindings
+{
+public:
+    /// Return the shader parameters for the entries of a block, null for entries the program does not use. Parameters are looked up with the given function on first use of the block's layout.
+    template <class T> const ShaderParameter* const* Get(const ShaderParameterBlock& block, const T& findParameter)
+    {
+        const PODVector<ShaderParameterBlockEntry>& entries = block.GetEntries();
+        unsigned layout = block.GetLayout();
+        if (layout >= bindings_.Size())
+            bindings_.Resize(layout + 1);
+
+        PODVector<const ShaderParameter*>& binding = bindings_[layout];
+        if (binding.Size() != entries.Size())
+        {
+            binding.Resize(entries.Size());
+            for (unsigned i = 0; i < entries.Size(); ++i)
+                binding[i] = findParameter(entries[i].name_);
+        }
+
+        return binding.Buffer();
+    }
+
+    /// Forget the parameters of all layouts. Call when the program's parameters change.
+    void Clear() { bindings_.Clear(); }
+
+private:
+    /// Shader parameters by layout index.
+    Vector<PODVector<const ShaderParameter*> > bindings_;
+};
+
+}
@@ -0,0 +1,734 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/Batch.h"
+#include "../Graphics/Camera.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Model.h"
+#include "../Graphics/OcclusionBuffer.h"
+#include "../Graphics/OctreeQuery.h"
+#include "../Graphics/StaticModelCloud.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
+#include "../Scene/Node.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* GEOMETRY_CATEGORY;
+
+/// Maximum number of instances in a leaf cell.
+static const unsigned MAX_CELL_INSTANCES = 64;
+/// Maximum depth of the cell hierarchy.
+static const unsigned MAX_CELL_DEPTH = 32;
+
+StaticModelCloud::StaticModelCloud(Context* context) :
+    Drawable(context, DRAWABLE_GEOMETRY),
+    materialsAttr_(Material::GetTypeStatic())
+{
+}
+
+StaticModelCloud::~StaticModelCloud() = default;
+
+void StaticModelCloud::RegisterObject(Context* context)
+{
+    context->RegisterFactory<StaticModelCloud>(GEOMETRY_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Model", GetModelAttr, SetModelAttr, ResourceRef, ResourceRef(Model::GetTypeStatic()), AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Material", GetMaterialsAttr, SetMaterialsAttr, ResourceRefList, ResourceRefList(Material::GetTypeStatic()),
+        AM_DEFAULT);
+    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Instances", GetInstancesAttr, SetInstancesAttr, PODVector<unsigned char>,
+        Variant::emptyBuffer, AM_FILE | AM_NOEDIT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Can Be Occluded", IsOccludee, SetOccludee, bool, true, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Cast Shadows", bool, castShadows_, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Draw Distance", GetDrawDistance, SetDrawDistance, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Fade Distance", GetFadeDistance, SetFadeDistance, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Shadow Distance", GetShadowDistance, SetShadowDistance, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("LOD Bias", GetLodBias, SetLodBias, float, 1.0f, AM_DEFAULT);
+    URHO3D_COPY_BASE_ATTRIBUTES(Drawable);
+}
+
+void StaticModelCloud::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results)
+{
+    RayQueryLevel level = query.level_;
+
+    // GetWorldBoundingBox() also brings the cell hierarchy up to date
+    if (query.ray_.HitDistance(GetWorldBoundingBox()) >= query.maxDistance_ || cells_.Empty())
+        return;
+
+    const Matrix3x4& nodeTransform = node_->GetWorldTransform();
+    const BoundingBox& modelBox = model_->GetBoundingBox();
+    Ray localRay = query.ray_.Transformed(nodeTransform.Inverse());
+
+    unsigned stack[MAX_CELL_DEPTH * 2 + 2];
+    unsigned stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize)
+    {
+        const StaticModelCloudCell& cell = cells_[stack[--stackSize]];
+        if (localRay.HitDistance(BoundingBox(cell.min_, cell.max_)) == M_INFINITY)
+            continue;
+
+        if (!cell.count_)
+        {
+            stack[stackSize++] = cell.offset_ + 1;
+            stack[stackSize++] = cell.offset_;
+            continue;
+        }
+
+        for (unsigned i = cell.offset_; i < cell.offset_ + cell.count_; ++i)
+        {
+            unsigned index = cellInstances_[i];
+            Matrix3x4 worldTransform = nodeTransform * instances_[index];
+
+            // Initial test using AABB
+            float distance = query.ray_.HitDistance(modelBox.Transformed(worldTransform));
+            Vector3 normal = -query.ray_.direction_;
+            Vector2 geometryUV;
+
+            // Then proceed to OBB and triangle-level tests if necessary
+            if (level >= RAY_OBB && distance < query.maxDistance_)
+            {
+                Ray instanceRay = query.ray_.Transformed(worldTransform.Inverse());
+                distance = instanceRay.HitDistance(modelBox);
+
+                if (level >= RAY_TRIANGLE && distance < query.maxDistance_)
+                {
+                    distance = M_INFINITY;
+
+                    for (unsigned j = 0; j < geometries_.Size(); ++j)
+                    {
+                        Geometry* geometry = geometries_[j][0];
+                        if (geometry)
+                        {
+                            Vector3 geometryNormal;
+                            Vector2 hitUV;
+                            float geometryDistance = level == RAY_TRIANGLE ? geometry->GetHitDistance(instanceRay, &geometryNormal) :
+                                geometry->GetHitDistance(instanceRay, &geometryNormal, &hitUV);
+                            if (geometryDistance < query.maxDistance_ && geometryDistance < distance)
+                            {
+                                distance = geometryDistance;
+                                normal = (worldTransform * Vector4(geometryNormal, 0.0f)).Normalized();
+                                geometryUV = hitUV;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (distance < query.maxDistance_)
+            {
+                RayQueryResult result;
+                result.position_ = query.ray_.origin_ + distance * query.ray_.direction_;
+                result.normal_ = normal;
+                result.textureUV_ = geometryUV;
+                result.distance_ = distance;
+                result.drawable_ = this;
+                result.node_ = node_;
+                result.subObject_ = index;
+                results.Push(result);
+            }
+        }
+    }
+}
+
+void StaticModelCloud::Update(const FrameInfo& frame)
+{
+    // Rebuild the cells during the octree update so that views do not need to
+    UpdateCells();
+}
+
+void StaticModelCloud::UpdateBatches(const FrameInfo& frame)
+{
+    const BoundingBox& worldBoundingBox = GetWorldBoundingBox();
+
+    MutexLock lock(mutex_);
+
+    StaticModelCloudView* view = GetView(frame, frame.camera_);
+    distance_ = view->numInstances_ ? view->distance_ : frame.camera_->GetDistance(worldBoundingBox.Center());
+
+    unsigned numGeometries = geometries_.Size();
+    for (unsigned i = 0; i < view->transforms_.Size(); ++i)
+    {
+        const PODVector<Matrix3x4>& transforms = view->transforms_[i];
+        for (unsigned j = 0; j < numGeometries; ++j)
+        {
+            SourceBatch& batch = batches_[i * numGeometries + j];
+            batch.distance_ = distance_;
+            batch.worldTransform_ = transforms.Size() ? &transforms[0] : &Matrix3x4::IDENTITY;
+            batch.numWorldTransforms_ = transforms.Size();
+        }
+    }
+
+    float scale = worldBoundingBox.Size().DotProduct(DOT_SCALE);
+    lodDistance_ = frame.camera_->GetLodDistance(distance_, scale, lodBias_);
+}
+
+const Vector<SourceBatch>& StaticModelCloud::GetShadowBatches(const FrameInfo& frame, Camera* shadowCamera)
+{
+    MutexLock lock(mutex_);
+
+    // Instances outside the view frustum may still cast shadows into it, so cull separately against the shadow camera
+    StaticModelCloudView* view = GetView(frame, shadowCamera);
+
+    shadowBatches_ = batches_;
+    unsigned numGeometries = geometries_.Size();
+    for (unsigned i = 0; i < view->transforms_.Size(); ++i)
+    {
+        const PODVector<Matrix3x4>& transforms = view->transforms_[i];
+        for (unsigned j = 0; j < numGeometries; ++j)
+        {
+            SourceBatch& batch = shadowBatches_[i * numGeometries + j];
+            batch.worldTransform_ = transforms.Size() ? &transforms[0] : &Matrix3x4::IDENTITY;
+            batch.numWorldTransforms_ = transforms.Size();
+        }
+    }
+
+    return shadowBatches_;
+}
+
+Geometry* StaticModelCloud::GetLodGeometry(unsigned batchIndex, unsigned level)
+{
+    if (geometries_.Empty() || batchIndex >= batches_.Size())
+        return nullptr;
+
+    // Batches are ordered by LOD band, then by geometry
+    const Vector<SharedPtr<Geometry> >& batchGeometries = geometries_[batchIndex % geometries_.Size()];
+
+    // If level is out of range, use the geometry of the band
+    if (level < batchGeometries.Size())
+        return batchGeometries[level];
+    else
+        return batches_[batchIndex].geometry_;
+}
+
+void StaticModelCloud::SetModel(Model* model)
+{
+    if (model == model_)
+        return;
+
+    // Unsubscribe from the reload event of previous model (if any), then subscribe to the new
+    if (model_)
+        UnsubscribeFromEvent(model_, E_RELOADFINISHED);
+
+    model_ = model;
+
+    if (model)
+    {
+        SubscribeToEvent(model, E_RELOADFINISHED, URHO3D_HANDLER(StaticModelCloud, HandleModelReloadFinished));
+        geometries_ = model->GetGeometries();
+    }
+    else
+        geometries_.Clear();
+
+    // Ensure that each geometry has at least one LOD level
+    for (unsigned i = 0; i < geometries_.Size(); ++i)
+    {
+        if (geometries_[i].Empty())
+            geometries_[i].Resize(1);
+    }
+
+    UpdateLodBands();
+    MarkInstancesDirty();
+}
+
+void StaticModelCloud::SetMaterial(Material* material)
+{
+    for (unsigned i = 0; i < batches_.Size(); ++i)
+        batches_[i].material_ = material;
+
+    MarkNetworkUpdate();
+}
+
+bool StaticModelCloud::SetMaterial(unsigned index, Material* material)
+{
+    unsigned numGeometries = geometries_.Size();
+    if (index >= numGeometries)
+    {
+        URHO3D_LOGERROR("Material index out of bounds");
+        return false;
+    }
+
+    for (unsigned i = index; i < batches_.Size(); i += numGeometries)
+        batches_[i].material_ = material;
+
+    MarkNetworkUpdate();
+    return true;
+}
+
+void StaticModelCloud::SetFadeDistance(float distance)
+{
+    fadeDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+unsigned StaticModelCloud::AddInstance(const Matrix3x4& transform)
+{
+    instances_.Push(transform);
+    MarkInstancesDirty();
+    return instances_.Size() - 1;
+}
+
+void StaticModelCloud::SetInstance(unsigned index, const Matrix3x4& transform)
+{
+    if (index >= instances_.Size())
+    {
+        URHO3D_LOGERROR("Instance index out of bounds");
+        return;
+    }
+
+    instances_[index] = transform;
+    MarkInstancesDirty();
+}
+
+void StaticModelCloud::SetInstances(const PODVector<Matrix3x4>& transforms)
+{
+    instances_ = transforms;
+    MarkInstancesDirty();
+}
+
+void StaticModelCloud::RemoveInstance(unsigned index)
+{
+    if (index >= instances_.Size())
+        return;
+
+    instances_.EraseSwap(index);
+    MarkInstancesDirty();
+}
+
+void StaticModelCloud::RemoveAllInstances()
+{
+    instances_.Clear();
+    MarkInstancesDirty();
+}
+
+Material* StaticModelCloud::GetMaterial(unsigned index) const
+{
+    return index < geometries_.Size() ? batches_[index].material_ : nullptr;
+}
+
+unsigned StaticModelCloud::GetNumVisibleInstances(Camera* camera) const
+{
+    MutexLock lock(mutex_);
+
+    unsigned frameNumber = 0;
+    unsigned numInstances = 0;
+    for (unsigned i = 0; i < views_.Size(); ++i)
+    {
+        const StaticModelCloudView* view = views_[i].Get();
+        if (view->camera_ == camera && view->frameNumber_ >= frameNumber)
+        {
+            frameNumber = view->frameNumber_;
+            numInstances = view->numInstances_;
+        }
+    }
+
+    return numInstances;
+}
+
+void StaticModelCloud::SetModelAttr(const ResourceRef& value)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    SetModel(cache->GetResource<Model>(value.name_));
+}
+
+void StaticModelCloud::SetMaterialsAttr(const ResourceRefList& value)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    for (unsigned i = 0; i < value.names_.Size(); ++i)
+        SetMaterial(i, cache->GetResource<Material>(value.names_[i]));
+}
+
+void StaticModelCloud::SetInstancesAttr(const PODVector<unsigned char>& value)
+{
+    MemoryBuffer buffer(value);
+    unsigned numInstances = buffer.ReadVLE();
+    // Guard against truncated data
+    numInstances = Min(numInstances, (buffer.GetSize() - buffer.GetPosition()) / (unsigned)sizeof(Matrix3x4));
+
+    instances_.Resize(numInstances);
+    if (numInstances)
+        buffer.Read(&instances_[0], numInstances * sizeof(Matrix3x4));
+
+    MarkInstancesDirty();
+}
+
+ResourceRef StaticModelCloud::GetModelAttr() const
+{
+    return GetResourceRef(model_, Model::GetTypeStatic());
+}
+
+const ResourceRefList& StaticModelCloud::GetMaterialsAttr() const
+{
+    materialsAttr_.names_.Resize(geometries_.Size());
+    for (unsigned i = 0; i < geometries_.Size(); ++i)
+        materialsAttr_.names_[i] = GetResourceName(GetMaterial(i));
+
+    return materialsAttr_;
+}
+
+PODVector<unsigned char> StaticModelCloud::GetInstancesAttr() const
+{
+    VectorBuffer ret;
+
+    ret.WriteVLE(instances_.Size());
+    if (instances_.Size())
+        ret.Write(&instances_[0], instances_.Size() * sizeof(Matrix3x4));
+
+    return ret.GetBuffer();
+}
+
+void StaticModelCloud::OnWorldBoundingBoxUpdate()
+{
+    UpdateCells();
+
+    if (cells_.Size())
+        worldBoundingBox_ = boundingBox_.Transformed(node_->GetWorldTransform());
+    else
+        worldBoundingBox_ = BoundingBox();
+}
+
+void StaticModelCloud::UpdateCells()
+{
+    MutexLock lock(mutex_);
+
+    if (!cellsDirty_)
+        return;
+
+    URHO3D_PROFILE("UpdateInstanceCells");
+
+    cellsDirty_ = false;
+    cells_.Clear();
+    cellInstances_.Clear();
+    boundingBox_ = BoundingBox();
+
+    unsigned numInstances = instances_.Size();
+    if (!model_ || !numInstances)
+    {
+        instanceSpheres_.Clear();
+        return;
+    }
+
+    // Bound each instance by a sphere around its transformed model bounding box
+    const BoundingBox& modelBox = model_->GetBoundingBox();
+    instanceSpheres_.Resize(numInstances);
+    cellInstances_.Resize(numInstances);
+    for (unsigned i = 0; i < numInstances; ++i)
+    {
+        BoundingBox box = modelBox.Transformed(instances_[i]);
+        instanceSpheres_[i].Define(box.Center(), box.HalfSize().Length());
+        cellInstances_[i] = i;
+    }
+
+    cells_.Reserve(2 * (numInstances / MAX_CELL_INSTANCES) + 1);
+    cells_.Resize(1);
+    BuildCell(0, 0, numInstances, 0);
+
+    boundingBox_.Define(cells_[0].min_, cells_[0].max_);
+}
+
+void StaticModelCloud::BuildCell(unsigned cellIndex, unsigned start, unsigned end, unsigned depth)
+{
+    BoundingBox box;
+    BoundingBox centerBox;
+    for (unsigned i = start; i < end; ++i)
+    {
+        const Sphere& sphere = instanceSpheres_[cellInstances_[i]];
+        Vector3 halfSize(sphere.radius_, sphere.radius_, sphere.radius_);
+        box.Merge(BoundingBox(sphere.center_ - halfSize, sphere.center_ + halfSize));
+        centerBox.Merge(sphere.center_);
+    }
+
+    StaticModelCloudCell& cell = cells_[cellIndex];
+    cell.min_ = box.min_;
+    cell.max_ = box.max_;
+    cell.offset_ = start;
+    cell.count_ = end - start;
+
+    if (end - start <= MAX_CELL_INSTANCES || depth >= MAX_CELL_DEPTH)
+        return;
+
+    // Split at the middle of the longest axis of the instance centers
+    Vector3 size = centerBox.Size();
+    unsigned axis = 0;
+    if (size.y_ > size.x_)
+        axis = 1;
+    if (size.z_ > size.Data()[axis])
+        axis = 2;
+    float split = centerBox.Center().Data()[axis];
+
+    unsigned mid = start;
+    for (unsigned i = start; i < end; ++i)
+    {
+        if (instanceSpheres_[cellInstances_[i]].center_.Data()[axis] < split)
+            Swap(cellInstances_[i], cellInstances_[mid++]);
+    }
+
+    // If all instances ended up on one side (e.g. coincident positions), split by count instead
+    if (mid == start || mid == end)
+        mid = start + (end - start) / 2;
+
+    unsigned childIndex = cells_.Size();
+    cells_.Resize(childIndex + 2);
+    cells_[cellIndex].offset_ = childIndex;
+    cells_[cellIndex].count_ = 0;
+
+    BuildCell(childIndex, start, mid, depth + 1);
+    BuildCell(childIndex + 1, mid, end, depth + 1);
+}
+
+void StaticModelCloud::UpdateLodBands()
+{
+    // Every LOD distance of every geometry starts a new band, in which each geometry uses one fixed LOD level
+    lodThresholds_.Clear();
+    for (unsigned i = 0; i < geometries_.Size(); ++i)
+    {
+        for (unsigned j = 1; j < geometries_[i].Size(); ++j)
+        {
+            if (geometries_[i][j])
+                lodThresholds_.Push(geometries_[i][j]->GetLodDistance());
+        }
+    }
+
+    Sort(lodThresholds_.Begin(), lodThresholds_.End());
+    unsigned numThresholds = 0;
+    for (unsigned i = 0; i < lodThresholds_.Size(); ++i)
+    {
+        if (!numThresholds || lodThresholds_[i] != lodThresholds_[numThresholds - 1])
+            lodThresholds_[numThresholds++] = lodThresholds_[i];
+    }
+    lodThresholds_.Resize(numThresholds);
+
+    // Keep the materials of the first band, which is laid out like the geometries
+    unsigned numGeometries = geometries_.Size();
+    unsigned numBands = GetNumLodBands();
+    Vector<SharedPtr<Material> > materials(numGeometries);
+    for (unsigned i = 0; i < numGeometries && i < batches_.Size(); ++i)
+        materials[i] = batches_[i].material_;
+
+    batches_.Resize(numBands * numGeometries);
+    for (unsigned i = 0; i < numBands; ++i)
+    {
+        // Choose the LOD levels as StaticModel would for a distance inside the band
+        float lodDistance = i < numThresholds ? lodThresholds_[i] : M_INFINITY;
+
+        for (unsigned j = 0; j < numGeometries; ++j)
+        {
+            const Vector<SharedPtr<Geometry> >& batchGeometries = geometries_[j];
+            unsigned k;
+
+            for (k = 1; k < batchGeometries.Size(); ++k)
+            {
+                if (batchGeometries[k] && lodDistance <= batchGeometries[k]->GetLodDistance())
+                    break;
+            }
+
+            SourceBatch& batch = batches_[i * numGeometries + j];
+            batch.geometry_ = batchGeometries[k - 1];
+            batch.material_ = materials[j];
+            batch.worldTransform_ = &Matrix3x4::IDENTITY;
+            batch.numWorldTransforms_ = 0;
+        }
+    }
+
+    // Drop the culling results, as they refer to the old band layout
+    MutexLock lock(mutex_);
+    views_.Clear();
+}
+
+StaticModelCloudView* StaticModelCloud::GetView(const FrameInfo& frame, Camera* cullCamera)
+{
+    // Batches are collected from each view before the next view is updated, but all views are rendered only afterward.
+    // Therefore keep the culling result of each camera until the next frame
+    StaticModelCloudView* freeView = nullptr;
+    for (unsigned i = 0; i < views_.Size(); ++i)
+    {
+        StaticModelCloudView* candidate = views_[i].Get();
+        if (candidate->frameNumber_ == frame.frameNumber_)
+        {
+            if (candidate->camera_ == cullCamera)
+                return candidate;
+        }
+        else if (!freeView)
+            freeView = candidate;
+    }
+
+    if (!freeView)
+    {
+        views_.Push(UniquePtr<StaticModelCloudView>(new StaticModelCloudView()));
+        freeView = views_.Back().Get();
+    }
+
+    freeView->camera_ = cullCamera;
+    freeView->frameNumber_ = frame.frameNumber_;
+    CullInstances(*freeView, frame);
+    return freeView;
+}
+
+void StaticModelCloud::CullInstances(StaticModelCloudView& view, const FrameInfo& frame)
+{
+    URHO3D_PROFILE("CullInstances");
+
+    unsigned numBands = GetNumLodBands();
+    view.transforms_.Resize(numBands);
+    for (unsigned i = 0; i < numBands; ++i)
+        view.transforms_[i].Clear();
+    view.distance_ = M_INFINITY;
+    view.numInstances_ = 0;
+
+    if (cells_.Empty() || !model_ || geometries_.Empty())
+        return;
+
+    // Shadow casters are culled against the shadow camera, but distances and LOD levels still follow the view camera
+    Camera* camera = frame.camera_;
+    bool shadowView = view.camera_ != camera;
+    const Frustum& frustum = view.camera_->GetFrustum();
+    OcclusionBuffer* occlusionBuffer = occludee_ && !shadowView ? frame.occlusionBuffer_ : nullptr;
+    bool orthographic = camera->IsOrthographic();
+    Vector3 cameraPosition = camera->GetNode()->GetWorldPosition();
+    const Matrix3x4& cameraView = camera->GetView();
+
+    const Matrix3x4& nodeTransform = node_->GetWorldTransform();
+    Vector3 nodeScale = nodeTransform.Scale();
+    float maxNodeScale = Max(Max(nodeScale.x_, nodeScale.y_), nodeScale.z_);
+
+    // Instance LOD scale is approximated from the bounding sphere, which matches the average box size of a cube
+    float lodScaleFactor = 2.0f * maxNodeScale / sqrtf(3.0f);
+    float drawDistance = drawDistance_;
+    float maxDistance = drawDistance;
+    if (shadowView && shadowDistance_ > 0.0f && (maxDistance <= 0.0f || shadowDistance_ < maxDistance))
+        maxDistance = shadowDistance_;
+    float fadeStart = fadeDistance_ > 0.0f && drawDistance > 0.0f ? Max(drawDistance - fadeDistance_, 0.0f) : M_INFINITY;
+    float fadeRange = drawDistance - fadeStart;
+    unsigned numThresholds = lodThresholds_.Size();
+
+    unsigned stack[MAX_CELL_DEPTH * 2 + 2];
+    unsigned stackSize = 0;
+    // The high bit marks cells known to be fully inside the frustum
+    static const unsigned INSIDE_FLAG = 0x80000000;
+    stack[stackSize++] = 0;
+
+    while (stackSize)
+    {
+        unsigned entry = stack[--stackSize];
+        bool inside = (entry & INSIDE_FLAG) != 0;
+        const StaticModelCloudCell& cell = cells_[entry & ~INSIDE_FLAG];
+        BoundingBox cellBox = BoundingBox(cell.min_, cell.max_).Transformed(nodeTransform);
+
+        if (!inside)
+        {
+            Intersection result = frustum.IsInside(cellBox);
+            if (result == OUTSIDE)
+                continue;
+            inside = result == INSIDE;
+        }
+
+        if (maxDistance > 0.0f)
+        {
+            Vector3 nearest = cameraPosition;
+            nearest.x_ = Clamp(nearest.x_, cellBox.min_.x_, cellBox.max_.x_);
+            nearest.y_ = Clamp(nearest.y_, cellBox.min_.y_, cellBox.max_.y_);
+            nearest.z_ = Clamp(nearest.z_, cellBox.min_.z_, cellBox.max_.z_);
+            float cellDistance = orthographic ? Abs((cameraView * nearest).z_) : (nearest - cameraPosition).Length();
+            if (cellDistance > maxDistance)
+                continue;
+        }
+
+        if (occlusionBuffer && !occlusionBuffer->IsVisible(cellBox))
+            continue;
+
+        if (!cell.count_)
+        {
+            unsigned flag = inside ? INSIDE_FLAG : 0;
+            stack[stackSize++] = (cell.offset_ + 1) | flag;
+            stack[stackSize++] = cell.offset_ | flag;
+            continue;
+        }
+
+        for (unsigned i = cell.offset_; i < cell.offset_ + cell.count_; ++i)
+        {
+            unsigned index = cellInstances_[i];
+            const Sphere& localSphere = instanceSpheres_[index];
+            Sphere sphere(nodeTransform * localSphere.center_, localSphere.radius_ * maxNodeScale);
+
+            if (!inside && frustum.IsInsideFast(sphere) == OUTSIDE)
+                continue;
+
+            float distance = orthographic ? Abs((cameraView * sphere.center_).z_) : (sphere.center_ - cameraPosition).Length();
+            if (maxDistance > 0.0f && distance > maxDistance)
+                continue;
+
+            float lodDistance = camera->GetLodDistance(distance, localSphere.radius_ * lodScaleFactor, lodBias_);
+            unsigned band = 0;
+            while (band < numThresholds && lodDistance > lodThresholds_[band])
+                ++band;
+
+            Matrix3x4 transform = nodeTransform * instances_[index];
+
+            // Shrink the instance towards its origin when approaching the draw distance
+            if (distance > fadeStart)
+            {
+                float fade = (drawDistance - distance) / fadeRange;
+                transform.m00_ *= fade; transform.m01_ *= fade; transform.m02_ *= fade;
+                transform.m10_ *= fade; transform.m11_ *= fade; transform.m12_ *= fade;
+                transform.m20_ *= fade; transform.m21_ *= fade; transform.m22_ *= fade;
+            }
+
+            view.transforms_[band].Push(transform);
+            view.distance_ = Min(view.distance_, distance);
+            ++view.numInstances_;
+        }
+    }
+}
+
+void StaticModelCloud::MarkInstancesDirty()
+{
+    {
+        MutexLock lock(mutex_);
+        cellsDirty_ = true;
+    }
+
+    OnMarkedDirty(node_);
+    MarkNetworkUpdate();
+}
+
+void StaticModelCloud::HandleModelReloadFinished(StringHash eventType, VariantMap& eventData)
+{
+    Model* currentModel = model_;
+    model_.Reset(); // Set null to allow to be re-set
+    SetModel(currentModel);
+}
+
+}
@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Core/Mutex.h"
+#include "../Graphics/Drawable.h"
+#include "../Math/Sphere.h"
+
+namespace Urho3D
+{
+
+class Model;
+
+/// Cell of the instance hierarchy of a static model cloud. Inner cells have zero instance count and their two children stored consecutively.
+struct StaticModelCloudCell
+{
+    /// Local-space bounding box minimum.
+    Vector3 min_;
+    /// First child cell index for inner cells, first entry in the cell instance list for leaves.
+    unsigned offset_;
+    /// Local-space bounding box maximum.
+    Vector3 max_;
+    /// Number of instances in a leaf, zero for inner cells.
+    unsigned count_;
+};
+
+/// Culling result of a static model cloud for one camera. Kept until the frame has been rendered, as the batches point to it.
+struct StaticModelCloudView
+{
+    /// Camera the instances were culled against. Either the view camera or a shadow camera.
+    Camera* camera_{};
+    /// Frame number the result was calculated on.
+    unsigned frameNumber_{};
+    /// Distance of the nearest visible instance.
+    float distance_{};
+    /// Number of visible instances.
+    unsigned numInstances_{};
+    /// Visible instance world transforms per LOD band.
+    Vector<PODVector<Matrix3x4> > transforms_;
+};
+
+/// Static model drawn as a cloud of instances without scene nodes. Instances are culled per cell and per instance and their LOD level is chosen individually.
+class URHO3D_API StaticModelCloud : public Drawable
+{
+    URHO3D_OBJECT(StaticModelCloud, Drawable);
+
+public:
+    /// Construct.
+    explicit StaticModelCloud(Context* context);
+    /// Destruct.
+    ~StaticModelCloud() override;
+    /// Register object factory. Drawable must be registered first.
+    static void RegisterObject(Context* context);
+
+    /// Process octree raycast. May be called from a worker thread.
+    void ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results) override;
+    /// Update before octree reinsertion. Is called from a worker thread.
+    void Update(const FrameInfo& frame) override;
+    /// Calculate distance and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
+    void UpdateBatches(const FrameInfo& frame) override;
+    /// Return the geometry for a specific LOD level.
+    Geometry* GetLodGeometry(unsigned batchIndex, unsigned level) override;
+    /// Return batches for rendering into a shadow map split, with the instances culled against the shadow camera.
+    const Vector<SourceBatch>& GetShadowBatches(const FrameInfo& frame, Camera* shadowCamera) override;
+
+    /// Set model.
+    void SetModel(Model* model);
+    /// Set material on all geometries.
+    void SetMaterial(Material* material);
+    /// Set material on one geometry. Return true if successful.
+    bool SetMaterial(unsigned index, Material* material);
+    /// Set distance over which instances shrink away before reaching the draw distance. Zero disables fading.
+    void SetFadeDistance(float distance);
+    /// Add an instance with a transform relative to the scene node. Return its index.
+    unsigned AddInstance(const Matrix3x4& transform);
+    /// Set the transform of an instance.
+    void SetInstance(unsigned index, const Matrix3x4& transform);
+    /// Set all instance transforms.
+    void SetInstances(const PODVector<Matrix3x4>& transforms);
+    /// Remove an instance. The last instance is moved to its index.
+    void RemoveInstance(unsigned index);
+    /// Remove all instances.
+    void RemoveAllInstances();
+
+    /// Return model.
+    Model* GetModel() const { return model_; }
+
+    /// Return number of geometries.
+    unsigned GetNumGeometries() const { return geometries_.Size(); }
+
+    /// Return material by geometry index.
+    Material* GetMaterial(unsigned index = 0) const;
+
+    /// Return fade distance.
+    float GetFadeDistance() const { return fadeDistance_; }
+
+    /// Return number of instances.
+    unsigned GetNumInstances() const { return instances_.Size(); }
+
+    /// Return instance transform relative to the scene node.
+    const Matrix3x4& GetInstance(unsigned index) const { return index < instances_.Size() ? instances_[index] : Matrix3x4::IDENTITY; }
+
+    /// Return all instance transforms.
+    const PODVector<Matrix3x4>& GetInstances() const { return instances_; }
+
+    /// Return number of LOD bands. Each band selects one LOD level for every geometry.
+    unsigned GetNumLodBands() const { return lodThresholds_.Size() + 1; }
+
+    /// Return number of cells in the instance hierarchy.
+    unsigned GetNumCells() const { return cells_.Size(); }
+
+    /// Return number of instances visible to a camera on the current frame.
+    unsigned GetNumVisibleInstances(Camera* camera) const;
+
+    /// Set model attribute.
+    void SetModelAttr(const ResourceRef& value);
+    /// Set materials attribute.
+    void SetMaterialsAttr(const ResourceRefList& value);
+    /// Set instances attribute.
+    void SetInstancesAttr(const PODVector<unsigned char>& value);
+    /// Return model attribute.
+    ResourceRef GetModelAttr() const;
+    /// Return materials attribute.
+    const ResourceRefList& GetMaterialsAttr() const;
+    /// Return instances attribute.
+    PODVector<unsigned char> GetInstancesAttr() const;
+
+protected:
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override;
+
+private:
+    /// Rebuild instance bounds and the cell hierarchy if instances or the model have changed.
+    void UpdateCells();
+    /// Build a cell from a range of the cell instance list recursively.
+    void BuildCell(unsigned cellIndex, unsigned start, unsigned end, unsigned depth);
+    /// Set up LOD bands and batches after the model or materials change.
+    void UpdateLodBands();
+    /// Return the culling result for a camera on the current frame, culling the instances if not done yet.
+    StaticModelCloudView* GetView(const FrameInfo& frame, Camera* cullCamera);
+    /// Cull the instances against the camera of a culling result and sort the visible ones into LOD bands by distance to the view camera.
+    void CullInstances(StaticModelCloudView& view, const FrameInfo& frame);
+    /// Mark instances changed.
+    void MarkInstancesDirty();
+    /// Handle model reload finished.
+    void HandleModelReloadFinished(StringHash eventType, VariantMap& eventData);
+
+    /// Instance transforms relative to the scene node.
+    PODVector<Matrix3x4> instances_;
+    /// Instance bounding spheres relative to the scene node.
+    PODVector<Sphere> instanceSpheres_;
+    /// Cell hierarchy, root first.
+    PODVector<StaticModelCloudCell> cells_;
+    /// Instance indices in cell order.
+    PODVector<unsigned> cellInstances_;
+    /// Culling results per camera.
+    Vector<UniquePtr<StaticModelCloudView> > views_;
+    /// Batches returned for the last shadow map split.
+    Vector<SourceBatch> shadowBatches_;
+    /// All geometries.
+    Vector<Vector<SharedPtr<Geometry> > > geometries_;
+    /// Sorted LOD distances at which any geometry changes its LOD level.
+    PODVector<float> lodThresholds_;
+    /// Model.
+    SharedPtr<Model> model_;
+    /// Fade distance.
+    float fadeDistance_{};
+    /// Instances or model changed flag.
+    bool cellsDirty_{};
+    /// Mutex for the cell rebuild and culling results.
+    mutable Mutex mutex_;
+    /// Material list attribute.
+    mutable ResourceRefList materialsAttr_;
+};
+
+}
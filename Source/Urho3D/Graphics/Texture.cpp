@@ -223,6 +223,9 @@ void Texture::SetParameters(const XMLElement& element)
 
         if (name == "srgb")
             SetSRGB(paramElem.GetBool("enable"));
+
+        if (name == "streaming")
+            SetStreaming(paramElem.GetBool("enable"));
     }
 }
 
@@ -68,6 +68,10 @@ public:
     void SetBackupTexture(Texture* texture);
     /// Set mip levels to skip on a quality setting when loading. Ensures higher quality levels do not skip more.
     void SetMipsToSkip(int quality, int toSkip);
+    /// Set whether the texture may be streamed when texture streaming is enabled. Default true.
+    void SetStreaming(bool enable) { streaming_ = enable; }
+    /// Set mip levels to skip in addition to the quality setting when loading from an image. Used by texture streaming.
+    void SetStreamingMipsToSkip(unsigned toSkip) { streamingMipsToSkip_ = toSkip; }
 
     /// Return API-specific texture format.
     unsigned GetFormat() const { return format_; }
@@ -78,6 +82,9 @@ public:
     /// Return number of mip levels.
     unsigned GetLevels() const { return levels_; }
 
+    /// Return requested number of mip levels. 0 means a full mip chain.
+    unsigned GetRequestedLevels() const { return requestedLevels_; }
+
     /// Return width.
     int GetWidth() const { return width_; }
 
@@ -122,6 +129,13 @@ public:
 
     /// Return mip levels to skip on a quality setting when loading.
     int GetMipsToSkip(int quality) const;
+
+    /// Return whether the texture may be streamed.
+    bool GetStreaming() const { return streaming_; }
+
+    /// Return mip levels skipped by texture streaming.
+    unsigned GetStreamingMipsToSkip() const { return streamingMipsToSkip_; }
+
     /// Return mip level width, or 0 if level does not exist.
     int GetLevelWidth(unsigned level) const;
     /// Return mip level width, or 0 if level does not exist.
@@ -230,6 +244,10 @@ protected:
     unsigned anisotropy_{};
     /// Mip levels to skip when loading per texture quality setting.
     unsigned mipsToSkip_[MAX_TEXTURE_QUALITY_LEVELS]{2, 1, 0};
+    /// Mip levels to skip when loading in addition to the quality setting, set by texture streaming.
+    unsigned streamingMipsToSkip_{};
+    /// Whether texture streaming may be used.
+    bool streaming_{true};
     /// Border color.
     Color borderColor_;
     /// Multisampling level.
@@ -29,6 +29,7 @@
 #include "../Graphics/GraphicsImpl.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
@@ -101,6 +102,12 @@ bool Texture2D::EndLoad()
     CheckTextureBudget(GetTypeStatic());
 
     SetParameters(loadParameters_);
+
+    // Let texture streaming decide the mip levels to upload first
+    auto* streaming = GetSubsystem<TextureStreaming>();
+    if (streaming)
+        streaming->RegisterTexture(this, loadImage_);
+
     bool success = SetData(loadImage_);
 
     loadImage_.Reset();
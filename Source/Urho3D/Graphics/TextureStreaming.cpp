@@ -0,0 +1,449 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+#include "../Graphics/Camera.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreaming.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../Resource/Compress.h"
+#include "../Resource/Image.h"
+#include "../Resource/ResourceCache.h"
+
+#include <atomic>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// %Texture image load running on a worker thread.
+struct TextureStreamingLoad : public RefCounted
+{
+    /// Texture to upload to. Only accessed on the main thread.
+    WeakPtr<Texture2D> texture_;
+    /// Resource name of the texture.
+    String name_;
+    /// Mip levels to skip when uploading.
+    unsigned mipsToSkip_{};
+    /// Loaded image, or null if failed.
+    SharedPtr<Image> image_;
+    /// Work item.
+    SharedPtr<WorkItem> workItem_;
+    /// Completion flag.
+    std::atomic<bool> done_{};
+};
+
+unsigned long long TextureStreamingEntry::GetMemoryUse(unsigned mipsToSkip) const
+{
+    unsigned long long memory = 0;
+    for (unsigned i = mipsToSkip; i < levels_; ++i)
+    {
+        const unsigned width = (unsigned)Max(width_ >> i, 1);
+        const unsigned height = (unsigned)Max(height_ >> i, 1);
+        memory += (unsigned long long)((width + blockDim_ - 1) / blockDim_) * ((height + blockDim_ - 1) / blockDim_) * blockSize_;
+    }
+    return memory;
+}
+
+unsigned long long ComputeTextureResidency(PODVector<TextureStreamingEntry>& entries, unsigned long long budget, unsigned frameNumber)
+{
+    unsigned long long memoryUse = 0;
+    for (TextureStreamingEntry& entry : entries)
+    {
+        entry.targetMipsToSkip_ = Min(entry.desiredMipsToSkip_, entry.maxMipsToSkip_);
+        memoryUse += entry.GetMemoryUse(entry.targetMipsToSkip_);
+    }
+    if (!budget || memoryUse <= budget)
+        return memoryUse;
+
+    // Drop textures not drawn on this frame to their lowest residency, least recently used first
+    PODVector<unsigned> order;
+    for (unsigned i = 0; i < entries.Size(); ++i)
+    {
+        if (entries[i].lastUsedFrame_ != frameNumber && entries[i].targetMipsToSkip_ < entries[i].maxMipsToSkip_)
+            order.Push(i);
+    }
+    Sort(order.Begin(), order.End(), [&entries](unsigned lhs, unsigned rhs)
+    {
+        return entries[lhs].lastUsedFrame_ < entries[rhs].lastUsedFrame_;
+    });
+
+    for (unsigned index : order)
+    {
+        if (memoryUse <= budget)
+            return memoryUse;
+
+        TextureStreamingEntry& entry = entries[index];
+        memoryUse -= entry.GetMemoryUse(entry.targetMipsToSkip_);
+        entry.targetMipsToSkip_ = entry.maxMipsToSkip_;
+        memoryUse += entry.GetMemoryUse(entry.targetMipsToSkip_);
+    }
+
+    // Then drop drawn textures one level at a time, largest first, until within budget or nothing can be dropped
+    while (memoryUse > budget)
+    {
+        order.Clear();
+        for (unsigned i = 0; i < entries.Size(); ++i)
+        {
+            if (entries[i].targetMipsToSkip_ < entries[i].maxMipsToSkip_)
+                order.Push(i);
+        }
+        if (order.Empty())
+            break;
+
+        Sort(order.Begin(), order.End(), [&entries](unsigned lhs, unsigned rhs)
+        {
+            return entries[lhs].GetMemoryUse(entries[lhs].targetMipsToSkip_) > entries[rhs].GetMemoryUse(entries[rhs].targetMipsToSkip_);
+        });
+
+        for (unsigned index : order)
+        {
+            if (memoryUse <= budget)
+                break;
+
+            TextureStreamingEntry& entry = entries[index];
+            const unsigned long long current = entry.GetMemoryUse(entry.targetMipsToSkip_);
+            ++entry.targetMipsToSkip_;
+            memoryUse -= current - entry.GetMemoryUse(entry.targetMipsToSkip_);
+        }
+    }
+
+    return memoryUse;
+}
+
+TextureStreaming::TextureStreaming(Context* context) :
+    Object(context)
+{
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(TextureStreaming, HandleBeginFrame));
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(TextureStreaming, HandleEndFrame));
+}
+
+TextureStreaming::~TextureStreaming()
+{
+    // Loads reference this subsystem's data; remove them from the queue or wait for them to finish
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue)
+        return;
+
+    for (unsigned i = 0; i < loads_.Size(); ++i)
+    {
+        TextureStreamingLoad* load = loads_[i];
+        if (load->done_.load(std::memory_order_acquire) || queue->RemoveWorkItem(load->workItem_))
+            continue;
+        while (!load->done_.load(std::memory_order_acquire))
+            Time::Sleep(1);
+    }
+}
+
+void TextureStreaming::SetEnabled(bool enable)
+{
+    enabled_ = enable;
+}
+
+void TextureStreaming::SetBudget(unsigned long long budget)
+{
+    budget_ = budget;
+}
+
+void TextureStreaming::SetMinResidentSize(int size)
+{
+    minResidentSize_ = Max(size, 1);
+}
+
+void TextureStreaming::SetMaxLoads(unsigned num)
+{
+    maxLoads_ = Max(num, 1U);
+}
+
+void TextureStreaming::SetMipBias(float bias)
+{
+    mipBias_ = bias;
+}
+
+void TextureStreaming::RegisterTexture(Texture2D* texture, Image* image)
+{
+    if (!texture || !image)
+        return;
+
+    // A reloaded texture starts over from its smallest levels
+    HashMap<Texture*, unsigned>::Iterator i = textureIndices_.Find(texture);
+    if (i != textureIndices_.End())
+        RemoveTexture(i->second_);
+
+    texture->SetStreamingMipsToSkip(0);
+    if (!enabled_ || !texture->GetStreaming() || texture->GetRequestedLevels() == 1 || texture->GetName().Empty())
+        return;
+
+    auto* renderer = GetSubsystem<Renderer>();
+    auto* graphics = GetSubsystem<Graphics>();
+    const unsigned qualityMipsToSkip = (unsigned)texture->GetMipsToSkip(renderer ? renderer->GetTextureQuality() : QUALITY_HIGH);
+
+    // Size and mip levels remaining after the quality setting, skipped the same way as when uploading
+    TextureStreamingEntry entry;
+    int width = image->GetWidth();
+    int height = image->GetHeight();
+    unsigned levels;
+    unsigned skip = qualityMipsToSkip;
+    const bool compressed = image->IsCompressed();
+    if (compressed)
+    {
+        levels = image->GetNumCompressedLevels();
+        if (!levels || !GetCompressedBlockSize(image->GetCompressedFormat()))
+            return;
+
+        if (graphics && graphics->GetFormat(image->GetCompressedFormat()))
+        {
+            entry.blockDim_ = 4;
+            entry.blockSize_ = GetCompressedBlockSize(image->GetCompressedFormat());
+        }
+        else
+            entry.blockSize_ = 4;
+
+        skip = Min(skip, levels - 1);
+        while (skip && ((width >> skip) < 4 || (height >> skip) < 4))
+            --skip;
+        levels -= skip;
+    }
+    else
+    {
+        entry.blockSize_ = image->GetComponents();
+        levels = LogBaseTwo((unsigned)Max(Max(width >> skip, height >> skip), 1)) + 1;
+    }
+    entry.width_ = Max(width >> skip, 1);
+    entry.height_ = Max(height >> skip, 1);
+    entry.levels_ = levels;
+
+    unsigned maxMipsToSkip = 0;
+    while (maxMipsToSkip + 1 < levels && Max(entry.width_ >> maxMipsToSkip, entry.height_ >> maxMipsToSkip) > minResidentSize_)
+    {
+        if (compressed && ((entry.width_ >> (maxMipsToSkip + 1)) < 4 || (entry.height_ >> (maxMipsToSkip + 1)) < 4))
+            break;
+        ++maxMipsToSkip;
+    }
+    if (!maxMipsToSkip)
+        return;
+
+    entry.maxMipsToSkip_ = maxMipsToSkip;
+    entry.desiredMipsToSkip_ = maxMipsToSkip;
+    entry.residentMipsToSkip_ = maxMipsToSkip;
+    entry.targetMipsToSkip_ = maxMipsToSkip;
+    texture->SetStreamingMipsToSkip(maxMipsToSkip);
+
+    StreamedTexture streamed;
+    streamed.texture_ = texture;
+    streamed.key_ = texture;
+    textureIndices_[texture] = textures_.Size();
+    textures_.Push(streamed);
+    entries_.Push(entry);
+}
+
+void TextureStreaming::RequestTexture(Texture* texture, float screenSize)
+{
+    HashMap<Texture*, unsigned>::Iterator i = textureIndices_.Find(texture);
+    if (i == textureIndices_.End())
+        return;
+
+    TextureStreamingEntry& entry = entries_[i->second_];
+    const float size = (float)Max(entry.width_, entry.height_);
+    const float level = screenSize > 0.0f ? log2f(size / screenSize) + mipBias_ : (float)entry.maxMipsToSkip_;
+    const auto mipsToSkip = (unsigned)Clamp((int)floorf(level), 0, (int)entry.maxMipsToSkip_);
+
+    // Keep the most detailed level requested during the frame
+    if (entry.lastUsedFrame_ != frameNumber_)
+    {
+        entry.desiredMipsToSkip_ = mipsToSkip;
+        entry.lastUsedFrame_ = frameNumber_;
+    }
+    else
+        entry.desiredMipsToSkip_ = Min(entry.desiredMipsToSkip_, mipsToSkip);
+}
+
+void TextureStreaming::RequestMaterial(Material* material, float screenSize)
+{
+    if (!material || textureIndices_.Empty())
+        return;
+
+    const HashMap<TextureUnit, SharedPtr<Texture> >& textures = material->GetTextures();
+    for (HashMap<TextureUnit, SharedPtr<Texture> >::ConstIterator i = textures.Begin(); i != textures.End(); ++i)
+        RequestTexture(i->second_, screenSize);
+}
+
+unsigned long long TextureStreaming::GetMemoryUse() const
+{
+    unsigned long long memoryUse = 0;
+    for (const TextureStreamingEntry& entry : entries_)
+        memoryUse += entry.GetMemoryUse(entry.residentMipsToSkip_);
+    return memoryUse;
+}
+
+float TextureStreaming::GetScreenSize(const BoundingBox& box, float distance, Camera* camera, int viewHeight)
+{
+    const float size = box.Size().Length() * (float)viewHeight * 0.5f / camera->GetHalfViewSize();
+    return camera->IsOrthographic() ? size : size / Max(distance, camera->GetNearClip());
+}
+
+void TextureStreaming::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    using namespace BeginFrame;
+
+    frameNumber_ = eventData[P_FRAMENUMBER].GetUInt();
+}
+
+void TextureStreaming::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    FinishLoads();
+
+    for (unsigned i = textures_.Size() - 1; i < textures_.Size(); --i)
+    {
+        if (textures_[i].texture_.Expired())
+            RemoveTexture(i);
+    }
+
+    if (entries_.Empty())
+        return;
+
+    URHO3D_PROFILE("UpdateTextureStreaming");
+
+    ComputeTextureResidency(entries_, budget_, frameNumber_);
+    StartLoads();
+}
+
+void TextureStreaming::FinishLoads()
+{
+    for (unsigned i = 0; i < loads_.Size();)
+    {
+        TextureStreamingLoad* load = loads_[i];
+        if (!load->done_.load(std::memory_order_acquire))
+        {
+            ++i;
+            continue;
+        }
+
+        Texture2D* texture = load->texture_;
+        HashMap<Texture*, unsigned>::Iterator j = texture ? textureIndices_.Find(texture) : textureIndices_.End();
+        if (j != textureIndices_.End())
+        {
+            const unsigned index = j->second_;
+            textures_[index].loading_ = false;
+
+            if (!load->image_)
+                URHO3D_LOGERROR("Failed to load " + load->name_ + " for texture streaming");
+            else
+            {
+                texture->SetStreamingMipsToSkip(load->mipsToSkip_);
+                if (texture->SetData(load->image_))
+                    entries_[index].residentMipsToSkip_ = load->mipsToSkip_;
+                else
+                    texture->SetStreamingMipsToSkip(entries_[index].residentMipsToSkip_);
+            }
+        }
+
+        loads_.Erase(i);
+    }
+}
+
+void TextureStreaming::StartLoads()
+{
+    // Dropping detail to relieve memory goes before adding detail
+    for (unsigned pass = 0; pass < 2; ++pass)
+    {
+        for (unsigned i = 0; i < entries_.Size() && loads_.Size() < maxLoads_; ++i)
+        {
+            const TextureStreamingEntry& entry = entries_[i];
+            if (textures_[i].loading_ || entry.targetMipsToSkip_ == entry.residentMipsToSkip_)
+                continue;
+            if ((pass == 0) == (entry.targetMipsToSkip_ > entry.residentMipsToSkip_))
+                StartLoad(i, entry.targetMipsToSkip_);
+        }
+    }
+}
+
+void TextureStreaming::StartLoad(unsigned index, unsigned mipsToSkip)
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    auto* cache = GetSubsystem<ResourceCache>();
+    if (!queue || !cache)
+        return;
+
+    SharedPtr<TextureStreamingLoad> load(new TextureStreamingLoad());
+    load->texture_ = textures_[index].texture_;
+    load->name_ = load->texture_->GetName();
+    load->mipsToSkip_ = mipsToSkip;
+    textures_[index].loading_ = true;
+
+    // The worker only touches the name, image and completion flag, the main thread keeps the load alive until done
+    TextureStreamingLoad* loadPtr = load.Get();
+    Context* context = context_;
+    load->workItem_ = queue->AddWorkItem([loadPtr, context, cache]()
+    {
+        SharedPtr<File> file = cache->GetFile(loadPtr->name_);
+        if (file)
+        {
+            SharedPtr<Image> image(new Image(context));
+            if (image->Load(*file))
+            {
+                // Calculate the mip levels here rather than when uploading on the main thread
+                image->PrecalculateLevels();
+                loadPtr->image_ = image;
+            }
+        }
+        loadPtr->done_.store(true, std::memory_order_release);
+    });
+
+    loads_.Push(load);
+}
+
+void TextureStreaming::RemoveTexture(unsigned index)
+{
+    // A load in progress finishes but is not uploaded
+    Texture2D* texture = textures_[index].texture_;
+    for (unsigned i = 0; i < loads_.Size(); ++i)
+    {
+        if (texture && loads_[i]->texture_ == texture)
+            loads_[i]->texture_.Reset();
+    }
+
+    textureIndices_.Erase(textures_[index].key_);
+    const unsigned last = textures_.Size() - 1;
+    if (index != last)
+    {
+        textures_[index] = textures_[last];
+        entries_[index] = entries_[last];
+        textureIndices_[textures_[index].key_] = index;
+    }
+    textures_.Pop();
+    entries_.Pop();
+}
+
+}
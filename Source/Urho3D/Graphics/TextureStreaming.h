@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Core/Object.h"
+
+namespace Urho3D
+{
+
+class BoundingBox;
+class Camera;
+class Image;
+class Material;
+class Texture;
+class Texture2D;
+struct TextureStreamingLoad;
+
+/// Default largest mip level dimension uploaded when a streamed texture is first loaded.
+static const int TEXTURE_STREAMING_DEFAULT_MIN_RESIDENT_SIZE = 64;
+/// Default number of textures loaded at the same time by texture streaming.
+static const unsigned TEXTURE_STREAMING_DEFAULT_MAX_LOADS = 4;
+
+/// Mip residency state of a streamed texture, used by the residency policy.
+struct URHO3D_API TextureStreamingEntry
+{
+    /// Return GPU memory use when skipping a number of mip levels.
+    unsigned long long GetMemoryUse(unsigned mipsToSkip) const;
+
+    /// Width of the most detailed mip level.
+    int width_{};
+    /// Height of the most detailed mip level.
+    int height_{};
+    /// Number of mip levels.
+    unsigned levels_{};
+    /// Block dimension in pixels: 4 for block compressed formats, 1 otherwise.
+    unsigned blockDim_{1};
+    /// Size of a block in bytes.
+    unsigned blockSize_{4};
+    /// Most mip levels that can be skipped. This is the residency when first loaded.
+    unsigned maxMipsToSkip_{};
+    /// Mip levels to skip for the screen size the texture was last drawn at.
+    unsigned desiredMipsToSkip_{};
+    /// Mip levels to skip currently uploaded.
+    unsigned residentMipsToSkip_{};
+    /// Mip levels to skip decided by the residency policy.
+    unsigned targetMipsToSkip_{};
+    /// Frame number the texture was last drawn on.
+    unsigned lastUsedFrame_{};
+};
+
+/// Decide the mip levels to keep resident within a GPU memory budget, setting the target of each entry. Textures first target their desired levels. When that is over budget, textures not drawn on the given frame drop to their lowest residency, least recently used first, and then drawn textures drop one level at a time, largest first. A budget of 0 is unlimited. Return the memory use of the targets.
+URHO3D_API unsigned long long ComputeTextureResidency(PODVector<TextureStreamingEntry>& entries, unsigned long long budget, unsigned frameNumber);
+
+/// Bookkeeping of a streamed texture.
+struct StreamedTexture
+{
+    /// Texture.
+    WeakPtr<Texture2D> texture_;
+    /// Texture pointer used as the lookup key, valid also after the texture has been destroyed.
+    Texture* key_{};
+    /// Whether a load is in progress.
+    bool loading_{};
+};
+
+/// %Texture streaming subsystem. 2D textures loaded as resources first upload only their small mip levels, and more detailed levels are loaded on worker threads according to the screen size they are drawn at, within a GPU memory budget. Textures drawn outside of views, such as by the UI, are not seen by streaming and should disable it in their parameter file.
+class URHO3D_API TextureStreaming : public Object
+{
+    URHO3D_OBJECT(TextureStreaming, Object);
+
+public:
+    /// Construct.
+    explicit TextureStreaming(Context* context);
+    /// Destruct. Wait for loads in progress.
+    ~TextureStreaming() override;
+
+    /// Set whether textures loaded from now on are streamed. Disabled by default.
+    void SetEnabled(bool enable);
+    /// Set GPU memory budget of streamed textures in bytes. 0 is unlimited.
+    void SetBudget(unsigned long long budget);
+    /// Set largest mip level dimension uploaded when a texture is first loaded.
+    void SetMinResidentSize(int size);
+    /// Set number of textures loaded at the same time.
+    void SetMaxLoads(unsigned num);
+    /// Set bias added to the desired mip level. Positive values load less detail.
+    void SetMipBias(float bias);
+
+    /// Register a 2D texture about to be uploaded from an image and set the mip levels it skips. Called by Texture2D when loading.
+    void RegisterTexture(Texture2D* texture, Image* image);
+    /// Report the screen size in pixels of an object drawn with a texture on this frame.
+    void RequestTexture(Texture* texture, float screenSize);
+    /// Report the screen size in pixels of an object drawn with a material on this frame.
+    void RequestMaterial(Material* material, float screenSize);
+
+    /// Return whether enabled.
+    bool IsEnabled() const { return enabled_; }
+
+    /// Return GPU memory budget.
+    unsigned long long GetBudget() const { return budget_; }
+
+    /// Return largest mip level dimension uploaded when a texture is first loaded.
+    int GetMinResidentSize() const { return minResidentSize_; }
+
+    /// Return number of textures loaded at the same time.
+    unsigned GetMaxLoads() const { return maxLoads_; }
+
+    /// Return mip bias.
+    float GetMipBias() const { return mipBias_; }
+
+    /// Return number of streamed textures.
+    unsigned GetNumTextures() const { return entries_.Size(); }
+
+    /// Return number of loads in progress.
+    unsigned GetNumLoads() const { return loads_.Size(); }
+
+    /// Return GPU memory use of the resident mip levels of streamed textures.
+    unsigned long long GetMemoryUse() const;
+
+    /// Return screen height in pixels of a bounding box at a distance from a camera, for a view of the given height.
+    static float GetScreenSize(const BoundingBox& box, float distance, Camera* camera, int viewHeight);
+
+private:
+    /// Handle beginning of frame. Store the frame number.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Handle end of frame. Update residency and loads.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+    /// Upload finished loads.
+    void FinishLoads();
+    /// Start loads towards the residency targets.
+    void StartLoads();
+    /// Start loading a texture with a number of mip levels to skip.
+    void StartLoad(unsigned index, unsigned mipsToSkip);
+    /// Remove a texture.
+    void RemoveTexture(unsigned index);
+
+    /// Streamed textures.
+    Vector<StreamedTexture> textures_;
+    /// Residency state of the streamed textures.
+    PODVector<TextureStreamingEntry> entries_;
+    /// Index of each streamed texture.
+    HashMap<Texture*, unsigned> textureIndices_;
+    /// Loads in progress.
+    Vector<SharedPtr<TextureStreamingLoad> > loads_;
+    /// Budget in bytes.
+    unsigned long long budget_{};
+    /// Current frame number.
+    unsigned frameNumber_{};
+    /// Largest mip level dimension uploaded when first loaded.
+    int minResidentSize_{TEXTURE_STREAMING_DEFAULT_MIN_RESIDENT_SIZE};
+    /// Number of textures loaded at the same time.
+    unsigned maxLoads_{TEXTURE_STREAMING_DEFAULT_MAX_LOADS};
+    /// Mip bias.
+    float mipBias_{};
+    /// Enabled flag.
+    bool enabled_{};
+};
+
+}
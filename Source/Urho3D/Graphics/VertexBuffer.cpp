@@ -85,6 +85,7 @@ bool VertexBuffer::SetSize(unsigned vertexCount, const PODVector<VertexElement>&
         shadowData_ = new unsigned char[vertexCount_ * vertexSize_];
     else
         shadowData_.Reset();
+    ++dataRevision_;
 
     return Create();
 }
@@ -110,6 +110,9 @@ public:
     /// Return shared array pointer to the CPU memory shadow data.
     SharedArrayPtr<unsigned char> GetShadowDataShared() const { return shadowData_; }
 
+    /// Return shadow data revision. Incremented whenever the shadow data is resized or rewritten.
+    unsigned GetDataRevision() const { return dataRevision_; }
+
     /// Return buffer hash for building vertex declarations. Used internally.
     unsigned long long GetBufferHash(unsigned streamIndex) { return elementHash_ << (streamIndex * 16); }
 
@@ -172,6 +175,8 @@ private:
     bool shadowed_{};
     /// Discard lock flag. Used by OpenGL only.
     bool discardLock_{};
+    /// Shadow data revision.
+    unsigned dataRevision_{};
 };
 
 }
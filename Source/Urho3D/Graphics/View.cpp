@@ -42,6 +42,7 @@
 #include "../Graphics/Texture2DArray.h"
 #include "../Graphics/Texture3D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../IO/FileSystem.h"
@@ -274,7 +275,43 @@ void SortShadowQueueWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* start = reinterpret_cast<LightBatchQueue*>(item->start_);
     for (unsigned i = 0; i < start->shadowSplits_.Size(); ++i)
+    {
         start->shadowSplits_[i].shadowBatches_.SortFrontToBack();
+        start->shadowSplits_[i].staticShadowBatches_.SortFrontToBack();
+    }
+}
+
+void RecordCommandBufferWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* buffer = reinterpret_cast<RenderCommandBuffer*>(item->start_);
+    auto* queue = reinterpret_cast<const BatchQueue*>(item->end_);
+    auto* renderer = reinterpret_cast<Renderer*>(item->aux_);
+
+    queue->Record(*buffer, renderer);
+}
+
+/// Number of frames a shadow caster must stay unchanged to be drawn into a cached static shadow map.
+static const unsigned STATIC_SHADOW_CASTER_FRAMES = 30;
+
+/// Return whether a shadow caster has stayed unchanged long enough to be drawn into a cached static shadow map.
+static bool IsStaticShadowCaster(Drawable* drawable, unsigned frameNumber)
+{
+    return frameNumber - drawable->GetUpdateFrameNumber() > STATIC_SHADOW_CASTER_FRAMES &&
+        drawable->GetUpdateGeometryType() == UPDATE_NONE;
+}
+
+/// Return a hash of a shadow caster and its geometries and materials, mixed so that summing them does not depend on the order.
+static unsigned long long GetShadowCasterHash(Drawable* drawable)
+{
+    auto hash = (unsigned long long)(size_t)drawable;
+    const Vector<SourceBatch>& batches = drawable->GetBatches();
+    for (unsigned i = 0; i < batches.Size(); ++i)
+        hash = hash * 31 + ((size_t)batches[i].geometry_ ^ (size_t)batches[i].material_.Get());
+
+    hash ^= hash >> 33u;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33u;
+    return hash;
 }
 
 StringHash ParseTextureTypeXml(ResourceCache* cache, const String& filename);
@@ -576,8 +613,9 @@ void View::Render()
     AllocateScreenBuffers();
     SendViewEvent(E_VIEWBUFFERSREADY);
 
-    // Forget parameter sources from the previous view
+    // Forget parameter sources from the previous view, and parameter blocks from the previous frame
     graphics_->ClearParameterSources();
+    shaderParameterBlocks_.Clear();
 
     if (renderer_->GetDynamicInstancing() && graphics_->GetInstancingSupport())
         PrepareInstancingBuffer();
@@ -606,7 +644,8 @@ void View::Render()
 #endif
     }
 
-    // Render
+    // Record draw commands now that the camera is final, then render
+    RecordCommandBuffers();
     ExecuteRenderPathCommands();
 
     // Reset state after commands
@@ -688,19 +727,36 @@ void View::SetCameraShaderParameters(Camera* camera)
     if (!camera)
         return;
 
+    // The projection includes the constant depth bias on OpenGL, so blocks are built per bias value
+    float depthConstantBias = graphics_->GetDepthConstantBias();
+    unsigned biasBits;
+    memcpy(&biasBits, &depthConstantBias, sizeof biasBits);
+    ShaderParameterBlock& block = GetShaderParameterBlock(camera, reinterpret_cast<const void*>((size_t)biasBits));
+    if (block.IsEmpty())
+        BuildCameraShaderParameters(block, camera);
+
+    graphics_->SetShaderParameters(block);
+
+    // If in a scene pass and the command defines shader parameters, set them now
+    if (passCommand_)
+        SetCommandShaderParameters(*passCommand_);
+}
+
+void View::BuildCameraShaderParameters(ShaderParameterBlock& block, Camera* camera)
+{
     Matrix3x4 cameraEffectiveTransform = camera->GetEffectiveWorldTransform();
 
-    graphics_->SetShaderParameter(VSP_CAMERAPOS, cameraEffectiveTransform.Translation());
-    graphics_->SetShaderParameter(VSP_VIEWINV, cameraEffectiveTransform);
-    graphics_->SetShaderParameter(VSP_VIEW, camera->GetView());
-    graphics_->SetShaderParameter(PSP_CAMERAPOS, cameraEffectiveTransform.Translation());
+    block.AddParameter(VSP_CAMERAPOS, cameraEffectiveTransform.Translation());
+    block.AddParameter(VSP_VIEWINV, cameraEffectiveTransform);
+    block.AddParameter(VSP_VIEW, camera->GetView());
+    block.AddParameter(PSP_CAMERAPOS, cameraEffectiveTransform.Translation());
 
     float nearClip = camera->GetNearClip();
     float farClip = camera->GetFarClip();
-    graphics_->SetShaderParameter(VSP_NEARCLIP, nearClip);
-    graphics_->SetShaderParameter(VSP_FARCLIP, farClip);
-    graphics_->SetShaderParameter(PSP_NEARCLIP, nearClip);
-    graphics_->SetShaderParameter(PSP_FARCLIP, farClip);
+    block.AddParameter(VSP_NEARCLIP, nearClip);
+    block.AddParameter(VSP_FARCLIP, farClip);
+    block.AddParameter(PSP_NEARCLIP, nearClip);
+    block.AddParameter(PSP_FARCLIP, farClip);
 
     Vector4 depthMode = Vector4::ZERO;
     if (camera->IsOrthographic())
@@ -716,16 +772,16 @@ void View::SetCameraShaderParameters(Camera* camera)
     else
         depthMode.w_ = 1.0f / camera->GetFarClip();
 
-    graphics_->SetShaderParameter(VSP_DEPTHMODE, depthMode);
+    block.AddParameter(VSP_DEPTHMODE, depthMode);
 
     Vector4 depthReconstruct
         (farClip / (farClip - nearClip), -nearClip / (farClip - nearClip), camera->IsOrthographic() ? 1.0f : 0.0f,
             camera->IsOrthographic() ? 0.0f : 1.0f);
-    graphics_->SetShaderParameter(PSP_DEPTHRECONSTRUCT, depthReconstruct);
+    block.AddParameter(PSP_DEPTHRECONSTRUCT, depthReconstruct);
 
     Vector3 nearVector, farVector;
     camera->GetFrustumSize(nearVector, farVector);
-    graphics_->SetShaderParameter(VSP_FRUSTUMSIZE, farVector);
+    block.AddParameter(VSP_FRUSTUMSIZE, farVector);
 
     Matrix4 projection = camera->GetGPUProjection();
 #ifdef URHO3D_OPENGL
@@ -735,11 +791,7 @@ void View::SetCameraShaderParameters(Camera* camera)
     projection.m23_ += projection.m33_ * constantBias;
 #endif
 
-    graphics_->SetShaderParameter(VSP_VIEWPROJ, projection * camera->GetView());
-
-    // If in a scene pass and the command defines shader parameters, set them now
-    if (passCommand_)
-        SetCommandShaderParameters(*passCommand_);
+    block.AddParameter(VSP_VIEWPROJ, projection * camera->GetView());
 }
 
 void View::SetCommandShaderParameters(const RenderPathCommand& command)
@@ -850,6 +902,7 @@ void View::GetDrawables()
     }
     else
         occluders_.Clear();
+    frame_.occlusionBuffer_ = occlusionBuffer_;
 
     // Get lights and geometries. Coarse occlusion for octants is used at this point
     if (occlusionBuffer_)
@@ -1057,16 +1110,37 @@ void View::GetLightBatches()
                     shadowQueue.nearSplit_ = query.shadowNearSplits_[j];
                     shadowQueue.farSplit_ = query.shadowFarSplits_[j];
                     shadowQueue.shadowBatches_.Clear(maxSortedInstances);
+                    shadowQueue.staticShadowBatches_.Clear(maxSortedInstances);
 
                     // Setup the shadow split viewport and finalize shadow camera parameters
                     shadowQueue.shadowViewport_ = GetShadowMapViewport(light, j, lightQueue.shadowMap_);
                     FinalizeShadowCamera(shadowCamera, light, shadowQueue.shadowViewport_, query.shadowCasterBox_[j]);
+                }
+
+                // Use the light's cached shadow map for static casters if possible. They need no batches only when the cached
+                // map is up to date and used as is; otherwise they are rendered into it, or directly if copying it fails
+                lightQueue.shadowMapCache_ = nullptr;
+                if (shadowSplits > 0)
+                    SetupShadowMapCache(lightQueue, query);
+                CachedShadowMap* shadowMapCache = lightQueue.shadowMapCache_;
+
+                for (unsigned j = 0; j < shadowSplits; ++j)
+                {
+                    ShadowBatchQueue& shadowQueue = lightQueue.shadowSplits_[j];
 
                     // Loop through shadow casters
                     for (PODVector<Drawable*>::ConstIterator k = query.shadowCasters_.Begin() + query.shadowCasterBegin_[j];
                          k < query.shadowCasters_.Begin() + query.shadowCasterEnd_[j]; ++k)
                     {
                         Drawable* drawable = *k;
+                        BatchQueue* destQueue = &shadowQueue.shadowBatches_;
+                        if (shadowMapCache && IsStaticShadowCaster(drawable, frame_.frameNumber_))
+                        {
+                            if (shadowMapCache->valid_ && lightQueue.shadowMap_ == shadowMapCache->texture_)
+                                continue;
+                            destQueue = &shadowQueue.staticShadowBatches_;
+                        }
+
                         // If drawable is not in actual view frustum, mark it in view here and check its geometry update type
                         if (!drawable->IsInView(frame_, true))
                         {
@@ -1078,7 +1152,7 @@ void View::GetLightBatches()
                                 threadedGeometries_.Push(drawable);
                         }
 
-                        const Vector<SourceBatch>& batches = drawable->GetBatches();
+                        const Vector<SourceBatch>& batches = drawable->GetShadowBatches(frame_, shadowQueue.shadowCamera_);
 
                         for (unsigned l = 0; l < batches.Size(); ++l)
                         {
@@ -1097,7 +1171,7 @@ void View::GetLightBatches()
                             destBatch.pass_ = pass;
                             destBatch.zone_ = nullptr;
 
-                            AddBatchToQueue(shadowQueue.shadowBatches_, destBatch, tech);
+                            AddBatchToQueue(*destQueue, destBatch, tech);
                         }
                     }
                 }
@@ -1175,6 +1249,10 @@ void View::GetBaseBatches()
 {
     URHO3D_PROFILE("GetBaseBatches");
 
+    auto* textureStreaming = GetSubsystem<TextureStreaming>();
+    if (textureStreaming && !textureStreaming->GetNumTextures())
+        textureStreaming = nullptr;
+
     for (PODVector<Drawable*>::ConstIterator i = geometries_.Begin(); i != geometries_.End(); ++i)
     {
         Drawable* drawable = *i;
@@ -1187,6 +1265,10 @@ void View::GetBaseBatches()
         const Vector<SourceBatch>& batches = drawable->GetBatches();
         bool vertexLightsProcessed = false;
 
+        // Report the screen size of the drawable for the textures of its materials
+        const float screenSize = textureStreaming ?
+            TextureStreaming::GetScreenSize(drawable->GetWorldBoundingBox(), drawable->GetDistance(), cullCamera_, viewSize_.y_) : 0.0f;
+
         for (unsigned j = 0; j < batches.Size(); ++j)
         {
             const SourceBatch& srcBatch = batches[j];
@@ -1200,6 +1282,9 @@ void View::GetBaseBatches()
             if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
                 continue;
 
+            if (textureStreaming)
+                textureStreaming->RequestMaterial(srcBatch.material_, screenSize);
+
             // Check each of the scene passes
             for (unsigned k = 0; k < scenePasses_.Size(); ++k)
             {
@@ -1240,6 +1325,7 @@ void View::GetBaseBatches()
                             i = vertexLightQueues_.Insert(MakePair(hash, LightBatchQueue()));
                             i->second_.light_ = nullptr;
                             i->second_.shadowMap_ = nullptr;
+                            i->second_.shadowMapCache_ = nullptr;
                             i->second_.vertexLights_ = drawableVertexLights;
                         }
 
@@ -1429,6 +1515,98 @@ void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQ
     }
 }
 
+void View::RecordCommandBuffers()
+{
+    queueCommandBuffers_.Clear();
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!renderer_->GetThreadedCommandRecording() || !queue->GetNumThreads())
+        return;
+
+    View* actualView = sourceView_ ? sourceView_ : this;
+
+    // Reserve buffers for every queue up front so that pointers to them stay valid
+    unsigned maxBuffers = actualView->batchQueues_.Size();
+    for (Vector<LightBatchQueue>::ConstIterator i = actualView->lightQueues_.Begin(); i != actualView->lightQueues_.End(); ++i)
+        maxBuffers += 2 + 2 * i->shadowSplits_.Size();
+    if (commandBuffers_.Size() < maxBuffers)
+        commandBuffers_.Resize(maxBuffers);
+
+    // Recording reads matrices and zone ambient gradients that are calculated on demand. Calculate them now so that the
+    // workers only read them
+    if (camera_)
+    {
+        camera_->GetView();
+        camera_->GetProjection();
+    }
+    auto prepareZone = [](Zone* zone)
+    {
+        zone->GetInverseWorldTransform();
+        zone->GetAmbientStartColor();
+        zone->GetAmbientEndColor();
+    };
+    for (PODVector<Zone*>::ConstIterator i = actualView->zones_.Begin(); i != actualView->zones_.End(); ++i)
+        prepareZone(*i);
+    if (actualView->cameraZone_)
+        prepareZone(actualView->cameraZone_);
+    if (actualView->farClipZone_)
+        prepareZone(actualView->farClipZone_);
+    prepareZone(renderer_->GetDefaultZone());
+
+    URHO3D_PROFILE("RecordCommandBuffers");
+
+    unsigned numBuffers = 0;
+    auto recordQueue = [&](const BatchQueue& batchQueue, Camera* camera, bool usingLightOptimization)
+    {
+        if (batchQueue.IsEmpty() || !camera)
+            return;
+
+        RenderCommandBuffer* buffer = &commandBuffers_[numBuffers++];
+        buffer->Reset(camera, usingLightOptimization);
+        queueCommandBuffers_[&batchQueue] = buffer;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = RecordCommandBufferWork;
+        item->start_ = buffer;
+        item->end_ = const_cast<BatchQueue*>(&batchQueue);
+        item->aux_ = renderer_;
+        queue->AddWorkItem(item);
+    };
+
+    for (HashMap<unsigned, BatchQueue>::ConstIterator i = actualView->batchQueues_.Begin(); i != actualView->batchQueues_.End(); ++i)
+        recordQueue(i->second_, camera_, false);
+
+    for (Vector<LightBatchQueue>::ConstIterator i = actualView->lightQueues_.Begin(); i != actualView->lightQueues_.End(); ++i)
+    {
+        recordQueue(i->litBaseBatches_, camera_, false);
+        recordQueue(i->litBatches_, camera_, true);
+
+        if (!drawShadows_ || !i->shadowMap_)
+            continue;
+        for (unsigned j = 0; j < i->shadowSplits_.Size(); ++j)
+        {
+            Camera* shadowCamera = i->shadowSplits_[j].shadowCamera_;
+            shadowCamera->GetView();
+            shadowCamera->GetProjection();
+            recordQueue(i->shadowSplits_[j].shadowBatches_, shadowCamera, false);
+            recordQueue(i->shadowSplits_[j].staticShadowBatches_, shadowCamera, false);
+        }
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+void View::DrawBatchQueue(const BatchQueue& queue, Camera* camera, bool markToStencil, bool usingLightOptimization,
+    bool allowDepthWrite)
+{
+    HashMap<const BatchQueue*, RenderCommandBuffer*>::ConstIterator i = queueCommandBuffers_.Find(&queue);
+    if (i != queueCommandBuffers_.End() && i->second_->GetCamera() == camera)
+        i->second_->Execute(this, markToStencil, allowDepthWrite);
+    else
+        queue.Draw(this, camera, markToStencil, usingLightOptimization, allowDepthWrite);
+}
+
 void View::ExecuteRenderPathCommands()
 {
     View* actualView = sourceView_ ? sourceView_ : this;
@@ -1578,7 +1756,7 @@ void View::ExecuteRenderPathCommands()
                             passCommand_ = &command;
                         }
 
-                        queue.Draw(this, camera_, command.markToStencil_, false, allowDepthWrite);
+                        DrawBatchQueue(queue, camera_, command.markToStencil_, false, allowDepthWrite);
 
                         passCommand_ = nullptr;
                     }
@@ -1623,7 +1801,7 @@ void View::ExecuteRenderPathCommands()
                         }
 
                         // Draw base (replace blend) batches first
-                        i->litBaseBatches_.Draw(this, camera_, false, false, allowDepthWrite);
+                        DrawBatchQueue(i->litBaseBatches_, camera_, false, false, allowDepthWrite);
 
                         // Then, if there are additive passes, optimize the light and draw them
                         if (!i->litBatches_.IsEmpty())
@@ -1631,7 +1809,7 @@ void View::ExecuteRenderPathCommands()
                             renderer_->OptimizeLightByScissor(i->light_, camera_);
                             if (!noStencil_)
                                 renderer_->OptimizeLightByStencil(i->light_, camera_);
-                            i->litBatches_.Draw(this, camera_, false, true, allowDepthWrite);
+                            DrawBatchQueue(i->litBatches_, camera_, false, true, allowDepthWrite);
                         }
 
                         passCommand_ = nullptr;
@@ -2953,7 +3131,10 @@ void View::PrepareInstancingBuffer()
     for (Vector<LightBatchQueue>::Iterator i = lightQueues_.Begin(); i != lightQueues_.End(); ++i)
     {
         for (unsigned j = 0; j < i->shadowSplits_.Size(); ++j)
+        {
             totalInstances += i->shadowSplits_[j].shadowBatches_.GetNumInstances();
+            totalInstances += i->shadowSplits_[j].staticShadowBatches_.GetNumInstances();
+        }
         totalInstances += i->litBaseBatches_.GetNumInstances();
         totalInstances += i->litBatches_.GetNumInstances();
     }
@@ -2974,7 +3155,10 @@ void View::PrepareInstancingBuffer()
     for (Vector<LightBatchQueue>::Iterator i = lightQueues_.Begin(); i != lightQueues_.End(); ++i)
     {
         for (unsigned j = 0; j < i->shadowSplits_.Size(); ++j)
+        {
             i->shadowSplits_[j].shadowBatches_.SetInstancingData(dest, stride, freeIndex);
+            i->shadowSplits_[j].staticShadowBatches_.SetInstancingData(dest, stride, freeIndex);
+        }
         i->litBaseBatches_.SetInstancingData(dest, stride, freeIndex);
         i->litBatches_.SetInstancingData(dest, stride, freeIndex);
     }
@@ -3031,6 +3215,67 @@ void View::SetupLightVolumeBatch(Batch& batch)
         graphics_->SetStencilTest(false);
 }
 
+void View::SetupShadowMapCache(LightBatchQueue& lightQueue, const LightQueryResult& query)
+{
+    lightQueue.shadowMapCache_ = nullptr;
+    if (!renderer_->GetShadowMapCaching() || lightQueue.shadowMap_->GetUsage() != TEXTURE_DEPTHSTENCIL)
+        return;
+
+    // Describe what the static part of the shadow map would be rendered with
+    Light* light = lightQueue.light_;
+    const BiasParameters& bias = light->GetShadowBias();
+    ShadowMapCacheKey key;
+    key.numSplits_ = lightQueue.shadowSplits_.Size();
+    key.constantBias_ = bias.constantBias_;
+    key.slopeScaledBias_ = bias.slopeScaledBias_;
+
+    bool hasDynamicCasters = false;
+    for (unsigned i = 0; i < key.numSplits_; ++i)
+    {
+        const ShadowBatchQueue& shadowQueue = lightQueue.shadowSplits_[i];
+        key.views_[i] = shadowQueue.shadowCamera_->GetView();
+        key.projections_[i] = shadowQueue.shadowCamera_->GetProjection();
+        key.viewports_[i] = shadowQueue.shadowViewport_;
+
+        for (PODVector<Drawable*>::ConstIterator j = query.shadowCasters_.Begin() + query.shadowCasterBegin_[i];
+             j < query.shadowCasters_.Begin() + query.shadowCasterEnd_[i]; ++j)
+        {
+            if (IsStaticShadowCaster(*j, frame_.frameNumber_))
+            {
+                key.casterHashes_[i] += GetShadowCasterHash(*j);
+                ++key.numCasters_[i];
+            }
+            else
+                hasDynamicCasters = true;
+        }
+    }
+
+    // Dynamic casters are drawn on a copy of the cached shadow map
+    if (hasDynamicCasters && !graphics_->GetTextureCopySupport())
+        return;
+
+    CachedShadowMap* cache = renderer_->GetCachedShadowMap(light, lightQueue.shadowMap_);
+    if (!cache)
+        return;
+    if (cache->key_ != key)
+    {
+        // If another view already uses the cached shadow map differently this frame, render the whole shadow map as usual
+        if (cache->frameNumber_ == frame_.frameNumber_)
+            return;
+        // Otherwise start caching only once the key stays the same for a frame, so that lights whose shadow cameras move
+        // every frame, such as directional lights following the camera, do not pay for rendering and copying the cache
+        cache->key_ = key;
+        cache->valid_ = false;
+        cache->frameNumber_ = frame_.frameNumber_;
+        return;
+    }
+    cache->frameNumber_ = frame_.frameNumber_;
+
+    lightQueue.shadowMapCache_ = cache;
+    if (!hasDynamicCasters)
+        lightQueue.shadowMap_ = cache->texture_;
+}
+
 bool View::NeedRenderShadowMap(const LightBatchQueue& queue)
 {
     // Must have a shadow map, and either forward or deferred lit batches
@@ -3042,7 +3287,29 @@ void View::RenderShadowMap(const LightBatchQueue& queue)
 {
     URHO3D_PROFILE("RenderShadowMap");
 
-    Texture2D* shadowMap = queue.shadowMap_;
+    CachedShadowMap* cache = queue.shadowMapCache_;
+    if (!cache)
+    {
+        RenderShadowMapSplits(queue, queue.shadowMap_, false, true, true);
+        return;
+    }
+
+    // Bring the cached static shadow map up to date, then draw the dynamic casters, if any, on a copy of it
+    if (!cache->valid_)
+    {
+        RenderShadowMapSplits(queue, cache->texture_, true, false, true);
+        cache->valid_ = true;
+    }
+    if (queue.shadowMap_ != cache->texture_)
+    {
+        // If the copy fails, render the static casters again along with the dynamic ones
+        bool copied = graphics_->CopyTexture(queue.shadowMap_, cache->texture_);
+        RenderShadowMapSplits(queue, queue.shadowMap_, !copied, true, !copied);
+    }
+}
+
+void View::RenderShadowMapSplits(const LightBatchQueue& queue, Texture2D* shadowMap, bool staticCasters, bool dynamicCasters, bool clear)
+{
     graphics_->SetTexture(TU_SHADOWMAP, nullptr);
 
     graphics_->SetFillMode(FILL_SOLID);
@@ -3062,7 +3329,8 @@ void View::RenderShadowMap(const LightBatchQueue& queue)
         for (unsigned i = 1; i < MAX_RENDERTARGETS; ++i)
             graphics_->SetRenderTarget(i, (RenderSurface*) nullptr);
         graphics_->SetViewport(IntRect(0, 0, shadowMap->GetWidth(), shadowMap->GetHeight()));
-        graphics_->Clear(CLEAR_DEPTH);
+        if (clear)
+            graphics_->Clear(CLEAR_DEPTH);
     }
     else // if the shadow map is a color rendertarget
     {
@@ -3104,16 +3372,20 @@ void View::RenderShadowMap(const LightBatchQueue& queue)
 
         graphics_->SetDepthBias(multiplier * parameters.constantBias_ + addition, multiplier * parameters.slopeScaledBias_);
 
-        if (!shadowQueue.shadowBatches_.IsEmpty())
-        {
-            graphics_->SetViewport(shadowQueue.shadowViewport_);
-            shadowQueue.shadowBatches_.Draw(this, shadowQueue.shadowCamera_, false, false, true);
-        }
+        graphics_->SetViewport(shadowQueue.shadowViewport_);
+        if (staticCasters && !shadowQueue.staticShadowBatches_.IsEmpty())
+            DrawBatchQueue(shadowQueue.staticShadowBatches_, shadowQueue.shadowCamera_, false, false, true);
+        if (dynamicCasters && !shadowQueue.shadowBatches_.IsEmpty())
+            DrawBatchQueue(shadowQueue.shadowBatches_, shadowQueue.shadowCamera_, false, false, true);
     }
 
-    // Scale filter blur amount to shadow map viewport size so that different shadow map resolutions don't behave differently
-    float blurScale = queue.shadowSplits_[0].shadowViewport_.Width() / 1024.0f;
-    renderer_->ApplyShadowMapFilter(this, shadowMap, blurScale);
+    // Filter only the final shadow map, not a cached one that is copied under dynamic casters
+    if (shadowMap == queue.shadowMap_)
+    {
+        // Scale filter blur amount to shadow map viewport size so that different shadow map resolutions don't behave differently
+        float blurScale = queue.shadowSplits_[0].shadowViewport_.Width() / 1024.0f;
+        renderer_->ApplyShadowMapFilter(this, shadowMap, blurScale);
+    }
 
     // reset some parameters
     graphics_->SetColorWrite(true);
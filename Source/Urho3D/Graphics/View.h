@@ -27,6 +27,8 @@
 #include "../Core/Object.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Light.h"
+#include "../Graphics/RenderCommandBuffer.h"
+#include "../Graphics/ShaderParameterBlock.h"
 #include "../Graphics/Zone.h"
 #include "../Math/Polyhedron.h"
 
@@ -111,6 +113,7 @@ class URHO3D_API View : public Object
 {
     friend void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex);
     friend void ProcessLightWork(const WorkItem* item, unsigned threadIndex);
+    friend void RecordCommandBufferWork(const WorkItem* item, unsigned threadIndex);
 
     URHO3D_OBJECT(View, Object);
 
@@ -184,6 +187,9 @@ public:
     /// Set G-buffer offset and inverse size shader parameters. Called by Batch and internally by View.
     void SetGBufferShaderParameters(const IntVector2& texSize, const IntRect& viewRect);
 
+    /// Return the shader parameter block of a source object and variant for the current render, empty until built by the caller. Called by Batch and internally by View.
+    ShaderParameterBlock& GetShaderParameterBlock(const void* source, const void* variant) { return shaderParameterBlocks_[MakePair(source, variant)]; }
+
     /// Draw a fullscreen quad. Shaders and renderstates must have been set beforehand. Quad will be drawn to the middle of depth range, similarly to deferred directional lights.
     void DrawFullscreenQuad(bool setIdentityProjection = false);
 
@@ -197,6 +203,8 @@ private:
     void GetBatches();
     /// Get lit geometries and shadowcasters for visible lights.
     void ProcessLights();
+    /// Build the camera-specific shader parameter block.
+    void BuildCameraShaderParameters(ShaderParameterBlock& block, Camera* camera);
     /// Get batches from lit geometries and shadowcasters.
     void GetLightBatches();
     /// Get unlit batches.
@@ -207,6 +215,10 @@ private:
     void GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue);
     /// Execute render commands.
     void ExecuteRenderPathCommands();
+    /// Record the draw commands of the batch queues in worker threads.
+    void RecordCommandBuffers();
+    /// Draw a batch queue, executing its recorded command buffer if it has one for the camera.
+    void DrawBatchQueue(const BatchQueue& queue, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite);
     /// Set rendertargets for current render command.
     void SetRenderTargets(RenderPathCommand& command);
     /// Set textures for current render command. Return whether depth write is allowed (depth-stencil not bound as a texture.)
@@ -264,8 +276,12 @@ private:
     void SetupLightVolumeBatch(Batch& batch);
     /// Check whether a light queue needs shadow rendering.
     bool NeedRenderShadowMap(const LightBatchQueue& queue);
+    /// Use the light's cached shadow map of static casters if its shadow cameras and the static casters allow.
+    void SetupShadowMapCache(LightBatchQueue& lightQueue, const LightQueryResult& query);
     /// Render a shadow map.
     void RenderShadowMap(const LightBatchQueue& queue);
+    /// Render the static and/or the other shadow casters of a light to a shadow map, optionally clearing it first.
+    void RenderShadowMapSplits(const LightBatchQueue& queue, Texture2D* shadowMap, bool staticCasters, bool dynamicCasters, bool clear);
     /// Return the proper depth-stencil surface to use for a rendertarget.
     RenderSurface* GetDepthStencil(RenderSurface* renderTarget);
     /// Helper function to get the render surface from a texture. 2D textures will always return the first face only.
@@ -410,6 +426,12 @@ private:
     Vector<LightBatchQueue> lightQueues_;
     /// Per-vertex light queues.
     HashMap<unsigned long long, LightBatchQueue> vertexLightQueues_;
+    /// Zone, light and camera shader parameter blocks built during the current render.
+    HashMap<Pair<const void*, const void*>, ShaderParameterBlock> shaderParameterBlocks_;
+    /// Command buffers recorded during the current render. Buffers beyond the used ones are kept for reuse.
+    Vector<RenderCommandBuffer> commandBuffers_;
+    /// Recorded command buffers by batch queue.
+    HashMap<const BatchQueue*, RenderCommandBuffer*> queueCommandBuffers_;
     /// Batch queues by pass index.
     HashMap<unsigned, BatchQueue> batchQueues_;
     /// Index of the GBuffer pass.
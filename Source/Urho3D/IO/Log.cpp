@@ -31,7 +31,11 @@
 #include "../IO/IOEvents.h"
 #include "../IO/Log.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <ctime>
+#include <mutex>
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -58,8 +62,228 @@ const char* logLevelPrefixes[] =
 static Log* logInstance = nullptr;
 static bool threadErrorDisplayed = false;
 
+/// Log message waiting in a queue.
+struct LogQueueNode
+{
+    /// Construct with parameters.
+    LogQueueNode(int level, const String& message, const LogFields* fields, time_t time, bool error) :
+        message_(message),
+        time_(time),
+        level_(level),
+        error_(error)
+    {
+        if (fields)
+            fields_ = *fields;
+    }
+
+    /// Next node.
+    LogQueueNode* next_{};
+    /// Message text.
+    String message_;
+    /// Structured fields.
+    LogFields fields_;
+    /// Time the message was written.
+    time_t time_;
+    /// Message level. LOG_RAW for raw messages.
+    int level_;
+    /// Error flag for raw messages.
+    bool error_;
+    /// Whether the writer thread outputs the message and then passes it on to the main thread for the log event.
+    bool queuedToWriter_{};
+};
+
+/// Lock-free queue of log messages with multiple producers and a single consumer. Producers push onto a linked stack and the consumer takes the whole stack at once.
+class LogMessageQueue
+{
+public:
+    /// Destruct. Free any remaining messages.
+    ~LogMessageQueue()
+    {
+        LogQueueNode* node = TakeAll();
+        while (node)
+        {
+            LogQueueNode* next = node->next_;
+            delete node;
+            node = next;
+        }
+    }
+
+    /// Push a message. May be called from any thread.
+    void Push(LogQueueNode* node)
+    {
+        // Sequentially consistent, so that the writer thread either sees the message or is seen to be waiting
+        node->next_ = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(node->next_, node, std::memory_order_seq_cst, std::memory_order_relaxed))
+            ;
+    }
+
+    /// Return whether there are no queued messages.
+    bool IsEmpty() const { return !head_.load(std::memory_order_seq_cst); }
+
+    /// Take all queued messages as a list in the order they were pushed.
+    LogQueueNode* TakeAll()
+    {
+        LogQueueNode* node = head_.exchange(nullptr, std::memory_order_acquire);
+        LogQueueNode* ordered = nullptr;
+        while (node)
+        {
+            LogQueueNode* next = node->next_;
+            node->next_ = ordered;
+            ordered = node;
+            node = next;
+        }
+        return ordered;
+    }
+
+private:
+    /// Most recently pushed message.
+    std::atomic<LogQueueNode*> head_{};
+};
+
+/// Thread that prints queued log messages and writes them to the log file in batches.
+class LogWriterThread : public Thread
+{
+public:
+    /// Construct.
+    explicit LogWriterThread(Log* log) :
+        log_(log)
+    {
+    }
+
+    /// Write messages until stopped. Sleep while there are none.
+    void ThreadFunction() override
+    {
+        while (shouldRun_)
+        {
+            if (WriteQueued())
+                continue;
+
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            waiting_.store(true, std::memory_order_seq_cst);
+            if (shouldRun_ && queue_.IsEmpty())
+                wakeCondition_.wait(lock);
+            waiting_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    /// Stop the thread, waking it up if it is waiting for messages.
+    void StopWriting()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            shouldRun_ = false;
+            wakeCondition_.notify_one();
+        }
+        Stop();
+    }
+
+    /// Queue a message. May be called from any thread.
+    void Push(LogQueueNode* node)
+    {
+        queued_.fetch_add(1, std::memory_order_relaxed);
+        queue_.Push(node);
+
+        // Only take the mutex when the thread actually sleeps
+        if (waiting_.load(std::memory_order_seq_cst))
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wakeCondition_.notify_one();
+        }
+    }
+
+    /// Print and write all queued messages. Return true if there were any. Must not be called concurrently with the thread running.
+    bool WriteQueued()
+    {
+        LogQueueNode* node = queue_.TakeAll();
+        if (!node)
+            return false;
+
+        String fileBuffer;
+        unsigned count = 0;
+        while (node)
+        {
+            String formattedMessage = node->level_ == LOG_RAW ? node->message_ :
+                log_->FormatMessage(node->level_, node->message_, &node->fields_, node->time_);
+            log_->PrintMessage(node->level_, node->message_, formattedMessage, node->error_);
+
+            fileBuffer += formattedMessage;
+            if (node->level_ != LOG_RAW)
+                fileBuffer += "\r\n";
+
+            // Messages from worker threads still need their log event sent on the main thread
+            LogQueueNode* next = node->next_;
+            if (node->queuedToWriter_)
+                log_->threadMessages_->Push(node);
+            else
+                delete node;
+            node = next;
+            ++count;
+        }
+
+        // One write and flush per batch instead of per message
+        {
+            MutexLock lock(log_->fileMutex_);
+            if (log_->logFile_)
+            {
+                log_->logFile_->Write(fileBuffer.CString(), fileBuffer.Length());
+                log_->logFile_->Flush();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(writtenMutex_);
+            written_.fetch_add(count, std::memory_order_release);
+            writtenCondition_.notify_all();
+        }
+        return true;
+    }
+
+    /// Wait until all messages queued so far have been written.
+    void Flush()
+    {
+        unsigned target = queued_.load(std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(writtenMutex_);
+        while ((int)(written_.load(std::memory_order_acquire) - target) < 0)
+            writtenCondition_.wait(lock);
+    }
+
+private:
+    /// Log subsystem.
+    Log* log_;
+    /// Message queue.
+    LogMessageQueue queue_;
+    /// Number of messages queued.
+    std::atomic<unsigned> queued_{};
+    /// Number of messages written.
+    std::atomic<unsigned> written_{};
+    /// Whether the thread is about to sleep or sleeping until a message is queued.
+    std::atomic<bool> waiting_{};
+    /// Mutex for waking up the thread.
+    std::mutex wakeMutex_;
+    /// Condition for waking up the thread.
+    std::condition_variable wakeCondition_;
+    /// Mutex for waiting until messages have been written.
+    std::mutex writtenMutex_;
+    /// Condition signaled after each written batch.
+    std::condition_variable writtenCondition_;
+};
+
+static String FormatTimeStamp(time_t time)
+{
+    char dateTime[20];
+    tm timeInfo;
+#ifdef _WIN32
+    localtime_s(&timeInfo, &time);
+#else
+    localtime_r(&time, &timeInfo);
+#endif
+    strftime(dateTime, sizeof(dateTime), "%Y-%m-%d %H:%M:%S", &timeInfo);
+    return dateTime;
+}
+
 Log::Log(Context* context) :
     Object(context),
+    threadMessages_(new LogMessageQueue()),
 #ifdef _DEBUG
     level_(LOG_DEBUG),
 #else
@@ -67,16 +291,22 @@ Log::Log(Context* context) :
 #endif
     timeStamp_(true),
     inWrite_(false),
-    quiet_(false)
+    quiet_(false),
+    flushOnError_(false)
 {
     logInstance = this;
 
+#ifdef URHO3D_THREADING
+    SetAsync(true);
+#endif
+
     SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(Log, HandleEndFrame));
 }
 
 Log::~Log()
 {
     logInstance = nullptr;
+    SetAsync(false);
 }
 
 void Log::Open(const String& fileName)
@@ -92,20 +322,26 @@ void Log::Open(const String& fileName)
             Close();
     }
 
-    logFile_ = new File(context_);
-    if (logFile_->Open(fileName, FILE_WRITE))
+    SharedPtr<File> logFile(new File(context_));
+    if (logFile->Open(fileName, FILE_WRITE))
+    {
+        {
+            MutexLock lock(fileMutex_);
+            logFile_ = logFile;
+        }
         Write(LOG_INFO, "Opened log file " + fileName);
+    }
     else
-    {
-        logFile_.Reset();
         Write(LOG_ERROR, "Failed to create log file " + fileName);
-    }
 #endif
 }
 
 void Log::Close()
 {
 #if !defined(__ANDROID__) && !defined(IOS) && !defined(TVOS)
+    Flush();
+
+    MutexLock lock(fileMutex_);
     if (logFile_ && logFile_->IsOpen())
     {
         logFile_->Close();
@@ -135,100 +371,183 @@ void Log::SetQuiet(bool quiet)
     quiet_ = quiet;
 }
 
-void Log::Write(int level, const String& message)
+void Log::SetAsync(bool enable)
 {
-    // Special case for LOG_RAW level
-    if (level == LOG_RAW)
-    {
-        WriteRaw(message, false);
+    if (enable == IsAsync())
         return;
+
+    if (enable)
+    {
+        // The writer is kept after stopping, as worker threads may still hold a pointer to it
+        if (!writerThread_)
+            writerThread_ = new LogWriterThread(this);
+        if (writerThread_->Run())
+            writer_.store(writerThread_.Get(), std::memory_order_release);
+    }
+    else
+    {
+        // Write out what is still queued on this thread after the writer has stopped
+        writer_.store(nullptr, std::memory_order_release);
+        writerThread_->StopWriting();
+        writerThread_->WriteQueued();
     }
+}
+
+void Log::SetFlushOnError(bool enable)
+{
+    flushOnError_ = enable;
+}
 
+void Log::Flush()
+{
+    LogWriterThread* writer = writer_.load(std::memory_order_acquire);
+    if (writer)
+        writer->Flush();
+}
+
+void Log::Write(int level, const String& message)
+{
+    WriteInternal(level, message, nullptr, false);
+}
+
+void Log::Write(int level, const String& message, const LogFields& fields)
+{
+    WriteInternal(level, message, &fields, false);
+}
+
+void Log::WriteRaw(const String& message, bool error)
+{
+    WriteInternal(LOG_RAW, message, nullptr, error);
+}
+
+void Log::WriteInternal(int level, const String& message, const LogFields* fields, bool error)
+{
     // No-op if illegal level
-    if (level < LOG_TRACE || level >= LOG_NONE)
+    if (level != LOG_RAW && (level < LOG_TRACE || level >= LOG_NONE))
         return;
 
-    // If not in the main thread, store message for later processing
+    // Do not log if message level excluded
+    if (!logInstance || (level != LOG_RAW && logInstance->level_ > level))
+        return;
+
+    time_t time;
+    ::time(&time);
+
+    LogWriterThread* writer = logInstance->writer_.load(std::memory_order_acquire);
+
+    // If not in the main thread, queue the message for the writer thread, which passes it on for the main thread to send
+    // the log event. Without the writer, the main thread also outputs it
     if (!Thread::IsMainThread())
     {
-        if (logInstance)
+        auto* node = new LogQueueNode(level, message, fields, time, error);
+        if (writer)
         {
-            MutexLock lock(logInstance->logMutex_);
-            logInstance->threadMessages_.Push(StoredLogMessage(message, level, false));
+            node->queuedToWriter_ = true;
+            writer->Push(node);
         }
-
+        else
+            logInstance->threadMessages_->Push(node);
         return;
     }
 
-    // Do not log if message level excluded or if currently sending a log event
-    if (!logInstance || logInstance->level_ > level || logInstance->inWrite_)
+    // Prevent recursion during log event
+    if (logInstance->inWrite_)
         return;
 
-    String formattedMessage = logLevelPrefixes[level];
-    formattedMessage += ": ";
-    formattedMessage += String(' ', 9 - formattedMessage.Length());
-    formattedMessage += message;
-    logInstance->lastMessage_ = message;
-
-    if (logInstance->timeStamp_)
-        formattedMessage = "[" + Time::GetTimeStamp() + "] " + formattedMessage;
-
-#if defined(__ANDROID__)
-    int androidLevel = ANDROID_LOG_VERBOSE + level;
-    __android_log_print(androidLevel, "Urho3D", "%s", message.CString());
-#elif defined(IOS) || defined(TVOS)
-    SDL_IOS_LogMessage(message.CString());
-#else
-    if (logInstance->quiet_)
+    if (writer)
     {
-        // If in quiet mode, still print the error message to the standard error stream
-        if (level == LOG_ERROR)
-            PrintUnicodeLine(formattedMessage, true);
+        writer->Push(new LogQueueNode(level, message, fields, time, error));
+        // Optionally make sure errors reach the log file in case the application is about to terminate
+        if (logInstance->flushOnError_ && (level == LOG_ERROR || (level == LOG_RAW && error)))
+            writer->Flush();
     }
-    else
-        PrintUnicodeLine(formattedMessage, level == LOG_ERROR);
-#endif
 
-    if (logInstance->logFile_)
+    logInstance->ProcessMessage(level, message, fields, time, error, !writer);
+}
+
+void Log::ProcessMessage(int level, const String& message, const LogFields* fields, time_t time, bool error, bool output)
+{
+    lastMessage_ = message;
+
+    // When the writer thread does the output, format on this thread only if someone listens to the log event
+    if (!output && !HasMessageEventReceivers())
+        return;
+
+    String formattedMessage = level == LOG_RAW ? message : FormatMessage(level, message, fields, time);
+
+    if (output)
     {
-        logInstance->logFile_->WriteLine(formattedMessage);
-        logInstance->logFile_->Flush();
+        PrintMessage(level, message, formattedMessage, error);
+
+        MutexLock lock(fileMutex_);
+        if (logFile_)
+        {
+            if (level == LOG_RAW)
+                logFile_->Write(message.CString(), message.Length());
+            else
+                logFile_->WriteLine(formattedMessage);
+            logFile_->Flush();
+        }
     }
 
-    logInstance->inWrite_ = true;
+    inWrite_ = true;
 
     using namespace LogMessage;
 
-    VariantMap& eventData = logInstance->GetEventDataMap();
+    VariantMap& eventData = GetEventDataMap();
     eventData[P_MESSAGE] = formattedMessage;
-    eventData[P_LEVEL] = level;
-    logInstance->SendEvent(E_LOGMESSAGE, eventData);
+    eventData[P_LEVEL] = level == LOG_RAW ? (error ? LOG_ERROR : LOG_INFO) : level;
+    SendEvent(E_LOGMESSAGE, eventData);
 
-    logInstance->inWrite_ = false;
+    inWrite_ = false;
 }
 
-void Log::WriteRaw(const String& message, bool error)
+String Log::FormatMessage(int level, const String& message, const LogFields* fields, time_t time) const
 {
-    // If not in the main thread, store message for later processing
-    if (!Thread::IsMainThread())
+    String formattedMessage = logLevelPrefixes[level];
+    formattedMessage += ": ";
+    formattedMessage += String(' ', 9 - formattedMessage.Length());
+    formattedMessage += message;
+
+    if (fields)
     {
-        if (logInstance)
+        for (unsigned i = 0; i < fields->Size(); ++i)
         {
-            MutexLock lock(logInstance->logMutex_);
-            logInstance->threadMessages_.Push(StoredLogMessage(message, LOG_RAW, error));
+            const Pair<String, Variant>& field = fields->At(i);
+            String value = field.second_.ToString();
+            formattedMessage += ' ';
+            formattedMessage += field.first_;
+            formattedMessage += '=';
+            // Quote values that would otherwise be ambiguous to parse
+            if (value.Empty() || value.Contains(' ') || value.Contains('=') || value.Contains('"'))
+            {
+                formattedMessage += '"';
+                formattedMessage += value.Replaced("\"", "\\\"");
+                formattedMessage += '"';
+            }
+            else
+                formattedMessage += value;
         }
-
-        return;
     }
 
-    // Prevent recursion during log event
-    if (!logInstance || logInstance->inWrite_)
-        return;
+    if (timeStamp_)
+        formattedMessage = "[" + FormatTimeStamp(time) + "] " + formattedMessage;
+
+    return formattedMessage;
+}
 
-    logInstance->lastMessage_ = message;
+void Log::PrintMessage(int level, const String& message, const String& formattedMessage, bool error) const
+{
+    if (level != LOG_RAW)
+        error = level == LOG_ERROR;
 
 #if defined(__ANDROID__)
-    if (logInstance->quiet_)
+    if (level != LOG_RAW)
+    {
+        int androidLevel = ANDROID_LOG_VERBOSE + level;
+        __android_log_print(androidLevel, "Urho3D", "%s", message.CString());
+    }
+    else if (quiet_)
     {
         if (error)
             __android_log_print(ANDROID_LOG_ERROR, "Urho3D", "%s", message.CString());
@@ -238,32 +557,20 @@ void Log::WriteRaw(const String& message, bool error)
 #elif defined(IOS) || defined(TVOS)
     SDL_IOS_LogMessage(message.CString());
 #else
-    if (logInstance->quiet_)
-    {
-        // If in quiet mode, still print the error message to the standard error stream
-        if (error)
-            PrintUnicode(message, true);
-    }
+    // If in quiet mode, still print the error message to the standard error stream
+    if (quiet_ && !error)
+        return;
+
+    if (level != LOG_RAW)
+        PrintUnicodeLine(formattedMessage, error);
     else
-        PrintUnicode(message, error);
+        PrintUnicode(formattedMessage, error);
 #endif
+}
 
-    if (logInstance->logFile_)
-    {
-        logInstance->logFile_->Write(message.CString(), message.Length());
-        logInstance->logFile_->Flush();
-    }
-
-    logInstance->inWrite_ = true;
-
-    using namespace LogMessage;
-
-    VariantMap& eventData = logInstance->GetEventDataMap();
-    eventData[P_MESSAGE] = message;
-    eventData[P_LEVEL] = error ? LOG_ERROR : LOG_INFO;
-    logInstance->SendEvent(E_LOGMESSAGE, eventData);
-
-    logInstance->inWrite_ = false;
+bool Log::HasMessageEventReceivers()
+{
+    return context_->GetEventReceivers(E_LOGMESSAGE) || context_->GetEventReceivers(this, E_LOGMESSAGE);
 }
 
 void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
@@ -279,19 +586,20 @@ void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
         return;
     }
 
-    MutexLock lock(logMutex_);
+    // Write messages that worker threads queued to the writer just as it was stopped
+    if (writerThread_ && !IsAsync())
+        writerThread_->WriteQueued();
 
     // Process messages accumulated from other threads (if any)
-    while (!threadMessages_.Empty())
+    LogQueueNode* node = threadMessages_->TakeAll();
+    while (node)
     {
-        const StoredLogMessage& stored = threadMessages_.Front();
-
-        if (stored.level_ != LOG_RAW)
-            Write(stored.level_, stored.message_);
-        else
-            WriteRaw(stored.message_, stored.error_);
+        if (!inWrite_)
+            ProcessMessage(node->level_, node->message_, &node->fields_, node->time_, node->error_, !node->queuedToWriter_);
 
-        threadMessages_.PopFront();
+        LogQueueNode* next = node->next_;
+        delete node;
+        node = next;
     }
 }
 
@@ -22,11 +22,14 @@
 
 #pragma once
 
-#include "../Container/List.h"
+#include "../Container/Pair.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Core/StringUtils.h"
 
+#include <atomic>
+#include <ctime>
+
 namespace Urho3D
 {
 
@@ -45,29 +48,17 @@ static const int LOG_ERROR = 4;
 /// Disable all log messages.
 static const int LOG_NONE = 5;
 
+/// Lowest message level compiled in by the logging macros. Messages below it cost nothing at runtime.
+#ifndef URHO3D_LOG_MIN_LEVEL
+#define URHO3D_LOG_MIN_LEVEL 0
+#endif
+
 class File;
+class LogMessageQueue;
+class LogWriterThread;
 
-/// Stored log message from another thread.
-struct StoredLogMessage
-{
-    /// Construct undefined.
-    StoredLogMessage() = default;
-
-    /// Construct with parameters.
-    StoredLogMessage(const String& message, int level, bool error) :
-        message_(message),
-        level_(level),
-        error_(error)
-    {
-    }
-
-    /// Message text.
-    String message_;
-    /// Message level. -1 for raw messages.
-    int level_{};
-    /// Error flag for raw messages.
-    bool error_{};
-};
+/// Structured log message fields as key/value pairs. Appended to the message text as key=value.
+using LogFields = Vector<Pair<String, Variant> >;
 
 /// Logging subsystem.
 class URHO3D_API Log : public Object
@@ -90,6 +81,12 @@ public:
     void SetTimeStamp(bool enable);
     /// Set quiet mode ie. only print error entries to standard error stream (which is normally redirected to console also). Output to log file is not affected by this mode.
     void SetQuiet(bool quiet);
+    /// Set whether to print and write messages on a background thread instead of the calling thread. Enabled by default when threading is available.
+    void SetAsync(bool enable);
+    /// Set whether an error message waits until it has been written to the log file, in case the application is about to terminate. Only affects errors logged from the main thread when writing asynchronously. Default false.
+    void SetFlushOnError(bool enable);
+    /// Wait until all messages queued so far have been printed and written to the log file. Call only from the main thread.
+    void Flush();
 
     /// Return logging level.
     int GetLevel() const { return level_; }
@@ -103,21 +100,45 @@ public:
     /// Return whether log is in quiet mode (only errors printed to standard error stream).
     bool IsQuiet() const { return quiet_; }
 
+    /// Return whether messages are printed and written on a background thread.
+    bool IsAsync() const { return writer_.load(std::memory_order_relaxed) != nullptr; }
+
+    /// Return whether error messages wait until they have been written to the log file.
+    bool GetFlushOnError() const { return flushOnError_; }
+
     /// Write to the log. If logging level is higher than the level of the message, the message is ignored.
     static void Write(int level, const String& message);
+    /// Write to the log with structured fields. If logging level is higher than the level of the message, the message is ignored.
+    static void Write(int level, const String& message, const LogFields& fields);
     /// Write raw output to the log.
     static void WriteRaw(const String& message, bool error = false);
     /// Return instance of opened log file.
     const File* GetLogFile() const { return logFile_; }
 
 private:
+    friend class LogWriterThread;
+
+    /// Write a message or raw output.
+    static void WriteInternal(int level, const String& message, const LogFields* fields, bool error);
+    /// Handle a message on the main thread: output it when requested and send the log message event.
+    void ProcessMessage(int level, const String& message, const LogFields* fields, time_t time, bool error, bool output);
+    /// Format a message with level prefix, fields and timestamp.
+    String FormatMessage(int level, const String& message, const LogFields* fields, time_t time) const;
+    /// Print a message to the console or platform log.
+    void PrintMessage(int level, const String& message, const String& formattedMessage, bool error) const;
+    /// Return whether anyone listens to the log message event.
+    bool HasMessageEventReceivers();
     /// Handle end of frame. Process the threaded log messages.
     void HandleEndFrame(StringHash eventType, VariantMap& eventData);
 
-    /// Mutex for threaded operation.
-    Mutex logMutex_;
-    /// Log messages from other threads.
-    List<StoredLogMessage> threadMessages_;
+    /// Log messages from other threads, to be sent as events or written on the main thread.
+    UniquePtr<LogMessageQueue> threadMessages_;
+    /// Background writer thread while writing asynchronously, null otherwise. Read by the logging threads.
+    std::atomic<LogWriterThread*> writer_{};
+    /// Background writer thread, kept once created.
+    UniquePtr<LogWriterThread> writerThread_;
+    /// Mutex for the log file, which the background writer thread uses.
+    Mutex fileMutex_;
     /// Log file.
     SharedPtr<File> logFile_;
     /// Last log message.
@@ -130,33 +151,68 @@ private:
     bool inWrite_;
     /// Quiet mode flag.
     bool quiet_;
+    /// Wait for error messages to be written flag.
+    bool flushOnError_;
 };
 
 #ifdef URHO3D_LOGGING
+#if URHO3D_LOG_MIN_LEVEL <= 0
 #define URHO3D_LOGTRACE(message) Urho3D::Log::Write(Urho3D::LOG_TRACE, message)
-#define URHO3D_LOGDEBUG(message) Urho3D::Log::Write(Urho3D::LOG_DEBUG, message)
-#define URHO3D_LOGINFO(message) Urho3D::Log::Write(Urho3D::LOG_INFO, message)
-#define URHO3D_LOGWARNING(message) Urho3D::Log::Write(Urho3D::LOG_WARNING, message)
-#define URHO3D_LOGERROR(message) Urho3D::Log::Write(Urho3D::LOG_ERROR, message)
-#define URHO3D_LOGRAW(message) Urho3D::Log::WriteRaw(message)
 #define URHO3D_LOGTRACEF(format, ...) Urho3D::Log::Write(Urho3D::LOG_TRACE, Urho3D::ToString(format, ##__VA_ARGS__))
+#define URHO3D_LOGTRACEFIELDS(message, ...) Urho3D::Log::Write(Urho3D::LOG_TRACE, message, Urho3D::LogFields{__VA_ARGS__})
+#endif
+#if URHO3D_LOG_MIN_LEVEL <= 1
+#define URHO3D_LOGDEBUG(message) Urho3D::Log::Write(Urho3D::LOG_DEBUG, message)
 #define URHO3D_LOGDEBUGF(format, ...) Urho3D::Log::Write(Urho3D::LOG_DEBUG, Urho3D::ToString(format, ##__VA_ARGS__))
+#define URHO3D_LOGDEBUGFIELDS(message, ...) Urho3D::Log::Write(Urho3D::LOG_DEBUG, message, Urho3D::LogFields{__VA_ARGS__})
+#endif
+#if URHO3D_LOG_MIN_LEVEL <= 2
+#define URHO3D_LOGINFO(message) Urho3D::Log::Write(Urho3D::LOG_INFO, message)
 #define URHO3D_LOGINFOF(format, ...) Urho3D::Log::Write(Urho3D::LOG_INFO, Urho3D::ToString(format, ##__VA_ARGS__))
+#define URHO3D_LOGINFOFIELDS(message, ...) Urho3D::Log::Write(Urho3D::LOG_INFO, message, Urho3D::LogFields{__VA_ARGS__})
+#endif
+#if URHO3D_LOG_MIN_LEVEL <= 3
+#define URHO3D_LOGWARNING(message) Urho3D::Log::Write(Urho3D::LOG_WARNING, message)
 #define URHO3D_LOGWARNINGF(format, ...) Urho3D::Log::Write(Urho3D::LOG_WARNING, Urho3D::ToString(format, ##__VA_ARGS__))
+#define URHO3D_LOGWARNINGFIELDS(message, ...) Urho3D::Log::Write(Urho3D::LOG_WARNING, message, Urho3D::LogFields{__VA_ARGS__})
+#endif
+#if URHO3D_LOG_MIN_LEVEL <= 4
+#define URHO3D_LOGERROR(message) Urho3D::Log::Write(Urho3D::LOG_ERROR, message)
 #define URHO3D_LOGERRORF(format, ...) Urho3D::Log::Write(Urho3D::LOG_ERROR, Urho3D::ToString(format, ##__VA_ARGS__))
+#define URHO3D_LOGERRORFIELDS(message, ...) Urho3D::Log::Write(Urho3D::LOG_ERROR, message, Urho3D::LogFields{__VA_ARGS__})
+#endif
+#define URHO3D_LOGRAW(message) Urho3D::Log::WriteRaw(message)
 #define URHO3D_LOGRAWF(format, ...) Urho3D::Log::WriteRaw(Urho3D::ToString(format, ##__VA_ARGS__))
-#else
+#endif
+
+// Levels disabled at compile time or with logging disabled
+#ifndef URHO3D_LOGTRACE
 #define URHO3D_LOGTRACE(message) ((void)0)
-#define URHO3D_LOGDEBUG(message) ((void)0)
-#define URHO3D_LOGINFO(message) ((void)0)
-#define URHO3D_LOGWARNING(message) ((void)0)
-#define URHO3D_LOGERROR(message) ((void)0)
-#define URHO3D_LOGRAW(message) ((void)0)
 #define URHO3D_LOGTRACEF(...) ((void)0)
+#define URHO3D_LOGTRACEFIELDS(...) ((void)0)
+#endif
+#ifndef URHO3D_LOGDEBUG
+#define URHO3D_LOGDEBUG(message) ((void)0)
 #define URHO3D_LOGDEBUGF(...) ((void)0)
+#define URHO3D_LOGDEBUGFIELDS(...) ((void)0)
+#endif
+#ifndef URHO3D_LOGINFO
+#define URHO3D_LOGINFO(message) ((void)0)
 #define URHO3D_LOGINFOF(...) ((void)0)
+#define URHO3D_LOGINFOFIELDS(...) ((void)0)
+#endif
+#ifndef URHO3D_LOGWARNING
+#define URHO3D_LOGWARNING(message) ((void)0)
 #define URHO3D_LOGWARNINGF(...) ((void)0)
+#define URHO3D_LOGWARNINGFIELDS(...) ((void)0)
+#endif
+#ifndef URHO3D_LOGERROR
+#define URHO3D_LOGERROR(message) ((void)0)
 #define URHO3D_LOGERRORF(...) ((void)0)
+#define URHO3D_LOGERRORFIELDS(...) ((void)0)
+#endif
+#ifndef URHO3D_LOGRAW
+#define URHO3D_LOGRAW(message) ((void)0)
 #define URHO3D_LOGRAWF(...) ((void)0)
 #endif
 
@@ -70,14 +70,17 @@ StringHash::StringHash(const String& str) noexcept :
 
 unsigned StringHash::Calculate(const char* str, unsigned hash)
 {
-    if (!str)
+    if (!str || !*str)
         return hash;
 
+    // Must give the same result as CalculateConstexpr(). Case folding is ASCII-only, which avoids the locale-dependent
+    // tolower() call per character. A nonzero seed continues a previous hash, so that chained hashing equals hashing
+    // the concatenated string
+    if (!hash)
+        hash = FNV_OFFSET_BASIS;
     while (*str)
     {
-        // Perform the actual hashing as case-insensitive
-        char c = *str;
-        hash = SDBMHash(hash, (unsigned char)tolower(c));
+        hash = (hash ^ FoldCase(*str)) * FNV_PRIME;
         ++str;
     }
 
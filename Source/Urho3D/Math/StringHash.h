@@ -29,26 +29,26 @@ namespace Urho3D
 
 class StringHashRegister;
 
-/// 32-bit hash value for a string.
+/// 32-bit hash value for a string. Strings are hashed with FNV-1a after folding ASCII letters to lower case.
 class URHO3D_API StringHash
 {
 public:
     /// Construct with zero value.
-    StringHash() noexcept :
+    constexpr StringHash() noexcept :
         value_(0)
     {
     }
 
     /// Copy-construct from another hash.
-    StringHash(const StringHash& rhs) noexcept = default;
+    constexpr StringHash(const StringHash& rhs) noexcept = default;
 
     /// Construct with an initial value.
-    explicit StringHash(unsigned value) noexcept :
+    constexpr explicit StringHash(unsigned value) noexcept :
         value_(value)
     {
     }
 
-    /// Construct from a C string case-insensitively.
+    /// Construct from a C string case-insensitively. For string literals prefer the _sh suffix, which hashes at compile time.
     StringHash(const char* str) noexcept;        // NOLINT(google-explicit-constructor)
     /// Construct from a string case-insensitively.
     StringHash(const String& str) noexcept;      // NOLINT(google-explicit-constructor)
@@ -72,22 +72,22 @@ public:
     }
 
     /// Test for equality with another hash.
-    bool operator ==(const StringHash& rhs) const { return value_ == rhs.value_; }
+    constexpr bool operator ==(const StringHash& rhs) const { return value_ == rhs.value_; }
 
     /// Test for inequality with another hash.
-    bool operator !=(const StringHash& rhs) const { return value_ != rhs.value_; }
+    constexpr bool operator !=(const StringHash& rhs) const { return value_ != rhs.value_; }
 
     /// Test if less than another hash.
-    bool operator <(const StringHash& rhs) const { return value_ < rhs.value_; }
+    constexpr bool operator <(const StringHash& rhs) const { return value_ < rhs.value_; }
 
     /// Test if greater than another hash.
-    bool operator >(const StringHash& rhs) const { return value_ > rhs.value_; }
+    constexpr bool operator >(const StringHash& rhs) const { return value_ > rhs.value_; }
 
     /// Return true if nonzero hash value.
-    explicit operator bool() const { return value_ != 0; }
+    constexpr explicit operator bool() const { return value_ != 0; }
 
     /// Return hash value.
-    unsigned Value() const { return value_; }
+    constexpr unsigned Value() const { return value_; }
 
     /// Return as string.
     String ToString() const;
@@ -96,22 +96,51 @@ public:
     String Reverse() const;
 
     /// Return hash value for HashSet & HashMap.
-    unsigned ToHash() const { return value_; }
+    constexpr unsigned ToHash() const { return value_; }
 
-    /// Calculate hash value case-insensitively from a C string.
+    /// Calculate hash value case-insensitively from a C string. A nonzero initial value continues that hash, so hashing strings in sequence equals hashing them concatenated. An empty string returns the initial value unchanged.
     static unsigned Calculate(const char* str, unsigned hash = 0);
 
+    /// Calculate hash value case-insensitively from a C string at compile time. Gives the same result as Calculate(), but is slower at runtime.
+    static constexpr unsigned CalculateConstexpr(const char* str, unsigned hash = 0)
+    {
+        return str && *str ? CalculateConstexprImpl(str, hash ? hash : FNV_OFFSET_BASIS) : hash;
+    }
+
+    /// Fold an ASCII letter to lower case. Other characters are returned unchanged.
+    static constexpr unsigned FoldCase(char c)
+    {
+        return (unsigned)(unsigned char)c - 'A' < 26u ? (unsigned)(unsigned char)c | 0x20u : (unsigned)(unsigned char)c;
+    }
+
     /// Get global StringHashRegister. Use for debug purposes only. Return nullptr if URHO3D_HASH_DEBUG is off.
     static StringHashRegister* GetGlobalStringHashRegister();
 
     /// Zero hash.
     static const StringHash ZERO;
 
+    /// FNV-1a offset basis.
+    static constexpr unsigned FNV_OFFSET_BASIS = 2166136261u;
+    /// FNV-1a prime.
+    static constexpr unsigned FNV_PRIME = 16777619u;
+
 private:
+    /// Hash the remaining characters of a non-empty string at compile time.
+    static constexpr unsigned CalculateConstexprImpl(const char* str, unsigned hash)
+    {
+        return *str ? CalculateConstexprImpl(str + 1, (hash ^ FoldCase(*str)) * FNV_PRIME) : hash;
+    }
+
     /// Hash value.
     unsigned value_;
 };
 
 static_assert(sizeof(StringHash) == sizeof(unsigned), "Unexpected StringHash size.");
 
+/// Hash a string literal case-insensitively at compile time. The string is not registered for reversing.
+constexpr StringHash operator "" _sh(const char* str, size_t /*length*/)
+{
+    return StringHash(StringHash::CalculateConstexpr(str));
+}
+
 }
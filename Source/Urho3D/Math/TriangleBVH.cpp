@@ -0,0 +1,598 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Math/Ray.h"
+#include "../Math/TriangleBVH.h"
+
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Maximum number of triangles in a leaf node.
+static const unsigned BVH_MAX_LEAF_TRIANGLES = 4;
+/// Number of bins used for surface area heuristic split evaluation.
+static const unsigned BVH_NUM_BINS = 12;
+/// Maximum depth of the hierarchy. Deeper ranges become leaves. Bounds the traversal stack size.
+static const unsigned BVH_MAX_DEPTH = 48;
+/// Traversal stack size.
+static const unsigned BVH_STACK_SIZE = BVH_MAX_DEPTH + 2;
+
+/// Pending node build range.
+struct BVHBuildTask
+{
+    /// Node index.
+    unsigned node_;
+    /// First triangle in the build order.
+    unsigned start_;
+    /// One past the last triangle in the build order.
+    unsigned end_;
+    /// Depth of the node.
+    unsigned depth_;
+};
+
+/// Ray prepared for slab tests.
+struct BVHRay
+{
+    explicit BVHRay(const Ray& ray) :
+        origin_(ray.origin_),
+        invDirection_(SafeInverse(ray.direction_.x_), SafeInverse(ray.direction_.y_), SafeInverse(ray.direction_.z_))
+    {
+    }
+
+    /// Return inverse of a direction component, avoiding infinities which would produce NaNs in the slab test.
+    static float SafeInverse(float value)
+    {
+        if (Abs(value) < 1e-20f)
+            return value < 0.0f ? -1e20f : 1e20f;
+        return 1.0f / value;
+    }
+
+    /// Ray origin.
+    Vector3 origin_;
+    /// Inverse ray direction.
+    Vector3 invDirection_;
+};
+
+static inline float SurfaceArea(const BoundingBox& box)
+{
+    Vector3 size = box.Size();
+    return 2.0f * (size.x_ * size.y_ + size.y_ * size.z_ + size.z_ * size.x_);
+}
+
+/// Return hit distance to a node's bounding box or infinity if no hit.
+static inline float HitDistance(const BVHRay& ray, const TriangleBVHNode& node)
+{
+#ifdef URHO3D_SSE
+    // Loads read the offset and count into the fourth lane, which is ignored
+    __m128 origin = _mm_set_ps(0.0f, ray.origin_.z_, ray.origin_.y_, ray.origin_.x_);
+    __m128 invDirection = _mm_set_ps(0.0f, ray.invDirection_.z_, ray.invDirection_.y_, ray.invDirection_.x_);
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.min_.x_), origin), invDirection);
+    __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.max_.x_), origin), invDirection);
+    __m128 tMin = _mm_min_ps(t1, t2);
+    __m128 tMax = _mm_max_ps(t1, t2);
+    __m128 nearest = _mm_max_ss(_mm_max_ss(tMin, _mm_shuffle_ps(tMin, tMin, _MM_SHUFFLE(1, 1, 1, 1))),
+        _mm_max_ss(_mm_shuffle_ps(tMin, tMin, _MM_SHUFFLE(2, 2, 2, 2)), _mm_setzero_ps()));
+    __m128 farthest = _mm_min_ss(_mm_min_ss(tMax, _mm_shuffle_ps(tMax, tMax, _MM_SHUFFLE(1, 1, 1, 1))),
+        _mm_shuffle_ps(tMax, tMax, _MM_SHUFFLE(2, 2, 2, 2)));
+    float nearDistance = _mm_cvtss_f32(nearest);
+    return nearDistance <= _mm_cvtss_f32(farthest) ? nearDistance : M_INFINITY;
+#else
+    float nearDistance = 0.0f;
+    float farDistance = M_INFINITY;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        float t1 = ((&node.min_.x_)[i] - ray.origin_.Data()[i]) * ray.invDirection_.Data()[i];
+        float t2 = ((&node.max_.x_)[i] - ray.origin_.Data()[i]) * ray.invDirection_.Data()[i];
+        nearDistance = Max(nearDistance, Min(t1, t2));
+        farDistance = Min(farDistance, Max(t1, t2));
+    }
+    return nearDistance <= farDistance ? nearDistance : M_INFINITY;
+#endif
+}
+
+/// Return hit distance to a triangle or infinity if no hit. Identical arithmetic to Ray::HitDistance.
+static inline float HitDistance(const Ray& ray, const TriangleBVHTriangle& triangle, float& outU, float& outV, float& outDet)
+{
+    Vector3 p(ray.direction_.CrossProduct(triangle.edge2_));
+    float det = triangle.edge1_.DotProduct(p);
+    if (det >= M_EPSILON)
+    {
+        Vector3 t(ray.origin_ - triangle.v0_);
+        float u = t.DotProduct(p);
+        if (u >= 0.0f && u <= det)
+        {
+            Vector3 q(t.CrossProduct(triangle.edge1_));
+            float v = ray.direction_.DotProduct(q);
+            if (v >= 0.0f && u + v <= det)
+            {
+                float distance = triangle.edge2_.DotProduct(q) / det;
+                if (distance >= 0.0f)
+                {
+                    outU = u;
+                    outV = v;
+                    outDet = det;
+                    return distance;
+                }
+            }
+        }
+    }
+
+    return M_INFINITY;
+}
+
+/// Return whether a candidate hit is closer than the current one. Ties resolve to the lowest source triangle, as in a linear scan.
+static inline bool IsCloserHit(float distance, unsigned triangle, float nearest, unsigned nearestTriangle)
+{
+    return distance < nearest || (distance == nearest && distance < M_INFINITY && triangle < nearestTriangle);
+}
+
+TriangleBVH::TriangleBVH() = default;
+
+void TriangleBVH::Define(const void* vertexData, unsigned vertexStride, unsigned vertexStart, unsigned vertexCount)
+{
+    Clear();
+    if (!vertexData || !vertexStride)
+        return;
+
+    vertices_.Resize(vertexCount / 3 * 3);
+    for (unsigned i = 0; i < vertices_.Size(); ++i)
+        vertices_[i] = vertexStart + i;
+
+    Build((const unsigned char*)vertexData, vertexStride);
+}
+
+void TriangleBVH::Define(const void* vertexData, unsigned vertexStride, const void* indexData, unsigned indexSize,
+    unsigned indexStart, unsigned indexCount)
+{
+    Clear();
+    if (!vertexData || !vertexStride || !indexData)
+        return;
+
+    vertices_.Resize(indexCount / 3 * 3);
+    if (indexSize == sizeof(unsigned short))
+    {
+        const unsigned short* indices = ((const unsigned short*)indexData) + indexStart;
+        for (unsigned i = 0; i < vertices_.Size(); ++i)
+            vertices_[i] = indices[i];
+    }
+    else
+    {
+        const unsigned* indices = ((const unsigned*)indexData) + indexStart;
+        for (unsigned i = 0; i < vertices_.Size(); ++i)
+            vertices_[i] = indices[i];
+    }
+
+    Build((const unsigned char*)vertexData, vertexStride);
+}
+
+void TriangleBVH::Clear()
+{
+    nodes_.Clear();
+    triangles_.Clear();
+    vertices_.Clear();
+}
+
+void TriangleBVH::Build(const unsigned char* vertexData, unsigned vertexStride)
+{
+    unsigned numTriangles = vertices_.Size() / 3;
+    if (!numTriangles)
+        return;
+
+    Vector<BoundingBox> bounds(numTriangles);
+    PODVector<Vector3> centers(numTriangles);
+    PODVector<unsigned> order(numTriangles);
+
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        const Vector3& v0 = *((const Vector3*)(&vertexData[vertices_[i * 3] * vertexStride]));
+        const Vector3& v1 = *((const Vector3*)(&vertexData[vertices_[i * 3 + 1] * vertexStride]));
+        const Vector3& v2 = *((const Vector3*)(&vertexData[vertices_[i * 3 + 2] * vertexStride]));
+        bounds[i] = BoundingBox(VectorMin(VectorMin(v0, v1), v2), VectorMax(VectorMax(v0, v1), v2));
+        centers[i] = bounds[i].Center();
+        order[i] = i;
+    }
+
+    nodes_.Reserve(numTriangles / 2 + 1);
+    nodes_.Resize(1);
+
+    PODVector<BVHBuildTask> tasks;
+    tasks.Push(BVHBuildTask{0, 0, numTriangles, 0});
+
+    while (tasks.Size())
+    {
+        BVHBuildTask task = tasks.Back();
+        tasks.Pop();
+
+        BoundingBox nodeBox;
+        BoundingBox centerBox;
+        for (unsigned i = task.start_; i < task.end_; ++i)
+        {
+            nodeBox.Merge(bounds[order[i]]);
+            centerBox.Merge(centers[order[i]]);
+        }
+
+        TriangleBVHNode& node = nodes_[task.node_];
+        node.min_ = nodeBox.min_;
+        node.max_ = nodeBox.max_;
+
+        unsigned count = task.end_ - task.start_;
+        if (count <= BVH_MAX_LEAF_TRIANGLES || task.depth_ >= BVH_MAX_DEPTH)
+        {
+            node.offset_ = task.start_;
+            node.count_ = count;
+            continue;
+        }
+
+        // Find the cheapest split by binning triangle centers along each axis
+        Vector3 centerSize = centerBox.Size();
+        float bestCost = M_INFINITY;
+        unsigned bestAxis = M_MAX_UNSIGNED;
+        unsigned bestBin = 0;
+
+        for (unsigned axis = 0; axis < 3; ++axis)
+        {
+            float axisMin = centerBox.min_.Data()[axis];
+            float axisSize = centerSize.Data()[axis];
+            if (axisSize < M_EPSILON)
+                continue;
+
+            BoundingBox binBoxes[BVH_NUM_BINS];
+            unsigned binCounts[BVH_NUM_BINS] = {};
+            float scale = (float)BVH_NUM_BINS / axisSize;
+
+            for (unsigned i = task.start_; i < task.end_; ++i)
+            {
+                unsigned bin = Min((unsigned)((centers[order[i]].Data()[axis] - axisMin) * scale), BVH_NUM_BINS - 1);
+                ++binCounts[bin];
+                binBoxes[bin].Merge(bounds[order[i]]);
+            }
+
+            float leftAreas[BVH_NUM_BINS];
+            unsigned leftCounts[BVH_NUM_BINS];
+            BoundingBox leftBox;
+            unsigned leftCount = 0;
+            for (unsigned i = 0; i < BVH_NUM_BINS - 1; ++i)
+            {
+                leftBox.Merge(binBoxes[i]);
+                leftCount += binCounts[i];
+                leftAreas[i] = leftCount ? SurfaceArea(leftBox) : 0.0f;
+                leftCounts[i] = leftCount;
+            }
+
+            BoundingBox rightBox;
+            unsigned rightCount = 0;
+            for (unsigned i = BVH_NUM_BINS - 1; i > 0; --i)
+            {
+                rightBox.Merge(binBoxes[i]);
+                rightCount += binCounts[i];
+                if (!rightCount || !leftCounts[i - 1])
+                    continue;
+
+                float cost = leftAreas[i - 1] * leftCounts[i - 1] + SurfaceArea(rightBox) * rightCount;
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = i;
+                }
+            }
+        }
+
+        unsigned middle;
+        if (bestAxis != M_MAX_UNSIGNED)
+        {
+            float axisMin = centerBox.min_.Data()[bestAxis];
+            float scale = (float)BVH_NUM_BINS / centerSize.Data()[bestAxis];
+            unsigned* first = &order[task.start_];
+            unsigned* last = &order[task.end_ - 1] + 1;
+            while (first < last)
+            {
+                unsigned bin = Min((unsigned)((centers[*first].Data()[bestAxis] - axisMin) * scale), BVH_NUM_BINS - 1);
+                if (bin < bestBin)
+                    ++first;
+                else
+                    Swap(*first, *--last);
+            }
+            middle = (unsigned)(first - &order[0]);
+        }
+        else
+        {
+            // All centers coincide, split the range in half
+            middle = (task.start_ + task.end_) / 2;
+        }
+
+        unsigned left = nodes_.Size();
+        nodes_.Resize(left + 2);
+        // The reference may have been invalidated by the resize
+        nodes_[task.node_].offset_ = left;
+        nodes_[task.node_].count_ = 0;
+        tasks.Push(BVHBuildTask{left, task.start_, middle, task.depth_ + 1});
+        tasks.Push(BVHBuildTask{left + 1, middle, task.end_, task.depth_ + 1});
+    }
+
+    triangles_.Resize(numTriangles);
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        unsigned index = order[i];
+        const Vector3& v0 = *((const Vector3*)(&vertexData[vertices_[index * 3] * vertexStride]));
+        const Vector3& v1 = *((const Vector3*)(&vertexData[vertices_[index * 3 + 1] * vertexStride]));
+        const Vector3& v2 = *((const Vector3*)(&vertexData[vertices_[index * 3 + 2] * vertexStride]));
+        TriangleBVHTriangle& triangle = triangles_[i];
+        triangle.v0_ = v0;
+        triangle.edge1_ = v1 - v0;
+        triangle.edge2_ = v2 - v0;
+        triangle.index_ = index;
+    }
+}
+
+float TriangleBVH::HitDistance(const Ray& ray, Vector3* outNormal, Vector3* outBary, unsigned* outTriangle) const
+{
+    float nearest = M_INFINITY;
+    unsigned nearestTriangle = M_MAX_UNSIGNED;
+    const TriangleBVHTriangle* nearestData = nullptr;
+    float nearestU = 0.0f;
+    float nearestV = 0.0f;
+    float nearestDet = 1.0f;
+
+    if (nodes_.Size())
+    {
+        BVHRay bvhRay(ray);
+        unsigned stack[BVH_STACK_SIZE];
+        float stackDistances[BVH_STACK_SIZE];
+        unsigned stackSize = 0;
+
+        float rootDistance = Urho3D::HitDistance(bvhRay, nodes_[0]);
+        if (rootDistance < M_INFINITY)
+        {
+            stack[stackSize] = 0;
+            stackDistances[stackSize++] = rootDistance;
+        }
+
+        while (stackSize)
+        {
+            --stackSize;
+            // Skip nodes which have become farther than the nearest hit since they were pushed
+            if (stackDistances[stackSize] > nearest)
+                continue;
+
+            const TriangleBVHNode& node = nodes_[stack[stackSize]];
+
+            if (node.count_)
+            {
+                const TriangleBVHTriangle* triangle = &triangles_[node.offset_];
+                const TriangleBVHTriangle* end = triangle + node.count_;
+                for (; triangle < end; ++triangle)
+                {
+                    float u, v, det;
+                    float distance = Urho3D::HitDistance(ray, *triangle, u, v, det);
+                    if (IsCloserHit(distance, triangle->index_, nearest, nearestTriangle))
+                    {
+                        nearest = distance;
+                        nearestTriangle = triangle->index_;
+                        nearestData = triangle;
+                        nearestU = u;
+                        nearestV = v;
+                        nearestDet = det;
+                    }
+                }
+            }
+            else
+            {
+                // Visit the nearer child first. Equal distances are still visited to resolve ties deterministically
+                float leftDistance = Urho3D::HitDistance(bvhRay, nodes_[node.offset_]);
+                float rightDistance = Urho3D::HitDistance(bvhRay, nodes_[node.offset_ + 1]);
+                bool leftHit = leftDistance <= nearest && leftDistance < M_INFINITY;
+                bool rightHit = rightDistance <= nearest && rightDistance < M_INFINITY;
+
+                bool leftFirst = leftDistance <= rightDistance;
+
+                if (rightHit && leftFirst)
+                {
+                    stack[stackSize] = node.offset_ + 1;
+                    stackDistances[stackSize++] = rightDistance;
+                }
+                if (leftHit)
+                {
+                    stack[stackSize] = node.offset_;
+                    stackDistances[stackSize++] = leftDistance;
+                }
+                if (rightHit && !leftFirst)
+                {
+                    stack[stackSize] = node.offset_ + 1;
+                    stackDistances[stackSize++] = rightDistance;
+                }
+            }
+        }
+    }
+
+    if (nearestData)
+    {
+        if (outNormal)
+            *outNormal = nearestData->edge1_.CrossProduct(nearestData->edge2_);
+        if (outBary)
+            *outBary = Vector3(1 - (nearestU / nearestDet) - (nearestV / nearestDet), nearestU / nearestDet, nearestV / nearestDet);
+    }
+    if (outTriangle)
+        *outTriangle = nearestTriangle;
+
+    return nearest;
+}
+
+void TriangleBVH::HitDistance(const Ray* rays, unsigned numRays, float* outDistances, unsigned* outTriangles) const
+{
+    numRays = Min(numRays, BVH_PACKET_SIZE);
+
+    float nearest[BVH_PACKET_SIZE];
+    unsigned nearestTriangles[BVH_PACKET_SIZE];
+    for (unsigned i = 0; i < BVH_PACKET_SIZE; ++i)
+    {
+        nearest[i] = M_INFINITY;
+        nearestTriangles[i] = M_MAX_UNSIGNED;
+    }
+
+    if (nodes_.Size() && numRays)
+    {
+#ifdef URHO3D_SSE
+        unsigned activeMask = (1u << numRays) - 1;
+
+        // Rays in structure of arrays layout, unused lanes duplicate the first ray
+        float packet[6][BVH_PACKET_SIZE];
+        for (unsigned i = 0; i < BVH_PACKET_SIZE; ++i)
+        {
+            BVHRay bvhRay(rays[i < numRays ? i : 0]);
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                packet[j][i] = bvhRay.origin_.Data()[j];
+                packet[j + 3][i] = bvhRay.invDirection_.Data()[j];
+            }
+        }
+        __m128 origin[3] = { _mm_loadu_ps(packet[0]), _mm_loadu_ps(packet[1]), _mm_loadu_ps(packet[2]) };
+        __m128 invDirection[3] = { _mm_loadu_ps(packet[3]), _mm_loadu_ps(packet[4]), _mm_loadu_ps(packet[5]) };
+#else
+        BVHRay bvhRays[BVH_PACKET_SIZE] = { BVHRay(rays[0]), BVHRay(rays[Min(1u, numRays - 1)]),
+            BVHRay(rays[Min(2u, numRays - 1)]), BVHRay(rays[Min(3u, numRays - 1)]) };
+#endif
+
+        // Return mask of packet rays which hit a node's bounding box no farther than their current nearest hit
+        auto hitMask = [&](const TriangleBVHNode& node) -> unsigned
+        {
+#ifdef URHO3D_SSE
+            __m128 nearDistance = _mm_setzero_ps();
+            __m128 farDistance = _mm_loadu_ps(nearest);
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps((&node.min_.x_)[j]), origin[j]), invDirection[j]);
+                __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps((&node.max_.x_)[j]), origin[j]), invDirection[j]);
+                nearDistance = _mm_max_ps(nearDistance, _mm_min_ps(t1, t2));
+                farDistance = _mm_min_ps(farDistance, _mm_max_ps(t1, t2));
+            }
+            return (unsigned)_mm_movemask_ps(_mm_cmple_ps(nearDistance, farDistance)) & activeMask;
+#else
+            unsigned mask = 0;
+            for (unsigned i = 0; i < numRays; ++i)
+            {
+                if (Urho3D::HitDistance(bvhRays[i], node) <= nearest[i])
+                    mask |= 1u << i;
+            }
+            return mask;
+#endif
+        };
+
+        unsigned stack[BVH_STACK_SIZE];
+        unsigned stackSize = 0;
+
+        if (hitMask(nodes_[0]))
+            stack[stackSize++] = 0;
+
+        while (stackSize)
+        {
+            const TriangleBVHNode& node = nodes_[stack[--stackSize]];
+            // Nearest hits may have shrunk since the node was pushed
+            unsigned mask = hitMask(node);
+            if (!mask)
+                continue;
+
+            if (node.count_)
+            {
+                const TriangleBVHTriangle* triangle = &triangles_[node.offset_];
+                const TriangleBVHTriangle* end = triangle + node.count_;
+                for (; triangle < end; ++triangle)
+                {
+                    for (unsigned i = 0; i < numRays; ++i)
+                    {
+                        if (!(mask & (1u << i)))
+                            continue;
+
+                        float u, v, det;
+                        float distance = Urho3D::HitDistance(rays[i], *triangle, u, v, det);
+                        if (IsCloserHit(distance, triangle->index_, nearest[i], nearestTriangles[i]))
+                        {
+                            nearest[i] = distance;
+                            nearestTriangles[i] = triangle->index_;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                stack[stackSize++] = node.offset_ + 1;
+                stack[stackSize++] = node.offset_;
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < numRays; ++i)
+    {
+        outDistances[i] = nearest[i];
+        if (outTriangles)
+            outTriangles[i] = nearestTriangles[i];
+    }
+}
+
+void TriangleBVH::GetTriangles(PODVector<unsigned>& dest, const BoundingBox& box) const
+{
+    dest.Clear();
+    if (nodes_.Empty())
+        return;
+
+    unsigned stack[BVH_STACK_SIZE];
+    unsigned stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize)
+    {
+        const TriangleBVHNode& node = nodes_[stack[--stackSize]];
+        if (box.IsInsideFast(BoundingBox(node.min_, node.max_)) == OUTSIDE)
+            continue;
+
+        if (node.count_)
+        {
+            const TriangleBVHTriangle* triangle = &triangles_[node.offset_];
+            const TriangleBVHTriangle* end = triangle + node.count_;
+            for (; triangle < end; ++triangle)
+            {
+                Vector3 v1 = triangle->v0_ + triangle->edge1_;
+                Vector3 v2 = triangle->v0_ + triangle->edge2_;
+                BoundingBox triangleBox(VectorMin(VectorMin(triangle->v0_, v1), v2), VectorMax(VectorMax(triangle->v0_, v1), v2));
+                if (box.IsInsideFast(triangleBox) != OUTSIDE)
+                    dest.Push(triangle->index_);
+            }
+        }
+        else
+        {
+            stack[stackSize++] = node.offset_ + 1;
+            stack[stackSize++] = node.offset_;
+        }
+    }
+
+    Sort(dest.Begin(), dest.End());
+}
+
+}
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Math/BoundingBox.h"
+
+namespace Urho3D
+{
+
+class Ray;
+
+/// Maximum number of rays in a BVH ray packet.
+static const unsigned BVH_PACKET_SIZE = 4;
+
+/// Bounding volume hierarchy node. Inner nodes have zero triangle count and their children stored consecutively.
+struct TriangleBVHNode
+{
+    /// Bounding box minimum.
+    Vector3 min_;
+    /// First child node index for inner nodes, first triangle index for leaves.
+    unsigned offset_;
+    /// Bounding box maximum.
+    Vector3 max_;
+    /// Number of triangles in a leaf, zero for inner nodes.
+    unsigned count_;
+};
+
+/// Triangle stored in BVH leaf order, in the form used by the ray intersection test.
+struct TriangleBVHTriangle
+{
+    /// First vertex position.
+    Vector3 v0_;
+    /// Edge from first to second vertex.
+    Vector3 edge1_;
+    /// Edge from first to third vertex.
+    Vector3 edge2_;
+    /// Index of the triangle in the source geometry.
+    unsigned index_;
+};
+
+/// Bounding volume hierarchy over triangle data for accelerated CPU-side raycasts and box queries.
+class URHO3D_API TriangleBVH
+{
+public:
+    /// Construct empty.
+    TriangleBVH();
+
+    /// Build from non-indexed triangle list data. The vertex position must be the first element of each vertex.
+    void Define(const void* vertexData, unsigned vertexStride, unsigned vertexStart, unsigned vertexCount);
+    /// Build from indexed triangle list data. The vertex position must be the first element of each vertex.
+    void Define(const void* vertexData, unsigned vertexStride, const void* indexData, unsigned indexSize, unsigned indexStart,
+        unsigned indexCount);
+    /// Remove all triangles.
+    void Clear();
+
+    /// Return hit distance to the nearest triangle, or infinity if no hit. Optionally return hit normal, barycentric coordinate and triangle index. Results match Ray::HitDistance on the same data.
+    float HitDistance(const Ray& ray, Vector3* outNormal = nullptr, Vector3* outBary = nullptr, unsigned* outTriangle = nullptr) const;
+    /// Return hit distances of up to BVH_PACKET_SIZE rays traversed as one packet. Triangle indices are optional and M_MAX_UNSIGNED for misses.
+    void HitDistance(const Ray* rays, unsigned numRays, float* outDistances, unsigned* outTriangles = nullptr) const;
+    /// Return indices of triangles whose bounding boxes intersect the box, in ascending order.
+    void GetTriangles(PODVector<unsigned>& dest, const BoundingBox& box) const;
+    /// Return vertex indices of a triangle.
+    void GetTriangleVertices(unsigned triangle, unsigned& i0, unsigned& i1, unsigned& i2) const
+    {
+        const unsigned* vertices = &vertices_[triangle * 3];
+        i0 = vertices[0];
+        i1 = vertices[1];
+        i2 = vertices[2];
+    }
+
+    /// Return number of triangles.
+    unsigned GetNumTriangles() const { return triangles_.Size(); }
+
+    /// Return number of nodes.
+    unsigned GetNumNodes() const { return nodes_.Size(); }
+
+    /// Return whether has no triangles.
+    bool IsEmpty() const { return triangles_.Empty(); }
+
+    /// Return bounding box of all triangles.
+    BoundingBox GetBoundingBox() const { return nodes_.Size() ? BoundingBox(nodes_[0].min_, nodes_[0].max_) : BoundingBox(); }
+
+    /// Return approximate memory use in bytes.
+    unsigned GetMemoryUse() const
+    {
+        return nodes_.Size() * sizeof(TriangleBVHNode) + triangles_.Size() * sizeof(TriangleBVHTriangle) +
+            vertices_.Size() * sizeof(unsigned);
+    }
+
+private:
+    /// Build the hierarchy from the vertex index list.
+    void Build(const unsigned char* vertexData, unsigned vertexStride);
+
+    /// Nodes, root first.
+    PODVector<TriangleBVHNode> nodes_;
+    /// Triangles in leaf order.
+    PODVector<TriangleBVHTriangle> triangles_;
+    /// Vertex indices of triangles in source order.
+    PODVector<unsigned> vertices_;
+};
+
+}
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/MemoryStats.h"
 #include "../Core/Profiler.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
@@ -450,6 +451,7 @@ bool Network::CheckRemoteEvent(StringHash eventType) const
 void Network::Update(float timeStep)
 {
     URHO3D_PROFILE("UpdateNetwork");
+    URHO3D_MEMORY_TAG(MEMTAG_NETWORK);
 
     // Process server connection if it exists
     if (serverConnection_)
@@ -481,6 +483,7 @@ void Network::Update(float timeStep)
 void Network::PostUpdate(float timeStep)
 {
     URHO3D_PROFILE("PostUpdateNetwork");
+    URHO3D_MEMORY_TAG(MEMTAG_NETWORK);
 
     // Check if periodic update should happen now
     updateAcc_ += timeStep;
@@ -32,6 +32,8 @@
 #include "../Graphics/Model.h"
 #include "../Graphics/Terrain.h"
 #include "../Graphics/VertexBuffer.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Physics/CollisionShape.h"
 #include "../Physics/PhysicsUtils.h"
@@ -49,6 +51,7 @@
 #include <Bullet/BulletCollision/CollisionShapes/btConvexHullShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btCylinderShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btOptimizedBvh.h>
 #include <Bullet/BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
@@ -62,6 +65,7 @@ namespace Urho3D
 
 static const float DEFAULT_COLLISION_MARGIN = 0.04f;
 static const unsigned QUANTIZE_MAX_TRIANGLES = 1000000;
+static const unsigned COOKED_COLLISION_VERSION = 1;
 
 static const btVector3 WHITE(1.0f, 1.0f, 1.0f);
 static const btVector3 GREEN(0.0f, 1.0f, 0.0f);
@@ -196,13 +200,121 @@ private:
     Vector<SharedArrayPtr<unsigned char> > dataArrays_;
 };
 
+bool HasDynamicBuffers(Model* model, unsigned lodLevel);
+
+/// Hash collision source data.
+static unsigned HashCollisionData(unsigned hash, const void* data, unsigned size)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (unsigned i = 0; i < size; ++i)
+        hash = SDBMHash(hash, bytes[i]);
+    return hash;
+}
+
+/// Hash the triangles of a mesh interface, including the vertex positions of each.
+static unsigned HashTriangleMesh(const btStridingMeshInterface* meshInterface)
+{
+    unsigned hash = 0;
+
+    for (int part = 0; part < meshInterface->getNumSubParts(); ++part)
+    {
+        const unsigned char* vertexBase;
+        const unsigned char* indexBase;
+        int numVertices, vertexStride, indexStride, numFaces;
+        PHY_ScalarType vertexType, indexType;
+        meshInterface->getLockedReadOnlyVertexIndexBase(&vertexBase, numVertices, vertexType, vertexStride, &indexBase, indexStride,
+            numFaces, indexType, part);
+
+        hash = HashCollisionData(hash, &numFaces, sizeof numFaces);
+        for (int i = 0; i < numFaces; ++i)
+        {
+            const unsigned char* face = indexBase + i * indexStride;
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                unsigned index = indexType == PHY_SHORT ? reinterpret_cast<const unsigned short*>(face)[j] :
+                    reinterpret_cast<const unsigned*>(face)[j];
+                hash = HashCollisionData(hash, vertexBase + index * vertexStride, sizeof(Vector3));
+            }
+        }
+
+        meshInterface->unLockReadOnlyVertexBase(part);
+    }
+
+    return hash;
+}
+
+/// Return the cooked collision data file name for a model, or empty if the collision cache is not used or the model data can change.
+static String GetCookedCollisionFileName(Model* model, unsigned lodLevel, ShapeType shapeType)
+{
+    const String& cacheDir = PhysicsWorld::config.collisionCacheDir_;
+    if (cacheDir.Empty() || model->GetName().Empty() || HasDynamicBuffers(model, lodLevel))
+        return String::EMPTY;
+
+    return AddTrailingSlash(cacheDir) + GetFileName(model->GetName()) + "_" + StringHash(model->GetName()).ToString() + "_" +
+        String(lodLevel) + (shapeType == SHAPE_TRIANGLEMESH ? ".tri" : ".hull");
+}
+
+/// Open a cooked collision data file and return it positioned after the header, or null if it does not exist or is not up to date.
+static SharedPtr<File> OpenCookedCollisionFile(Context* context, const String& fileName, ShapeType shapeType, unsigned contentHash)
+{
+    auto* fileSystem = context->GetSubsystem<FileSystem>();
+    if (!fileSystem || !fileSystem->FileExists(fileName))
+        return SharedPtr<File>();
+
+    // The BVH is used in place, so its layout must match this build
+    SharedPtr<File> file(new File(context, fileName));
+    if (!file->IsOpen() || file->ReadFileID() != "UCOL" || file->ReadUInt() != COOKED_COLLISION_VERSION ||
+        file->ReadUInt() != (unsigned)shapeType || file->ReadUInt() != contentHash || file->ReadUInt() != sizeof(btOptimizedBvh))
+        return SharedPtr<File>();
+
+    return file;
+}
+
+/// Create a cooked collision data file and write the header. Return null on failure.
+static SharedPtr<File> CreateCookedCollisionFile(Context* context, const String& fileName, ShapeType shapeType, unsigned contentHash)
+{
+    auto* fileSystem = context->GetSubsystem<FileSystem>();
+    if (!fileSystem || !fileSystem->CreateDirsRecursive(GetPath(fileName)))
+        return SharedPtr<File>();
+
+    SharedPtr<File> file(new File(context, fileName, FILE_WRITE));
+    if (!file->IsOpen())
+        return SharedPtr<File>();
+
+    file->WriteFileID("UCOL");
+    file->WriteUInt(COOKED_COLLISION_VERSION);
+    file->WriteUInt((unsigned)shapeType);
+    file->WriteUInt(contentHash);
+    file->WriteUInt(sizeof(btOptimizedBvh));
+    return file;
+}
+
 TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel)
 {
     meshInterface_ = new TriangleMeshInterface(model, lodLevel);
+
+    // Use the cooked BVH and triangle info if they are up to date, as building them is slow for large meshes
+    String cookedFileName = GetCookedCollisionFileName(model, lodLevel, SHAPE_TRIANGLEMESH);
+    unsigned contentHash = 0;
+    if (!cookedFileName.Empty())
+    {
+        contentHash = HashTriangleMesh(meshInterface_.Get());
+        SharedPtr<File> file = OpenCookedCollisionFile(model->GetContext(), cookedFileName, SHAPE_TRIANGLEMESH, contentHash);
+        if (file && LoadCooked(*file))
+            return;
+    }
+
     shape_ = new btBvhTriangleMeshShape(meshInterface_.Get(), meshInterface_->useQuantize_, true);
 
     infoMap_ = new btTriangleInfoMap();
     btGenerateInternalEdgeInfo(shape_.Get(), infoMap_.Get());
+
+    if (!cookedFileName.Empty())
+    {
+        SharedPtr<File> file = CreateCookedCollisionFile(model->GetContext(), cookedFileName, SHAPE_TRIANGLEMESH, contentHash);
+        if (!file || !SaveCooked(*file))
+            URHO3D_LOGWARNING("Could not save cooked collision data " + cookedFileName);
+    }
 }
 
 TriangleMeshData::TriangleMeshData(CustomGeometry* custom)
@@ -214,6 +326,93 @@ TriangleMeshData::TriangleMeshData(CustomGeometry* custom)
     btGenerateInternalEdgeInfo(shape_.Get(), infoMap_.Get());
 }
 
+bool TriangleMeshData::LoadCooked(Deserializer& source)
+{
+    bool useQuantize = source.ReadBool();
+    Vector3 aabbMin = source.ReadVector3();
+    Vector3 aabbMax = source.ReadVector3();
+
+    // The BVH is deserialized in place and must be 16-byte aligned
+    unsigned bvhSize = source.ReadUInt();
+    if (!bvhSize || bvhSize > source.GetSize() - source.GetPosition())
+        return false;
+    SharedArrayPtr<unsigned char> bvhData(new unsigned char[bvhSize + 16]);
+    auto* alignedBvhData = reinterpret_cast<unsigned char*>((reinterpret_cast<size_t>(bvhData.Get()) + 15) & ~(size_t)15);
+    if (source.Read(alignedBvhData, bvhSize) != bvhSize)
+        return false;
+    btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(alignedBvhData, bvhSize, false);
+    if (!bvh)
+        return false;
+
+    UniquePtr<btTriangleInfoMap> infoMap(new btTriangleInfoMap());
+    infoMap->m_convexEpsilon = source.ReadFloat();
+    infoMap->m_planarEpsilon = source.ReadFloat();
+    infoMap->m_equalVertexThreshold = source.ReadFloat();
+    infoMap->m_edgeDistanceThreshold = source.ReadFloat();
+    infoMap->m_maxEdgeAngleThreshold = source.ReadFloat();
+    infoMap->m_zeroAreaThreshold = source.ReadFloat();
+    unsigned numInfos = source.ReadUInt();
+    for (unsigned i = 0; i < numInfos && !source.IsEof(); ++i)
+    {
+        int key = source.ReadInt();
+        btTriangleInfo info;
+        info.m_flags = source.ReadInt();
+        info.m_edgeV0V1Angle = source.ReadFloat();
+        info.m_edgeV1V2Angle = source.ReadFloat();
+        info.m_edgeV2V0Angle = source.ReadFloat();
+        infoMap->insert(btHashInt(key), info);
+    }
+    if ((unsigned)infoMap->size() != numInfos)
+        return false;
+
+    // With the premade AABB the shape does not need to go through the triangles
+    meshInterface_->setPremadeAabb(ToBtVector3(aabbMin), ToBtVector3(aabbMax));
+    shape_ = new btBvhTriangleMeshShape(meshInterface_.Get(), useQuantize, false);
+    shape_->setOptimizedBvh(bvh);
+    infoMap_ = infoMap.Detach();
+    shape_->setTriangleInfoMap(infoMap_.Get());
+    bvhData_ = bvhData;
+    return true;
+}
+
+bool TriangleMeshData::SaveCooked(Serializer& dest) const
+{
+    btOptimizedBvh* bvh = shape_ ? shape_->getOptimizedBvh() : nullptr;
+    if (!bvh || !infoMap_)
+        return false;
+
+    bool success = true;
+    success &= dest.WriteBool(shape_->usesQuantizedAabbCompression());
+    success &= dest.WriteVector3(ToVector3(shape_->getLocalAabbMin()));
+    success &= dest.WriteVector3(ToVector3(shape_->getLocalAabbMax()));
+
+    unsigned bvhSize = bvh->calculateSerializeBufferSize();
+    void* bvhData = btAlignedAlloc(bvhSize, 16);
+    success &= bvh->serializeInPlace(bvhData, bvhSize, false);
+    success &= dest.WriteUInt(bvhSize);
+    success &= dest.Write(bvhData, bvhSize) == bvhSize;
+    btAlignedFree(bvhData);
+
+    success &= dest.WriteFloat(infoMap_->m_convexEpsilon);
+    success &= dest.WriteFloat(infoMap_->m_planarEpsilon);
+    success &= dest.WriteFloat(infoMap_->m_equalVertexThreshold);
+    success &= dest.WriteFloat(infoMap_->m_edgeDistanceThreshold);
+    success &= dest.WriteFloat(infoMap_->m_maxEdgeAngleThreshold);
+    success &= dest.WriteFloat(infoMap_->m_zeroAreaThreshold);
+    success &= dest.WriteUInt((unsigned)infoMap_->size());
+    for (int i = 0; i < infoMap_->size(); ++i)
+    {
+        const btTriangleInfo* info = infoMap_->getAtIndex(i);
+        success &= dest.WriteInt(infoMap_->getKeyAtIndex(i).getUid1());
+        success &= dest.WriteInt(info->m_flags);
+        success &= dest.WriteFloat(info->m_edgeV0V1Angle);
+        success &= dest.WriteFloat(info->m_edgeV1V2Angle);
+        success &= dest.WriteFloat(info->m_edgeV2V0Angle);
+    }
+
+    return success;
+}
+
 GImpactMeshData::GImpactMeshData(Model* model, unsigned lodLevel)
 {
     meshInterface_ = new TriangleMeshInterface(model, lodLevel);
@@ -262,7 +461,23 @@ ConvexData::ConvexData(Model* model, unsigned lodLevel)
         }
     }
 
+    // Use the cooked hull if it is up to date
+    String cookedFileName = GetCookedCollisionFileName(model, lodLevel, SHAPE_CONVEXHULL);
+    if (cookedFileName.Empty())
+    {
+        BuildHull(vertices);
+        return;
+    }
+
+    unsigned contentHash = HashCollisionData(0, vertices.Buffer(), vertices.Size() * sizeof(Vector3));
+    SharedPtr<File> file = OpenCookedCollisionFile(model->GetContext(), cookedFileName, SHAPE_CONVEXHULL, contentHash);
+    if (file && LoadCooked(*file))
+        return;
+
     BuildHull(vertices);
+    file = CreateCookedCollisionFile(model->GetContext(), cookedFileName, SHAPE_CONVEXHULL, contentHash);
+    if (!file || !SaveCooked(*file))
+        URHO3D_LOGWARNING("Could not save cooked collision data " + cookedFileName);
 }
 
 ConvexData::ConvexData(CustomGeometry* custom)
@@ -314,6 +529,37 @@ void ConvexData::BuildHull(const PODVector<Vector3>& vertices)
     }
 }
 
+bool ConvexData::LoadCooked(Deserializer& source)
+{
+    unsigned vertexCount = source.ReadUInt();
+    unsigned indexCount = source.ReadUInt();
+    if ((unsigned long long)vertexCount * sizeof(Vector3) + (unsigned long long)indexCount * sizeof(unsigned) !=
+        source.GetSize() - source.GetPosition())
+        return false;
+
+    SharedArrayPtr<Vector3> vertexData(new Vector3[vertexCount]);
+    SharedArrayPtr<unsigned> indexData(new unsigned[indexCount]);
+    if (source.Read(vertexData.Get(), vertexCount * sizeof(Vector3)) != vertexCount * sizeof(Vector3) ||
+        source.Read(indexData.Get(), indexCount * sizeof(unsigned)) != indexCount * sizeof(unsigned))
+        return false;
+
+    vertexData_ = vertexData;
+    vertexCount_ = vertexCount;
+    indexData_ = indexData;
+    indexCount_ = indexCount;
+    return true;
+}
+
+bool ConvexData::SaveCooked(Serializer& dest) const
+{
+    bool success = true;
+    success &= dest.WriteUInt(vertexCount_);
+    success &= dest.WriteUInt(indexCount_);
+    success &= dest.Write(vertexData_.Get(), vertexCount_ * sizeof(Vector3)) == vertexCount_ * sizeof(Vector3);
+    success &= dest.Write(indexData_.Get(), indexCount_ * sizeof(unsigned)) == indexCount_ * sizeof(unsigned);
+    return success;
+}
+
 HeightfieldData::HeightfieldData(Terrain* terrain, unsigned lodLevel) :
     heightData_(terrain->GetHeightData()),
     spacing_(terrain->GetSpacing()),
@@ -844,6 +1090,9 @@ BoundingBox CollisionShape::GetWorldBoundingBox() const
 
 void CollisionShape::NotifyRigidBody(bool updateMass)
 {
+    if (physicsWorld_)
+        physicsWorld_->WaitForStep();
+
     btCompoundShape* compound = GetParentCompoundShape();
     if (node_ && shape_ && compound)
     {
@@ -888,6 +1137,10 @@ ResourceRef CollisionShape::GetModelAttr() const
 
 void CollisionShape::ReleaseShape()
 {
+    // The shape may be in use by an asynchronous simulation step
+    if (physicsWorld_)
+        physicsWorld_->WaitForStep();
+
     btCompoundShape* compound = GetParentCompoundShape();
     if (shape_ && compound)
     {
@@ -957,6 +1210,9 @@ void CollisionShape::OnMarkedDirty(Node* node)
             return;
         }
 
+        if (physicsWorld_)
+            physicsWorld_->WaitForStep();
+
         switch (shapeType_)
         {
         case SHAPE_BOX:
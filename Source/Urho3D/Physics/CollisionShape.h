@@ -39,10 +39,12 @@ namespace Urho3D
 {
 
 class CustomGeometry;
+class Deserializer;
 class Geometry;
 class Model;
 class PhysicsWorld;
 class RigidBody;
+class Serializer;
 class Terrain;
 class TriangleMeshInterface;
 
@@ -78,8 +80,15 @@ struct TriangleMeshData : public CollisionGeometryData
     /// Construct from a custom geometry.
     explicit TriangleMeshData(CustomGeometry* custom);
 
+    /// Load cooked BVH and triangle info map from a stream. The mesh interface must already exist. Return true if successful.
+    bool LoadCooked(Deserializer& source);
+    /// Save cooked BVH and triangle info map to a stream. Return true if successful.
+    bool SaveCooked(Serializer& dest) const;
+
     /// Bullet triangle mesh interface.
     UniquePtr<TriangleMeshInterface> meshInterface_;
+    /// Cooked BVH data when loaded from the collision cache. The shape uses the BVH in place.
+    SharedArrayPtr<unsigned char> bvhData_;
     /// Bullet triangle mesh collision shape.
     UniquePtr<btBvhTriangleMeshShape> shape_;
     /// Bullet triangle info map.
@@ -108,6 +117,10 @@ struct ConvexData : public CollisionGeometryData
 
     /// Build the convex hull from vertices.
     void BuildHull(const PODVector<Vector3>& vertices);
+    /// Load cooked hull vertices and indices from a stream. Return true if successful.
+    bool LoadCooked(Deserializer& source);
+    /// Save cooked hull vertices and indices to a stream. Return true if successful.
+    bool SaveCooked(Serializer& dest) const;
 
     /// Vertex data.
     SharedArrayPtr<Vector3> vertexData_;
@@ -126,7 +126,10 @@ void Constraint::ApplyAttributes()
 void Constraint::OnSetEnabled()
 {
     if (constraint_)
+    {
+        physicsWorld_->WaitForStep();
         constraint_->setEnabled(IsEnabledEffective());
+    }
 }
 
 void Constraint::GetDependencyNodes(PODVector<Node*>& dest)
@@ -141,6 +144,7 @@ void Constraint::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     {
         physicsWorld_->SetDebugRenderer(debug);
         physicsWorld_->SetDebugDepthTest(depthTest);
+        physicsWorld_->WaitForStep();
         physicsWorld_->GetWorld()->debugDrawConstraint(constraint_.Get());
         physicsWorld_->SetDebugRenderer(nullptr);
     }
@@ -262,6 +266,7 @@ void Constraint::SetWorldPosition(const Vector3& position)
 {
     if (constraint_)
     {
+        physicsWorld_->WaitForStep();
         btTransform ownBodyInverse = constraint_->getRigidBodyA().getWorldTransform().inverse();
         btTransform otherBodyInverse = constraint_->getRigidBodyB().getWorldTransform().inverse();
         btVector3 worldPos = ToBtVector3(position);
@@ -337,6 +342,7 @@ Vector3 Constraint::GetWorldPosition() const
 {
     if (constraint_)
     {
+        physicsWorld_->WaitForStep();
         btTransform ownBody = constraint_->getRigidBodyA().getWorldTransform();
         return ToVector3(ownBody * ToBtVector3(position_ * cachedWorldScale_ - ownBody_->GetCenterOfMass()));
     }
@@ -348,6 +354,10 @@ void Constraint::ReleaseConstraint()
 {
     if (constraint_)
     {
+        // The constraint may be in use by an asynchronous simulation step
+        if (physicsWorld_)
+            physicsWorld_->WaitForStep();
+
         if (ownBody_)
             ownBody_->RemoveConstraint(this);
         if (otherBody_)
@@ -365,6 +375,8 @@ void Constraint::ApplyFrames()
     if (!constraint_ || !node_ || (otherBody_ && !otherBody_->GetNode()))
         return;
 
+    physicsWorld_->WaitForStep();
+
     cachedWorldScale_ = node_->GetWorldScale();
 
     Vector3 ownBodyScaledPosition = position_ * cachedWorldScale_ - ownBody_->GetCenterOfMass();
@@ -474,6 +486,8 @@ void Constraint::CreateConstraint()
         return;
     }
 
+    physicsWorld_->WaitForStep();
+
     if (!otherBody)
         otherBody = &btTypedConstraint::getFixedBody();
 
@@ -541,6 +555,8 @@ void Constraint::ApplyLimits()
     if (!constraint_)
         return;
 
+    physicsWorld_->WaitForStep();
+
     switch (constraint_->getConstraintType())
     {
     case HINGE_CONSTRAINT_TYPE:
@@ -584,6 +600,7 @@ void Constraint::AdjustOtherBodyPosition()
     // overridden and does not accumulate constraint error
     if (constraint_ && !otherBody_)
     {
+        physicsWorld_->WaitForStep();
         btTransform ownBody = constraint_->getRigidBodyA().getWorldTransform();
         btVector3 worldPos = ownBody * ToBtVector3(position_ * cachedWorldScale_ - ownBody_->GetCenterOfMass());
         otherPosition_ = ToVector3(worldPos);
@@ -23,8 +23,13 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/MemoryStats.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
@@ -40,6 +45,7 @@
 #include "../Scene/SceneEvents.h"
 
 #include <Bullet/BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <Bullet/BulletCollision/CollisionDispatch/btCollisionObjectWrapper.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
 #include <Bullet/BulletCollision/CollisionShapes/btBoxShape.h>
@@ -47,6 +53,7 @@
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <Bullet/LinearMath/btTransformUtil.h>
 
 extern ContactAddedCallback gContactAddedCallback;
 
@@ -58,6 +65,7 @@ extern const char* SUBSYSTEM_CATEGORY;
 
 static const int MAX_SOLVER_ITERATIONS = 256;
 static const Vector3 DEFAULT_GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
+static const unsigned MIN_QUERIES_PER_WORK_ITEM = 64;
 
 PhysicsWorldConfig PhysicsWorld::config;
 
@@ -66,14 +74,496 @@ static bool CompareRaycastResults(const PhysicsRaycastResult& lhs, const Physics
     return lhs.distance_ < rhs.distance_;
 }
 
+/// Batched physics query with its collision shape resolved on the main thread.
+struct ResolvedPhysicsQuery
+{
+    /// Query, with the collision shape's offset applied to the convex cast transforms.
+    PhysicsQuery query_;
+    /// Bullet shape for convex casts. Null if the shape was not valid.
+    btConvexShape* shape_;
+    /// Collision object to exclude from the result.
+    const btCollisionObject* ignoreObject_;
+};
+
+/// Batched physics query work item data.
+struct PhysicsQueryBatchWorkData
+{
+    /// Broadphase.
+    btDbvtBroadphase* broadphase_;
+    /// Resolved queries.
+    const ResolvedPhysicsQuery* queries_;
+    /// Results, one per query.
+    PhysicsRaycastResult* results_;
+};
+
+/// Bullet dynamics world that exposes its variable timestep state, which belongs to a simulation snapshot.
+class PhysicsDynamicsWorld : public btDiscreteDynamicsWorld
+{
+public:
+    using btDiscreteDynamicsWorld::btDiscreteDynamicsWorld;
+    using btDiscreteDynamicsWorld::releasePredictiveContacts;
+
+    /// Return the time accumulated towards the next fixed step.
+    btScalar GetLocalTime() const { return m_localTime; }
+    /// Return the fixed step of the last simulation.
+    btScalar GetFixedTimeStep() const { return m_fixedTimeStep; }
+    /// Set the timestep state.
+    void SetTimeStepState(btScalar localTime, btScalar fixedTimeStep)
+    {
+        m_localTime = localTime;
+        m_fixedTimeStep = fixedTimeStep;
+    }
+};
+
+/// Compare contact manifolds for a solving order that does not depend on the broadphase or dispatcher history.
+static bool CompareManifolds(const btPersistentManifold* lhs, const btPersistentManifold* rhs)
+{
+    int lhsIndex = lhs->getBody0()->getWorldArrayIndex();
+    int rhsIndex = rhs->getBody0()->getWorldArrayIndex();
+    if (lhsIndex != rhsIndex)
+        return lhsIndex < rhsIndex;
+    lhsIndex = lhs->getBody1()->getWorldArrayIndex();
+    rhsIndex = rhs->getBody1()->getWorldArrayIndex();
+    if (lhsIndex != rhsIndex)
+        return lhsIndex < rhsIndex;
+    if (lhs->getNumContacts() != rhs->getNumContacts())
+        return lhs->getNumContacts() < rhs->getNumContacts();
+    if (!lhs->getNumContacts())
+        return false;
+
+    // Several manifolds between the same objects are from compound child shapes
+    const btManifoldPoint& lhsPoint = lhs->getContactPoint(0);
+    const btManifoldPoint& rhsPoint = rhs->getContactPoint(0);
+    if (lhsPoint.m_index0 != rhsPoint.m_index0)
+        return lhsPoint.m_index0 < rhsPoint.m_index0;
+    if (lhsPoint.m_index1 != rhsPoint.m_index1)
+        return lhsPoint.m_index1 < rhsPoint.m_index1;
+    if (lhsPoint.m_partId0 != rhsPoint.m_partId0)
+        return lhsPoint.m_partId0 < rhsPoint.m_partId0;
+    if (lhsPoint.m_partId1 != rhsPoint.m_partId1)
+        return lhsPoint.m_partId1 < rhsPoint.m_partId1;
+    return lhsPoint.m_distance1 < rhsPoint.m_distance1;
+}
+
+/// Compare constraints for a solving order that does not depend on the simulation island history.
+static bool CompareConstraints(const btTypedConstraint* lhs, const btTypedConstraint* rhs)
+{
+    int lhsIndex = lhs->getRigidBodyA().getWorldArrayIndex();
+    int rhsIndex = rhs->getRigidBodyA().getWorldArrayIndex();
+    if (lhsIndex != rhsIndex)
+        return lhsIndex < rhsIndex;
+    lhsIndex = lhs->getRigidBodyB().getWorldArrayIndex();
+    rhsIndex = rhs->getRigidBodyB().getWorldArrayIndex();
+    if (lhsIndex != rhsIndex)
+        return lhsIndex < rhsIndex;
+    return lhs < rhs;
+}
+
+/// Bullet constraint solver that can solve the contacts in an order that depends only on the current state of the world, so
+/// that re-simulating from a restored snapshot gives the same results.
+class PhysicsConstraintSolver : public btSequentialImpulseConstraintSolver
+{
+public:
+    /// Solve a group of constraints.
+    btScalar solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds, int numManifolds,
+        btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info, btIDebugDraw* debugDrawer,
+        btDispatcher* dispatcher) override
+    {
+        if (sortManifolds_)
+        {
+            Sort(RandomAccessIterator<btPersistentManifold*>(manifolds),
+                RandomAccessIterator<btPersistentManifold*>(manifolds + numManifolds), CompareManifolds);
+            Sort(RandomAccessIterator<btTypedConstraint*>(constraints),
+                RandomAccessIterator<btTypedConstraint*>(constraints + numConstraints), CompareConstraints);
+        }
+
+        return btSequentialImpulseConstraintSolver::solveGroup(bodies, numBodies, manifolds, numManifolds, constraints,
+            numConstraints, info, debugDrawer, dispatcher);
+    }
+
+    /// Sort the contact manifolds before solving flag.
+    bool sortManifolds_{};
+};
+
+/// Physics snapshot header.
+struct PhysicsSnapshotHeader
+{
+    /// Number of collision objects in the world.
+    unsigned numObjects_;
+    /// Number of constraints in the world.
+    unsigned numConstraints_;
+    /// Number of contact manifolds.
+    unsigned numManifolds_;
+    /// Bullet time accumulator for interpolated mode.
+    float localTime_;
+    /// Bullet fixed step of the last simulation.
+    float fixedTimeStep_;
+    /// Time accumulator for non-interpolated mode.
+    float timeAcc_;
+    /// Constraint solver random seed.
+    unsigned long long solverSeed_;
+};
+
+/// Physics snapshot state of one collision object. The transforms are stored as the basis rows followed by the origin.
+struct RigidBodySnapshot
+{
+    /// Rigid body component ID, or 0 if the object is not a rigid body.
+    unsigned id_;
+    /// Activation state.
+    int activationState_;
+    /// Time spent below the sleeping thresholds.
+    float deactivationTime_;
+    /// Fraction of the last step simulated before a continuous collision.
+    float hitFraction_;
+    /// World transform.
+    float worldTransform_[12];
+    /// World transform at the start of the last step, used for interpolation.
+    float interpolationWorldTransform_[12];
+    /// Linear velocity.
+    float linearVelocity_[3];
+    /// Angular velocity.
+    float angularVelocity_[3];
+    /// Linear velocity used for interpolation.
+    float interpolationLinearVelocity_[3];
+    /// Angular velocity used for interpolation.
+    float interpolationAngularVelocity_[3];
+};
+
+/// Physics snapshot state of one constraint.
+struct ConstraintSnapshot
+{
+    /// Impulse applied on the last step.
+    float appliedImpulse_;
+    /// Enabled flag, cleared when the constraint breaks.
+    int enabled_;
+};
+
+/// Physics snapshot header of one contact manifold, followed by its contact points.
+struct ManifoldSnapshot
+{
+    /// World index of the first collision object.
+    int indexA_;
+    /// World index of the second collision object.
+    int indexB_;
+    /// Number of contact points.
+    int numContacts_;
+};
+
+static void StoreVector(float* dest, const btVector3& vector)
+{
+    dest[0] = vector.x();
+    dest[1] = vector.y();
+    dest[2] = vector.z();
+}
+
+static btVector3 LoadVector(const float* src)
+{
+    return btVector3(src[0], src[1], src[2]);
+}
+
+static void StoreTransform(float* dest, const btTransform& transform)
+{
+    const btMatrix3x3& basis = transform.getBasis();
+    for (int i = 0; i < 3; ++i)
+        StoreVector(dest + i * 3, basis[i]);
+    StoreVector(dest + 9, transform.getOrigin());
+}
+
+static btTransform LoadTransform(const float* src)
+{
+    return btTransform(btMatrix3x3(src[0], src[1], src[2], src[3], src[4], src[5], src[6], src[7], src[8]), LoadVector(src + 9));
+}
+
+/// Set up the direction of a broadphase ray as btCollisionWorld does.
+static void SetBroadphaseRay(btBroadphaseRayCallback& callback, const btVector3& from, const btVector3& to)
+{
+    btVector3 unnormalizedDir = to - from;
+    btVector3 rayDir = unnormalizedDir.normalized();
+    for (int i = 0; i < 3; ++i)
+    {
+        callback.m_rayDirectionInverse[i] = rayDir[i] == 0.0f ? btScalar(BT_LARGE_FLOAT) : 1.0f / rayDir[i];
+        callback.m_signs[i] = callback.m_rayDirectionInverse[i] < 0.0f;
+    }
+    callback.m_lambda_max = rayDir.dot(unnormalizedDir);
+}
+
+/// Broadphase callback performing an exact raycast against each object whose AABB the ray hits.
+struct BatchRayCallback : public btBroadphaseRayCallback
+{
+    /// Construct.
+    BatchRayCallback(const btVector3& from, const btVector3& to, btCollisionWorld::RayResultCallback& resultCallback) :
+        resultCallback_(resultCallback)
+    {
+        fromTrans_.setIdentity();
+        fromTrans_.setOrigin(from);
+        toTrans_.setIdentity();
+        toTrans_.setOrigin(to);
+        SetBroadphaseRay(*this, from, to);
+    }
+
+    /// Process a broadphase proxy. Return false to end the traversal.
+    bool process(const btBroadphaseProxy* proxy) override
+    {
+        if (resultCallback_.m_closestHitFraction == 0.0f)
+            return false;
+
+        auto* object = static_cast<btCollisionObject*>(proxy->m_clientObject);
+        if (resultCallback_.needsCollision(object->getBroadphaseHandle()))
+        {
+            btCollisionWorld::rayTestSingle(fromTrans_, toTrans_, object, object->getCollisionShape(),
+                object->getWorldTransform(), resultCallback_);
+        }
+        return true;
+    }
+
+    /// Ray start transform.
+    btTransform fromTrans_;
+    /// Ray end transform.
+    btTransform toTrans_;
+    /// Result callback.
+    btCollisionWorld::RayResultCallback& resultCallback_;
+};
+
+/// Broadphase callback performing an exact swept convex test against each object whose expanded AABB the sweep hits.
+struct BatchSweepCallback : public btBroadphaseRayCallback
+{
+    /// Construct.
+    BatchSweepCallback(const btConvexShape* shape, const btTransform& fromTrans, const btTransform& toTrans,
+        btCollisionWorld::ConvexResultCallback& resultCallback) :
+        shape_(shape),
+        fromTrans_(fromTrans),
+        toTrans_(toTrans),
+        resultCallback_(resultCallback)
+    {
+        SetBroadphaseRay(*this, fromTrans.getOrigin(), toTrans.getOrigin());
+    }
+
+    /// Process a broadphase proxy. Return false to end the traversal.
+    bool process(const btBroadphaseProxy* proxy) override
+    {
+        if (resultCallback_.m_closestHitFraction == 0.0f)
+            return false;
+
+        auto* object = static_cast<btCollisionObject*>(proxy->m_clientObject);
+        if (resultCallback_.needsCollision(object->getBroadphaseHandle()))
+        {
+            btCollisionWorld::objectQuerySingle(shape_, fromTrans_, toTrans_, object, object->getCollisionShape(),
+                object->getWorldTransform(), resultCallback_, 0.0f);
+        }
+        return true;
+    }
+
+    /// Swept shape.
+    const btConvexShape* shape_;
+    /// Sweep start transform.
+    btTransform fromTrans_;
+    /// Sweep end transform.
+    btTransform toTrans_;
+    /// Result callback.
+    btCollisionWorld::ConvexResultCallback& resultCallback_;
+};
+
+/// Closest hit convex result callback that excludes one collision object.
+struct BatchConvexResultCallback : public btCollisionWorld::ClosestConvexResultCallback
+{
+    /// Construct.
+    BatchConvexResultCallback(const btVector3& from, const btVector3& to, const btCollisionObject* ignoreObject) :
+        ClosestConvexResultCallback(from, to),
+        ignoreObject_(ignoreObject)
+    {
+    }
+
+    /// Return whether to test against an object.
+    bool needsCollision(btBroadphaseProxy* proxy) const override
+    {
+        return proxy->m_clientObject != ignoreObject_ && ClosestConvexResultCallback::needsCollision(proxy);
+    }
+
+    /// Collision object to exclude.
+    const btCollisionObject* ignoreObject_;
+};
+
+/// Dbvt policy passing the leaves hit by a ray to a broadphase callback.
+struct BatchRayTester : public btDbvt::ICollide
+{
+    /// Construct.
+    explicit BatchRayTester(btBroadphaseRayCallback& callback) :
+        callback_(callback)
+    {
+    }
+
+    /// Process a leaf.
+    void Process(const btDbvtNode* leaf)
+    {
+        callback_.process(static_cast<btDbvtProxy*>(leaf->data));
+    }
+
+    /// Broadphase callback.
+    btBroadphaseRayCallback& callback_;
+};
+
+/// Traverse the broadphase with a ray. Unlike btDbvtBroadphase::rayTest, uses a caller-owned stack so that several threads can traverse at once.
+static void BroadphaseRayTest(btDbvtBroadphase* broadphase, const btVector3& from, const btVector3& to, const btVector3& aabbMin,
+    const btVector3& aabbMax, btBroadphaseRayCallback& callback, btAlignedObjectArray<const btDbvtNode*>& stack)
+{
+    BatchRayTester tester(callback);
+    for (btDbvt& set : broadphase->m_sets)
+    {
+        set.rayTestInternal(set.m_root, from, to, callback.m_rayDirectionInverse, callback.m_signs, callback.m_lambda_max,
+            aabbMin, aabbMax, stack, tester);
+    }
+}
+
+static void ExecutePhysicsQuery(PhysicsRaycastResult& result, const ResolvedPhysicsQuery& resolved, btDbvtBroadphase* broadphase,
+    btAlignedObjectArray<const btDbvtNode*>& stack)
+{
+    const PhysicsQuery& query = resolved.query_;
+    const btVector3 from = ToBtVector3(query.startPosition_);
+    const btVector3 to = ToBtVector3(query.endPosition_);
+
+    if (query.type_ == PHYSICSQUERY_RAYCAST)
+    {
+        btCollisionWorld::ClosestRayResultCallback rayCallback(from, to);
+        rayCallback.m_collisionFilterGroup = (short)0xffff;
+        rayCallback.m_collisionFilterMask = (short)query.collisionMask_;
+
+        BatchRayCallback broadphaseCallback(from, to, rayCallback);
+        BroadphaseRayTest(broadphase, from, to, btVector3(0.0f, 0.0f, 0.0f), btVector3(0.0f, 0.0f, 0.0f), broadphaseCallback, stack);
+
+        if (rayCallback.hasHit())
+        {
+            result.position_ = ToVector3(rayCallback.m_hitPointWorld);
+            result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+            result.distance_ = (result.position_ - query.startPosition_).Length();
+            result.hitFraction_ = rayCallback.m_closestHitFraction;
+            result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+            return;
+        }
+    }
+    else
+    {
+        btSphereShape sphereShape(query.radius_);
+        const btConvexShape* shape = query.type_ == PHYSICSQUERY_SPHERECAST ? &sphereShape : resolved.shape_;
+        if (shape)
+        {
+            btTransform fromTrans(ToBtQuaternion(query.startRotation_), from);
+            btTransform toTrans(ToBtQuaternion(query.endRotation_), to);
+
+            BatchConvexResultCallback convexCallback(from, to, resolved.ignoreObject_);
+            convexCallback.m_collisionFilterGroup = (short)0xffff;
+            convexCallback.m_collisionFilterMask = (short)query.collisionMask_;
+
+            // Expand the object AABBs by the extent of the shape over its rotation, as btCollisionWorld::convexSweepTest does
+            btVector3 linVel, angVel;
+            btTransformUtil::calculateVelocity(fromTrans, toTrans, 1.0f, linVel, angVel);
+            btTransform rotation(fromTrans.getRotation());
+            btVector3 aabbMin, aabbMax;
+            shape->calculateTemporalAabb(rotation, btVector3(0.0f, 0.0f, 0.0f), angVel, 1.0f, aabbMin, aabbMax);
+
+            BatchSweepCallback broadphaseCallback(shape, fromTrans, toTrans, convexCallback);
+            BroadphaseRayTest(broadphase, from, to, aabbMin, aabbMax, broadphaseCallback, stack);
+
+            if (convexCallback.hasHit())
+            {
+                result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
+                result.position_ = ToVector3(convexCallback.m_hitPointWorld);
+                result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+                result.distance_ = convexCallback.m_closestHitFraction * (query.endPosition_ - query.startPosition_).Length();
+                result.hitFraction_ = convexCallback.m_closestHitFraction;
+                return;
+            }
+        }
+    }
+
+    result.body_ = nullptr;
+    result.position_ = Vector3::ZERO;
+    result.normal_ = Vector3::ZERO;
+    result.distance_ = M_INFINITY;
+    result.hitFraction_ = 0.0f;
+}
+
+static void ExecutePhysicsQueries(const PhysicsQueryBatchWorkData& data, unsigned start, unsigned end)
+{
+    btAlignedObjectArray<const btDbvtNode*> stack;
+    for (unsigned i = start; i < end; ++i)
+        ExecutePhysicsQuery(data.results_[i], data.queries_[i], data.broadphase_, stack);
+}
+
+static void PhysicsQueryBatchWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* data = reinterpret_cast<PhysicsQueryBatchWorkData*>(item->aux_);
+    auto start = (unsigned)(reinterpret_cast<PhysicsRaycastResult*>(item->start_) - data->results_);
+    auto end = (unsigned)(reinterpret_cast<PhysicsRaycastResult*>(item->end_) - data->results_);
+
+    ExecutePhysicsQueries(*data, start, end);
+}
+
+PhysicsQuery PhysicsQuery::Raycast(const Ray& ray, float maxDistance, unsigned collisionMask)
+{
+    PhysicsQuery query;
+    query.type_ = PHYSICSQUERY_RAYCAST;
+    query.startPosition_ = ray.origin_;
+    query.endPosition_ = ray.origin_ + maxDistance * ray.direction_;
+    query.collisionMask_ = collisionMask;
+    return query;
+}
+
+PhysicsQuery PhysicsQuery::SphereCast(const Ray& ray, float radius, float maxDistance, unsigned collisionMask)
+{
+    PhysicsQuery query;
+    query.type_ = PHYSICSQUERY_SPHERECAST;
+    query.startPosition_ = ray.origin_;
+    query.endPosition_ = ray.origin_ + maxDistance * ray.direction_;
+    query.radius_ = radius;
+    query.collisionMask_ = collisionMask;
+    return query;
+}
+
+PhysicsQuery PhysicsQuery::ConvexCast(CollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
+    const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
+{
+    PhysicsQuery query;
+    query.type_ = PHYSICSQUERY_CONVEXCAST;
+    query.startPosition_ = startPos;
+    query.startRotation_ = startRot;
+    query.endPosition_ = endPos;
+    query.endRotation_ = endRot;
+    query.shape_ = shape;
+    query.collisionMask_ = collisionMask;
+    return query;
+}
+
 void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep)
 {
-    static_cast<PhysicsWorld*>(world->getWorldUserInfo())->PreStep(timeStep);
+    // The step events of an asynchronous step are sent from the main thread instead
+    auto* physicsWorld = static_cast<PhysicsWorld*>(world->getWorldUserInfo());
+    if (physicsWorld->IsSimulatingAsync())
+        return;
+
+    physicsWorld->PreStep(timeStep);
+
+    // Start profiling block for the actual simulation step
+    URHO3D_PROFILE_START("PhysicsStepSimulation");
 }
 
 void InternalTickCallback(btDynamicsWorld* world, btScalar timeStep)
 {
-    static_cast<PhysicsWorld*>(world->getWorldUserInfo())->PostStep(timeStep);
+    auto* physicsWorld = static_cast<PhysicsWorld*>(world->getWorldUserInfo());
+    if (physicsWorld->IsSimulatingAsync())
+        return;
+
+    URHO3D_PROFILE_END();
+
+    physicsWorld->PostStep(timeStep);
+}
+
+void PhysicsStepWork(const WorkItem* item, unsigned /*threadIndex*/)
+{
+    URHO3D_MEMORY_TAG(MEMTAG_PHYSICS);
+
+    auto* physicsWorld = reinterpret_cast<PhysicsWorld*>(item->aux_);
+    physicsWorld->StepSimulation(physicsWorld->asyncTimeStep_);
+    physicsWorld->asyncStepCompleted_.store(true, std::memory_order_release);
 }
 
 static bool CustomMaterialCombinerCallback(btManifoldPoint& cp, const btCollisionObjectWrapper* colObj0Wrap, int partId0,
@@ -160,8 +650,8 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.Get()));
 
     broadphase_ = new btDbvtBroadphase();
-    solver_ = new btSequentialImpulseConstraintSolver();
-    world_ = new btDiscreteDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+    solver_ = new PhysicsConstraintSolver();
+    world_ = new PhysicsDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -174,6 +664,10 @@ PhysicsWorld::PhysicsWorld(Context* context) :
 
 PhysicsWorld::~PhysicsWorld()
 {
+    // Do not leave the simulation running in a worker thread. Its results are discarded, as the scene may be partially destroyed
+    if (simulatingAsync_)
+        JoinAsyncStep();
+
     if (scene_)
     {
         // Force all remaining constraints, rigid bodies and collision shapes to release themselves
@@ -208,6 +702,7 @@ void PhysicsWorld::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Solver Iterations", GetNumIterations, SetNumIterations, int, 10, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Net Max Angular Vel.", float, maxNetworkAngularVelocity_, DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Interpolation", bool, interpolation_, true, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Async Step", GetAsyncStep, SetAsyncStep, bool, false, AM_FILE);
     URHO3D_ATTRIBUTE("Internal Edge Utility", bool, internalEdge_, true, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Split Impulse", GetSplitImpulse, SetSplitImpulse, bool, false, AM_DEFAULT);
 }
@@ -232,6 +727,8 @@ void PhysicsWorld::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     {
         URHO3D_PROFILE("PhysicsDrawDebug");
 
+        WaitForStep();
+
         debugRenderer_ = debug;
         debugDepthTest_ = depthTest;
         world_->debugDrawWorld();
@@ -256,7 +753,21 @@ void PhysicsWorld::draw3dText(const btVector3& location, const char* textString)
 void PhysicsWorld::Update(float timeStep)
 {
     URHO3D_PROFILE("UpdatePhysics");
+    URHO3D_MEMORY_TAG(MEMTAG_PHYSICS);
+
+    WaitForStep();
+    SendAsyncStepEvents();
+
+    delayedWorldTransforms_.Clear();
+    simulating_ = true;
+    StepSimulation(timeStep);
+    simulating_ = false;
+
+    ApplyDelayedWorldTransforms();
+}
 
+void PhysicsWorld::StepSimulation(float timeStep)
+{
     float internalTimeStep = 1.0f / fps_;
     int maxSubSteps = (int)(timeStep * fps_) + 1;
     if (maxSubSteps_ < 0)
@@ -267,9 +778,6 @@ void PhysicsWorld::Update(float timeStep)
     else if (maxSubSteps_ > 0)
         maxSubSteps = Min(maxSubSteps, maxSubSteps_);
 
-    delayedWorldTransforms_.Clear();
-    simulating_ = true;
-
     if (interpolation_)
         world_->stepSimulation(timeStep, maxSubSteps, internalTimeStep);
     else
@@ -282,10 +790,10 @@ void PhysicsWorld::Update(float timeStep)
             --maxSubSteps;
         }
     }
+}
 
-    simulating_ = false;
-
-    // Apply delayed (parented) world transforms now
+void PhysicsWorld::ApplyDelayedWorldTransforms()
+{
     while (!delayedWorldTransforms_.Empty())
     {
         for (HashMap<RigidBody*, DelayedWorldTransform>::Iterator i = delayedWorldTransforms_.Begin();
@@ -307,6 +815,7 @@ void PhysicsWorld::Update(float timeStep)
 
 void PhysicsWorld::UpdateCollisions()
 {
+    WaitForStep();
     world_->performDiscreteCollisionDetection();
 }
 
@@ -319,6 +828,7 @@ void PhysicsWorld::SetFps(int fps)
 
 void PhysicsWorld::SetGravity(const Vector3& gravity)
 {
+    WaitForStep();
     world_->setGravity(ToBtVector3(gravity));
 
     MarkNetworkUpdate();
@@ -333,6 +843,7 @@ void PhysicsWorld::SetMaxSubSteps(int num)
 void PhysicsWorld::SetNumIterations(int num)
 {
     num = Clamp(num, 1, MAX_SOLVER_ITERATIONS);
+    WaitForStep();
     world_->getSolverInfo().m_numIterations = num;
 
     MarkNetworkUpdate();
@@ -348,6 +859,31 @@ void PhysicsWorld::SetInterpolation(bool enable)
     interpolation_ = enable;
 }
 
+void PhysicsWorld::SetAsyncStep(bool enable)
+{
+    if (enable == asyncStep_)
+        return;
+
+    asyncStep_ = enable;
+
+    if (enable)
+    {
+        SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(PhysicsWorld, HandlePostUpdate));
+        SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(PhysicsWorld, HandleEndFrame));
+    }
+    else
+    {
+        // Finish any step in progress so that its results are not lost
+        if (asyncStepQueued_)
+            StartAsyncStep();
+        WaitForStep();
+        SendAsyncStepEvents();
+
+        UnsubscribeFromEvent(E_POSTUPDATE);
+        UnsubscribeFromEvent(E_ENDFRAME);
+    }
+}
+
 void PhysicsWorld::SetInternalEdge(bool enable)
 {
     internalEdge_ = enable;
@@ -357,6 +893,7 @@ void PhysicsWorld::SetInternalEdge(bool enable)
 
 void PhysicsWorld::SetSplitImpulse(bool enable)
 {
+    WaitForStep();
     world_->getSolverInfo().m_splitImpulse = enable;
 
     MarkNetworkUpdate();
@@ -373,6 +910,8 @@ void PhysicsWorld::Raycast(PODVector<PhysicsRaycastResult>& result, const Ray& r
 {
     URHO3D_PROFILE("PhysicsRaycast");
 
+    WaitForStep();
+
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
@@ -401,6 +940,8 @@ void PhysicsWorld::RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, f
 {
     URHO3D_PROFILE("PhysicsRaycastSingle");
 
+    WaitForStep();
+
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
@@ -433,6 +974,8 @@ void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ra
 {
     URHO3D_PROFILE("PhysicsRaycastSingleSegmented");
 
+    WaitForStep();
+
     assert(overlapDistance < segmentDistance);
 
     if (maxDistance >= M_INFINITY)
@@ -485,6 +1028,8 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
 {
     URHO3D_PROFILE("PhysicsSphereCast");
 
+    WaitForStep();
+
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
 
@@ -520,6 +1065,8 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos,
     const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
 {
+    WaitForStep();
+
     if (!shape || !shape->GetCollisionShape())
     {
         URHO3D_LOGERROR("Null collision shape for convex cast");
@@ -561,6 +1108,8 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shap
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, btCollisionShape* shape, const Vector3& startPos,
     const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
 {
+    WaitForStep();
+
     if (!shape)
     {
         URHO3D_LOGERROR("Null collision shape for convex cast");
@@ -611,6 +1160,371 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, btCollisionShape* sh
     }
 }
 
+void PhysicsWorld::QueryBatch(PODVector<PhysicsRaycastResult>& result, const Vector<PhysicsQuery>& queries)
+{
+    URHO3D_PROFILE("PhysicsQueryBatch");
+
+    WaitForStep();
+
+    unsigned numQueries = queries.Size();
+    result.Resize(numQueries);
+    if (!numQueries)
+        return;
+
+    // Resolve the convex cast shapes on the calling thread, as reading their node transforms may update them
+    Vector<ResolvedPhysicsQuery> resolvedQueries(numQueries);
+    for (unsigned i = 0; i < numQueries; ++i)
+    {
+        ResolvedPhysicsQuery& resolved = resolvedQueries[i];
+        resolved.query_ = queries[i];
+        resolved.shape_ = nullptr;
+        resolved.ignoreObject_ = nullptr;
+
+        CollisionShape* shape = queries[i].shape_;
+        if (queries[i].type_ != PHYSICSQUERY_CONVEXCAST)
+            continue;
+        if (!shape || !shape->GetCollisionShape())
+        {
+            URHO3D_LOGERROR("Null collision shape for convex cast");
+            continue;
+        }
+        if (!shape->GetCollisionShape()->isConvex())
+        {
+            URHO3D_LOGERROR("Can not use non-convex collision shape for convex cast");
+            continue;
+        }
+
+        // The shape's own rigid body is excluded from the result, like ConvexCast does by clearing its collision group
+        auto* bodyComp = shape->GetComponent<RigidBody>();
+        resolved.ignoreObject_ = bodyComp ? bodyComp->GetBody() : nullptr;
+        resolved.shape_ = static_cast<btConvexShape*>(shape->GetCollisionShape());
+
+        // Take the shape's offset position & rotation into account
+        Node* shapeNode = shape->GetNode();
+        PhysicsQuery& query = resolved.query_;
+        Matrix3x4 startTransform(query.startPosition_, query.startRotation_, shapeNode ? shapeNode->GetWorldScale() : Vector3::ONE);
+        Matrix3x4 endTransform(query.endPosition_, query.endRotation_, shapeNode ? shapeNode->GetWorldScale() : Vector3::ONE);
+        query.startPosition_ = startTransform * shape->GetPosition();
+        query.endPosition_ = endTransform * shape->GetPosition();
+        query.startRotation_ = query.startRotation_ * shape->GetRotation();
+        query.endRotation_ = query.endRotation_ * shape->GetRotation();
+    }
+
+    PhysicsQueryBatchWorkData data;
+    data.broadphase_ = static_cast<btDbvtBroadphase*>(broadphase_.Get());
+    data.queries_ = resolvedQueries.Buffer();
+    data.results_ = result.Buffer();
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numWorkItems = CanQueryInParallel() ? queue->GetNumThreads() + 1 : 1; // Worker threads + main thread
+    // Use several items per thread to balance queries of uneven cost
+    unsigned queriesPerItem = Max(numQueries / (numWorkItems * 4), MIN_QUERIES_PER_WORK_ITEM);
+
+    if (numWorkItems == 1 || numQueries <= queriesPerItem)
+    {
+        ExecutePhysicsQueries(data, 0, numQueries);
+        return;
+    }
+
+    // The world is only read during the queries, and each query writes only its own result
+    for (unsigned start = 0; start < numQueries; start += queriesPerItem)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = PhysicsQueryBatchWork;
+        item->aux_ = &data;
+        item->start_ = result.Buffer() + start;
+        item->end_ = result.Buffer() + Min(start + queriesPerItem, numQueries);
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+void PhysicsWorld::SaveSnapshot(Serializer& dest)
+{
+    URHO3D_PROFILE("SavePhysicsSnapshot");
+
+    WaitForStep();
+
+    auto* world = static_cast<PhysicsDynamicsWorld*>(world_.Get());
+    const btCollisionObjectArray& objects = world->getCollisionObjectArray();
+    btDispatcher* dispatcher = world->getDispatcher();
+
+    auto* solver = static_cast<PhysicsConstraintSolver*>(solver_.Get());
+
+    // The manifolds restored from a snapshot are not in the same order as when saving. Solve in an order that does not
+    // depend on it from now on, including the steps following this snapshot
+    solver->sortManifolds_ = true;
+
+    // The continuous collision contacts are recreated on the next step and are not saved. Release them so that they are not
+    // mistaken for the contacts of their objects when restoring
+    world->releasePredictiveContacts();
+
+    PhysicsSnapshotHeader header;
+    header.numObjects_ = (unsigned)objects.size();
+    header.numConstraints_ = (unsigned)world->getNumConstraints();
+    header.numManifolds_ = (unsigned)dispatcher->getNumManifolds();
+    header.localTime_ = world->GetLocalTime();
+    header.fixedTimeStep_ = world->GetFixedTimeStep();
+    header.timeAcc_ = timeAcc_;
+    header.solverSeed_ = solver->getRandSeed();
+    dest.Write(&header, sizeof header);
+
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        const btCollisionObject* object = objects[i];
+        const btRigidBody* body = btRigidBody::upcast(object);
+        auto* rigidBody = body ? static_cast<RigidBody*>(body->getUserPointer()) : nullptr;
+
+        RigidBodySnapshot state;
+        state.id_ = rigidBody ? rigidBody->GetID() : 0;
+        state.activationState_ = object->getActivationState();
+        state.deactivationTime_ = object->getDeactivationTime();
+        state.hitFraction_ = object->getHitFraction();
+        StoreTransform(state.worldTransform_, object->getWorldTransform());
+        StoreTransform(state.interpolationWorldTransform_, object->getInterpolationWorldTransform());
+        StoreVector(state.linearVelocity_, body ? body->getLinearVelocity() : btVector3(0.0f, 0.0f, 0.0f));
+        StoreVector(state.angularVelocity_, body ? body->getAngularVelocity() : btVector3(0.0f, 0.0f, 0.0f));
+        StoreVector(state.interpolationLinearVelocity_, object->getInterpolationLinearVelocity());
+        StoreVector(state.interpolationAngularVelocity_, object->getInterpolationAngularVelocity());
+        dest.Write(&state, sizeof state);
+    }
+
+    for (int i = 0; i < world->getNumConstraints(); ++i)
+    {
+        const btTypedConstraint* constraint = world->getConstraint(i);
+
+        ConstraintSnapshot state;
+        state.appliedImpulse_ = constraint->getAppliedImpulse();
+        state.enabled_ = constraint->isEnabled() ? 1 : 0;
+        dest.Write(&state, sizeof state);
+    }
+
+    // The contact points are stored whole, as their accumulated impulses warm start the solver on the next step
+    for (int i = 0; i < dispatcher->getNumManifolds(); ++i)
+    {
+        const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+
+        ManifoldSnapshot state;
+        state.indexA_ = manifold->getBody0()->getWorldArrayIndex();
+        state.indexB_ = manifold->getBody1()->getWorldArrayIndex();
+        state.numContacts_ = manifold->getNumContacts();
+        dest.Write(&state, sizeof state);
+
+        for (int j = 0; j < state.numContacts_; ++j)
+            dest.Write(&manifold->getContactPoint(j), sizeof(btManifoldPoint));
+    }
+}
+
+bool PhysicsWorld::RestoreSnapshot(Deserializer& source)
+{
+    URHO3D_PROFILE("RestorePhysicsSnapshot");
+
+    WaitForStep();
+
+    auto* world = static_cast<PhysicsDynamicsWorld*>(world_.Get());
+    btCollisionObjectArray& objects = world->getCollisionObjectArray();
+    btDispatcher* dispatcher = world->getDispatcher();
+
+    PhysicsSnapshotHeader header;
+    if (source.Read(&header, sizeof header) != sizeof header || header.numObjects_ != (unsigned)objects.size() ||
+        header.numConstraints_ != (unsigned)world->getNumConstraints())
+    {
+        URHO3D_LOGERROR("Physics snapshot does not match the rigid bodies and constraints in the world");
+        return false;
+    }
+
+    // Check that the rigid bodies are the same before modifying anything
+    unsigned objectsStart = source.GetPosition();
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        btRigidBody* body = btRigidBody::upcast(objects[i]);
+        auto* rigidBody = body ? static_cast<RigidBody*>(body->getUserPointer()) : nullptr;
+        unsigned id = 0;
+
+        source.Seek(objectsStart + i * sizeof(RigidBodySnapshot));
+        if (source.Read(&id, sizeof id) != sizeof id || id != (rigidBody ? rigidBody->GetID() : 0))
+        {
+            URHO3D_LOGERROR("Physics snapshot does not match the rigid bodies and constraints in the world");
+            return false;
+        }
+    }
+    source.Seek(objectsStart);
+
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        btCollisionObject* object = objects[i];
+        btRigidBody* body = btRigidBody::upcast(object);
+
+        RigidBodySnapshot state;
+        source.Read(&state, sizeof state);
+        object->setWorldTransform(LoadTransform(state.worldTransform_));
+        object->setInterpolationWorldTransform(LoadTransform(state.interpolationWorldTransform_));
+        object->setInterpolationLinearVelocity(LoadVector(state.interpolationLinearVelocity_));
+        object->setInterpolationAngularVelocity(LoadVector(state.interpolationAngularVelocity_));
+        object->setHitFraction(state.hitFraction_);
+        object->forceActivationState(state.activationState_);
+        object->setDeactivationTime(state.deactivationTime_);
+        if (body)
+        {
+            // The world space inertia tensor follows the rotation
+            body->updateInertiaTensor();
+            body->setLinearVelocity(LoadVector(state.linearVelocity_));
+            body->setAngularVelocity(LoadVector(state.angularVelocity_));
+        }
+    }
+
+    for (int i = 0; i < world->getNumConstraints(); ++i)
+    {
+        btTypedConstraint* constraint = world->getConstraint(i);
+
+        ConstraintSnapshot state;
+        source.Read(&state, sizeof state);
+        constraint->internalSetAppliedImpulse(state.appliedImpulse_);
+        constraint->setEnabled(state.enabled_ != 0);
+    }
+
+    // Run the narrowphase so that contact manifolds exist for all overlapping pairs at the restored transforms, then
+    // replace their contact points with the saved ones. Manifolds that were not saved are emptied
+    world->releasePredictiveContacts();
+    world->performDiscreteCollisionDetection();
+    ChainSnapshotManifolds();
+
+    // A saved pair may have separated during the step and have lost its manifolds since, while the original simulation
+    // kept them alive and warm started from their points. Recreate them with a contact distance that spans the gap
+    unsigned manifoldsStart = source.GetPosition();
+    bool recreated = false;
+    for (unsigned i = 0; i < header.numManifolds_; ++i)
+    {
+        ManifoldSnapshot state;
+        source.Read(&state, sizeof state);
+        if (state.numContacts_ < 0 || state.numContacts_ > MANIFOLD_CACHE_SIZE)
+        {
+            URHO3D_LOGERROR("Corrupted physics snapshot");
+            return false;
+        }
+        source.Seek(source.GetPosition() + state.numContacts_ * sizeof(btManifoldPoint));
+
+        if (state.numContacts_ && state.indexA_ >= 0 && state.indexA_ < objects.size() && state.indexB_ >= 0 &&
+            state.indexB_ < objects.size() && !snapshotManifolds_.Contains(MakePair(state.indexA_, state.indexB_)))
+        {
+            RecreateContactPair(objects[state.indexA_], objects[state.indexB_]);
+            recreated = true;
+        }
+    }
+    if (recreated)
+        ChainSnapshotManifolds();
+    source.Seek(manifoldsStart);
+
+    int numManifolds = dispatcher->getNumManifolds();
+    for (unsigned i = 0; i < header.numManifolds_; ++i)
+    {
+        ManifoldSnapshot state;
+        source.Read(&state, sizeof state);
+
+        HashMap<Pair<int, int>, int>::Iterator j = snapshotManifolds_.Find(MakePair(state.indexA_, state.indexB_));
+        if (j != snapshotManifolds_.End() && j->second_ >= 0)
+        {
+            btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(j->second_);
+            manifold->clearManifold();
+            manifold->setNumContacts(state.numContacts_);
+            for (int k = 0; k < state.numContacts_; ++k)
+                source.Read(&manifold->getContactPoint(k), sizeof(btManifoldPoint));
+
+            // Mark as restored and move to the next manifold of the pair
+            int next = snapshotManifoldNext_[j->second_];
+            snapshotManifoldNext_[j->second_] = numManifolds;
+            j->second_ = next;
+        }
+        else
+            source.Seek(source.GetPosition() + state.numContacts_ * sizeof(btManifoldPoint));
+    }
+
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        if (snapshotManifoldNext_[i] != numManifolds)
+            dispatcher->getManifoldByIndexInternal(i)->clearManifold();
+    }
+
+    world->SetTimeStepState(header.localTime_, header.fixedTimeStep_);
+    timeAcc_ = header.timeAcc_;
+    world->clearForces();
+    auto* solver = static_cast<PhysicsConstraintSolver*>(solver_.Get());
+    solver->setRandSeed((unsigned long)header.solverSeed_);
+    solver->sortManifolds_ = true;
+
+    // Move the scene nodes to the restored transforms, interpolated the same way as after a simulation step
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        btRigidBody* body = btRigidBody::upcast(objects[i]);
+        if (!body || !body->getMotionState())
+            continue;
+
+        if (body->isKinematicObject())
+            body->getMotionState()->setWorldTransform(body->getWorldTransform());
+        else if (!body->isStaticObject())
+            world->synchronizeSingleMotionState(body);
+    }
+    ApplyDelayedWorldTransforms();
+
+    return true;
+}
+
+void PhysicsWorld::ChainSnapshotManifolds()
+{
+    // Compound shapes may have several manifolds per object pair
+    btDispatcher* dispatcher = world_->getDispatcher();
+    int numManifolds = dispatcher->getNumManifolds();
+    snapshotManifolds_.Clear();
+    snapshotManifoldNext_.Resize((unsigned)numManifolds);
+    for (int i = numManifolds - 1; i >= 0; --i)
+    {
+        const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+        Pair<int, int> key(manifold->getBody0()->getWorldArrayIndex(), manifold->getBody1()->getWorldArrayIndex());
+        HashMap<Pair<int, int>, int>::Iterator j = snapshotManifolds_.Find(key);
+        snapshotManifoldNext_[i] = j != snapshotManifolds_.End() ? j->second_ : -1;
+        snapshotManifolds_[key] = i;
+    }
+}
+
+void PhysicsWorld::RecreateContactPair(btCollisionObject* objectA, btCollisionObject* objectB)
+{
+    btBroadphaseProxy* proxyA = objectA->getBroadphaseHandle();
+    btBroadphaseProxy* proxyB = objectB->getBroadphaseHandle();
+    if (!proxyA || !proxyB)
+        return;
+
+    btOverlappingPairCache* pairCache = broadphase_->getOverlappingPairCache();
+    btBroadphasePair* pair = pairCache->findPair(proxyA, proxyB);
+    if (!pair)
+        pair = pairCache->addOverlappingPair(proxyA, proxyB);
+    if (!pair)
+        return;
+
+    auto* object0 = static_cast<btCollisionObject*>(pair->m_pProxy0->m_clientObject);
+    auto* object1 = static_cast<btCollisionObject*>(pair->m_pProxy1->m_clientObject);
+    btCollisionObjectWrapper wrapper0(nullptr, object0->getCollisionShape(), object0, object0->getWorldTransform(), -1, -1);
+    btCollisionObjectWrapper wrapper1(nullptr, object1->getCollisionShape(), object1, object1->getWorldTransform(), -1, -1);
+    btDispatcher* dispatcher = world_->getDispatcher();
+    if (!pair->m_algorithm)
+        pair->m_algorithm = dispatcher->findAlgorithm(&wrapper0, &wrapper1, nullptr, BT_CONTACT_POINT_ALGORITHMS);
+    if (!pair->m_algorithm)
+        return;
+
+    // Widen the contact distance over the gap between the bounding boxes, which include the breaking threshold of
+    // both objects, so that the compound child manifolds are created as well. The points found are replaced afterward
+    btScalar gap = 0.0f;
+    for (int i = 0; i < 3; ++i)
+    {
+        gap = Max(gap, pair->m_pProxy1->m_aabbMin[i] - pair->m_pProxy0->m_aabbMax[i]);
+        gap = Max(gap, pair->m_pProxy0->m_aabbMin[i] - pair->m_pProxy1->m_aabbMax[i]);
+    }
+    btManifoldResult result(&wrapper0, &wrapper1);
+    result.m_closestPointDistanceThreshold = gap + 4.0f * gContactBreakingThreshold;
+    pair->m_algorithm->processCollision(&wrapper0, &wrapper1, world_->getDispatchInfo(), &result);
+}
+
 void PhysicsWorld::RemoveCachedGeometry(Model* model)
 {
     RemoveCachedGeometryImpl(triMeshCache_, model);
@@ -622,6 +1536,8 @@ void PhysicsWorld::GetRigidBodies(PODVector<RigidBody*>& result, const Sphere& s
 {
     URHO3D_PROFILE("PhysicsSphereQuery");
 
+    WaitForStep();
+
     result.Clear();
 
     btSphereShape sphereShape(sphere.radius_);
@@ -641,6 +1557,8 @@ void PhysicsWorld::GetRigidBodies(PODVector<RigidBody*>& result, const BoundingB
 {
     URHO3D_PROFILE("PhysicsBoxQuery");
 
+    WaitForStep();
+
     result.Clear();
 
     btBoxShape boxShape(ToBtVector3(box.HalfSize()));
@@ -659,6 +1577,8 @@ void PhysicsWorld::GetRigidBodies(PODVector<RigidBody*>& result, const RigidBody
 {
     URHO3D_PROFILE("PhysicsBodyQuery");
 
+    WaitForStep();
+
     result.Clear();
 
     if (!body || !body->GetBody())
@@ -717,11 +1637,13 @@ bool PhysicsWorld::GetSplitImpulse() const
 
 void PhysicsWorld::AddRigidBody(RigidBody* body)
 {
+    WaitForStep();
     rigidBodies_.Push(body);
 }
 
 void PhysicsWorld::RemoveRigidBody(RigidBody* body)
 {
+    WaitForStep();
     rigidBodies_.Remove(body);
     // Remove possible dangling pointer from the delayedWorldTransforms structure
     delayedWorldTransforms_.Erase(body);
@@ -729,21 +1651,25 @@ void PhysicsWorld::RemoveRigidBody(RigidBody* body)
 
 void PhysicsWorld::AddCollisionShape(CollisionShape* shape)
 {
+    WaitForStep();
     collisionShapes_.Push(shape);
 }
 
 void PhysicsWorld::RemoveCollisionShape(CollisionShape* shape)
 {
+    WaitForStep();
     collisionShapes_.Remove(shape);
 }
 
 void PhysicsWorld::AddConstraint(Constraint* constraint)
 {
+    WaitForStep();
     constraints_.Push(constraint);
 }
 
 void PhysicsWorld::RemoveConstraint(Constraint* constraint)
 {
+    WaitForStep();
     constraints_.Remove(constraint);
 }
 
@@ -752,6 +1678,11 @@ void PhysicsWorld::AddDelayedWorldTransform(const DelayedWorldTransform& transfo
     delayedWorldTransforms_[transform.rigidBody_] = transform;
 }
 
+void PhysicsWorld::AddAsyncWorldTransform(const DelayedWorldTransform& transform)
+{
+    asyncWorldTransforms_[transform.rigidBody_] = transform;
+}
+
 void PhysicsWorld::DrawDebugGeometry(bool depthTest)
 {
     auto* debug = GetComponent<DebugRenderer>();
@@ -785,7 +1716,12 @@ void PhysicsWorld::OnSceneSet(Scene* scene)
         SubscribeToEvent(scene_, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(PhysicsWorld, HandleSceneSubsystemUpdate));
     }
     else
+    {
+        // The scene is going away, so do not leave the simulation running
+        WaitForStep();
+        asyncStepQueued_ = false;
         UnsubscribeFromEvent(E_SCENESUBSYSTEMUPDATE);
+    }
 }
 
 void PhysicsWorld::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData)
@@ -794,7 +1730,132 @@ void PhysicsWorld::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap&
         return;
 
     using namespace SceneSubsystemUpdate;
-    Update(eventData[P_TIMESTEP].GetFloat());
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+    if (asyncStep_ && CanStepAsync())
+        QueueAsyncStep(timeStep);
+    else
+        Update(timeStep);
+}
+
+void PhysicsWorld::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    // All update logic has run, so the simulation can proceed while the frame is rendered
+    if (asyncStepQueued_)
+        StartAsyncStep();
+}
+
+void PhysicsWorld::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    // Defined synchronization point: the scene nodes receive the simulated transforms before the next frame's update
+    WaitForStep();
+    SendAsyncStepEvents();
+}
+
+bool PhysicsWorld::CanStepAsync() const
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    return queue && queue->GetNumThreads() && Thread::IsMainThread();
+}
+
+void PhysicsWorld::QueueAsyncStep(float timeStep)
+{
+    // Finish the previous step first if there was no frame in between, for example when the scene is updated manually
+    if (asyncStepQueued_)
+        StartAsyncStep();
+    WaitForStep();
+    SendAsyncStepEvents();
+
+    // Send the pre-step event now, so that the update logic reacting to it runs in the main thread as usual
+    simulating_ = true;
+    PreStep(timeStep);
+    simulating_ = false;
+
+    asyncTimeStep_ = timeStep;
+    asyncStepQueued_ = true;
+}
+
+void PhysicsWorld::StartAsyncStep()
+{
+    URHO3D_PROFILE("StartPhysicsStep");
+
+    asyncStepQueued_ = false;
+
+    // Bullet reads the transforms of kinematic bodies during the step. Cache them from the scene nodes while it is still safe
+    btTransform kinematicTransform;
+    for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+    {
+        if ((*i)->IsKinematic() && (*i)->GetBody())
+            (*i)->getWorldTransform(kinematicTransform);
+    }
+
+    delayedWorldTransforms_.Clear();
+    asyncWorldTransforms_.Clear();
+    simulating_ = true;
+    simulatingAsync_ = true;
+
+    // Use a dedicated item so that it can be waited on. Prioritize it over background work, but below the items that the
+    // renderer completes in the main thread, so that rendering does not wait for the simulation
+    auto* queue = GetSubsystem<WorkQueue>();
+    asyncStepCompleted_.store(false, std::memory_order_relaxed);
+    stepItem_ = new WorkItem();
+    stepItem_->workFunction_ = PhysicsStepWork;
+    stepItem_->aux_ = this;
+    stepItem_->priority_ = M_MAX_UNSIGNED - 1;
+    queue->AddWorkItem(stepItem_);
+}
+
+void PhysicsWorld::JoinAsyncStep()
+{
+    URHO3D_PROFILE("WaitForPhysicsStep");
+
+    // The work item's own completed flag is not ordered with the simulation results, so use the step's acquire flag instead
+    if (!asyncStepCompleted_.load(std::memory_order_acquire))
+    {
+        // If no worker thread has picked up the step yet, simulate in this thread rather than wait
+        auto* queue = GetSubsystem<WorkQueue>();
+        if (queue && queue->RemoveWorkItem(stepItem_))
+            PhysicsStepWork(stepItem_, 0);
+        else
+        {
+            while (!asyncStepCompleted_.load(std::memory_order_acquire))
+                Time::Sleep(0);
+        }
+    }
+
+    stepItem_.Reset();
+    simulating_ = false;
+    simulatingAsync_ = false;
+}
+
+void PhysicsWorld::CompleteStep(RigidBody* movedBody)
+{
+    JoinAsyncStep();
+
+    // A body whose node was moved during the step keeps the new node transform, as it would after a synchronous step
+    if (movedBody)
+        asyncWorldTransforms_.Erase(movedBody);
+
+    // Apply the simulated transforms now that the scene nodes can be accessed. Parented bodies are delayed as usual
+    for (HashMap<RigidBody*, DelayedWorldTransform>::ConstIterator i = asyncWorldTransforms_.Begin();
+         i != asyncWorldTransforms_.End(); ++i)
+        i->first_->SetSimulatedWorldTransform(i->second_.worldPosition_, i->second_.worldRotation_);
+    asyncWorldTransforms_.Clear();
+
+    ApplyDelayedWorldTransforms();
+
+    asyncStepEventsPending_ = true;
+}
+
+void PhysicsWorld::SendAsyncStepEvents()
+{
+    if (!asyncStepEventsPending_)
+        return;
+
+    asyncStepEventsPending_ = false;
+
+    simulating_ = true;
+    PostStep(asyncTimeStep_);
+    simulating_ = false;
 }
 
 void PhysicsWorld::PreStep(float timeStep)
@@ -806,15 +1867,10 @@ void PhysicsWorld::PreStep(float timeStep)
     eventData[P_WORLD] = this;
     eventData[P_TIMESTEP] = timeStep;
     SendEvent(E_PHYSICSPRESTEP, eventData);
-
-    // Start profiling block for the actual simulation step
-    URHO3D_PROFILE_START("PhysicsStepSimulation");
 }
 
 void PhysicsWorld::PostStep(float timeStep)
 {
-    URHO3D_PROFILE_END();
-
     SendCollisionEvents();
 
     // Send post-step event
@@ -826,6 +1882,22 @@ void PhysicsWorld::PostStep(float timeStep)
     SendEvent(E_PHYSICSPOSTSTEP, eventData);
 }
 
+bool PhysicsWorld::CanQueryInParallel() const
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue || !queue->GetNumThreads() || !Thread::IsMainThread() || queue->IsCompleting() || simulating_)
+        return false;
+
+    // GImpact meshes lock their vertex data when queried, which is not safe to do from several threads at once
+    for (PODVector<CollisionShape*>::ConstIterator i = collisionShapes_.Begin(); i != collisionShapes_.End(); ++i)
+    {
+        if ((*i)->GetShapeType() == SHAPE_GIMPACTMESH)
+            return false;
+    }
+
+    return true;
+}
+
 void PhysicsWorld::SendCollisionEvents()
 {
     URHO3D_PROFILE("SendCollisionEvents");
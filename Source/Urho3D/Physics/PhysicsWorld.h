@@ -31,7 +31,10 @@
 
 #include <Bullet/LinearMath/btIDebugDraw.h>
 
+#include <atomic>
+
 class btCollisionConfiguration;
+class btCollisionObject;
 class btCollisionShape;
 class btBroadphaseInterface;
 class btConstraintSolver;
@@ -54,6 +57,8 @@ class Scene;
 class Serializer;
 class XMLElement;
 
+struct WorkItem;
+
 struct CollisionGeometryData;
 
 /// Physics raycast hit.
@@ -77,6 +82,43 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_{};
 };
 
+/// Physics world query type for batched queries.
+enum PhysicsQueryType
+{
+    PHYSICSQUERY_RAYCAST = 0,
+    PHYSICSQUERY_SPHERECAST,
+    PHYSICSQUERY_CONVEXCAST
+};
+
+/// Physics world query for batched execution. Returns the closest hit like RaycastSingle, SphereCast and ConvexCast.
+struct URHO3D_API PhysicsQuery
+{
+    /// Construct a raycast.
+    static PhysicsQuery Raycast(const Ray& ray, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Construct a swept sphere test.
+    static PhysicsQuery SphereCast(const Ray& ray, float radius, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Construct a swept convex test using a collision shape. The shape's own rigid body is excluded from the result.
+    static PhysicsQuery ConvexCast(CollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
+        const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
+
+    /// Query type.
+    PhysicsQueryType type_{PHYSICSQUERY_RAYCAST};
+    /// Start position.
+    Vector3 startPosition_;
+    /// Start rotation for convex casts.
+    Quaternion startRotation_;
+    /// End position.
+    Vector3 endPosition_;
+    /// End rotation for convex casts.
+    Quaternion endRotation_;
+    /// Sphere radius for sphere casts.
+    float radius_{};
+    /// Collision shape for convex casts.
+    CollisionShape* shape_{};
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
 /// Delayed world transform assignment for parented rigidbodies.
 struct DelayedWorldTransform
 {
@@ -116,6 +158,8 @@ struct PhysicsWorldConfig
 
     /// Override for the collision configuration (default btDefaultCollisionConfiguration).
     btCollisionConfiguration* collisionConfig_;
+    /// Directory to store cooked triangle mesh and convex hull collision data for models, to reuse instead of rebuilding them. Empty (default) to not use.
+    String collisionCacheDir_;
 };
 
 static const int DEFAULT_FPS = 60;
@@ -131,6 +175,7 @@ class URHO3D_API PhysicsWorld : public Component, public btIDebugDraw
 
     friend void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep);
     friend void InternalTickCallback(btDynamicsWorld* world, btScalar timeStep);
+    friend void PhysicsStepWork(const WorkItem* item, unsigned threadIndex);
 
 public:
     /// Construct.
@@ -165,6 +210,10 @@ public:
     void Update(float timeStep);
     /// Refresh collisions only without updating dynamics.
     void UpdateCollisions();
+    /// Save the simulation state to a compact binary snapshot, for example to roll back and re-simulate in network prediction. Contains the rigid body transforms, velocities and sleep states, the constraint impulses and the cached contact points. Does not allocate memory once the destination has grown large enough.
+    void SaveSnapshot(Serializer& dest);
+    /// Restore the simulation state from a snapshot and move the scene nodes accordingly. The snapshot must have been saved with the same rigid bodies and constraints in the world. Forces applied since the last step are cleared. Return true if successful.
+    bool RestoreSnapshot(Deserializer& source);
     /// Set simulation substeps per second.
     void SetFps(int fps);
     /// Set gravity.
@@ -177,6 +226,8 @@ public:
     void SetUpdateEnabled(bool enable);
     /// Set whether to interpolate between simulation steps.
     void SetInterpolation(bool enable);
+    /// Set whether to step the simulation in a worker thread while the frame is rendered. The simulated transforms are applied to the scene nodes at the end of the frame, and the post-step and collision events are sent then. Requires worker threads, otherwise the simulation is stepped during the scene update as usual. Disabled by default.
+    void SetAsyncStep(bool enable);
     /// Set whether to use Bullet's internal edge utility for trimesh collisions. Disabled by default.
     void SetInternalEdge(bool enable);
     /// Set split impulse collision mode. This is more accurate, but slower. Disabled by default.
@@ -200,6 +251,8 @@ public:
     /// Perform a physics world swept convex test using a user-supplied Bullet collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, btCollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform a batch of raycasts and swept tests and return the closest hit of each in the same order. Executed in parallel on the work queue when called from the main thread outside the simulation step.
+    void QueryBatch(PODVector<PhysicsRaycastResult>& result, const Vector<PhysicsQuery>& queries);
     /// Invalidate cached collision geometry for a model.
     void RemoveCachedGeometry(Model* model);
     /// Return rigid bodies by a sphere query.
@@ -226,6 +279,9 @@ public:
     /// Return whether interpolation between simulation steps is enabled.
     bool GetInterpolation() const { return interpolation_; }
 
+    /// Return whether the simulation is stepped in a worker thread while the frame is rendered.
+    bool GetAsyncStep() const { return asyncStep_; }
+
     /// Return whether Bullet's internal edge utility for trimesh collisions is enabled.
     bool GetInternalEdge() const { return internalEdge_; }
 
@@ -283,6 +339,19 @@ public:
     /// Return whether is currently inside the Bullet substep loop.
     bool IsSimulating() const { return simulating_; }
 
+    /// Return whether an asynchronous simulation step is in progress. Simulated transforms are then buffered instead of being applied to the scene nodes.
+    bool IsSimulatingAsync() const { return simulatingAsync_; }
+
+    /// Wait for an asynchronous simulation step to finish and apply the simulated transforms. Called by the physics components before they access Bullet objects. A rigid body whose node was moved in the meantime keeps the node transform.
+    void WaitForStep(RigidBody* movedBody = nullptr)
+    {
+        if (simulatingAsync_)
+            CompleteStep(movedBody);
+    }
+
+    /// Add a simulated world transform during an asynchronous step. Called by RigidBody.
+    void AddAsyncWorldTransform(const DelayedWorldTransform& transform);
+
     /// Overrides of the internal configuration.
     static struct PhysicsWorldConfig config;
 
@@ -293,12 +362,38 @@ protected:
 private:
     /// Handle the scene subsystem update event, step simulation here.
     void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the post-update event, start a queued asynchronous step here.
+    void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the frame end event, apply the results of an asynchronous step here.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+    /// Run the Bullet substep loop.
+    void StepSimulation(float timeStep);
+    /// Apply delayed (parented) world transforms.
+    void ApplyDelayedWorldTransforms();
+    /// Chain the current contact manifolds by the world indices of their collision objects, used when restoring a snapshot.
+    void ChainSnapshotManifolds();
+    /// Recreate the overlapping pair and contact manifolds of two collision objects that have moved apart, used when restoring a snapshot.
+    void RecreateContactPair(btCollisionObject* objectA, btCollisionObject* objectB);
+    /// Return whether the simulation can be stepped in a worker thread.
+    bool CanStepAsync() const;
+    /// Send the pre-step event and queue an asynchronous step to be started after the update.
+    void QueueAsyncStep(float timeStep);
+    /// Start a queued asynchronous step in a worker thread.
+    void StartAsyncStep();
+    /// Wait for an asynchronous step to finish without applying its results.
+    void JoinAsyncStep();
+    /// Wait for an asynchronous step to finish and apply the simulated transforms.
+    void CompleteStep(RigidBody* movedBody);
+    /// Send the post-step and collision events of a completed asynchronous step.
+    void SendAsyncStepEvents();
     /// Trigger update before each physics simulation step.
     void PreStep(float timeStep);
     /// Trigger update after each physics simulation step.
     void PostStep(float timeStep);
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Return whether batched queries can be executed in worker threads.
+    bool CanQueryInParallel() const;
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -324,6 +419,16 @@ private:
     HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> previousCollisions_;
     /// Delayed (parented) world transform assignments.
     HashMap<RigidBody*, DelayedWorldTransform> delayedWorldTransforms_;
+    /// Simulated world transforms buffered during an asynchronous step. Written only by the stepping thread until the step is complete.
+    HashMap<RigidBody*, DelayedWorldTransform> asyncWorldTransforms_;
+    /// First unrestored contact manifold index by the world indices of the collision objects, used when restoring a snapshot.
+    HashMap<Pair<int, int>, int> snapshotManifolds_;
+    /// Next contact manifold index of the same collision objects, used when restoring a snapshot.
+    PODVector<int> snapshotManifoldNext_;
+    /// Work item of an asynchronous step in progress.
+    SharedPtr<WorkItem> stepItem_;
+    /// Asynchronous step finished flag. Set with release semantics by the stepping thread, so that reading it true makes the simulation results visible.
+    std::atomic<bool> asyncStepCompleted_{};
     /// Cache for trimesh geometry data by model and LOD level.
     CollisionGeometryDataCache triMeshCache_;
     /// Cache for convex geometry data by model and LOD level.
@@ -342,6 +447,8 @@ private:
     int maxSubSteps_{};
     /// Time accumulator for non-interpolated mode.
     float timeAcc_{};
+    /// Timestep of the queued or last asynchronous step.
+    float asyncTimeStep_{};
     /// Maximum angular velocity for network replication.
     float maxNetworkAngularVelocity_{DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY};
     /// Automatic simulation update enabled flag.
@@ -354,6 +461,14 @@ private:
     bool applyingTransforms_{};
     /// Simulating flag.
     bool simulating_{};
+    /// Asynchronous stepping flag.
+    bool asyncStep_{};
+    /// Asynchronous step queued to be started after the update.
+    bool asyncStepQueued_{};
+    /// Asynchronous step in progress flag.
+    bool simulatingAsync_{};
+    /// Post-step and collision events of a completed asynchronous step not yet sent.
+    bool asyncStepEventsPending_{};
     /// Debug draw depth test mode.
     bool debugDepthTest_{};
     /// Debug renderer.
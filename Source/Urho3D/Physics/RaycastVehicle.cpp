@@ -59,6 +59,7 @@ struct RaycastVehicleData
         {
             if (physWorld_ && added_)
             {
+                physWorld_->WaitForStep();
                 btDynamicsWorld* pbtDynWorld = physWorld_->GetWorld();
                 if (pbtDynWorld)
                     pbtDynWorld->removeAction(vehicle_);
@@ -71,6 +72,9 @@ struct RaycastVehicleData
 
     btRaycastVehicle* Get()
     {
+        // The vehicle is updated by the simulation step, so wait for an asynchronous step to finish before accessing it
+        if (physWorld_)
+            physWorld_->WaitForStep();
         return vehicle_;
     }
 
@@ -81,6 +85,8 @@ struct RaycastVehicleData
         if (!pbtDynWorld)
             return;
 
+        pPhysWorld->WaitForStep();
+
         // Delete old vehicle & action first
         delete vehicleRayCaster_;
         if (vehicle_)
@@ -117,6 +123,7 @@ struct RaycastVehicleData
         if (!pbtDynWorld)
             return;
 
+        physWorld_->WaitForStep();
         if (enabled && !added_)
         {
             pbtDynWorld->addAction(vehicle_);
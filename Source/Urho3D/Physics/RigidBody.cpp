@@ -150,19 +150,42 @@ void RigidBody::getWorldTransform(btTransform& worldTrans) const
     // so check to be sure
     if (node_)
     {
-        lastPosition_ = node_->GetWorldPosition();
-        lastRotation_ = node_->GetWorldRotation();
+        // During an asynchronous step the main thread may modify the scene nodes, so use the transform cached when the
+        // step was started
+        if (!physicsWorld_ || !physicsWorld_->IsSimulatingAsync())
+        {
+            lastPosition_ = node_->GetWorldPosition();
+            lastRotation_ = node_->GetWorldRotation();
+        }
         worldTrans.setOrigin(ToBtVector3(lastPosition_ + lastRotation_ * centerOfMass_));
         worldTrans.setRotation(ToBtQuaternion(lastRotation_));
     }
 
-    hasSimulated_ = true;
+    if (!physicsWorld_ || !physicsWorld_->IsSimulatingAsync())
+        hasSimulated_ = true;
 }
 
 void RigidBody::setWorldTransform(const btTransform& worldTrans)
 {
     Quaternion newWorldRotation = ToQuaternion(worldTrans.getRotation());
     Vector3 newWorldPosition = ToVector3(worldTrans.getOrigin()) - newWorldRotation * centerOfMass_;
+
+    // During an asynchronous step buffer the transform, to be applied in the main thread once the step is complete
+    if (physicsWorld_ && physicsWorld_->IsSimulatingAsync())
+    {
+        DelayedWorldTransform simulated;
+        simulated.rigidBody_ = this;
+        simulated.parentRigidBody_ = nullptr;
+        simulated.worldPosition_ = newWorldPosition;
+        simulated.worldRotation_ = newWorldRotation;
+        physicsWorld_->AddAsyncWorldTransform(simulated);
+    }
+    else
+        SetSimulatedWorldTransform(newWorldPosition, newWorldRotation);
+}
+
+void RigidBody::SetSimulatedWorldTransform(const Vector3& newWorldPosition, const Quaternion& newWorldRotation)
+{
     RigidBody* parentRigidBody = nullptr;
 
     // It is possible that the RigidBody component has been kept alive via a shared pointer,
@@ -199,6 +222,7 @@ void RigidBody::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     {
         physicsWorld_->SetDebugRenderer(debug);
         physicsWorld_->SetDebugDepthTest(depthTest);
+        physicsWorld_->WaitForStep();
 
         btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
         world->debugDrawObject(body_->getWorldTransform(), shiftedCompoundShape_.Get(), IsActive() ? btVector3(1.0f, 1.0f, 1.0f) :
@@ -224,6 +248,7 @@ void RigidBody::SetPosition(const Vector3& position)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         btTransform& worldTrans = body_->getWorldTransform();
         worldTrans.setOrigin(ToBtVector3(position + ToQuaternion(worldTrans.getRotation()) * centerOfMass_));
 
@@ -247,6 +272,7 @@ void RigidBody::SetRotation(const Quaternion& rotation)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         Vector3 oldPosition = GetPosition();
         btTransform& worldTrans = body_->getWorldTransform();
         worldTrans.setRotation(ToBtQuaternion(rotation));
@@ -273,6 +299,7 @@ void RigidBody::SetTransform(const Vector3& position, const Quaternion& rotation
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         btTransform& worldTrans = body_->getWorldTransform();
         worldTrans.setRotation(ToBtQuaternion(rotation));
         worldTrans.setOrigin(ToBtVector3(position + rotation * centerOfMass_));
@@ -296,6 +323,7 @@ void RigidBody::SetLinearVelocity(const Vector3& velocity)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setLinearVelocity(ToBtVector3(velocity));
         if (velocity != Vector3::ZERO)
             Activate();
@@ -307,6 +335,7 @@ void RigidBody::SetLinearFactor(const Vector3& factor)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setLinearFactor(ToBtVector3(factor));
         MarkNetworkUpdate();
     }
@@ -316,6 +345,7 @@ void RigidBody::SetLinearRestThreshold(float threshold)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setSleepingThresholds(threshold, body_->getAngularSleepingThreshold());
         MarkNetworkUpdate();
     }
@@ -325,6 +355,7 @@ void RigidBody::SetLinearDamping(float damping)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setDamping(damping, body_->getAngularDamping());
         MarkNetworkUpdate();
     }
@@ -334,6 +365,7 @@ void RigidBody::SetAngularVelocity(const Vector3& velocity)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setAngularVelocity(ToBtVector3(velocity));
         if (velocity != Vector3::ZERO)
             Activate();
@@ -345,6 +377,7 @@ void RigidBody::SetAngularFactor(const Vector3& factor)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setAngularFactor(ToBtVector3(factor));
         MarkNetworkUpdate();
     }
@@ -354,6 +387,7 @@ void RigidBody::SetAngularRestThreshold(float threshold)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setSleepingThresholds(body_->getLinearSleepingThreshold(), threshold);
         MarkNetworkUpdate();
     }
@@ -363,6 +397,7 @@ void RigidBody::SetAngularDamping(float damping)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setDamping(body_->getLinearDamping(), damping);
         MarkNetworkUpdate();
     }
@@ -372,6 +407,7 @@ void RigidBody::SetFriction(float friction)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setFriction(friction);
         MarkNetworkUpdate();
     }
@@ -381,6 +417,7 @@ void RigidBody::SetAnisotropicFriction(const Vector3& friction)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setAnisotropicFriction(ToBtVector3(friction));
         MarkNetworkUpdate();
     }
@@ -390,6 +427,7 @@ void RigidBody::SetRollingFriction(float friction)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setRollingFriction(friction);
         MarkNetworkUpdate();
     }
@@ -399,6 +437,7 @@ void RigidBody::SetRestitution(float restitution)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setRestitution(restitution);
         MarkNetworkUpdate();
     }
@@ -408,6 +447,7 @@ void RigidBody::SetContactProcessingThreshold(float threshold)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setContactProcessingThreshold(threshold);
         MarkNetworkUpdate();
     }
@@ -418,6 +458,7 @@ void RigidBody::SetCcdRadius(float radius)
     radius = Max(radius, 0.0f);
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setCcdSweptSphereRadius(radius);
         MarkNetworkUpdate();
     }
@@ -428,6 +469,7 @@ void RigidBody::SetCcdMotionThreshold(float threshold)
     threshold = Max(threshold, 0.0f);
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->setCcdMotionThreshold(threshold);
         MarkNetworkUpdate();
     }
@@ -514,6 +556,7 @@ void RigidBody::ApplyForce(const Vector3& force)
 {
     if (body_ && force != Vector3::ZERO)
     {
+        physicsWorld_->WaitForStep();
         Activate();
         body_->applyCentralForce(ToBtVector3(force));
     }
@@ -523,6 +566,7 @@ void RigidBody::ApplyForce(const Vector3& force, const Vector3& position)
 {
     if (body_ && force != Vector3::ZERO)
     {
+        physicsWorld_->WaitForStep();
         Activate();
         body_->applyForce(ToBtVector3(force), ToBtVector3(position - centerOfMass_));
     }
@@ -532,6 +576,7 @@ void RigidBody::ApplyTorque(const Vector3& torque)
 {
     if (body_ && torque != Vector3::ZERO)
     {
+        physicsWorld_->WaitForStep();
         Activate();
         body_->applyTorque(ToBtVector3(torque));
     }
@@ -541,6 +586,7 @@ void RigidBody::ApplyImpulse(const Vector3& impulse)
 {
     if (body_ && impulse != Vector3::ZERO)
     {
+        physicsWorld_->WaitForStep();
         Activate();
         body_->applyCentralImpulse(ToBtVector3(impulse));
     }
@@ -550,6 +596,7 @@ void RigidBody::ApplyImpulse(const Vector3& impulse, const Vector3& position)
 {
     if (body_ && impulse != Vector3::ZERO)
     {
+        physicsWorld_->WaitForStep();
         Activate();
         body_->applyImpulse(ToBtVector3(impulse), ToBtVector3(position - centerOfMass_));
     }
@@ -559,6 +606,7 @@ void RigidBody::ApplyTorqueImpulse(const Vector3& torque)
 {
     if (body_ && torque != Vector3::ZERO)
     {
+        physicsWorld_->WaitForStep();
         Activate();
         body_->applyTorqueImpulse(ToBtVector3(torque));
     }
@@ -567,13 +615,19 @@ void RigidBody::ApplyTorqueImpulse(const Vector3& torque)
 void RigidBody::ResetForces()
 {
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->clearForces();
+    }
 }
 
 void RigidBody::Activate()
 {
     if (body_ && mass_ > 0.0f)
+    {
+        physicsWorld_->WaitForStep();
         body_->activate(true);
+    }
 }
 
 void RigidBody::ReAddBodyToWorld()
@@ -600,6 +654,7 @@ Vector3 RigidBody::GetPosition() const
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         const btTransform& transform = body_->getWorldTransform();
         return ToVector3(transform.getOrigin()) - ToQuaternion(transform.getRotation()) * centerOfMass_;
     }
@@ -609,12 +664,20 @@ Vector3 RigidBody::GetPosition() const
 
 Quaternion RigidBody::GetRotation() const
 {
-    return body_ ? ToQuaternion(body_->getWorldTransform().getRotation()) : Quaternion::IDENTITY;
+    if (!body_)
+        return Quaternion::IDENTITY;
+
+    physicsWorld_->WaitForStep();
+    return ToQuaternion(body_->getWorldTransform().getRotation());
 }
 
 Vector3 RigidBody::GetLinearVelocity() const
 {
-    return body_ ? ToVector3(body_->getLinearVelocity()) : Vector3::ZERO;
+    if (!body_)
+        return Vector3::ZERO;
+
+    physicsWorld_->WaitForStep();
+    return ToVector3(body_->getLinearVelocity());
 }
 
 Vector3 RigidBody::GetLinearFactor() const
@@ -624,7 +687,11 @@ Vector3 RigidBody::GetLinearFactor() const
 
 Vector3 RigidBody::GetVelocityAtPoint(const Vector3& position) const
 {
-    return body_ ? ToVector3(body_->getVelocityInLocalPoint(ToBtVector3(position - centerOfMass_))) : Vector3::ZERO;
+    if (!body_)
+        return Vector3::ZERO;
+
+    physicsWorld_->WaitForStep();
+    return ToVector3(body_->getVelocityInLocalPoint(ToBtVector3(position - centerOfMass_)));
 }
 
 float RigidBody::GetLinearRestThreshold() const
@@ -639,7 +706,11 @@ float RigidBody::GetLinearDamping() const
 
 Vector3 RigidBody::GetAngularVelocity() const
 {
-    return body_ ? ToVector3(body_->getAngularVelocity()) : Vector3::ZERO;
+    if (!body_)
+        return Vector3::ZERO;
+
+    physicsWorld_->WaitForStep();
+    return ToVector3(body_->getAngularVelocity());
 }
 
 Vector3 RigidBody::GetAngularFactor() const
@@ -694,7 +765,11 @@ float RigidBody::GetCcdMotionThreshold() const
 
 bool RigidBody::IsActive() const
 {
-    return body_ ? body_->isActive() : false;
+    if (!body_)
+        return false;
+
+    physicsWorld_->WaitForStep();
+    return body_->isActive();
 }
 
 void RigidBody::GetCollidingBodies(PODVector<RigidBody*>& result) const
@@ -738,6 +813,8 @@ void RigidBody::UpdateMass()
     if (!body_ || !enableMassUpdate_)
         return;
 
+    physicsWorld_->WaitForStep();
+
     btTransform principal;
     principal.setRotation(btQuaternion::getIdentity());
     principal.setOrigin(btVector3(0.0f, 0.0f, 0.0f));
@@ -820,6 +897,7 @@ void RigidBody::UpdateGravity()
 {
     if (physicsWorld_ && body_)
     {
+        physicsWorld_->WaitForStep();
         btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
 
         int flags = body_->getFlags();
@@ -906,6 +984,15 @@ void RigidBody::OnMarkedDirty(Node* node)
         Vector3 newPosition = node_->GetWorldPosition();
         Quaternion newRotation = node_->GetWorldRotation();
 
+        // If moved during an asynchronous step, the node transform overrides the simulated one
+        if (physicsWorld_ && physicsWorld_->IsSimulatingAsync())
+        {
+            bool moved = !newRotation.Equals(lastRotation_) || !newPosition.Equals(lastPosition_);
+            physicsWorld_->WaitForStep(moved ? this : nullptr);
+            if (!moved)
+                return;
+        }
+
         if (!newRotation.Equals(lastRotation_))
         {
             lastRotation_ = newRotation;
@@ -953,6 +1040,8 @@ void RigidBody::AddBodyToWorld()
 
     URHO3D_PROFILE("AddBodyToWorld");
 
+    physicsWorld_->WaitForStep();
+
     if (mass_ < 0.0f)
         mass_ = 0.0f;
 
@@ -1026,6 +1115,7 @@ void RigidBody::RemoveBodyFromWorld()
 {
     if (physicsWorld_ && body_ && inWorld_)
     {
+        physicsWorld_->WaitForStep();
         btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
         world->removeRigidBody(body_.Get());
         inWorld_ = false;
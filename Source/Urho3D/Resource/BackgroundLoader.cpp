@@ -25,6 +25,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/MemoryStats.h"
 #include "../Core/Profiler.h"
 #include "../IO/Log.h"
 #include "../Resource/BackgroundLoader.h"
@@ -50,6 +51,8 @@ BackgroundLoader::~BackgroundLoader()
 
 void BackgroundLoader::ThreadFunction()
 {
+    URHO3D_MEMORY_TAG(MEMTAG_RESOURCE);
+
     while (shouldRun_)
     {
         backgroundLoadMutex_.Acquire();
@@ -0,0 +1,799 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/Log.h"
+#include "../Math/MathDefs.h"
+#include "../Resource/Compress.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+// Block encoders produce data that decodes exactly as in Decompress.cpp, so that errors measured here match what is
+// displayed. Endpoints are fitted along the principal axis of the block's colors and then refined by least squares
+// against the selected indices; the number of refinement passes and extra searches depend on the quality level.
+
+namespace Urho3D
+{
+
+static const char* compressionQualityNames[] =
+{
+    "fast",
+    "normal",
+    "high",
+    nullptr
+};
+
+/// Interpolation weights of BC7 4-bit indices.
+static const int bc7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+/// Number of least squares refinement passes for each quality level.
+static const int refinePasses[] = {0, 2, 8};
+
+/// BC1 color block candidate.
+struct ColorBlock
+{
+    /// First endpoint.
+    unsigned short color0_;
+    /// Second endpoint.
+    unsigned short color1_;
+    /// Three-color mode flag.
+    bool threeColor_;
+    /// Per-pixel indices.
+    unsigned char indices_[16];
+    /// Squared error.
+    int error_;
+};
+
+/// BC4 channel block candidate.
+struct ChannelBlock
+{
+    /// First endpoint.
+    int endpoint0_;
+    /// Second endpoint.
+    int endpoint1_;
+    /// Per-pixel indices.
+    unsigned char indices_[16];
+    /// Squared error.
+    int error_;
+};
+
+/// BC7 mode 6 block candidate.
+struct BC7Block
+{
+    /// Endpoints quantized to 7 bits.
+    int endpoints_[2][4];
+    /// Endpoint P-bits.
+    int pBits_[2];
+    /// Per-pixel indices.
+    unsigned char indices_[16];
+    /// Squared error.
+    int error_;
+};
+
+/// Fit a line through the pixels along their principal axis and return its extent. Pixels with a set skip flag are ignored.
+static void FitEndpoints(const unsigned char* rgba, unsigned channels, const bool* skip, float* start, float* end)
+{
+    float mean[4] = {};
+    unsigned count = 0;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        if (skip && skip[i])
+            continue;
+        for (unsigned c = 0; c < channels; ++c)
+            mean[c] += rgba[i * 4 + c];
+        ++count;
+    }
+
+    if (!count)
+    {
+        for (unsigned c = 0; c < channels; ++c)
+            start[c] = end[c] = 0.0f;
+        return;
+    }
+
+    for (unsigned c = 0; c < channels; ++c)
+        mean[c] /= count;
+
+    float covariance[4][4] = {};
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        if (skip && skip[i])
+            continue;
+        float delta[4];
+        for (unsigned c = 0; c < channels; ++c)
+            delta[c] = rgba[i * 4 + c] - mean[c];
+        for (unsigned a = 0; a < channels; ++a)
+        {
+            for (unsigned b = a; b < channels; ++b)
+                covariance[a][b] += delta[a] * delta[b];
+        }
+    }
+    for (unsigned a = 0; a < channels; ++a)
+    {
+        for (unsigned b = 0; b < a; ++b)
+            covariance[a][b] = covariance[b][a];
+    }
+
+    // Power iteration, starting from the row of the channel with the largest variance
+    unsigned largest = 0;
+    for (unsigned c = 1; c < channels; ++c)
+    {
+        if (covariance[c][c] > covariance[largest][largest])
+            largest = c;
+    }
+
+    float axis[4];
+    for (unsigned c = 0; c < channels; ++c)
+        axis[c] = covariance[largest][c];
+
+    for (unsigned iteration = 0; iteration < 8; ++iteration)
+    {
+        float next[4] = {};
+        float maxComponent = 0.0f;
+        for (unsigned a = 0; a < channels; ++a)
+        {
+            for (unsigned b = 0; b < channels; ++b)
+                next[a] += covariance[a][b] * axis[b];
+            maxComponent = Max(maxComponent, Abs(next[a]));
+        }
+        if (maxComponent < M_EPSILON)
+            break;
+        for (unsigned c = 0; c < channels; ++c)
+            axis[c] = next[c] / maxComponent;
+    }
+
+    float lengthSquared = 0.0f;
+    for (unsigned c = 0; c < channels; ++c)
+        lengthSquared += axis[c] * axis[c];
+
+    if (lengthSquared < M_EPSILON)
+    {
+        // All pixels are the same
+        for (unsigned c = 0; c < channels; ++c)
+            start[c] = end[c] = mean[c];
+        return;
+    }
+
+    const float invLength = 1.0f / sqrtf(lengthSquared);
+    for (unsigned c = 0; c < channels; ++c)
+        axis[c] *= invLength;
+
+    float minT = M_INFINITY;
+    float maxT = -M_INFINITY;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        if (skip && skip[i])
+            continue;
+        float t = 0.0f;
+        for (unsigned c = 0; c < channels; ++c)
+            t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+        minT = Min(minT, t);
+        maxT = Max(maxT, t);
+    }
+
+    for (unsigned c = 0; c < channels; ++c)
+    {
+        start[c] = Clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+        end[c] = Clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    }
+}
+
+/// Solve the endpoints that best reproduce the pixels with the given indices in the least squares sense. Weights give the position of each index between the endpoints. Return false if the system is degenerate.
+static bool SolveEndpoints(const unsigned char* rgba, unsigned channels, const unsigned char* indices, const float* weights,
+    const bool* skip, float* start, float* end)
+{
+    float aa = 0.0f;
+    float bb = 0.0f;
+    float ab = 0.0f;
+    float ax[4] = {};
+    float bx[4] = {};
+
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        if (skip && skip[i])
+            continue;
+        const float b = weights[indices[i]];
+        const float a = 1.0f - b;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (unsigned c = 0; c < channels; ++c)
+        {
+            ax[c] += a * rgba[i * 4 + c];
+            bx[c] += b * rgba[i * 4 + c];
+        }
+    }
+
+    const float determinant = aa * bb - ab * ab;
+    if (determinant < M_EPSILON)
+        return false;
+
+    const float invDeterminant = 1.0f / determinant;
+    for (unsigned c = 0; c < channels; ++c)
+    {
+        start[c] = Clamp((ax[c] * bb - bx[c] * ab) * invDeterminant, 0.0f, 255.0f);
+        end[c] = Clamp((bx[c] * aa - ax[c] * ab) * invDeterminant, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+static unsigned short PackColor565(const float* color)
+{
+    int r = Clamp((int)(color[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+    int g = Clamp((int)(color[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+    int b = Clamp((int)(color[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+    return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+static void UnpackColor565(unsigned short packed, int* color)
+{
+    int r = (packed >> 11) & 0x1f;
+    int g = (packed >> 5) & 0x3f;
+    int b = packed & 0x1f;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+/// Select the indices for a pair of BC1 endpoints and keep the result if it is better than the best so far.
+static void EvaluateColorEndpoints(const unsigned char* rgba, unsigned short color0, unsigned short color1, bool threeColor,
+    const bool* transparent, ColorBlock& best)
+{
+    // Four-color mode is signaled by color0 > color1, three-color mode by color0 <= color1
+    if (threeColor ? color0 > color1 : color0 < color1)
+        Swap(color0, color1);
+
+    int palette[4][3];
+    UnpackColor565(color0, palette[0]);
+    UnpackColor565(color1, palette[1]);
+    for (unsigned c = 0; c < 3; ++c)
+    {
+        if (threeColor)
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        else
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    }
+    // Equal endpoints select three-color mode in BC1, so only use the endpoint itself
+    const unsigned numColors = color0 == color1 ? 1 : (threeColor ? 3 : 4);
+
+    ColorBlock block;
+    block.color0_ = color0;
+    block.color1_ = color1;
+    block.threeColor_ = threeColor;
+    block.error_ = 0;
+
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        if (transparent && transparent[i])
+        {
+            block.indices_[i] = 3;
+            continue;
+        }
+
+        const unsigned char* pixel = rgba + i * 4;
+        int bestError = M_MAX_INT;
+        for (unsigned k = 0; k < numColors; ++k)
+        {
+            const int dr = pixel[0] - palette[k][0];
+            const int dg = pixel[1] - palette[k][1];
+            const int db = pixel[2] - palette[k][2];
+            const int error = dr * dr + dg * dg + db * db;
+            if (error < bestError)
+            {
+                bestError = error;
+                block.indices_[i] = (unsigned char)k;
+            }
+        }
+
+        block.error_ += bestError;
+        if (block.error_ >= best.error_)
+            return;
+    }
+
+    best = block;
+}
+
+/// Compress a BC1 color block. Pixels with alpha below 128 are made transparent if punch-through alpha is allowed.
+static void CompressColorBlock(unsigned char* dest, const unsigned char* rgba, bool punchThroughAlpha, CompressionQuality quality)
+{
+    static const float weights4[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+    static const float weights3[4] = {0.0f, 1.0f, 0.5f, 0.0f};
+
+    bool transparent[16];
+    bool hasTransparent = false;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        transparent[i] = punchThroughAlpha && rgba[i * 4 + 3] < 128;
+        hasTransparent |= transparent[i];
+    }
+    const bool* skip = hasTransparent ? transparent : nullptr;
+
+    ColorBlock best;
+    best.error_ = M_MAX_INT;
+
+    float start[3];
+    float end[3];
+    FitEndpoints(rgba, 3, skip, start, end);
+    EvaluateColorEndpoints(rgba, PackColor565(end), PackColor565(start), hasTransparent, skip, best);
+
+    // Three-color mode can also be used for opaque pixels when it happens to fit better
+    if (punchThroughAlpha && !hasTransparent && quality == COMPRESSION_HIGH)
+        EvaluateColorEndpoints(rgba, PackColor565(end), PackColor565(start), true, nullptr, best);
+
+    for (int pass = 0; pass < refinePasses[quality] && best.error_ > 0; ++pass)
+    {
+        const int previousError = best.error_;
+        if (!SolveEndpoints(rgba, 3, best.indices_, best.threeColor_ ? weights3 : weights4, skip, start, end))
+            break;
+        EvaluateColorEndpoints(rgba, PackColor565(start), PackColor565(end), best.threeColor_, skip, best);
+        if (best.error_ >= previousError)
+            break;
+    }
+
+    if (quality == COMPRESSION_HIGH)
+    {
+        // Nudge each 5:6:5 endpoint component by one step while the error keeps decreasing
+        static const unsigned shifts[3] = {11, 5, 0};
+        static const unsigned masks[3] = {0x1f, 0x3f, 0x1f};
+
+        for (unsigned iteration = 0; iteration < 4 && best.error_ > 0; ++iteration)
+        {
+            const int previousError = best.error_;
+            for (unsigned endpoint = 0; endpoint < 2; ++endpoint)
+            {
+                for (unsigned c = 0; c < 3; ++c)
+                {
+                    for (int delta = -1; delta <= 1; delta += 2)
+                    {
+                        unsigned short colors[2] = {best.color0_, best.color1_};
+                        const int value = (int)((colors[endpoint] >> shifts[c]) & masks[c]) + delta;
+                        if (value < 0 || value > (int)masks[c])
+                            continue;
+                        colors[endpoint] = (unsigned short)((colors[endpoint] & ~(masks[c] << shifts[c])) | (value << shifts[c]));
+                        EvaluateColorEndpoints(rgba, colors[0], colors[1], best.threeColor_, skip, best);
+                    }
+                }
+            }
+            if (best.error_ >= previousError)
+                break;
+        }
+    }
+
+    dest[0] = (unsigned char)(best.color0_ & 0xff);
+    dest[1] = (unsigned char)(best.color0_ >> 8);
+    dest[2] = (unsigned char)(best.color1_ & 0xff);
+    dest[3] = (unsigned char)(best.color1_ >> 8);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        const unsigned char* indices = best.indices_ + i * 4;
+        dest[4 + i] = (unsigned char)(indices[0] | (indices[1] << 2) | (indices[2] << 4) | (indices[3] << 6));
+    }
+}
+
+/// Select the indices for a pair of BC4 endpoints and keep the result if it is better than the best so far.
+static void EvaluateChannelEndpoints(const int* values, int endpoint0, int endpoint1, ChannelBlock& best)
+{
+    int codes[8];
+    codes[0] = endpoint0;
+    codes[1] = endpoint1;
+    if (endpoint0 <= endpoint1)
+    {
+        // Six interpolated values plus explicit 0 and 255
+        for (int i = 1; i < 5; ++i)
+            codes[1 + i] = ((5 - i) * endpoint0 + i * endpoint1) / 5;
+        codes[6] = 0;
+        codes[7] = 255;
+    }
+    else
+    {
+        for (int i = 1; i < 7; ++i)
+            codes[1 + i] = ((7 - i) * endpoint0 + i * endpoint1) / 7;
+    }
+
+    ChannelBlock block;
+    block.endpoint0_ = endpoint0;
+    block.endpoint1_ = endpoint1;
+    block.error_ = 0;
+
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        int bestError = M_MAX_INT;
+        for (unsigned k = 0; k < 8; ++k)
+        {
+            const int delta = values[i] - codes[k];
+            const int error = delta * delta;
+            if (error < bestError)
+            {
+                bestError = error;
+                block.indices_[i] = (unsigned char)k;
+            }
+        }
+
+        block.error_ += bestError;
+        if (block.error_ >= best.error_)
+            return;
+    }
+
+    best = block;
+}
+
+/// Compress one channel of the pixels into a BC4 block. Also used for BC3 alpha and the two halves of BC5.
+static void CompressChannelBlock(unsigned char* dest, const unsigned char* rgba, unsigned channel, CompressionQuality quality)
+{
+    int values[16];
+    int minValue = 255;
+    int maxValue = 0;
+    int minInner = 255;
+    int maxInner = 0;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const int value = rgba[i * 4 + channel];
+        values[i] = value;
+        minValue = Min(minValue, value);
+        maxValue = Max(maxValue, value);
+        if (value != 0 && value != 255)
+        {
+            minInner = Min(minInner, value);
+            maxInner = Max(maxInner, value);
+        }
+    }
+
+    ChannelBlock best;
+    best.error_ = M_MAX_INT;
+    EvaluateChannelEndpoints(values, maxValue, minValue, best);
+
+    if (quality != COMPRESSION_FAST && best.error_ > 0)
+    {
+        // Six-value mode spends its range on the values between the extremes, which are then hit exactly
+        if (minInner <= maxInner)
+            EvaluateChannelEndpoints(values, minInner, maxInner, best);
+        else
+            EvaluateChannelEndpoints(values, 0, 255, best);
+    }
+
+    if (quality == COMPRESSION_HIGH && maxValue > minValue && best.error_ > 0)
+    {
+        // Narrowing the range slightly often places the interpolated values better
+        for (int i = 0; i <= 4; ++i)
+        {
+            for (int j = 0; j <= 4; ++j)
+            {
+                if (maxValue - i > minValue + j)
+                    EvaluateChannelEndpoints(values, maxValue - i, minValue + j, best);
+            }
+        }
+    }
+
+    dest[0] = (unsigned char)best.endpoint0_;
+    dest[1] = (unsigned char)best.endpoint1_;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        unsigned value = 0;
+        for (unsigned j = 0; j < 8; ++j)
+            value |= (unsigned)best.indices_[i * 8 + j] << (3 * j);
+        dest[2 + i * 3] = (unsigned char)(value & 0xff);
+        dest[3 + i * 3] = (unsigned char)((value >> 8) & 0xff);
+        dest[4 + i * 3] = (unsigned char)((value >> 16) & 0xff);
+    }
+}
+
+/// Compress alpha into a BC2 explicit alpha block.
+static void CompressExplicitAlphaBlock(unsigned char* dest, const unsigned char* rgba)
+{
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        const unsigned lo = (rgba[i * 8 + 3] * 15u + 127u) / 255u;
+        const unsigned hi = (rgba[i * 8 + 7] * 15u + 127u) / 255u;
+        dest[i] = (unsigned char)(lo | (hi << 4));
+    }
+}
+
+/// Select the indices for a pair of BC7 mode 6 endpoints and keep the result if it is better than the best so far.
+static void EvaluateBC7Endpoints(const unsigned char* rgba, const int (&endpoints)[2][4], const int (&pBits)[2], BC7Block& best)
+{
+    int palette[16][4];
+    for (unsigned c = 0; c < 4; ++c)
+    {
+        const int e0 = (endpoints[0][c] << 1) | pBits[0];
+        const int e1 = (endpoints[1][c] << 1) | pBits[1];
+        for (unsigned k = 0; k < 16; ++k)
+            palette[k][c] = ((64 - bc7Weights4[k]) * e0 + bc7Weights4[k] * e1 + 32) >> 6;
+    }
+
+    BC7Block block;
+    memcpy(block.endpoints_, endpoints, sizeof block.endpoints_);
+    memcpy(block.pBits_, pBits, sizeof block.pBits_);
+    block.error_ = 0;
+
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const unsigned char* pixel = rgba + i * 4;
+        int bestError = M_MAX_INT;
+        for (unsigned k = 0; k < 16; ++k)
+        {
+            int error = 0;
+            for (unsigned c = 0; c < 4; ++c)
+            {
+                const int delta = pixel[c] - palette[k][c];
+                error += delta * delta;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                block.indices_[i] = (unsigned char)k;
+            }
+        }
+
+        block.error_ += bestError;
+        if (block.error_ >= best.error_)
+            return;
+    }
+
+    best = block;
+}
+
+/// Quantize an endpoint to 7 bits with the given P-bit. Return the squared quantization error.
+static int QuantizeBC7Endpoint(const float* color, int pBit, int* quantized)
+{
+    int error = 0;
+    for (unsigned c = 0; c < 4; ++c)
+    {
+        quantized[c] = Clamp((int)((color[c] - pBit) * 0.5f + 0.5f), 0, 127);
+        const int delta = (int)(color[c] + 0.5f) - ((quantized[c] << 1) | pBit);
+        error += delta * delta;
+    }
+    return error;
+}
+
+/// Quantize and evaluate a pair of BC7 endpoints. High quality tries every P-bit combination, otherwise the P-bits closest to the endpoints are used.
+static void EvaluateBC7Endpoints(const unsigned char* rgba, const float* start, const float* end, CompressionQuality quality, BC7Block& best)
+{
+    int endpoints[2][4];
+    int pBits[2];
+
+    if (quality == COMPRESSION_HIGH)
+    {
+        for (int p0 = 0; p0 < 2; ++p0)
+        {
+            for (int p1 = 0; p1 < 2; ++p1)
+            {
+                pBits[0] = p0;
+                pBits[1] = p1;
+                QuantizeBC7Endpoint(start, p0, endpoints[0]);
+                QuantizeBC7Endpoint(end, p1, endpoints[1]);
+                EvaluateBC7Endpoints(rgba, endpoints, pBits, best);
+            }
+        }
+        return;
+    }
+
+    const float* colors[2] = {start, end};
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        int quantized[4];
+        const int error0 = QuantizeBC7Endpoint(colors[i], 0, endpoints[i]);
+        const int error1 = QuantizeBC7Endpoint(colors[i], 1, quantized);
+        pBits[i] = 0;
+        if (error1 < error0)
+        {
+            pBits[i] = 1;
+            memcpy(endpoints[i], quantized, sizeof quantized);
+        }
+    }
+    EvaluateBC7Endpoints(rgba, endpoints, pBits, best);
+}
+
+/// Write bits to a block, least significant bit first.
+static void WriteBits(unsigned char* dest, unsigned& bitPosition, unsigned value, unsigned numBits)
+{
+    for (unsigned i = 0; i < numBits; ++i, ++bitPosition)
+    {
+        if (value & (1u << i))
+            dest[bitPosition >> 3u] |= (unsigned char)(1u << (bitPosition & 7u));
+    }
+}
+
+/// Compress a BC7 block using mode 6, which has a single subset with 7-bit RGBA endpoints, P-bits and 4-bit indices.
+static void CompressBlockBC7(unsigned char* dest, const unsigned char* rgba, CompressionQuality quality)
+{
+    float weights[16];
+    for (unsigned k = 0; k < 16; ++k)
+        weights[k] = bc7Weights4[k] / 64.0f;
+
+    BC7Block best;
+    best.error_ = M_MAX_INT;
+
+    float start[4];
+    float end[4];
+    FitEndpoints(rgba, 4, nullptr, start, end);
+    EvaluateBC7Endpoints(rgba, start, end, quality, best);
+
+    for (int pass = 0; pass < refinePasses[quality] && best.error_ > 0; ++pass)
+    {
+        const int previousError = best.error_;
+        if (!SolveEndpoints(rgba, 4, best.indices_, weights, nullptr, start, end))
+            break;
+        EvaluateBC7Endpoints(rgba, start, end, quality, best);
+        if (best.error_ >= previousError)
+            break;
+    }
+
+    // The highest index bit of the first pixel is implicit zero, so swap the endpoints if it would be set
+    if (best.indices_[0] & 8)
+    {
+        for (unsigned c = 0; c < 4; ++c)
+            Swap(best.endpoints_[0][c], best.endpoints_[1][c]);
+        Swap(best.pBits_[0], best.pBits_[1]);
+        for (unsigned i = 0; i < 16; ++i)
+            best.indices_[i] = (unsigned char)(15 - best.indices_[i]);
+    }
+
+    memset(dest, 0, 16);
+    unsigned bitPosition = 0;
+    WriteBits(dest, bitPosition, 1u << 6u, 7);
+    for (unsigned c = 0; c < 4; ++c)
+    {
+        WriteBits(dest, bitPosition, (unsigned)best.endpoints_[0][c], 7);
+        WriteBits(dest, bitPosition, (unsigned)best.endpoints_[1][c], 7);
+    }
+    WriteBits(dest, bitPosition, (unsigned)best.pBits_[0], 1);
+    WriteBits(dest, bitPosition, (unsigned)best.pBits_[1], 1);
+    WriteBits(dest, bitPosition, best.indices_[0], 3);
+    for (unsigned i = 1; i < 16; ++i)
+        WriteBits(dest, bitPosition, best.indices_[i], 4);
+}
+
+unsigned GetCompressedBlockSize(CompressedFormat format)
+{
+    switch (format)
+    {
+    case CF_DXT1:
+    case CF_BC4:
+    case CF_ETC1:
+        return 8;
+
+    case CF_DXT3:
+    case CF_DXT5:
+    case CF_BC5:
+    case CF_BC7:
+        return 16;
+
+    default:
+        return 0;
+    }
+}
+
+bool IsCompressionSupported(CompressedFormat format)
+{
+    switch (format)
+    {
+    case CF_DXT1:
+    case CF_DXT3:
+    case CF_DXT5:
+    case CF_BC4:
+    case CF_BC5:
+    case CF_BC7:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+CompressedFormat ParseCompressedFormatName(const String& name)
+{
+    String upperCaseName = name.ToUpper().Trimmed();
+
+    if (upperCaseName == "BC1" || upperCaseName == "DXT1")
+        return CF_DXT1;
+    else if (upperCaseName == "BC2" || upperCaseName == "DXT3")
+        return CF_DXT3;
+    else if (upperCaseName == "BC3" || upperCaseName == "DXT5")
+        return CF_DXT5;
+    else if (upperCaseName == "BC4")
+        return CF_BC4;
+    else if (upperCaseName == "BC5")
+        return CF_BC5;
+    else if (upperCaseName == "BC7")
+        return CF_BC7;
+
+    URHO3D_LOGERROR("Unknown compressed format name " + name);
+    return CF_NONE;
+}
+
+CompressionQuality ParseCompressionQualityName(const String& name)
+{
+    return (CompressionQuality)GetStringListIndex(name.ToLower().Trimmed().CString(), compressionQualityNames, COMPRESSION_NORMAL);
+}
+
+void CompressBlock(unsigned char* dest, const unsigned char* rgba, CompressedFormat format, CompressionQuality quality)
+{
+    switch (format)
+    {
+    case CF_DXT1:
+        CompressColorBlock(dest, rgba, true, quality);
+        break;
+
+    case CF_DXT3:
+        CompressExplicitAlphaBlock(dest, rgba);
+        CompressColorBlock(dest + 8, rgba, false, quality);
+        break;
+
+    case CF_DXT5:
+        CompressChannelBlock(dest, rgba, 3, quality);
+        CompressColorBlock(dest + 8, rgba, false, quality);
+        break;
+
+    case CF_BC4:
+        CompressChannelBlock(dest, rgba, 0, quality);
+        break;
+
+    case CF_BC5:
+        CompressChannelBlock(dest, rgba, 0, quality);
+        CompressChannelBlock(dest + 8, rgba, 1, quality);
+        break;
+
+    case CF_BC7:
+        CompressBlockBC7(dest, rgba, quality);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void CompressImageRows(unsigned char* dest, const unsigned char* rgba, int width, int height, int beginRow, int endRow,
+    CompressedFormat format, CompressionQuality quality)
+{
+    const unsigned blockSize = GetCompressedBlockSize(format);
+    const int blocksWide = (width + 3) / 4;
+    unsigned char block[16 * 4];
+
+    for (int blockY = beginRow; blockY < endRow; ++blockY)
+    {
+        unsigned char* destRow = dest + (size_t)blockY * blocksWide * blockSize;
+        for (int blockX = 0; blockX < blocksWide; ++blockX)
+        {
+            for (int py = 0; py < 4; ++py)
+            {
+                const int y = Min(blockY * 4 + py, height - 1);
+                for (int px = 0; px < 4; ++px)
+                {
+                    const int x = Min(blockX * 4 + px, width - 1);
+                    memcpy(block + (py * 4 + px) * 4, rgba + ((size_t)y * width + x) * 4, 4);
+                }
+            }
+
+            CompressBlock(destRow + blockX * blockSize, block, format, quality);
+        }
+    }
+}
+
+}
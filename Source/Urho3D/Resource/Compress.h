@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Resource/Image.h"
+
+namespace Urho3D
+{
+
+/// Return size in bytes of a 4x4 block of a block compressed format, or 0 if the format is not block based.
+URHO3D_API unsigned GetCompressedBlockSize(CompressedFormat format);
+/// Return whether images can be compressed to a format.
+URHO3D_API bool IsCompressionSupported(CompressedFormat format);
+/// Parse a compressed format name such as "BC3" or "DXT5". Return CF_NONE if not recognized.
+URHO3D_API CompressedFormat ParseCompressedFormatName(const String& name);
+/// Parse a compression quality name ("fast", "normal" or "high"). Return normal quality if not recognized.
+URHO3D_API CompressionQuality ParseCompressionQualityName(const String& name);
+/// Compress a 4x4 block of RGBA pixels. BC4 uses the red and BC5 the red and green channels.
+URHO3D_API void CompressBlock(unsigned char* dest, const unsigned char* rgba, CompressedFormat format, CompressionQuality quality);
+/// Compress a range of block rows of an RGBA image. Blocks reaching past the image edge repeat the edge pixels. The destination points to the first block of the image.
+URHO3D_API void CompressImageRows(unsigned char* dest, const unsigned char* rgba, int width, int height, int beginRow, int endRow,
+    CompressedFormat format, CompressionQuality quality);
+
+}
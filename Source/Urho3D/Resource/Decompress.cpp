@@ -22,13 +22,29 @@
 
 #include "../Precompiled.h"
 
+#include "../Math/MathDefs.h"
 #include "../Resource/Decompress.h"
 
+#include <cstring>
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 // DXT decompression based on the Squish library, modified for Urho3D
 
 namespace Urho3D
 {
 
+/// Store a decoded 4x4 block of RGBA pixels to an image, skipping the pixels outside it.
+static void StoreBlock(unsigned char* rgba, const unsigned* pixels, int width, int height, int x, int y)
+{
+    const int columns = Min(width - x, 4);
+    const int rows = Min(height - y, 4);
+    for (int py = 0; py < rows; ++py)
+        memcpy(rgba + 4 * (width * (y + py) + x), pixels + 4 * py, 4 * (size_t)columns);
+}
+
 /* -----------------------------------------------------------------------------
 
     Copyright (c) 2006 Simon Brown                          si@sjbrown.co.uk
@@ -74,7 +90,7 @@ static int Unpack565(unsigned char const* packed, unsigned char* colour)
     return value;
 }
 
-static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isDxt1)
+static void DecompressColourDXT(unsigned* pixels, void const* block, bool isDxt1)
 {
     // get the block bytes
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
@@ -106,26 +122,41 @@ static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isD
     codes[8 + 3] = 255;
     codes[12 + 3] = (unsigned char)((isDxt1 && a <= b) ? 0 : 255);
 
-    // unpack the indices
-    unsigned char indices[16];
+    unsigned palette[4];
+    memcpy(palette, codes, sizeof palette);
+
+#ifdef URHO3D_SSE
+    // select the colours of a row of 4 pixels at once by comparing each 2-bit index field against the possible values
+    const __m128i fieldMask = _mm_set_epi32(0xc0, 0x30, 0x0c, 0x03);
+    const __m128i fieldOne = _mm_set_epi32(0x40, 0x10, 0x04, 0x01);
+    const __m128i fieldTwo = _mm_set_epi32(0x80, 0x20, 0x08, 0x02);
+    const __m128i colour0 = _mm_set1_epi32((int)palette[0]);
+    const __m128i colour1 = _mm_set1_epi32((int)palette[1]);
+    const __m128i colour2 = _mm_set1_epi32((int)palette[2]);
+    const __m128i colour3 = _mm_set1_epi32((int)palette[3]);
     for (int i = 0; i < 4; ++i)
     {
-        unsigned char* ind = indices + 4 * i;
-        unsigned char packed = bytes[4 + i];
-
-        ind[0] = (unsigned char)(packed & 0x3);
-        ind[1] = (unsigned char)((packed >> 2) & 0x3);
-        ind[2] = (unsigned char)((packed >> 4) & 0x3);
-        ind[3] = (unsigned char)((packed >> 6) & 0x3);
+        __m128i fields = _mm_and_si128(_mm_set1_epi32(bytes[4 + i]), fieldMask);
+        __m128i is1 = _mm_cmpeq_epi32(fields, fieldOne);
+        __m128i is2 = _mm_cmpeq_epi32(fields, fieldTwo);
+        __m128i is3 = _mm_cmpeq_epi32(fields, fieldMask);
+        __m128i row = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(is1, is2), is3), colour0);
+        row = _mm_or_si128(row, _mm_and_si128(is1, colour1));
+        row = _mm_or_si128(row, _mm_and_si128(is2, colour2));
+        row = _mm_or_si128(row, _mm_and_si128(is3, colour3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 4 * i), row);
     }
-
-    // store out the colours
-    for (int i = 0; i < 16; ++i)
+#else
+    // store out the colours by the 2-bit indices
+    for (int i = 0; i < 4; ++i)
     {
-        auto offset = (unsigned char)(4 * indices[i]);
-        for (int j = 0; j < 4; ++j)
-            rgba[4 * i + j] = codes[offset + j];
+        unsigned char packed = bytes[4 + i];
+        pixels[4 * i] = palette[packed & 0x3];
+        pixels[4 * i + 1] = palette[(packed >> 2) & 0x3];
+        pixels[4 * i + 2] = palette[(packed >> 4) & 0x3];
+        pixels[4 * i + 3] = palette[(packed >> 6) & 0x3];
     }
+#endif
 }
 
 static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
@@ -148,7 +179,7 @@ static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
     }
 }
 
-static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
+static void DecompressAlphaDXT5(unsigned char* rgba, void const* block, int channel = 3)
 {
     // get the two alpha values
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
@@ -198,11 +229,25 @@ static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
 
     // write out the indexed codebook values
     for (int i = 0; i < 16; ++i)
-        rgba[4 * i + 3] = codes[indices[i]];
+        rgba[4 * i + channel] = codes[indices[i]];
 }
 
-static void DecompressDXT(unsigned char* rgba, const void* block, CompressedFormat format)
+static void DecompressDXT(unsigned* pixels, const void* block, CompressedFormat format)
 {
+    auto* rgba = reinterpret_cast<unsigned char*>(pixels);
+
+    // BC4 and BC5 store red and green in blocks encoded like DXT5 alpha
+    if (format == CF_BC4 || format == CF_BC5)
+    {
+        for (int i = 0; i < 16; ++i)
+            pixels[i] = 0xff000000;
+
+        DecompressAlphaDXT5(rgba, block, 0);
+        if (format == CF_BC5)
+            DecompressAlphaDXT5(rgba, reinterpret_cast< unsigned char const* >( block ) + 8, 1);
+        return;
+    }
+
     // get the block locations
     void const* colourBlock = block;
     void const* alphaBock = block;
@@ -210,7 +255,7 @@ static void DecompressDXT(unsigned char* rgba, const void* block, CompressedForm
         colourBlock = reinterpret_cast< unsigned char const* >( block ) + 8;
 
     // decompress colour
-    DecompressColourDXT(rgba, colourBlock, format == CF_DXT1);
+    DecompressColourDXT(pixels, colourBlock, format == CF_DXT1);
 
     // decompress alpha separately if necessary
     if (format == CF_DXT3)
@@ -221,11 +266,288 @@ static void DecompressDXT(unsigned char* rgba, const void* block, CompressedForm
 
 void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format)
 {
-    // initialise the block input
     auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
-    int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+    int bytesPerBlock = (format == CF_DXT1 || format == CF_BC4) ? 8 : 16;
+    int blocksHigh = (height + 3) / 4;
+    int sliceSize = (width + 3) / 4 * blocksHigh * bytesPerBlock;
+
+    for (int z = 0; z < depth; ++z)
+        DecompressImageDXTRows(rgba + width * height * 4 * z, sourceBlock + sliceSize * z, width, height, 0, blocksHigh, format);
+}
+
+void DecompressImageDXTRows(unsigned char* rgba, const void* blocks, int width, int height, int beginRow, int endRow,
+    CompressedFormat format)
+{
+    // initialise the block input
+    int bytesPerBlock = (format == CF_DXT1 || format == CF_BC4) ? 8 : 16;
+    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks ) + (width + 3) / 4 * beginRow * bytesPerBlock;
 
     // loop over blocks
+    for (int y = beginRow * 4; y < endRow * 4; y += 4)
+    {
+        for (int x = 0; x < width; x += 4)
+        {
+            // decompress the block and write the pixels inside the image
+            unsigned pixels[16];
+            DecompressDXT(pixels, sourceBlock, format);
+            StoreBlock(rgba, pixels, width, height, x, y);
+
+            // advance
+            sourceBlock += bytesPerBlock;
+        }
+    }
+}
+
+/// BC7 mode layout.
+struct BC7ModeInfo
+{
+    /// Number of subsets.
+    unsigned subsets_;
+    /// Number of partition bits.
+    unsigned partitionBits_;
+    /// Number of rotation bits.
+    unsigned rotationBits_;
+    /// Number of index selection bits.
+    unsigned indexSelectionBits_;
+    /// Number of bits per colour endpoint component.
+    unsigned colourBits_;
+    /// Number of bits per alpha endpoint component, zero if alpha is opaque.
+    unsigned alphaBits_;
+    /// Whether each endpoint has a P-bit.
+    bool endpointPBits_;
+    /// Whether each subset has a P-bit shared by its endpoints.
+    bool sharedPBits_;
+    /// Number of bits per primary index.
+    unsigned indexBits_;
+    /// Number of bits per secondary index, zero if there is none.
+    unsigned secondaryIndexBits_;
+};
+
+static const BC7ModeInfo bc7Modes[] =
+{
+    {3, 4, 0, 0, 4, 0, true, false, 3, 0},
+    {2, 6, 0, 0, 6, 0, false, true, 3, 0},
+    {3, 6, 0, 0, 5, 0, false, false, 2, 0},
+    {2, 6, 0, 0, 7, 0, true, false, 2, 0},
+    {1, 0, 2, 1, 5, 6, false, false, 2, 3},
+    {1, 0, 2, 0, 7, 8, false, false, 2, 2},
+    {1, 0, 0, 0, 7, 7, true, false, 4, 0},
+    {2, 6, 0, 0, 5, 5, true, false, 2, 0},
+};
+
+/// Two-subset partitions, one bit per pixel selecting the subset.
+static const unsigned short bc7Partitions2[64] =
+{
+    0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+    0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+    0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+    0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+    0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+    0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+    0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+    0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+};
+
+/// Three-subset partitions, two bits per pixel selecting the subset.
+static const unsigned bc7Partitions3[64] =
+{
+    0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+    0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+    0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+    0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+    0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+    0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+    0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+    0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254,
+};
+
+/// Anchor pixel of the second subset of two-subset partitions.
+static const unsigned char bc7Anchors2[64] =
+{
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+    15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+    6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+};
+
+/// Anchor pixels of the second and third subsets of three-subset partitions.
+static const unsigned char bc7Anchors3[2][64] =
+{
+    {
+        3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+        3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+        8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+        3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3,
+    },
+    {
+        15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+        15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+        15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+        15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8,
+    },
+};
+
+/// Read bits from a BC7 block, least significant bit first.
+static int ReadBC7Bits(unsigned char const* bytes, unsigned& bitPosition, unsigned numBits)
+{
+    int value = 0;
+    for (unsigned i = 0; i < numBits; ++i, ++bitPosition)
+        value |= ((bytes[bitPosition >> 3u] >> (bitPosition & 7u)) & 1) << i;
+    return value;
+}
+
+/// Expand an endpoint component to 8 bits by replicating its high bits.
+static int ExpandBC7Component(int value, unsigned numBits)
+{
+    return numBits < 8 ? (value << (8 - numBits)) | (value >> (2 * numBits - 8)) : value;
+}
+
+static bool DecompressBC7(unsigned char* rgba, const void* block)
+{
+    static const int weights2[] = {0, 21, 43, 64};
+    static const int weights3[] = {0, 9, 18, 27, 37, 46, 55, 64};
+    static const int weights4[] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    static const int* weights[] = {nullptr, nullptr, weights2, weights3, weights4};
+
+    auto const* bytes = reinterpret_cast< unsigned char const* >( block );
+
+    // the mode is given by the position of the lowest set bit
+    unsigned mode = 0;
+    while (mode < 8 && !(bytes[0] & (1u << mode)))
+        ++mode;
+    if (mode == 8)
+    {
+        // reserved mode
+        memset(rgba, 0, 4 * 16);
+        return false;
+    }
+    unsigned bitPosition = mode + 1;
+
+    const BC7ModeInfo& info = bc7Modes[mode];
+    const unsigned partition = (unsigned)ReadBC7Bits(bytes, bitPosition, info.partitionBits_);
+    const int rotation = ReadBC7Bits(bytes, bitPosition, info.rotationBits_);
+    const int indexSelection = ReadBC7Bits(bytes, bitPosition, info.indexSelectionBits_);
+
+    // endpoints are stored channel by channel, each channel listing both endpoints of every subset
+    int endpoints[3][2][4];
+    const unsigned numEndpoints = info.subsets_ * 2;
+    for (unsigned c = 0; c < 3; ++c)
+    {
+        for (unsigned e = 0; e < numEndpoints; ++e)
+            endpoints[e >> 1u][e & 1u][c] = ReadBC7Bits(bytes, bitPosition, info.colourBits_);
+    }
+    for (unsigned e = 0; e < numEndpoints; ++e)
+        endpoints[e >> 1u][e & 1u][3] = info.alphaBits_ ? ReadBC7Bits(bytes, bitPosition, info.alphaBits_) : 255;
+
+    // P-bits append a shared low bit to every component of an endpoint
+    unsigned colourBits = info.colourBits_;
+    unsigned alphaBits = info.alphaBits_;
+    if (info.endpointPBits_ || info.sharedPBits_)
+    {
+        for (unsigned e = 0; e < numEndpoints; ++e)
+        {
+            if (info.sharedPBits_ && (e & 1u))
+                continue;
+            const int pBit = ReadBC7Bits(bytes, bitPosition, 1);
+            for (unsigned i = e; i <= (info.sharedPBits_ ? e + 1 : e); ++i)
+            {
+                for (unsigned c = 0; c < 3; ++c)
+                    endpoints[i >> 1u][i & 1u][c] = (endpoints[i >> 1u][i & 1u][c] << 1) | pBit;
+                if (alphaBits)
+                    endpoints[i >> 1u][i & 1u][3] = (endpoints[i >> 1u][i & 1u][3] << 1) | pBit;
+            }
+        }
+        ++colourBits;
+        if (alphaBits)
+            ++alphaBits;
+    }
+
+    for (unsigned e = 0; e < numEndpoints; ++e)
+    {
+        for (unsigned c = 0; c < 3; ++c)
+            endpoints[e >> 1u][e & 1u][c] = ExpandBC7Component(endpoints[e >> 1u][e & 1u][c], colourBits);
+        if (alphaBits)
+            endpoints[e >> 1u][e & 1u][3] = ExpandBC7Component(endpoints[e >> 1u][e & 1u][3], alphaBits);
+    }
+
+    // assign the pixels to subsets and find the anchor pixels, whose index has an implicit zero high bit
+    unsigned char subsets[16];
+    unsigned anchors[3] = {0, 0, 0};
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        if (info.subsets_ == 2)
+            subsets[i] = (unsigned char)((bc7Partitions2[partition] >> i) & 1u);
+        else if (info.subsets_ == 3)
+            subsets[i] = (unsigned char)((bc7Partitions3[partition] >> (2 * i)) & 3u);
+        else
+            subsets[i] = 0;
+    }
+    if (info.subsets_ == 2)
+        anchors[1] = bc7Anchors2[partition];
+    else if (info.subsets_ == 3)
+    {
+        anchors[1] = bc7Anchors3[0][partition];
+        anchors[2] = bc7Anchors3[1][partition];
+    }
+
+    unsigned char primary[16];
+    unsigned char secondary[16];
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const bool anchor = i == anchors[subsets[i]];
+        primary[i] = (unsigned char)ReadBC7Bits(bytes, bitPosition, anchor ? info.indexBits_ - 1 : info.indexBits_);
+    }
+    if (info.secondaryIndexBits_)
+    {
+        for (unsigned i = 0; i < 16; ++i)
+            secondary[i] = (unsigned char)ReadBC7Bits(bytes, bitPosition, i ? info.secondaryIndexBits_ : info.secondaryIndexBits_ - 1);
+    }
+
+    // with two index sets the colour uses the primary one unless index selection swaps them
+    const unsigned char* colourIndices = primary;
+    const unsigned char* alphaIndices = primary;
+    const int* colourWeights = weights[info.indexBits_];
+    const int* alphaWeights = colourWeights;
+    if (info.secondaryIndexBits_)
+    {
+        if (indexSelection)
+        {
+            colourIndices = secondary;
+            colourWeights = weights[info.secondaryIndexBits_];
+        }
+        else
+        {
+            alphaIndices = secondary;
+            alphaWeights = weights[info.secondaryIndexBits_];
+        }
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const int (&subsetEndpoints)[2][4] = endpoints[subsets[i]];
+        const int colourWeight = colourWeights[colourIndices[i]];
+        const int alphaWeight = alphaWeights[alphaIndices[i]];
+        for (int c = 0; c < 3; ++c)
+            rgba[4 * i + c] = (unsigned char)(((64 - colourWeight) * subsetEndpoints[0][c] + colourWeight * subsetEndpoints[1][c] + 32) >> 6);
+        rgba[4 * i + 3] = (unsigned char)(((64 - alphaWeight) * subsetEndpoints[0][3] + alphaWeight * subsetEndpoints[1][3] + 32) >> 6);
+
+        // rotation swaps alpha with one of the colour channels
+        if (rotation)
+        {
+            unsigned char temp = rgba[4 * i + 3];
+            rgba[4 * i + 3] = rgba[4 * i + rotation - 1];
+            rgba[4 * i + rotation - 1] = temp;
+        }
+    }
+
+    return true;
+}
+
+bool DecompressImageBC7(unsigned char* rgba, const void* blocks, int width, int height, int depth)
+{
+    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
+    bool success = true;
+
     for (int z = 0; z < depth; ++z)
     {
         int sz = width * height * 4 * z;
@@ -233,40 +555,22 @@ void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int
         {
             for (int x = 0; x < width; x += 4)
             {
-                // decompress the block
                 unsigned char targetRgba[4 * 16];
-                DecompressDXT(targetRgba, sourceBlock, format);
+                success &= DecompressBC7(targetRgba, sourceBlock);
 
-                // write the decompressed pixels to the correct image locations
-                unsigned char const* sourcePixel = targetRgba;
-                for (int py = 0; py < 4; ++py)
+                // write the pixels that are inside the image
+                for (int py = 0; py < 4 && y + py < height; ++py)
                 {
-                    for (int px = 0; px < 4; ++px)
-                    {
-                        // get the target location
-                        int sx = x + px;
-                        int sy = y + py;
-                        if (sx < width && sy < height)
-                        {
-                            unsigned char* targetPixel = rgba + sz + 4 * (width * sy + sx);
-
-                            // copy the rgba value
-                            for (int i = 0; i < 4; ++i)
-                                *targetPixel++ = *sourcePixel++;
-                        }
-                        else
-                        {
-                            // skip this pixel as its outside the image
-                            sourcePixel += 4;
-                        }
-                    }
+                    const int columns = Min(4, width - x);
+                    memcpy(rgba + sz + 4 * (width * (y + py) + x), targetRgba + 16 * py, (size_t)(4 * columns));
                 }
 
-                // advance
-                sourceBlock += bytesPerBlock;
+                sourceBlock += 16;
             }
         }
     }
+
+    return success;
 }
 
 // ETC and PVRTC decompression based on the Oolong Engine, modified for Urho3D
@@ -303,34 +607,41 @@ const int mod[8][4] = {{2,  8,   -2,  -8},
                        {33, 106, -33, -106},
                        {47, 183, -47, -183}};
 
+// build the 4 possible colours of a subblock from its base colour
+static void GetETCPalette(unsigned palette[4], int red, int green, int blue, int modTable)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        int pixelMod = mod[modTable][i];
+        int r = _CLAMP_(red + pixelMod, 0, 255);
+        int g = _CLAMP_(green + pixelMod, 0, 255);
+        int b = _CLAMP_(blue + pixelMod, 0, 255);
+        palette[i] = (unsigned)((b << 16) + (g << 8) + r) | 0xff000000;
+    }
+}
+
 // lsb: hgfedcba ponmlkji msb: hgfedcba ponmlkji due to endianness
-static unsigned long ModifyPixel(int red, int green, int blue, int x, int y, unsigned long modBlock, int modTable)
+static unsigned GetETCModifierIndex(unsigned modBlock, int x, int y)
 {
-    int index = x * 4 + y, pixelMod;
-    unsigned long mostSig = modBlock << 1;
+    int index = x * 4 + y;
+    unsigned mostSig = modBlock << 1;
     if (index < 8)    //hgfedcba
-        pixelMod = mod[modTable][((modBlock >> (index + 24)) & 0x1) + ((mostSig >> (index + 8)) & 0x2)];
+        return ((modBlock >> (index + 24)) & 0x1) + ((mostSig >> (index + 8)) & 0x2);
     else    // ponmlkj
-        pixelMod = mod[modTable][((modBlock >> (index + 8)) & 0x1) + ((mostSig >> (index - 8)) & 0x2)];
-
-    red = _CLAMP_(red + pixelMod, 0, 255);
-    green = _CLAMP_(green + pixelMod, 0, 255);
-    blue = _CLAMP_(blue + pixelMod, 0, 255);
-
-    return ((blue << 16) + (green << 8) + red) | 0xff000000;
+        return ((modBlock >> (index + 8)) & 0x1) + ((mostSig >> (index - 8)) & 0x2);
 }
 
-static void DecompressETC(unsigned char* pDestData, const void* pSrcData)
+static void DecompressETC(unsigned* output, const void* pSrcData)
 {
-    unsigned long blockTop, blockBot, * input = (unsigned long*)pSrcData, * output;
+    // the block is read as two 32-bit words; a long is 64 bits on LP64 platforms
+    unsigned blockTop, blockBot;
     unsigned char red1, green1, blue1, red2, green2, blue2;
     bool bFlip, bDiff;
     int modtable1, modtable2;
 
-    blockTop = *(input++);
-    blockBot = *(input++);
+    memcpy(&blockTop, pSrcData, sizeof blockTop);
+    memcpy(&blockBot, reinterpret_cast<const unsigned char*>(pSrcData) + sizeof blockTop, sizeof blockBot);
 
-    output = (unsigned long*)pDestData;
     // check flipbit
     bFlip = (blockTop & ETC_FLIP) != 0;
     bDiff = (blockTop & ETC_DIFF) != 0;
@@ -381,14 +692,20 @@ static void DecompressETC(unsigned char* pDestData, const void* pSrcData)
     modtable1 = (int)((blockTop >> 29) & 0x7);
     modtable2 = (int)((blockTop >> 26) & 0x7);
 
+    // clamp the 4 modified colours of each subblock once instead of per pixel
+    unsigned palette1[4];
+    unsigned palette2[4];
+    GetETCPalette(palette1, red1, green1, blue1, modtable1);
+    GetETCPalette(palette2, red2, green2, blue2, modtable2);
+
     if (!bFlip)
     {   // 2 2x4 blocks side by side
         for (int j = 0; j < 4; j++)    // vertical
         {
             for (int k = 0; k < 2; k++)    // horizontal
             {
-                *(output + j * 4 + k) = ModifyPixel(red1, green1, blue1, k, j, blockBot, modtable1);
-                *(output + j * 4 + k + 2) = ModifyPixel(red2, green2, blue2, k + 2, j, blockBot, modtable2);
+                *(output + j * 4 + k) = palette1[GetETCModifierIndex(blockBot, k, j)];
+                *(output + j * 4 + k + 2) = palette2[GetETCModifierIndex(blockBot, k + 2, j)];
             }
         }
     }
@@ -398,52 +715,33 @@ static void DecompressETC(unsigned char* pDestData, const void* pSrcData)
         {
             for (int k = 0; k < 4; k++)
             {
-                *(output + j * 4 + k) = ModifyPixel(red1, green1, blue1, k, j, blockBot, modtable1);
-                *(output + (j + 2) * 4 + k) = ModifyPixel(red2, green2, blue2, k, j + 2, blockBot, modtable2);
+                *(output + j * 4 + k) = palette1[GetETCModifierIndex(blockBot, k, j)];
+                *(output + (j + 2) * 4 + k) = palette2[GetETCModifierIndex(blockBot, k, j + 2)];
             }
         }
     }
 }
 
 void DecompressImageETC(unsigned char* rgba, const void* blocks, int width, int height)
+{
+    DecompressImageETCRows(rgba, blocks, width, height, 0, (height + 3) / 4);
+}
+
+void DecompressImageETCRows(unsigned char* rgba, const void* blocks, int width, int height, int beginRow, int endRow)
 {
     // initialise the block input
-    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
     int bytesPerBlock = 8;
+    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks ) + (width + 3) / 4 * beginRow * bytesPerBlock;
 
     // loop over blocks
-    for (int y = 0; y < height; y += 4)
+    for (int y = beginRow * 4; y < endRow * 4; y += 4)
     {
         for (int x = 0; x < width; x += 4)
         {
-            // decompress the block
-            unsigned char targetRgba[4 * 16];
-            DecompressETC(targetRgba, sourceBlock);
-
-            // write the decompressed pixels to the correct image locations
-            unsigned char const* sourcePixel = targetRgba;
-            for (int py = 0; py < 4; ++py)
-            {
-                for (int px = 0; px < 4; ++px)
-                {
-                    // get the target location
-                    int sx = x + px;
-                    int sy = y + py;
-                    if (sx < width && sy < height)
-                    {
-                        unsigned char* targetPixel = rgba + 4 * (width * sy + sx);
-
-                        // copy the rgba value
-                        for (int i = 0; i < 4; ++i)
-                            *targetPixel++ = *sourcePixel++;
-                    }
-                    else
-                    {
-                        // skip this pixel as its outside the image
-                        sourcePixel += 4;
-                    }
-                }
-            }
+            // decompress the block and write the pixels inside the image
+            unsigned pixels[16];
+            DecompressETC(pixels, sourceBlock);
+            StoreBlock(rgba, pixels, width, height, x, y);
 
             // advance
             sourceBlock += bytesPerBlock;
@@ -803,6 +1101,12 @@ static unsigned TwiddleUV(unsigned YSize, unsigned XSize, unsigned YPos, unsigne
 }
 
 void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, int height, CompressedFormat format)
+{
+    DecompressImagePVRTCRows(rgba, blocks, width, height, 0, height, format);
+}
+
+void DecompressImagePVRTCRows(unsigned char* rgba, const void* blocks, int width, int height, int beginRow, int endRow,
+    CompressedFormat format)
 {
     auto* pCompressedData = (AMTC_BLOCK_STRUCT*)blocks;
     int AssumeImageTiles = 1;
@@ -828,8 +1132,8 @@ void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, in
     // Local neighbourhood of blocks
     AMTC_BLOCK_STRUCT* pBlocks[2][2];
 
-    AMTC_BLOCK_STRUCT* pPrevious[2][2] = {{nullptr, nullptr},
-                                          {nullptr, nullptr}};
+    // Top left block of the previous pixel's neighbourhood
+    int PrevBlkX = -1, PrevBlkY = -1;
 
     // Low precision colours extracted from the blocks
     struct
@@ -855,9 +1159,7 @@ void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, in
     BlkYDim = _MAX(2, height / BLK_Y_SIZE);
 
     // Step through the pixels of the image decompressing each one in turn
-    //
-    // Note that this is a hideously inefficient way to do this!
-    for (y = 0; y < height; y++)
+    for (y = beginRow; y < endRow; y++)
     {
         for (x = 0; x < width; x++)
         {
@@ -871,20 +1173,22 @@ void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, in
             BlkX /= XBlockSize;
             BlkY /= BLK_Y_SIZE;
 
-            // Compute the positions of the other 3 blocks
-            BlkXp1 = LIMIT_COORD(BlkX + 1, BlkXDim, AssumeImageTiles);
-            BlkYp1 = LIMIT_COORD(BlkY + 1, BlkYDim, AssumeImageTiles);
+            // Extract the colours and the modulation information IF the neighbourhood
+            // has changed. The other 3 blocks follow from the top left one, so its
+            // coordinates are enough to tell, and the block addresses need to be
+            // computed only then.
+            if (BlkX != PrevBlkX || BlkY != PrevBlkY)
+            {
+                // Compute the positions of the other 3 blocks
+                BlkXp1 = LIMIT_COORD(BlkX + 1, BlkXDim, AssumeImageTiles);
+                BlkYp1 = LIMIT_COORD(BlkY + 1, BlkYDim, AssumeImageTiles);
 
-            // Map to block memory locations
-            pBlocks[0][0] = pCompressedData + TwiddleUV((unsigned)BlkYDim, (unsigned)BlkXDim, (unsigned)BlkY, (unsigned)BlkX);
-            pBlocks[0][1] = pCompressedData + TwiddleUV((unsigned)BlkYDim, (unsigned)BlkXDim, (unsigned)BlkY, (unsigned)BlkXp1);
-            pBlocks[1][0] = pCompressedData + TwiddleUV((unsigned)BlkYDim, (unsigned)BlkXDim, (unsigned)BlkYp1, (unsigned)BlkX);
-            pBlocks[1][1] = pCompressedData + TwiddleUV((unsigned)BlkYDim, (unsigned)BlkXDim, (unsigned)BlkYp1, (unsigned)BlkXp1);
+                // Map to block memory locations
+                pBlocks[0][0] = pCompressedData + TwiddleUV((unsigned)BlkYDim, (unsigned)BlkXDim, (unsigned)BlkY, (unsigned)BlkX);
+                pBlocks[0][1] = pCompressedData + TwiddleUV((unsigned)BlkYDim, (unsigned)BlkXDim, (unsigned)BlkY, (unsigned)BlkXp1);
+                pBlocks[1][0] = pCompressedData + TwiddleUV((unsigned)BlkYDim, (unsigned)BlkXDim, (unsigned)BlkYp1, (unsigned)BlkX);
+                pBlocks[1][1] = pCompressedData + TwiddleUV((unsigned)BlkYDim, (unsigned)BlkXDim, (unsigned)BlkYp1, (unsigned)BlkXp1);
 
-            // Extract the colours and the modulation information IF the previous values
-            // have changed.
-            if (memcmp(pPrevious, pBlocks, 4 * sizeof(void*)) != 0)
-            {
                 StartY = 0;
                 for (i = 0; i < 2; i++)
                 {
@@ -905,8 +1209,8 @@ void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, in
                     StartY += BLK_Y_SIZE;
                 }
 
-                // Make a copy of the new pointers
-                memcpy(pPrevious, pBlocks, 4 * sizeof(void*));
+                PrevBlkX = BlkX;
+                PrevBlkY = BlkY;
             }
 
             // Decompress the pixel.  First compute the interpolated A and B signals
@@ -27,13 +27,23 @@
 namespace Urho3D
 {
 
-/// Decompress a DXT compressed image to RGBA.
+/// Decompress a DXT, BC4 or BC5 compressed image to RGBA. BC4 decodes to red and BC5 to red and green.
 URHO3D_API void
     DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format);
+/// Decompress a range of block rows of a single DXT, BC4 or BC5 compressed image slice to RGBA. The source and destination point to the start of the slice.
+URHO3D_API void DecompressImageDXTRows(unsigned char* rgba, const void* blocks, int width, int height, int beginRow, int endRow,
+    CompressedFormat format);
+/// Decompress a BC7 compressed image to RGBA. Only the single subset modes 4, 5 and 6 are supported; blocks in other modes decode to zero and make the function return false.
+URHO3D_API bool DecompressImageBC7(unsigned char* rgba, const void* blocks, int width, int height, int depth);
 /// Decompress an ETC1 compressed image to RGBA.
 URHO3D_API void DecompressImageETC(unsigned char* rgba, const void* blocks, int width, int height);
+/// Decompress a range of block rows of an ETC1 compressed image to RGBA. The source and destination point to the start of the image.
+URHO3D_API void DecompressImageETCRows(unsigned char* rgba, const void* blocks, int width, int height, int beginRow, int endRow);
 /// Decompress a PVRTC compressed image to RGBA.
 URHO3D_API void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, int height, CompressedFormat format);
+/// Decompress a range of pixel rows of a PVRTC compressed image to RGBA. The whole image is needed as source, as pixels are interpolated from neighbouring blocks.
+URHO3D_API void DecompressImagePVRTCRows(unsigned char* rgba, const void* blocks, int width, int height, int beginRow, int endRow,
+    CompressedFormat format);
 /// Flip a compressed block vertically.
 URHO3D_API void FlipBlockVertical(unsigned char* dest, const unsigned char* src, CompressedFormat format);
 /// Flip a compressed block horizontally.
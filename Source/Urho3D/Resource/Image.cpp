@@ -24,10 +24,14 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../Resource/Compress.h"
 #include "../Resource/Decompress.h"
+#include "../Resource/ImageFilter.h"
 
 #include <SDL/SDL_surface.h>
 #include <STB/stb_image.h>
@@ -50,6 +54,20 @@
 #define FOURCC_DXT4 (MAKEFOURCC('D','X','T','4'))
 #define FOURCC_DXT5 (MAKEFOURCC('D','X','T','5'))
 #define FOURCC_DX10 (MAKEFOURCC('D','X','1','0'))
+#define FOURCC_ATI1 (MAKEFOURCC('A','T','I','1'))
+#define FOURCC_ATI2 (MAKEFOURCC('A','T','I','2'))
+#define FOURCC_BC4U (MAKEFOURCC('B','C','4','U'))
+#define FOURCC_BC5U (MAKEFOURCC('B','C','5','U'))
+#define FOURCC_BC7 (MAKEFOURCC('B','C','7',' '))
+
+static const unsigned DDSD_CAPS = 0x00000001U;
+static const unsigned DDSD_HEIGHT = 0x00000002U;
+static const unsigned DDSD_WIDTH = 0x00000004U;
+static const unsigned DDSD_PIXELFORMAT = 0x00001000U;
+static const unsigned DDSD_MIPMAPCOUNT = 0x00020000U;
+static const unsigned DDSD_LINEARSIZE = 0x00080000U;
+
+static const unsigned DDPF_FOURCC = 0x00000004U;
 
 static const unsigned DDSCAPS_COMPLEX = 0x00000008U;
 static const unsigned DDSCAPS_TEXTURE = 0x00001000U;
@@ -80,6 +98,10 @@ static const unsigned DDS_DXGI_FORMAT_BC2_UNORM = 74;
 static const unsigned DDS_DXGI_FORMAT_BC2_UNORM_SRGB = 75;
 static const unsigned DDS_DXGI_FORMAT_BC3_UNORM = 77;
 static const unsigned DDS_DXGI_FORMAT_BC3_UNORM_SRGB = 78;
+static const unsigned DDS_DXGI_FORMAT_BC4_UNORM = 80;
+static const unsigned DDS_DXGI_FORMAT_BC5_UNORM = 83;
+static const unsigned DDS_DXGI_FORMAT_BC7_UNORM = 98;
+static const unsigned DDS_DXGI_FORMAT_BC7_UNORM_SRGB = 99;
 
 namespace Urho3D
 {
@@ -210,28 +232,82 @@ struct DDSurfaceDesc2
     unsigned dwTextureStage_;
 };
 
-bool CompressedLevel::Decompress(unsigned char* dest)
+/// Pixels per work item when processing image rows in parallel.
+static const int PIXELS_PER_WORK_ITEM = 16384;
+
+/// Return the work queue if image processing should be split into work items, or null to process on the calling thread.
+static WorkQueue* GetImageWorkQueue(Context* context)
+{
+    auto* queue = context ? context->GetSubsystem<WorkQueue>() : nullptr;
+    return queue && queue->GetNumThreads() && Thread::IsMainThread() && !queue->IsCompleting() ? queue : nullptr;
+}
+
+/// Process rows of an image with a kernel taking a row range, in parallel on the work queue when possible. Return when all rows are done.
+static void ProcessImageRows(Context* context, int numRows, int rowPixels, const std::function<void(int, int)>& kernel)
+{
+    WorkQueue* queue = GetImageWorkQueue(context);
+    const int rowsPerItem = Max(PIXELS_PER_WORK_ITEM / Max(rowPixels, 1), 1);
+    if (!queue || numRows <= rowsPerItem)
+    {
+        kernel(0, numRows);
+        return;
+    }
+
+    for (int row = 0; row < numRows; row += rowsPerItem)
+    {
+        const int endRow = Min(row + rowsPerItem, numRows);
+        queue->AddWorkItem([=, &kernel]() { kernel(row, endRow); }, M_MAX_UNSIGNED);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
+bool CompressedLevel::Decompress(unsigned char* dest, Context* context)
 {
     if (!data_)
         return false;
 
+    const int blocksWide = (width_ + 3) / 4;
+    const int blocksHigh = (height_ + 3) / 4;
+
     switch (format_)
     {
     case CF_DXT1:
     case CF_DXT3:
     case CF_DXT5:
-        DecompressImageDXT(dest, data_, width_, height_, depth_, format_);
+    case CF_BC4:
+    case CF_BC5:
+        {
+            const int bytesPerBlock = (format_ == CF_DXT1 || format_ == CF_BC4) ? 8 : 16;
+            for (int z = 0; z < depth_; ++z)
+            {
+                unsigned char* sliceDest = dest + width_ * height_ * 4 * z;
+                const unsigned char* sliceData = data_ + blocksWide * blocksHigh * bytesPerBlock * z;
+                ProcessImageRows(context, blocksHigh, blocksWide * 16, [=](int beginRow, int endRow)
+                {
+                    DecompressImageDXTRows(sliceDest, sliceData, width_, height_, beginRow, endRow, format_);
+                });
+            }
+        }
         return true;
 
+    case CF_BC7:
+        return DecompressImageBC7(dest, data_, width_, height_, depth_);
+
     case CF_ETC1:
-        DecompressImageETC(dest, data_, width_, height_);
+        ProcessImageRows(context, blocksHigh, blocksWide * 16, [=](int beginRow, int endRow)
+        {
+            DecompressImageETCRows(dest, data_, width_, height_, beginRow, endRow);
+        });
         return true;
 
     case CF_PVRTC_RGB_2BPP:
     case CF_PVRTC_RGBA_2BPP:
     case CF_PVRTC_RGB_4BPP:
     case CF_PVRTC_RGBA_4BPP:
-        DecompressImagePVRTC(dest, data_, width_, height_, format_);
+        ProcessImageRows(context, height_, width_, [=](int beginRow, int endRow)
+        {
+            DecompressImagePVRTCRows(dest, data_, width_, height_, beginRow, endRow, format_);
+        });
         return true;
 
     default:
@@ -288,6 +364,16 @@ bool Image::BeginLoad(Deserializer& source)
             case DDS_DXGI_FORMAT_BC3_UNORM_SRGB:
                 fourCC = FOURCC_DXT5;
                 break;
+            case DDS_DXGI_FORMAT_BC4_UNORM:
+                fourCC = FOURCC_BC4U;
+                break;
+            case DDS_DXGI_FORMAT_BC5_UNORM:
+                fourCC = FOURCC_BC5U;
+                break;
+            case DDS_DXGI_FORMAT_BC7_UNORM:
+            case DDS_DXGI_FORMAT_BC7_UNORM_SRGB:
+                fourCC = FOURCC_BC7;
+                break;
             case DDS_DXGI_FORMAT_R8G8B8A8_UNORM:
             case DDS_DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
                 fourCC = 0;
@@ -301,6 +387,7 @@ bool Image::BeginLoad(Deserializer& source)
             if (dxgiHeader.dxgiFormat == DDS_DXGI_FORMAT_BC1_UNORM_SRGB ||
                 dxgiHeader.dxgiFormat == DDS_DXGI_FORMAT_BC2_UNORM_SRGB ||
                 dxgiHeader.dxgiFormat == DDS_DXGI_FORMAT_BC3_UNORM_SRGB ||
+                dxgiHeader.dxgiFormat == DDS_DXGI_FORMAT_BC7_UNORM_SRGB ||
                 dxgiHeader.dxgiFormat == DDS_DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
             {
                 sRGB_ = true;
@@ -323,6 +410,23 @@ bool Image::BeginLoad(Deserializer& source)
             components_ = 4;
             break;
 
+        case FOURCC_ATI1:
+        case FOURCC_BC4U:
+            compressedFormat_ = CF_BC4;
+            components_ = 1;
+            break;
+
+        case FOURCC_ATI2:
+        case FOURCC_BC5U:
+            compressedFormat_ = CF_BC5;
+            components_ = 2;
+            break;
+
+        case FOURCC_BC7:
+            compressedFormat_ = CF_BC7;
+            components_ = 4;
+            break;
+
         case 0:
             if (ddsd.ddpfPixelFormat_.dwRGBBitCount_ != 32 && ddsd.ddpfPixelFormat_.dwRGBBitCount_ != 24 &&
                 ddsd.ddpfPixelFormat_.dwRGBBitCount_ != 16)
@@ -354,7 +458,7 @@ bool Image::BeginLoad(Deserializer& source)
         unsigned dataSize = 0;
         if (compressedFormat_ != CF_RGBA)
         {
-            const unsigned blockSize = compressedFormat_ == CF_DXT1 ? 8 : 16; //DXT1/BC1 is 8 bytes, DXT3/BC2 and DXT5/BC3 are 16 bytes
+            const unsigned blockSize = GetCompressedBlockSize(compressedFormat_);
             // Add 3 to ensure valid block: ie 2x2 fits uses a whole 4x4 block
             unsigned blocksWide = (ddsd.dwWidth_ + 3) / 4;
             unsigned blocksHeight = (ddsd.dwHeight_ + 3) / 4;
@@ -571,6 +675,23 @@ bool Image::BeginLoad(Deserializer& source)
             components_ = 4;
             break;
 
+        case 0x8dbb:
+            compressedFormat_ = CF_BC4;
+            components_ = 1;
+            break;
+
+        case 0x8dbd:
+            compressedFormat_ = CF_BC5;
+            components_ = 2;
+            break;
+
+        case 0x8e8c:
+        case 0x8e8d:
+            compressedFormat_ = CF_BC7;
+            components_ = 4;
+            sRGB_ = internalFormat == 0x8e8d;
+            break;
+
         case 0x8d64:
             compressedFormat_ = CF_ETC1;
             components_ = 3;
@@ -840,6 +961,8 @@ bool Image::SaveFile(const String& fileName) const
 {
     if (fileName.EndsWith(".dds", false))
         return SaveDDS(fileName);
+    else if (fileName.EndsWith(".ktx", false))
+        return SaveKTX(fileName);
     else if (fileName.EndsWith(".bmp", false))
         return SaveBMP(fileName);
     else if (fileName.EndsWith(".jpg", false) || fileName.EndsWith(".jpeg", false))
@@ -1144,34 +1267,12 @@ bool Image::Resize(int width, int height)
 
     /// \todo Reducing image size does not sample all needed pixels
     SharedArrayPtr<unsigned char> newData(new unsigned char[width * height * components_]);
-    for (int y = 0; y < height; ++y)
+    unsigned char* dest = newData.Get();
+    const unsigned char* src = data_.Get();
+    ProcessImageRows(context_, height, width, [=](int beginRow, int endRow)
     {
-        for (int x = 0; x < width; ++x)
-        {
-            // Calculate float coordinates between 0 - 1 for resampling
-            float xF = (width_ > 1) ? (float)x / (float)(width - 1) : 0.0f;
-            float yF = (height_ > 1) ? (float)y / (float)(height - 1) : 0.0f;
-            unsigned uintColor = GetPixelBilinear(xF, yF).ToUInt();
-            unsigned char* dest = newData + (y * width + x) * components_;
-            auto* src = (unsigned char*)&uintColor;
-
-            switch (components_)
-            {
-            case 4:
-                dest[3] = src[3];
-                // Fall through
-            case 3:
-                dest[2] = src[2];
-                // Fall through
-            case 2:
-                dest[1] = src[1];
-                // Fall through
-            default:
-                dest[0] = src[0];
-                break;
-            }
-        }
-    }
+        ResizeImageRows(dest, width, height, src, width_, height_, components_, beginRow, endRow);
+    });
 
     width_ = width;
     height_ = height;
@@ -1307,8 +1408,86 @@ bool Image::SaveDDS(const String& fileName) const
 
     if (IsCompressed())
     {
-        URHO3D_LOGERROR("Can not save compressed image to DDS");
-        return false;
+        if (nextSibling_ || depth_ > 1 || !numCompressedLevels_)
+        {
+            URHO3D_LOGERROR("Can not save compressed 3D, cube map or array image to DDS");
+            return false;
+        }
+
+        unsigned fourCC;
+        unsigned dxgiFormat;
+        switch (compressedFormat_)
+        {
+        case CF_DXT1:
+            fourCC = FOURCC_DXT1;
+            dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC1_UNORM_SRGB : DDS_DXGI_FORMAT_BC1_UNORM;
+            break;
+
+        case CF_DXT3:
+            fourCC = FOURCC_DXT3;
+            dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC2_UNORM_SRGB : DDS_DXGI_FORMAT_BC2_UNORM;
+            break;
+
+        case CF_DXT5:
+            fourCC = FOURCC_DXT5;
+            dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC3_UNORM_SRGB : DDS_DXGI_FORMAT_BC3_UNORM;
+            break;
+
+        case CF_BC4:
+            fourCC = FOURCC_BC4U;
+            dxgiFormat = DDS_DXGI_FORMAT_BC4_UNORM;
+            break;
+
+        case CF_BC5:
+            fourCC = FOURCC_BC5U;
+            dxgiFormat = DDS_DXGI_FORMAT_BC5_UNORM;
+            break;
+
+        case CF_BC7:
+            fourCC = FOURCC_DX10;
+            dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC7_UNORM_SRGB : DDS_DXGI_FORMAT_BC7_UNORM;
+            break;
+
+        default:
+            URHO3D_LOGERROR("Can not save ETC1 or PVRTC compressed image to DDS");
+            return false;
+        }
+
+        // sRGB can only be expressed in the DX10 header
+        if (sRGB_)
+            fourCC = FOURCC_DX10;
+
+        outFile.WriteFileID("DDS ");
+
+        DDSurfaceDesc2 ddsd;        // NOLINT(hicpp-member-init)
+        memset(&ddsd, 0, sizeof(ddsd));
+        ddsd.dwSize_ = sizeof(ddsd);
+        ddsd.dwFlags_ = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+        ddsd.dwWidth_ = width_;
+        ddsd.dwHeight_ = height_;
+        ddsd.dwLinearSize_ = GetCompressedLevel(0).dataSize_;
+        ddsd.dwMipMapCount_ = numCompressedLevels_;
+        ddsd.ddpfPixelFormat_.dwSize_ = sizeof(ddsd.ddpfPixelFormat_);
+        ddsd.ddpfPixelFormat_.dwFlags_ = DDPF_FOURCC;
+        ddsd.ddpfPixelFormat_.dwFourCC_ = fourCC;
+        ddsd.ddsCaps_.dwCaps_ = DDSCAPS_TEXTURE;
+        if (numCompressedLevels_ > 1)
+            ddsd.ddsCaps_.dwCaps_ |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+        outFile.Write(&ddsd, sizeof(ddsd));
+        if (fourCC == FOURCC_DX10)
+        {
+            DDSHeader10 dxgiHeader{dxgiFormat, DDS_DIMENSION_TEXTURE2D, 0, 1, 0};
+            outFile.Write(&dxgiHeader, sizeof(dxgiHeader));
+        }
+
+        for (unsigned i = 0; i < numCompressedLevels_; ++i)
+        {
+            CompressedLevel level = GetCompressedLevel(i);
+            outFile.Write(level.data_, level.dataSize_);
+        }
+
+        return true;
     }
 
     if (components_ != 4)
@@ -1346,6 +1525,124 @@ bool Image::SaveDDS(const String& fileName) const
     return true;
 }
 
+bool Image::SaveKTX(const String& fileName) const
+{
+    URHO3D_PROFILE("SaveImageKTX");
+
+    static const unsigned char ktxIdentifier[] = {0xab, 'K', 'T', 'X', ' ', '1', '1', 0xbb, '\r', '\n', 0x1a, '\n'};
+    static const unsigned GL_RED_BASE = 0x1903;
+    static const unsigned GL_RG_BASE = 0x8227;
+    static const unsigned GL_RGB_BASE = 0x1907;
+    static const unsigned GL_RGBA_BASE = 0x1908;
+
+    if (!IsCompressed() || compressedFormat_ == CF_RGBA)
+    {
+        URHO3D_LOGERROR("Can not save uncompressed image to KTX");
+        return false;
+    }
+
+    if (nextSibling_ || depth_ > 1 || !numCompressedLevels_)
+    {
+        URHO3D_LOGERROR("Can not save compressed 3D, cube map or array image to KTX");
+        return false;
+    }
+
+    unsigned internalFormat;
+    unsigned baseInternalFormat;
+    switch (compressedFormat_)
+    {
+    case CF_DXT1:
+        internalFormat = 0x83f1;
+        baseInternalFormat = GL_RGBA_BASE;
+        break;
+
+    case CF_DXT3:
+        internalFormat = 0x83f2;
+        baseInternalFormat = GL_RGBA_BASE;
+        break;
+
+    case CF_DXT5:
+        internalFormat = 0x83f3;
+        baseInternalFormat = GL_RGBA_BASE;
+        break;
+
+    case CF_BC4:
+        internalFormat = 0x8dbb;
+        baseInternalFormat = GL_RED_BASE;
+        break;
+
+    case CF_BC5:
+        internalFormat = 0x8dbd;
+        baseInternalFormat = GL_RG_BASE;
+        break;
+
+    case CF_BC7:
+        internalFormat = sRGB_ ? 0x8e8d : 0x8e8c;
+        baseInternalFormat = GL_RGBA_BASE;
+        break;
+
+    case CF_ETC1:
+        internalFormat = 0x8d64;
+        baseInternalFormat = GL_RGB_BASE;
+        break;
+
+    case CF_PVRTC_RGB_4BPP:
+        internalFormat = 0x8c00;
+        baseInternalFormat = GL_RGB_BASE;
+        break;
+
+    case CF_PVRTC_RGB_2BPP:
+        internalFormat = 0x8c01;
+        baseInternalFormat = GL_RGB_BASE;
+        break;
+
+    case CF_PVRTC_RGBA_4BPP:
+        internalFormat = 0x8c02;
+        baseInternalFormat = GL_RGBA_BASE;
+        break;
+
+    default:
+        internalFormat = 0x8c03;
+        baseInternalFormat = GL_RGBA_BASE;
+        break;
+    }
+
+    File outFile(context_, fileName, FILE_WRITE);
+    if (!outFile.IsOpen())
+    {
+        URHO3D_LOGERROR("Access denied to " + fileName);
+        return false;
+    }
+
+    outFile.Write(ktxIdentifier, sizeof ktxIdentifier);
+    outFile.WriteUInt(0x04030201);
+    outFile.WriteUInt(0); // type
+    outFile.WriteUInt(1); // type size
+    outFile.WriteUInt(0); // format
+    outFile.WriteUInt(internalFormat);
+    outFile.WriteUInt(baseInternalFormat);
+    outFile.WriteUInt((unsigned)width_);
+    outFile.WriteUInt((unsigned)height_);
+    outFile.WriteUInt(0); // depth
+    outFile.WriteUInt(0); // array elements
+    outFile.WriteUInt(1); // faces
+    outFile.WriteUInt(numCompressedLevels_);
+    outFile.WriteUInt(0); // key/value data size
+
+    for (unsigned i = 0; i < numCompressedLevels_; ++i)
+    {
+        CompressedLevel level = GetCompressedLevel(i);
+        outFile.WriteUInt(level.dataSize_);
+        outFile.Write(level.data_, level.dataSize_);
+
+        static const unsigned char padding[3] = {};
+        if (level.dataSize_ & 3u)
+            outFile.Write(padding, 4 - (level.dataSize_ & 3u));
+    }
+
+    return true;
+}
+
 bool Image::SaveWEBP(const String& fileName, float compression /* = 0.0f */) const
 {
 #ifdef URHO3D_WEBP
@@ -1557,6 +1854,14 @@ Color Image::GetPixelTrilinear(float x, float y, float z) const
 }
 
 SharedPtr<Image> Image::GetNextLevel() const
+{
+    if (nextLevel_)
+        return nextLevel_;
+
+    return GetNextLevel(MIPFILTER_BOX, false);
+}
+
+SharedPtr<Image> Image::GetNextLevel(MipFilter filter, bool sRGB) const
 {
     if (IsCompressed())
     {
@@ -1569,9 +1874,6 @@ SharedPtr<Image> Image::GetNextLevel() const
         return SharedPtr<Image>();
     }
 
-    if (nextLevel_)
-        return nextLevel_;
-
     URHO3D_PROFILE("CalculateImageMipLevel");
 
     int widthOut = width_ / 2;
@@ -1644,84 +1946,10 @@ SharedPtr<Image> Image::GetNextLevel() const
     // 2D case
     else if (depth_ == 1)
     {
-        switch (components_)
+        ProcessImageRows(context_, heightOut, widthOut, [=](int beginRow, int endRow)
         {
-        case 1:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_];
-                unsigned char* out = &pixelDataOut[y * widthOut];
-
-                for (int x = 0; x < widthOut; ++x)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 1] +
-                                              inLower[x * 2] + inLower[x * 2 + 1]) >> 2);
-                }
-            }
-            break;
-
-        case 2:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 2];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 2];
-                unsigned char* out = &pixelDataOut[y * widthOut * 2];
-
-                for (int x = 0; x < widthOut * 2; x += 2)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 2] +
-                                              inLower[x * 2] + inLower[x * 2 + 2]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 3] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 3]) >> 2);
-                }
-            }
-            break;
-
-        case 3:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 3];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 3];
-                unsigned char* out = &pixelDataOut[y * widthOut * 3];
-
-                for (int x = 0; x < widthOut * 3; x += 3)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 3] +
-                                              inLower[x * 2] + inLower[x * 2 + 3]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 4] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 5]) >> 2);
-                }
-            }
-            break;
-
-        case 4:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 4];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 4];
-                unsigned char* out = &pixelDataOut[y * widthOut * 4];
-
-                for (int x = 0; x < widthOut * 4; x += 4)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 4] +
-                                              inLower[x * 2] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 5]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 6] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 6]) >> 2);
-                    out[x + 3] = (unsigned char)(((unsigned)inUpper[x * 2 + 3] + inUpper[x * 2 + 7] +
-                                                  inLower[x * 2 + 3] + inLower[x * 2 + 7]) >> 2);
-                }
-            }
-            break;
-
-        default:
-            assert(false);  // Should never reach here
-            break;
-        }
+            DownsampleImageRows(pixelDataOut, pixelDataIn, width_, height_, components_, filter, sRGB, beginRow, endRow);
+        });
     }
     // 3D case
     else
@@ -1884,45 +2112,10 @@ SharedPtr<Image> Image::ConvertToRGBA() const
 
     const unsigned char* src = data_;
     unsigned char* dest = ret->GetData();
-
-    switch (components_)
+    ProcessImageRows(context_, height_ * depth_, width_, [=](int beginRow, int endRow)
     {
-    case 1:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
-        {
-            unsigned char pixel = *src++;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = 255;
-        }
-        break;
-
-    case 2:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
-        {
-            unsigned char pixel = *src++;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = *src++;
-        }
-        break;
-
-    case 3:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
-        {
-            *dest++ = *src++;
-            *dest++ = *src++;
-            *dest++ = *src++;
-            *dest++ = 255;
-        }
-        break;
-
-    default:
-        assert(false);  // Should never reach nere
-        break;
-    }
+        ConvertImageRowsToRGBA(dest, src, width_, components_, beginRow, endRow);
+    });
 
     return ret;
 }
@@ -1987,7 +2180,7 @@ CompressedLevel Image::GetCompressedLevel(unsigned index) const
     }
     else if (compressedFormat_ < CF_PVRTC_RGB_2BPP)
     {
-        level.blockSize_ = (compressedFormat_ == CF_DXT1 || compressedFormat_ == CF_ETC1) ? 8 : 16;
+        level.blockSize_ = GetCompressedBlockSize(compressedFormat_);
         unsigned i = 0;
         unsigned offset = 0;
 
@@ -2062,6 +2255,101 @@ CompressedLevel Image::GetCompressedLevel(unsigned index) const
     }
 }
 
+SharedPtr<Image> Image::Compress(CompressedFormat format, CompressionQuality quality, bool generateMips) const
+{
+    URHO3D_PROFILE("CompressImage");
+
+    // Blocks per work item when compressing in parallel
+    static const int BLOCKS_PER_WORK_ITEM = 1024;
+
+    if (!IsCompressionSupported(format))
+    {
+        URHO3D_LOGERROR("Unsupported format for image compression");
+        return SharedPtr<Image>();
+    }
+    if (IsCompressed())
+    {
+        URHO3D_LOGERROR("Can not compress an already compressed image");
+        return SharedPtr<Image>();
+    }
+    if (depth_ > 1 || nextSibling_)
+    {
+        URHO3D_LOGERROR("Can not compress 3D, cube map or array image");
+        return SharedPtr<Image>();
+    }
+
+    SharedPtr<Image> rgbaImage = ConvertToRGBA();
+    if (!rgbaImage)
+        return SharedPtr<Image>();
+
+    Vector<SharedPtr<Image> > levels;
+    levels.Push(rgbaImage);
+    while (generateMips && (levels.Back()->GetWidth() > 1 || levels.Back()->GetHeight() > 1))
+    {
+        SharedPtr<Image> nextLevel = levels.Back()->GetNextLevel();
+        if (!nextLevel)
+            return SharedPtr<Image>();
+        levels.Push(nextLevel);
+    }
+
+    const unsigned blockSize = GetCompressedBlockSize(format);
+    unsigned dataSize = 0;
+    for (unsigned i = 0; i < levels.Size(); ++i)
+        dataSize += ((levels[i]->GetWidth() + 3) / 4) * ((levels[i]->GetHeight() + 3) / 4) * blockSize;
+
+    SharedArrayPtr<unsigned char> data(new unsigned char[dataSize]);
+
+    // Split the levels into ranges of block rows for worker threads when possible. The levels are kept alive until completion
+    WorkQueue* queue = GetImageWorkQueue(context_);
+    const bool threaded = queue != nullptr;
+
+    unsigned char* dest = data.Get();
+    for (unsigned i = 0; i < levels.Size(); ++i)
+    {
+        const unsigned char* src = levels[i]->GetData();
+        const int width = levels[i]->GetWidth();
+        const int height = levels[i]->GetHeight();
+        const int blocksWide = (width + 3) / 4;
+        const int blocksHigh = (height + 3) / 4;
+
+        if (threaded)
+        {
+            const int rowsPerItem = Max(BLOCKS_PER_WORK_ITEM / blocksWide, 1);
+            for (int row = 0; row < blocksHigh; row += rowsPerItem)
+            {
+                const int endRow = Min(row + rowsPerItem, blocksHigh);
+                queue->AddWorkItem([=]() { CompressImageRows(dest, src, width, height, row, endRow, format, quality); },
+                    M_MAX_UNSIGNED);
+            }
+        }
+        else
+            CompressImageRows(dest, src, width, height, 0, blocksHigh, format, quality);
+
+        dest += blocksWide * blocksHigh * blockSize;
+    }
+
+    if (threaded)
+        queue->Complete(M_MAX_UNSIGNED);
+
+    SharedPtr<Image> ret(new Image(context_));
+    ret->SetName(GetName());
+    ret->width_ = width_;
+    ret->height_ = height_;
+    ret->depth_ = 1;
+    if (format == CF_BC4)
+        ret->components_ = 1;
+    else if (format == CF_BC5)
+        ret->components_ = 2;
+    else
+        ret->components_ = format == CF_DXT1 && !HasAlphaChannel() ? 3 : 4;
+    ret->numCompressedLevels_ = levels.Size();
+    ret->sRGB_ = sRGB_;
+    ret->compressedFormat_ = format;
+    ret->data_ = data;
+    ret->SetMemoryUse(dataSize);
+    return ret;
+}
+
 Image* Image::GetSubimage(const IntRect& rect) const
 {
     if (!data_)
@@ -40,6 +40,9 @@ enum CompressedFormat
     CF_DXT1,
     CF_DXT3,
     CF_DXT5,
+    CF_BC4,
+    CF_BC5,
+    CF_BC7,
     CF_ETC1,
     CF_PVRTC_RGB_2BPP,
     CF_PVRTC_RGBA_2BPP,
@@ -47,11 +50,28 @@ enum CompressedFormat
     CF_PVRTC_RGBA_4BPP,
 };
 
+/// Block compression quality, trading encoding speed for accuracy.
+enum CompressionQuality
+{
+    COMPRESSION_FAST = 0,
+    COMPRESSION_NORMAL,
+    COMPRESSION_HIGH
+};
+
+/// Filter used for generating mip levels.
+enum MipFilter
+{
+    /// Average of 2x2 pixels.
+    MIPFILTER_BOX = 0,
+    /// Kaiser windowed sinc, sharper than the box filter.
+    MIPFILTER_KAISER
+};
+
 /// Compressed image mip level.
 struct CompressedLevel
 {
-    /// Decompress to RGBA. The destination buffer required is width * height * 4 bytes. Return true if successful.
-    bool Decompress(unsigned char* dest);
+    /// Decompress to RGBA. The destination buffer required is width * height * 4 bytes. When a context is given and called from the main thread, large levels are decompressed in parallel on the work queue. Return true if successful.
+    bool Decompress(unsigned char* dest, Context* context = nullptr);
 
     /// Compressed image data.
     unsigned char* data_{};
@@ -113,7 +133,7 @@ public:
     bool FlipHorizontal();
     /// Flip image vertically. Return true if successful.
     bool FlipVertical();
-    /// Resize image by bilinear resampling. Return true if successful.
+    /// Resize image by bilinear resampling. Rows are processed in parallel on the work queue when called from the main thread. Return true if successful.
     bool Resize(int width, int height);
     /// Clear the image with a color.
     void Clear(const Color& color);
@@ -127,8 +147,10 @@ public:
     bool SaveTGA(const String& fileName) const;
     /// Save in JPG format with specified quality. Return true if successful.
     bool SaveJPG(const String& fileName, int quality) const;
-    /// Save in DDS format. Only uncompressed RGBA images are supported. Return true if successful.
+    /// Save in DDS format. Uncompressed RGBA and DXT/BC compressed images are supported. Return true if successful.
     bool SaveDDS(const String& fileName) const;
+    /// Save in KTX format. Only compressed images are supported. Return true if successful.
+    bool SaveKTX(const String& fileName) const;
     /// Save in WebP format with minimum (fastest) or specified compression. Return true if successful. Fails always if WebP support is not compiled in.
     bool SaveWEBP(const String& fileName, float compression = 0.0f) const;
     /// Whether this texture is detected as a cubemap, only relevant for DDS.
@@ -177,12 +199,16 @@ public:
 
     /// Return next mip level by bilinear filtering. Note that if the image is already 1x1x1, will keep returning an image of that size.
     SharedPtr<Image> GetNextLevel() const;
+    /// Return next mip level calculated with a filter, optionally filtering the color channels in linear space for sRGB content. 1D and 3D images always use the box filter. Rows are processed in parallel on the work queue when called from the main thread.
+    SharedPtr<Image> GetNextLevel(MipFilter filter, bool sRGB) const;
     /// Return the next sibling image of an array or cubemap.
     SharedPtr<Image> GetNextSibling() const { return nextSibling_;  }
     /// Return image converted to 4-component (RGBA) to circumvent modern rendering API's not supporting e.g. the luminance-alpha format.
     SharedPtr<Image> ConvertToRGBA() const;
     /// Return a compressed mip level.
     CompressedLevel GetCompressedLevel(unsigned index) const;
+    /// Return image block compressed to DXT1/3/5, BC4, BC5 or BC7, optionally with a full mip chain, or null if failed. Blocks are encoded in parallel on the work queue when called from the main thread. 3D and array images are not supported.
+    SharedPtr<Image> Compress(CompressedFormat format, CompressionQuality quality = COMPRESSION_NORMAL, bool generateMips = true) const;
     /// Return subimage from the image by the defined rect or null if failed. 3D images are not supported. You must free the subimage yourself.
     Image* GetSubimage(const IntRect& rect) const;
     /// Return an SDL surface from the image, or null if failed. Only RGB images are supported. Specify rect to only return partial image. You must free the surface yourself.
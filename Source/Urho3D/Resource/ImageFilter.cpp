@@ -0,0 +1,501 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/LinearAllocator.h"
+#include "../Math/MathDefs.h"
+#include "../Resource/ImageFilter.h"
+
+#include <cstring>
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Number of taps of the Kaiser mip filter in source pixels.
+static const int KAISER_TAPS = 12;
+/// Width of the Kaiser mip filter in destination pixels.
+static const float KAISER_WIDTH = 3.0f;
+/// Kaiser window shape parameter.
+static const float KAISER_ALPHA = 4.0f;
+/// Size of the linear to sRGB lookup table.
+static const int LINEAR_TO_SRGB_TABLE_SIZE = 4096;
+
+/// Lookup tables for sRGB conversion.
+struct SRGBTables
+{
+    /// Construct and fill the tables.
+    SRGBTables()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            const float value = i / 255.0f;
+            toLinear_[i] = value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < LINEAR_TO_SRGB_TABLE_SIZE; ++i)
+        {
+            const float value = (float)i / (LINEAR_TO_SRGB_TABLE_SIZE - 1);
+            const float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+            toSRGB_[i] = (unsigned char)Clamp((int)(encoded * 255.0f + 0.5f), 0, 255);
+        }
+    }
+
+    /// sRGB encoded byte to linear value.
+    float toLinear_[256];
+    /// Quantized linear value to sRGB encoded byte.
+    unsigned char toSRGB_[LINEAR_TO_SRGB_TABLE_SIZE];
+};
+
+static const SRGBTables& GetSRGBTables()
+{
+    static const SRGBTables tables;
+    return tables;
+}
+
+static float BesselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    const float halfX = x * 0.5f;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= halfX / k;
+        sum += term * term;
+        if (term * term < sum * 1e-8f)
+            break;
+    }
+    return sum;
+}
+
+/// Normalized weights of the Kaiser mip filter.
+struct KaiserWeights
+{
+    /// Construct and calculate the weights.
+    KaiserWeights()
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < KAISER_TAPS; ++i)
+        {
+            // Distance of the source pixel center from the destination pixel center, in destination pixels
+            const float t = (i - (KAISER_TAPS - 1) * 0.5f) * 0.5f;
+            const float sinc = t != 0.0f ? sinf(M_PI * t) / (M_PI * t) : 1.0f;
+            const float window = t / KAISER_WIDTH;
+            const float kaiser = Abs(window) < 1.0f ?
+                BesselI0(KAISER_ALPHA * sqrtf(1.0f - window * window)) / BesselI0(KAISER_ALPHA) : 0.0f;
+            weights_[i] = sinc * kaiser;
+            sum += weights_[i];
+        }
+        for (float& weight : weights_)
+            weight /= sum;
+    }
+
+    /// Weights.
+    float weights_[KAISER_TAPS];
+};
+
+static const KaiserWeights& GetKaiserWeights()
+{
+    static const KaiserWeights weights;
+    return weights;
+}
+
+/// Return whether a channel holds color as opposed to alpha.
+static bool IsColorChannel(unsigned channel, unsigned components)
+{
+    return components == 2 ? channel == 0 : channel < 3;
+}
+
+float SRGBToLinear(unsigned char value)
+{
+    return GetSRGBTables().toLinear_[value];
+}
+
+unsigned char LinearToSRGB(float value)
+{
+    return GetSRGBTables().toSRGB_[(int)(Clamp(value, 0.0f, 1.0f) * (LINEAR_TO_SRGB_TABLE_SIZE - 1) + 0.5f)];
+}
+
+template <unsigned C> static void DownsampleBoxRow(unsigned char* out, const unsigned char* upper, const unsigned char* lower, int widthOut)
+{
+    int x = 0;
+#ifdef URHO3D_SSE
+    const __m128i zero = _mm_setzero_si128();
+    if (C == 4)
+    {
+        // Two destination pixels from four source pixels of each row
+        for (; x + 2 <= widthOut; x += 2)
+        {
+            const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(upper + x * 8));
+            const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lower + x * 8));
+            const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(l, zero));
+            const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(l, zero));
+            const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+            const __m128i result = _mm_packus_epi16(_mm_srli_epi16(sum, 2), zero);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), result);
+        }
+    }
+    else if (C == 1)
+    {
+        // Eight destination pixels from sixteen source pixels of each row
+        const __m128i evenMask = _mm_set1_epi16(0xff);
+        for (; x + 8 <= widthOut; x += 8)
+        {
+            const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(upper + x * 2));
+            const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lower + x * 2));
+            const __m128i sum = _mm_add_epi16(
+                _mm_add_epi16(_mm_and_si128(u, evenMask), _mm_srli_epi16(u, 8)),
+                _mm_add_epi16(_mm_and_si128(l, evenMask), _mm_srli_epi16(l, 8)));
+            const __m128i result = _mm_packus_epi16(_mm_srli_epi16(sum, 2), zero);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), result);
+        }
+    }
+#endif
+    for (; x < widthOut; ++x)
+    {
+        for (unsigned c = 0; c < C; ++c)
+        {
+            out[x * C + c] = (unsigned char)(((unsigned)upper[x * 2 * C + c] + upper[(x * 2 + 1) * C + c] +
+                lower[x * 2 * C + c] + lower[(x * 2 + 1) * C + c]) >> 2);
+        }
+    }
+}
+
+template <unsigned C> static void DownsampleBoxRowSRGB(unsigned char* out, const unsigned char* upper, const unsigned char* lower, int widthOut)
+{
+    const float* toLinear = GetSRGBTables().toLinear_;
+    for (int x = 0; x < widthOut; ++x)
+    {
+        for (unsigned c = 0; c < C; ++c)
+        {
+            const unsigned a = upper[x * 2 * C + c];
+            const unsigned b = upper[(x * 2 + 1) * C + c];
+            const unsigned d = lower[x * 2 * C + c];
+            const unsigned e = lower[(x * 2 + 1) * C + c];
+            if (IsColorChannel(c, C))
+                out[x * C + c] = LinearToSRGB((toLinear[a] + toLinear[b] + toLinear[d] + toLinear[e]) * 0.25f);
+            else
+                out[x * C + c] = (unsigned char)((a + b + d + e) >> 2);
+        }
+    }
+}
+
+template <unsigned C> static void DownsampleBoxRows(unsigned char* dest, const unsigned char* src, int width, int height, bool sRGB,
+    int beginRow, int endRow)
+{
+    const int widthOut = Max(width / 2, 1);
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        const unsigned char* upper = src + (y * 2) * width * C;
+        const unsigned char* lower = src + (y * 2 + 1) * width * C;
+        unsigned char* out = dest + y * widthOut * C;
+        if (sRGB)
+            DownsampleBoxRowSRGB<C>(out, upper, lower, widthOut);
+        else
+            DownsampleBoxRow<C>(out, upper, lower, widthOut);
+    }
+}
+
+static void DownsampleKaiserRows(unsigned char* dest, const unsigned char* src, int width, int height, unsigned components,
+    bool sRGB, int beginRow, int endRow)
+{
+    const float* weights = GetKaiserWeights().weights_;
+    const float* toLinear = GetSRGBTables().toLinear_;
+    const int widthOut = Max(width / 2, 1);
+    const int rowSize = widthOut * components;
+    const int firstTap = -(KAISER_TAPS / 2 - 1);
+
+    // Filter horizontally the source rows needed by the destination rows into a float buffer, then vertically from it
+    const int firstRow = Max(beginRow * 2 + firstTap, 0);
+    const int lastRow = Min((endRow - 1) * 2 + firstTap + KAISER_TAPS - 1, height - 1);
+
+    LinearAllocatorScope scope(GetScratchAllocator());
+    LinearAllocator& allocator = scope.GetAllocator();
+    auto* rows = allocator.AllocateArray<float>((unsigned)((lastRow - firstRow + 1) * rowSize));
+    auto* line = allocator.AllocateArray<float>((unsigned)(width * components));
+    auto* sum = allocator.AllocateArray<float>((unsigned)rowSize);
+
+    // Byte to linear value conversion of each channel
+    const float* channelTables[4];
+    float unorm[256];
+    for (int i = 0; i < 256; ++i)
+        unorm[i] = i * (1.0f / 255.0f);
+    for (unsigned c = 0; c < components; ++c)
+        channelTables[c] = sRGB && IsColorChannel(c, components) ? toLinear : unorm;
+
+    for (int y = firstRow; y <= lastRow; ++y)
+    {
+        const unsigned char* in = src + y * width * components;
+        for (int x = 0; x < width; ++x)
+        {
+            for (unsigned c = 0; c < components; ++c)
+                line[x * components + c] = channelTables[c][in[x * components + c]];
+        }
+
+        float* out = rows + (y - firstRow) * rowSize;
+        for (int x = 0; x < widthOut; ++x)
+        {
+            const int first = x * 2 + firstTap;
+            float value[4] = {};
+            if (first >= 0 && first + KAISER_TAPS <= width)
+            {
+                const float* taps = line + first * components;
+                for (int i = 0; i < KAISER_TAPS; ++i)
+                {
+                    for (unsigned c = 0; c < components; ++c)
+                        value[c] += weights[i] * taps[i * components + c];
+                }
+            }
+            else
+            {
+                for (int i = 0; i < KAISER_TAPS; ++i)
+                {
+                    const float* tap = line + Clamp(first + i, 0, width - 1) * components;
+                    for (unsigned c = 0; c < components; ++c)
+                        value[c] += weights[i] * tap[c];
+                }
+            }
+            for (unsigned c = 0; c < components; ++c)
+                out[x * components + c] = value[c];
+        }
+    }
+
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        memset(sum, 0, rowSize * sizeof(float));
+        for (int i = 0; i < KAISER_TAPS; ++i)
+        {
+            const float* row = rows + (Clamp(y * 2 + firstTap + i, 0, height - 1) - firstRow) * rowSize;
+            const float weight = weights[i];
+            for (int j = 0; j < rowSize; ++j)
+                sum[j] += weight * row[j];
+        }
+
+        unsigned char* out = dest + y * rowSize;
+        for (int x = 0; x < widthOut; ++x)
+        {
+            for (unsigned c = 0; c < components; ++c)
+            {
+                const float value = sum[x * components + c];
+                if (channelTables[c] == toLinear)
+                    out[x * components + c] = LinearToSRGB(value);
+                else
+                    out[x * components + c] = (unsigned char)Clamp((int)(value * 255.0f + 0.5f), 0, 255);
+            }
+        }
+    }
+}
+
+void DownsampleImageRows(unsigned char* dest, const unsigned char* src, int width, int height, unsigned components,
+    MipFilter filter, bool sRGB, int beginRow, int endRow)
+{
+    if (filter == MIPFILTER_KAISER)
+    {
+        DownsampleKaiserRows(dest, src, width, height, components, sRGB, beginRow, endRow);
+        return;
+    }
+
+    switch (components)
+    {
+    case 1:
+        DownsampleBoxRows<1>(dest, src, width, height, sRGB, beginRow, endRow);
+        break;
+
+    case 2:
+        DownsampleBoxRows<2>(dest, src, width, height, sRGB, beginRow, endRow);
+        break;
+
+    case 3:
+        DownsampleBoxRows<3>(dest, src, width, height, sRGB, beginRow, endRow);
+        break;
+
+    case 4:
+        DownsampleBoxRows<4>(dest, src, width, height, sRGB, beginRow, endRow);
+        break;
+
+    default:
+        assert(false);  // Should never reach here
+        break;
+    }
+}
+
+/// Return source position of a destination pixel for bilinear resampling as integer coordinate and 8-bit fraction.
+static void GetResampleCoordinate(int x, int destSize, int size, int& coord, unsigned& fraction)
+{
+    // Matches Image::GetPixelBilinear() at normalized coordinate x / (destSize - 1)
+    const float normalized = destSize > 1 ? (float)x / (float)(destSize - 1) : 0.0f;
+    const float pos = Clamp(normalized * size - 0.5f, 0.0f, (float)(size - 1));
+    coord = (int)pos;
+    fraction = (unsigned)((pos - coord) * 256.0f + 0.5f);
+}
+
+template <unsigned C> static void ResizeRows(unsigned char* dest, int destWidth, int destHeight, const unsigned char* src, int width,
+    int height, int beginRow, int endRow)
+{
+    // Source columns and fractions are the same for every row
+    LinearAllocatorScope scope(GetScratchAllocator());
+    auto* columns = scope.GetAllocator().AllocateArray<int>((unsigned)destWidth * 2);
+    auto* fractions = scope.GetAllocator().AllocateArray<unsigned>((unsigned)destWidth);
+    for (int x = 0; x < destWidth; ++x)
+    {
+        GetResampleCoordinate(x, destWidth, width, columns[x * 2], fractions[x]);
+        columns[x * 2 + 1] = Min(columns[x * 2] + 1, width - 1);
+    }
+
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        int y0;
+        unsigned fy;
+        GetResampleCoordinate(y, destHeight, height, y0, fy);
+        const unsigned char* top = src + y0 * width * C;
+        const unsigned char* bottom = src + Min(y0 + 1, height - 1) * width * C;
+        unsigned char* out = dest + y * destWidth * C;
+
+#ifdef URHO3D_SSE
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(128);
+        const __m128i weightsY = _mm_unpacklo_epi64(_mm_set1_epi16((short)(256 - fy)), _mm_set1_epi16((short)fy));
+#endif
+
+        for (int x = 0; x < destWidth; ++x)
+        {
+            const int x0 = columns[x * 2];
+            const int x1 = columns[x * 2 + 1];
+            const unsigned fx = fractions[x];
+
+#ifdef URHO3D_SSE
+            if (C == 4)
+            {
+                // Interpolate the four channels of both source pixels at once in 16-bit lanes
+                int p[4];
+                memcpy(&p[0], top + x0 * 4, 4);
+                memcpy(&p[1], top + x1 * 4, 4);
+                memcpy(&p[2], bottom + x0 * 4, 4);
+                memcpy(&p[3], bottom + x1 * 4, 4);
+                const __m128i weightsX = _mm_unpacklo_epi64(_mm_set1_epi16((short)(256 - fx)), _mm_set1_epi16((short)fx));
+                const __m128i t = _mm_mullo_epi16(_mm_unpacklo_epi8(
+                    _mm_unpacklo_epi32(_mm_cvtsi32_si128(p[0]), _mm_cvtsi32_si128(p[1])), zero), weightsX);
+                const __m128i b = _mm_mullo_epi16(_mm_unpacklo_epi8(
+                    _mm_unpacklo_epi32(_mm_cvtsi32_si128(p[2]), _mm_cvtsi32_si128(p[3])), zero), weightsX);
+                const __m128i rowT = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, _mm_srli_si128(t, 8)), round), 8);
+                const __m128i rowB = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(b, _mm_srli_si128(b, 8)), round), 8);
+                const __m128i v = _mm_mullo_epi16(_mm_unpacklo_epi64(rowT, rowB), weightsY);
+                const __m128i result = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(v, _mm_srli_si128(v, 8)), round), 8);
+                const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(result, zero));
+                memcpy(out + x * 4, &packed, 4);
+                continue;
+            }
+#endif
+            for (unsigned c = 0; c < C; ++c)
+            {
+                const unsigned t = (top[x0 * C + c] * (256 - fx) + top[x1 * C + c] * fx + 128) >> 8;
+                const unsigned b = (bottom[x0 * C + c] * (256 - fx) + bottom[x1 * C + c] * fx + 128) >> 8;
+                out[x * C + c] = (unsigned char)((t * (256 - fy) + b * fy + 128) >> 8);
+            }
+        }
+    }
+}
+
+void ResizeImageRows(unsigned char* dest, int destWidth, int destHeight, const unsigned char* src, int width, int height,
+    unsigned components, int beginRow, int endRow)
+{
+    switch (components)
+    {
+    case 1:
+        ResizeRows<1>(dest, destWidth, destHeight, src, width, height, beginRow, endRow);
+        break;
+
+    case 2:
+        ResizeRows<2>(dest, destWidth, destHeight, src, width, height, beginRow, endRow);
+        break;
+
+    case 3:
+        ResizeRows<3>(dest, destWidth, destHeight, src, width, height, beginRow, endRow);
+        break;
+
+    case 4:
+        ResizeRows<4>(dest, destWidth, destHeight, src, width, height, beginRow, endRow);
+        break;
+
+    default:
+        assert(false);  // Should never reach here
+        break;
+    }
+}
+
+void ConvertImageRowsToRGBA(unsigned char* dest, const unsigned char* src, int width, unsigned components, int beginRow, int endRow)
+{
+    const unsigned count = (unsigned)((endRow - beginRow) * width);
+    src += beginRow * width * components;
+    dest += beginRow * width * 4;
+
+    switch (components)
+    {
+    case 1:
+        for (unsigned i = 0; i < count; ++i)
+        {
+            const unsigned char pixel = src[i];
+            dest[i * 4] = pixel;
+            dest[i * 4 + 1] = pixel;
+            dest[i * 4 + 2] = pixel;
+            dest[i * 4 + 3] = 255;
+        }
+        break;
+
+    case 2:
+        for (unsigned i = 0; i < count; ++i)
+        {
+            const unsigned char pixel = src[i * 2];
+            dest[i * 4] = pixel;
+            dest[i * 4 + 1] = pixel;
+            dest[i * 4 + 2] = pixel;
+            dest[i * 4 + 3] = src[i * 2 + 1];
+        }
+        break;
+
+    case 3:
+        for (unsigned i = 0; i < count; ++i)
+        {
+            dest[i * 4] = src[i * 3];
+            dest[i * 4 + 1] = src[i * 3 + 1];
+            dest[i * 4 + 2] = src[i * 3 + 2];
+            dest[i * 4 + 3] = 255;
+        }
+        break;
+
+    case 4:
+        memcpy(dest, src, count * 4);
+        break;
+
+    default:
+        assert(false);  // Should never reach here
+        break;
+    }
+}
+
+}
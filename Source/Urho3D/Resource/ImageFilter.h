@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Resource/Image.h"
+
+namespace Urho3D
+{
+
+/// Convert an 8-bit sRGB encoded value to linear 0-1.
+URHO3D_API float SRGBToLinear(unsigned char value);
+/// Convert a linear 0-1 value to 8-bit sRGB encoding.
+URHO3D_API unsigned char LinearToSRGB(float value);
+/// Downsample a range of rows of a 2D image to half size for the next mip level. Width and height are of the source image and must be at least 2. When sRGB is true the color channels are filtered in linear space, alpha channels always are.
+URHO3D_API void DownsampleImageRows(unsigned char* dest, const unsigned char* src, int width, int height, unsigned components,
+    MipFilter filter, bool sRGB, int beginRow, int endRow);
+/// Resize a range of rows of a 2D image by bilinear resampling.
+URHO3D_API void ResizeImageRows(unsigned char* dest, int destWidth, int destHeight, const unsigned char* src, int width, int height,
+    unsigned components, int beginRow, int endRow);
+/// Convert a range of rows of a 1-3 component image to RGBA. Grayscale is replicated to the color channels and missing alpha is opaque.
+URHO3D_API void ConvertImageRowsToRGBA(unsigned char* dest, const unsigned char* src, int width, unsigned components, int beginRow, int endRow);
+
+}
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/MemoryStats.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/FileSystem.h"
@@ -562,6 +563,8 @@ Resource* ResourceCache::GetExistingResource(StringHash type, const String& name
 
 Resource* ResourceCache::GetResource(StringHash type, const String& name, bool sendEventOnFailure)
 {
+    URHO3D_MEMORY_TAG(MEMTAG_RESOURCE);
+
     String sanitatedName = SanitateResourceName(name);
 
     if (!Thread::IsMainThread())
@@ -658,6 +661,8 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name,
 
 SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String& name, bool sendEventOnFailure)
 {
+    URHO3D_MEMORY_TAG(MEMTAG_RESOURCE);
+
     String sanitatedName = SanitateResourceName(name);
 
     // If empty name, return null pointer immediately
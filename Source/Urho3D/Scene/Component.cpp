@@ -55,6 +55,7 @@ Component::Component(Context* context) :
     Animatable(context),
     node_(nullptr),
     id_(0),
+    sceneTypeIndex_(M_MAX_UNSIGNED),
     networkUpdate_(false),
     enabled_(true)
 {
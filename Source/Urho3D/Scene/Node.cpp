@@ -1084,8 +1084,10 @@ void Node::ReorderComponent(Component* component, unsigned index)
         {
             // Need shared ptr to insert. Also, prevent destruction when removing first
             SharedPtr<Component> componentShared(component);
+            componentTypes_.Erase((unsigned)(i - components_.Begin()));
             components_.Erase(i);
             components_.Insert(index, componentShared);
+            componentTypes_.Insert(index, component->GetType());
             return;
         }
     }
@@ -1343,10 +1345,10 @@ void Node::GetComponents(PODVector<Component*>& dest, StringHash type, bool recu
 
     if (!recursive)
     {
-        for (Vector<SharedPtr<Component> >::ConstIterator i = components_.Begin(); i != components_.End(); ++i)
+        for (unsigned i = 0; i < componentTypes_.Size(); ++i)
         {
-            if ((*i)->GetType() == type)
-                dest.Push(*i);
+            if (componentTypes_[i] == type)
+                dest.Push(components_[i]);
         }
     }
     else
@@ -1355,12 +1357,7 @@ void Node::GetComponents(PODVector<Component*>& dest, StringHash type, bool recu
 
 bool Node::HasComponent(StringHash type) const
 {
-    for (Vector<SharedPtr<Component> >::ConstIterator i = components_.Begin(); i != components_.End(); ++i)
-    {
-        if ((*i)->GetType() == type)
-            return true;
-    }
-    return false;
+    return componentTypes_.Contains(type);
 }
 
 bool Node::IsReplicated() const
@@ -1393,10 +1390,10 @@ const Variant& Node::GetVar(StringHash key) const
 
 Component* Node::GetComponent(StringHash type, bool recursive) const
 {
-    for (Vector<SharedPtr<Component> >::ConstIterator i = components_.Begin(); i != components_.End(); ++i)
+    for (unsigned i = 0; i < componentTypes_.Size(); ++i)
     {
-        if ((*i)->GetType() == type)
-            return *i;
+        if (componentTypes_[i] == type)
+            return components_[i];
     }
 
     if (recursive)
@@ -1820,6 +1817,7 @@ void Node::AddComponent(Component* component, unsigned id, CreateMode mode)
         return;
 
     components_.Push(SharedPtr<Component>(component));
+    componentTypes_.Push(component->GetType());
 
     if (component->GetNode())
         URHO3D_LOGWARNING("Component " + component->GetTypeName() + " already belongs to a node!");
@@ -2150,10 +2148,10 @@ void Node::GetChildrenWithComponentRecursive(PODVector<Node*>& dest, StringHash
 
 void Node::GetComponentsRecursive(PODVector<Component*>& dest, StringHash type) const
 {
-    for (Vector<SharedPtr<Component> >::ConstIterator i = components_.Begin(); i != components_.End(); ++i)
+    for (unsigned i = 0; i < componentTypes_.Size(); ++i)
     {
-        if ((*i)->GetType() == type)
-            dest.Push(*i);
+        if (componentTypes_[i] == type)
+            dest.Push(components_[i]);
     }
     for (Vector<SharedPtr<Node> >::ConstIterator i = children_.Begin(); i != children_.End(); ++i)
         (*i)->GetComponentsRecursive(dest, type);
@@ -2248,6 +2246,7 @@ void Node::RemoveComponent(Vector<SharedPtr<Component> >::Iterator i)
     if (scene_)
         scene_->ComponentRemoved(*i);
     (*i)->SetNode(nullptr);
+    componentTypes_.Erase((unsigned)(i - components_.Begin()));
     components_.Erase(i);
 }
 
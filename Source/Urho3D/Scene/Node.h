@@ -691,6 +691,8 @@ private:
     mutable Quaternion worldRotation_;
     /// Components.
     Vector<SharedPtr<Component> > components_;
+    /// Types of the components in the same order, so that lookups by type scan a contiguous array without virtual calls. Nodes have few components, so a linear scan beats a hashed lookup.
+    PODVector<StringHash> componentTypes_;
     /// Child scene nodes.
     Vector<SharedPtr<Node> > children_;
     /// Node listeners.
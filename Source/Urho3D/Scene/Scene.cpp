@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/MemoryStats.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/File.h"
@@ -87,10 +88,10 @@ Scene::~Scene()
     RemoveAllChildren();
 
     // Remove scene reference and owner from all nodes that still exist
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
-        i->second_->ResetScene();
-    for (HashMap<unsigned, Node*>::Iterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
-        i->second_->ResetScene();
+    for (Node* node : replicatedNodes_.GetValues())
+        node->ResetScene();
+    for (Node* node : localNodes_.GetValues())
+        node->ResetScene();
 }
 
 void Scene::RegisterObject(Context* context)
@@ -210,8 +211,8 @@ void Scene::AddReplicationState(NodeReplicationState* state)
     Node::AddReplicationState(state);
 
     // This is the first update for a new connection. Mark all replicated nodes dirty
-    for (HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
-        state->sceneState_->dirtyNodes_.Insert(i->first_);
+    for (unsigned id : replicatedNodes_.GetIDs())
+        state->sceneState_->dirtyNodes_.Insert(id);
 }
 
 bool Scene::LoadXML(Deserializer& source)
@@ -638,6 +639,8 @@ void Scene::Clear(bool clearReplicated, bool clearLocal)
     {
         localNodeID_ = FIRST_LOCAL_ID;
         localComponentID_ = FIRST_LOCAL_ID;
+        localNodes_.ClearRecycledIDs();
+        localComponents_.ClearRecycledIDs();
     }
 }
 
@@ -705,16 +708,7 @@ void Scene::UnregisterAllVars()
 
 Node* Scene::GetNode(unsigned id) const
 {
-    if (IsReplicatedID(id))
-    {
-        HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Find(id);
-        return i != replicatedNodes_.End() ? i->second_ : nullptr;
-    }
-    else
-    {
-        HashMap<unsigned, Node*>::ConstIterator i = localNodes_.Find(id);
-        return i != localNodes_.End() ? i->second_ : nullptr;
-    }
+    return IsReplicatedID(id) ? replicatedNodes_.Get(id) : localNodes_.Get(id);
 }
 
 bool Scene::GetNodesWithTag(PODVector<Node*>& dest, const String& tag) const
@@ -730,18 +724,46 @@ bool Scene::GetNodesWithTag(PODVector<Node*>& dest, const String& tag) const
         return false;
 }
 
+const PODVector<Component*>& Scene::GetComponentsByType(StringHash type) const
+{
+    static const PODVector<Component*> noComponents;
+
+    HashMap<StringHash, PODVector<Component*> >::ConstIterator i = componentsByType_.Find(type);
+    return i != componentsByType_.End() ? i->second_ : noComponents;
+}
+
 Component* Scene::GetComponent(unsigned id) const
 {
-    if (IsReplicatedID(id))
-    {
-        HashMap<unsigned, Component*>::ConstIterator i = replicatedComponents_.Find(id);
-        return i != replicatedComponents_.End() ? i->second_ : nullptr;
-    }
-    else
-    {
-        HashMap<unsigned, Component*>::ConstIterator i = localComponents_.Find(id);
-        return i != localComponents_.End() ? i->second_ : nullptr;
-    }
+    return IsReplicatedID(id) ? replicatedComponents_.Get(id) : localComponents_.Get(id);
+}
+
+Node* Scene::GetNode(const NodeHandle& handle) const
+{
+    return IsReplicatedID(handle.id_) ? replicatedNodes_.Get(handle) : localNodes_.Get(handle);
+}
+
+Component* Scene::GetComponent(const ComponentHandle& handle) const
+{
+    return IsReplicatedID(handle.id_) ? replicatedComponents_.Get(handle) : localComponents_.Get(handle);
+}
+
+NodeHandle Scene::GetNodeHandle(Node* node) const
+{
+    if (!node || node->GetScene() != this)
+        return NodeHandle();
+
+    const unsigned id = node->GetID();
+    return GetNode(id) == node ? (IsReplicatedID(id) ? replicatedNodes_.GetHandle(id) : localNodes_.GetHandle(id)) : NodeHandle();
+}
+
+ComponentHandle Scene::GetComponentHandle(Component* component) const
+{
+    if (!component)
+        return ComponentHandle();
+
+    const unsigned id = component->GetID();
+    return GetComponent(id) == component ?
+        (IsReplicatedID(id) ? replicatedComponents_.GetHandle(id) : localComponents_.GetHandle(id)) : ComponentHandle();
 }
 
 float Scene::GetAsyncProgress() const
@@ -759,6 +781,8 @@ const String& Scene::GetVarName(StringHash hash) const
 
 void Scene::Update(float timeStep)
 {
+    URHO3D_MEMORY_TAG(MEMTAG_SCENE);
+
     if (asyncLoading_)
     {
         UpdateAsyncLoading();
@@ -857,6 +881,10 @@ unsigned Scene::GetFreeNodeID(CreateMode mode)
     }
     else
     {
+        unsigned recycled = localNodes_.TakeRecycledID();
+        if (recycled)
+            return recycled;
+
         for (;;)
         {
             unsigned ret = localNodeID_;
@@ -889,6 +917,10 @@ unsigned Scene::GetFreeComponentID(CreateMode mode)
     }
     else
     {
+        unsigned recycled = localComponents_.TakeRecycledID();
+        if (recycled)
+            return recycled;
+
         for (;;)
         {
             unsigned ret = localComponentID_;
@@ -926,27 +958,27 @@ void Scene::NodeAdded(Node* node)
     // If node with same ID exists, remove the scene reference from it and overwrite with the new node
     if (IsReplicatedID(id))
     {
-        HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Find(id);
-        if (i != replicatedNodes_.End() && i->second_ != node)
+        Node* existing = replicatedNodes_.Get(id);
+        if (existing && existing != node)
         {
             URHO3D_LOGWARNING("Overwriting node with ID " + String(id));
-            NodeRemoved(i->second_);
+            NodeRemoved(existing);
         }
 
-        replicatedNodes_[id] = node;
+        replicatedNodes_.Insert(id, node);
 
         MarkNetworkUpdate(node);
         MarkReplicationDirty(node);
     }
     else
     {
-        HashMap<unsigned, Node*>::Iterator i = localNodes_.Find(id);
-        if (i != localNodes_.End() && i->second_ != node)
+        Node* existing = localNodes_.Get(id);
+        if (existing && existing != node)
         {
             URHO3D_LOGWARNING("Overwriting node with ID " + String(id));
-            NodeRemoved(i->second_);
+            NodeRemoved(existing);
         }
-        localNodes_[id] = node;
+        localNodes_.Insert(id, node);
     }
 
     // Cache tag if already tagged.
@@ -1025,25 +1057,32 @@ void Scene::ComponentAdded(Component* component)
 
     if (IsReplicatedID(id))
     {
-        HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Find(id);
-        if (i != replicatedComponents_.End() && i->second_ != component)
+        Component* existing = replicatedComponents_.Get(id);
+        if (existing && existing != component)
         {
             URHO3D_LOGWARNING("Overwriting component with ID " + String(id));
-            ComponentRemoved(i->second_);
+            ComponentRemoved(existing);
         }
 
-        replicatedComponents_[id] = component;
+        replicatedComponents_.Insert(id, component);
     }
     else
     {
-        HashMap<unsigned, Component*>::Iterator i = localComponents_.Find(id);
-        if (i != localComponents_.End() && i->second_ != component)
+        Component* existing = localComponents_.Get(id);
+        if (existing && existing != component)
         {
             URHO3D_LOGWARNING("Overwriting component with ID " + String(id));
-            ComponentRemoved(i->second_);
+            ComponentRemoved(existing);
         }
 
-        localComponents_[id] = component;
+        localComponents_.Insert(id, component);
+    }
+
+    if (component->sceneTypeIndex_ == M_MAX_UNSIGNED)
+    {
+        PODVector<Component*>& components = componentsByType_[component->GetType()];
+        component->sceneTypeIndex_ = components.Size();
+        components.Push(component);
     }
 
     component->OnSceneSet(this);
@@ -1060,6 +1099,18 @@ void Scene::ComponentRemoved(Component* component)
     else
         localComponents_.Erase(id);
 
+    // Swap the last component of the type into the vacated slot
+    unsigned index = component->sceneTypeIndex_;
+    if (index != M_MAX_UNSIGNED)
+    {
+        PODVector<Component*>& components = componentsByType_[component->GetType()];
+        Component* last = components.Back();
+        components[index] = last;
+        last->sceneTypeIndex_ = index;
+        components.Pop();
+        component->sceneTypeIndex_ = M_MAX_UNSIGNED;
+    }
+
     component->SetID(0);
     component->OnSceneSet(nullptr);
 }
@@ -1112,11 +1163,11 @@ void Scene::CleanupConnection(Connection* connection)
 {
     Node::CleanupConnection(connection);
 
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
-        i->second_->CleanupConnection(connection);
+    for (Node* node : replicatedNodes_.GetValues())
+        node->CleanupConnection(connection);
 
-    for (HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Begin(); i != replicatedComponents_.End(); ++i)
-        i->second_->CleanupConnection(connection);
+    for (Component* component : replicatedComponents_.GetValues())
+        component->CleanupConnection(connection);
 }
 
 void Scene::MarkNetworkUpdate(Node* node)
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/HashSet.h"
+#include "../Container/SlotMap.h"
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
@@ -40,6 +41,76 @@ static const unsigned LAST_REPLICATED_ID = 0xffffff;
 static const unsigned FIRST_LOCAL_ID = 0x01000000;
 static const unsigned LAST_LOCAL_ID = 0xffffffff;
 
+/// Handle to a scene node. Resolves to null once the node has left the scene, even if its ID has been reused. Only valid with the scene that issued it.
+using NodeHandle = SlotHandle<Node>;
+/// Handle to a component. Resolves to null once the component has left the scene, even if its ID has been reused. Only valid with the scene that issued it.
+using ComponentHandle = SlotHandle<Component>;
+
+/// Read-only view of the scene's components of one type, cast to their class per element.
+template <class T> class ComponentTypeView
+{
+public:
+    /// Iterator to the cast components.
+    class ConstIterator
+    {
+    public:
+        /// Construct.
+        explicit ConstIterator(Component* const* ptr) :
+            ptr_(ptr)
+        {
+        }
+
+        /// Return the component.
+        T* operator *() const { return static_cast<T*>(*ptr_); }
+
+        /// Preincrement.
+        ConstIterator& operator ++()
+        {
+            ++ptr_;
+            return *this;
+        }
+
+        /// Test for equality with another iterator.
+        bool operator ==(const ConstIterator& rhs) const { return ptr_ == rhs.ptr_; }
+
+        /// Test for inequality with another iterator.
+        bool operator !=(const ConstIterator& rhs) const { return ptr_ != rhs.ptr_; }
+
+    private:
+        /// Pointer to the component.
+        Component* const* ptr_;
+    };
+
+    /// Construct from the components of the type.
+    explicit ComponentTypeView(const PODVector<Component*>& components) :
+        components_(components)
+    {
+    }
+
+    /// Return component at index.
+    T* operator [](unsigned index) const { return static_cast<T*>(components_[index]); }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return ConstIterator(components_.Buffer()); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return ConstIterator(components_.Buffer() + components_.Size()); }
+
+    /// Return number of components.
+    unsigned Size() const { return components_.Size(); }
+
+    /// Return whether has no components.
+    bool Empty() const { return components_.Empty(); }
+
+private:
+    /// Components of the type.
+    const PODVector<Component*>& components_;
+};
+
+template <class T> typename ComponentTypeView<T>::ConstIterator begin(const ComponentTypeView<T>& v) { return v.Begin(); }
+
+template <class T> typename ComponentTypeView<T>::ConstIterator end(const ComponentTypeView<T>& v) { return v.End(); }
+
 /// Asynchronous scene loading mode.
 enum LoadMode
 {
@@ -169,8 +240,20 @@ public:
     Node* GetNode(unsigned id) const;
     /// Return component from the whole scene by ID, or null if not found.
     Component* GetComponent(unsigned id) const;
+    /// Return node by handle, or null if it has left the scene.
+    Node* GetNode(const NodeHandle& handle) const;
+    /// Return component by handle, or null if it has left the scene.
+    Component* GetComponent(const ComponentHandle& handle) const;
+    /// Return handle to a node in the scene, or a null handle if it is not in the scene. Cheaper to hold and check than a WeakPtr.
+    NodeHandle GetNodeHandle(Node* node) const;
+    /// Return handle to a component in the scene, or a null handle if it is not in the scene.
+    ComponentHandle GetComponentHandle(Component* component) const;
     /// Get nodes with specific tag from the whole scene, return false if empty.
     bool GetNodesWithTag(PODVector<Node*>& dest, const String& tag)  const;
+    /// Return all components of a type in the scene as a contiguous array, without walking the node tree. Only components of exactly that type are included. The order is arbitrary and the array changes when components of the type are added or removed.
+    const PODVector<Component*>& GetComponentsByType(StringHash type) const;
+    /// Template version of returning all components of a type in the scene, as a view that casts each component to the class.
+    template <class T> ComponentTypeView<T> GetComponentsByType() const;
 
     /// Return whether updates are enabled.
     bool IsUpdateEnabled() const { return updateEnabled_; }
@@ -223,9 +306,9 @@ public:
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
 
-    /// Get free node ID, either non-local or local.
+    /// Get free node ID, either non-local or local. Local IDs of removed nodes are reused first, oldest first.
     unsigned GetFreeNodeID(CreateMode mode);
-    /// Get free component ID, either non-local or local.
+    /// Get free component ID, either non-local or local. Local IDs of removed components are reused first, oldest first.
     unsigned GetFreeComponentID(CreateMode mode);
     /// Return whether the specified id is a replicated id.
     static bool IsReplicatedID(unsigned id) { return id < FIRST_LOCAL_ID; }
@@ -278,16 +361,18 @@ private:
     /// Preload resources from a JSON scene or object prefab file.
     void PreloadResourcesJSON(const JSONValue& value);
 
-    /// Replicated scene nodes by ID.
-    HashMap<unsigned, Node*> replicatedNodes_;
+    /// Replicated scene nodes by ID. Replicated IDs are not recycled, so that clients never see an ID reused soon after removal.
+    SlotMap<Node> replicatedNodes_{FIRST_REPLICATED_ID, LAST_REPLICATED_ID, false};
     /// Local scene nodes by ID.
-    HashMap<unsigned, Node*> localNodes_;
+    SlotMap<Node> localNodes_{FIRST_LOCAL_ID, LAST_LOCAL_ID, true};
     /// Replicated components by ID.
-    HashMap<unsigned, Component*> replicatedComponents_;
+    SlotMap<Component> replicatedComponents_{FIRST_REPLICATED_ID, LAST_REPLICATED_ID, false};
     /// Local components by ID.
-    HashMap<unsigned, Component*> localComponents_;
+    SlotMap<Component> localComponents_{FIRST_LOCAL_ID, LAST_LOCAL_ID, true};
     /// Cached tagged nodes by tag.
     HashMap<StringHash, PODVector<Node*> > taggedNodes_;
+    /// Components by exact type.
+    HashMap<StringHash, PODVector<Component*> > componentsByType_;
     /// Asynchronous loading progress.
     AsyncProgress asyncProgress_;
     /// Node and component ID resolver for asynchronous loading.
@@ -336,6 +421,11 @@ private:
     bool threadedUpdate_;
 };
 
+template <class T> ComponentTypeView<T> Scene::GetComponentsByType() const
+{
+    return ComponentTypeView<T>(GetComponentsByType(T::GetTypeStatic()));
+}
+
 /// Register Scene library objects.
 void URHO3D_API RegisterSceneLibrary(Context* context);
 
@@ -21,6 +21,7 @@
 //
 
 #include "../Core/CoreEvents.h"
+#include "../Core/FrameStats.h"
 #include "../Core/Profiler.h"
 #include "../Engine/Engine.h"
 #include "../Graphics/Graphics.h"
@@ -235,6 +236,26 @@ void DebugHud::RenderUi(VariantMap& eventData)
             for (HashMap<String, String>::ConstIterator i = appStats_.Begin(); i != appStats_.End(); ++i)
                 ui::Text("%s %s", i->first_.CString(), i->second_.CString());
         }
+
+        if (mode_ & DEBUGHUD_SHOW_FRAMESTATS)
+        {
+            auto* frameStats = GetSubsystem<FrameStats>();
+            if (frameStats && (frameStats_.Empty() || frameStatsTimer_.GetMSec(false) > FPS_UPDATE_INTERVAL_MS))
+            {
+                frameStats->GetSummaries(frameStats_);
+                frameStatsTimer_.Reset();
+            }
+
+            if (!(mode_ & DEBUGHUD_SHOW_STATS))
+                ui::SetCursorPos({posStats_.x_, posStats_.y_});
+            ui::Text("%-20s %9s %9s %9s %9s %9s %9s", "", "min", "avg", "p50", "p95", "p99", "max");
+            for (unsigned i = 0; i < frameStats_.Size(); ++i)
+            {
+                const FrameMetricSummary& summary = frameStats_[i];
+                ui::Text("%-20s %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f%s", summary.name_.CString(), summary.min_, summary.avg_,
+                    summary.p50_, summary.p95_, summary.p99_, summary.max_, summary.type_ == FRAME_METRIC_TIMING ? " ms" : "");
+            }
+        }
     }
     ui::End();
     ui::PopStyleColor();
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Core/FrameStats.h"
 #include "../Core/Object.h"
 #include "../Core/Timer.h"
 
@@ -31,6 +32,7 @@ namespace Urho3D
 static const unsigned DEBUGHUD_SHOW_NONE = 0x0;
 static const unsigned DEBUGHUD_SHOW_STATS = 0x1;
 static const unsigned DEBUGHUD_SHOW_MODE = 0x2;
+static const unsigned DEBUGHUD_SHOW_FRAMESTATS = 0x4;
 static const unsigned DEBUGHUD_SHOW_ALL = 0x7;
 
 /// Displays rendering stats and profiling information.
@@ -102,6 +104,10 @@ private:
     Timer fpsTimer_;
     /// Calculated fps
     unsigned fps_;
+    /// Frame statistics update timer.
+    Timer frameStatsTimer_;
+    /// Frame statistics summaries.
+    Vector<FrameMetricSummary> frameStats_;
     /// DebugHud extents that data will be rendered in.
     IntRect extents_;
     /// Cached position (bottom-left corner) of mode information.
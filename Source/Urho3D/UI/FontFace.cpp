@@ -64,6 +64,45 @@ const FontGlyph* FontFace::GetGlyph(unsigned c)
         return nullptr;
 }
 
+static unsigned HashText(const PODVector<unsigned>& text)
+{
+    // SDBM hash of the code points
+    unsigned hash = 0;
+    for (unsigned i = 0; i < text.Size(); ++i)
+        hash = text[i] + (hash << 6u) + (hash << 16u) - hash;
+    return hash;
+}
+
+TextLayout* FontFace::GetTextLayout(const PODVector<unsigned>& text, int wrapWidth)
+{
+    TextLayoutKey key{HashText(text), wrapWidth, GetRevision()};
+    HashMap<TextLayoutKey, WeakPtr<TextLayout> >::ConstIterator i = textLayouts_.Find(key);
+    if (i == textLayouts_.End() || i->second_.Expired())
+        return nullptr;
+
+    // Guard against hash collisions
+    TextLayout* layout = i->second_;
+    return layout->text_ == text ? layout : nullptr;
+}
+
+void FontFace::AddTextLayout(TextLayout* layout, int wrapWidth)
+{
+    if (textLayouts_.Size() >= textLayoutPurgeSize_)
+    {
+        for (HashMap<TextLayoutKey, WeakPtr<TextLayout> >::Iterator i = textLayouts_.Begin(); i != textLayouts_.End();)
+        {
+            if (i->second_.Expired())
+                i = textLayouts_.Erase(i);
+            else
+                ++i;
+        }
+        textLayoutPurgeSize_ = Max(textLayouts_.Size() * 2, 64U);
+    }
+
+    TextLayoutKey key{HashText(layout->text_), wrapWidth, GetRevision()};
+    textLayouts_[key] = layout;
+}
+
 float FontFace::GetKerning(unsigned c, unsigned d) const
 {
     if (kerningMapping_.Empty())
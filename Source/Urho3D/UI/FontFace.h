@@ -32,6 +32,7 @@ namespace Urho3D
 {
 
 class Font;
+class FontFace;
 class Image;
 class Texture2D;
 
@@ -58,10 +59,56 @@ struct URHO3D_API FontGlyph
     float advanceX_{};
     /// Texture page. M_MAX_UNSIGNED if not yet resident on any texture.
     unsigned page_{M_MAX_UNSIGNED};
+    /// Texture page generation the glyph was placed on. Only used with the shared glyph atlas.
+    unsigned generation_{};
     /// Used flag.
     bool used_{};
 };
 
+/// Text laid out with a font face: printed characters after word wrapping, their glyphs and the row widths. Shared by all text elements showing the same text with the same face and wrap width.
+struct URHO3D_API TextLayout : public RefCounted
+{
+    /// Font face the layout was built with.
+    WeakPtr<FontFace> face_;
+    /// Source text as Unicode characters.
+    PODVector<unsigned> text_;
+    /// Text modified into printed form.
+    PODVector<unsigned> printText_;
+    /// Mapping of printed form back to original char indices.
+    PODVector<unsigned> printToText_;
+    /// Glyph of each printed character. Null for line breaks and missing glyphs.
+    PODVector<const FontGlyph*> glyphs_;
+    /// Kerning between each printed character and the next.
+    PODVector<float> kerning_;
+    /// Row widths.
+    PODVector<float> rowWidths_;
+    /// Width of the widest row.
+    int width_{};
+};
+
+/// Key of a cached text layout.
+struct TextLayoutKey
+{
+    /// Test for equality with another key.
+    bool operator ==(const TextLayoutKey& rhs) const
+    {
+        return textHash_ == rhs.textHash_ && wrapWidth_ == rhs.wrapWidth_ && revision_ == rhs.revision_;
+    }
+
+    /// Test for inequality with another key.
+    bool operator !=(const TextLayoutKey& rhs) const { return !(*this == rhs); }
+
+    /// Return hash value for HashMap.
+    unsigned ToHash() const { return textHash_ ^ ((unsigned)wrapWidth_ * 31) ^ (revision_ << 16u); }
+
+    /// Hash of the source text.
+    unsigned textHash_;
+    /// Word wrap width, negative if word wrap is disabled.
+    int wrapWidth_;
+    /// Font face glyph revision.
+    unsigned revision_;
+};
+
 /// %Font face description.
 class URHO3D_API FontFace : public RefCounted
 {
@@ -81,6 +128,14 @@ public:
     /// Return if font face uses mutable glyphs.
     virtual bool HasMutableGlyphs() const { return false; }
 
+    /// Return revision of glyph metrics and placement. Changes when text using the face needs to be laid out again.
+    virtual unsigned GetRevision() const { return revision_; }
+
+    /// Return a cached layout of a text with a word wrap width (negative if word wrap is disabled), or null if not cached.
+    TextLayout* GetTextLayout(const PODVector<unsigned>& text, int wrapWidth);
+    /// Add a text layout to the cache. The cache does not keep layouts alive once no text element uses them.
+    void AddTextLayout(TextLayout* layout, int wrapWidth);
+
     /// Return the kerning for a character and the next character.
     float GetKerning(unsigned c, unsigned d) const;
     /// Return true when one of the texture has a data loss.
@@ -114,6 +169,12 @@ protected:
     float pointSize_{};
     /// Row height.
     float rowHeight_{};
+    /// Glyph revision.
+    unsigned revision_{};
+    /// Cached text layouts.
+    HashMap<TextLayoutKey, WeakPtr<TextLayout> > textLayouts_;
+    /// Number of cached text layouts at which expired ones are removed next.
+    unsigned textLayoutPurgeSize_{};
 };
 
 }
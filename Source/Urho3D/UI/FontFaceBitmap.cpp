@@ -192,7 +192,8 @@ bool FontFaceBitmap::Load(FontFace* fontFace, bool usedGlyphs)
     for (HashMap<unsigned, FontGlyph>::ConstIterator i = fontFace->glyphMapping_.Begin(); i != fontFace->glyphMapping_.End(); ++i)
     {
         FontGlyph fontGlyph = i->second_;
-        if (!fontGlyph.used_)
+        // Skip glyphs that are not resident on any texture, e.g. still being rasterized in the background
+        if (!fontGlyph.used_ || fontGlyph.page_ >= fontFace->textures_.Size())
             continue;
 
         int x, y;
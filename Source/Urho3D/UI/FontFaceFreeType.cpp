@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Texture2D.h"
 #include "../IO/FileSystem.h"
@@ -30,6 +31,7 @@
 #include "../IO/MemoryBuffer.h"
 #include "../UI/Font.h"
 #include "../UI/FontFaceFreeType.h"
+#include "../UI/FontGlyphAtlas.h"
 #include "../UI/UI.h"
 
 #include <cassert>
@@ -76,6 +78,23 @@ private:
     FT_Library library_{};
 };
 
+void RasterizeGlyphsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* face = reinterpret_cast<FontFaceFreeType*>(item->aux_);
+    face->rasterizedGlyphs_.Resize(face->rasterizingGlyphs_.Size());
+    for (unsigned i = 0; i < face->rasterizingGlyphs_.Size(); ++i)
+    {
+        FontGlyphBitmap& bitmap = face->rasterizedGlyphs_[i];
+        bitmap.charCode_ = face->rasterizingGlyphs_[i];
+        face->RasterizeGlyph(bitmap.charCode_, bitmap.glyph_, bitmap.data_);
+    }
+
+    // Notify under the lock, as a waiting destructor may destroy the face as soon as it can reacquire it
+    std::lock_guard<std::mutex> lock(face->rasterizeMutex_);
+    face->rasterized_.store(true, std::memory_order_release);
+    face->rasterizeCondition_.notify_all();
+}
+
 FontFaceFreeType::FontFaceFreeType(Font* font) :
     FontFace(font),
     loadMode_(FT_LOAD_DEFAULT)
@@ -84,6 +103,24 @@ FontFaceFreeType::FontFaceFreeType(Font* font) :
 
 FontFaceFreeType::~FontFaceFreeType()
 {
+    // Wait for background rasterization, as it uses the FreeType face, unless it can still be removed from the queue
+    if (rasterizeItem_ && !rasterized_.load(std::memory_order_acquire))
+    {
+        auto* queue = font_->GetSubsystem<WorkQueue>();
+        if (!queue || !queue->RemoveWorkItem(rasterizeItem_))
+        {
+            std::unique_lock<std::mutex> lock(rasterizeMutex_);
+            rasterizeCondition_.wait(lock, [this] { return rasterized_.load(std::memory_order_acquire); });
+        }
+    }
+
+    if (atlas_)
+    {
+        atlas_->RemoveFace(this);
+        // Atlas pages are not accounted to the font's memory use
+        textures_.Clear();
+    }
+
     if (face_)
     {
         FT_Done_Face((FT_Face)face_);
@@ -194,35 +231,52 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
         rowHeight_ = Max(rowHeight_, ascender_ + descender);
     }
 
-    int textureWidth = maxTextureSize;
-    int textureHeight = maxTextureSize;
-    hasMutableGlyph_ = false;
-
-    SharedPtr<Image> image(new Image(font_->GetContext()));
-    image->SetSize(textureWidth, textureHeight, 1);
-    unsigned char* imageData = image->GetData();
-    memset(imageData, 0, (size_t)image->GetWidth() * image->GetHeight());
-    allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textureWidth, textureHeight);
-
-    for (unsigned i = 0; i < charCodes.Size(); ++i)
+    if (ui->GetUseMutableGlyphs())
     {
-        unsigned charCode = charCodes[i];
-        if (charCode == 0)
-            continue;
+        // Place glyphs on the atlas shared by all faces. Only printable ASCII is rasterized up front, other glyphs are
+        // rasterized in the background when first requested
+        atlas_ = ui->GetFontGlyphAtlas();
+        hasMutableGlyph_ = true;
+        placeholderAdvance_ = (float)face->size->metrics.x_ppem / oversampling_;
 
-        if (!LoadCharGlyph(charCode, image))
+        for (unsigned charCode = 32; charCode < 127; ++charCode)
         {
-            hasMutableGlyph_ = true;
-            break;
+            if (charCode == 32 || FT_Get_Char_Index(face, charCode))
+                LoadAtlasGlyph(charCode);
         }
     }
+    else
+    {
+        int textureWidth = maxTextureSize;
+        int textureHeight = maxTextureSize;
+        hasMutableGlyph_ = false;
 
-    SharedPtr<Texture2D> texture = LoadFaceTexture(image);
-    if (!texture)
-        return false;
+        SharedPtr<Image> image(new Image(font_->GetContext()));
+        image->SetSize(textureWidth, textureHeight, 1);
+        unsigned char* imageData = image->GetData();
+        memset(imageData, 0, (size_t)image->GetWidth() * image->GetHeight());
+        allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textureWidth, textureHeight);
 
-    textures_.Push(texture);
-    font_->SetMemoryUse(font_->GetMemoryUse() + textureWidth * textureHeight);
+        for (unsigned i = 0; i < charCodes.Size(); ++i)
+        {
+            unsigned charCode = charCodes[i];
+            if (charCode == 0)
+                continue;
+
+            if (!LoadCharGlyph(charCode, image))
+            {
+                hasMutableGlyph_ = true;
+                break;
+            }
+        }
+
+        SharedPtr<Texture2D> texture = LoadFaceTexture(image);
+        if (!texture)
+            return false;
+
+        textures_.Push(texture);
+        font_->SetMemoryUse(font_->GetMemoryUse() + textureWidth * textureHeight);
+    }
 
     // Store kerning if face has kerning information
     if (FT_HAS_KERNING(face))
@@ -307,6 +361,44 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
 
 const FontGlyph* FontFaceFreeType::GetGlyph(unsigned c)
 {
+    if (atlas_)
+    {
+        UpdateAtlasTextures();
+
+        HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Find(c);
+        if (i != glyphMapping_.End())
+        {
+            FontGlyph& glyph = i->second_;
+            glyph.used_ = true;
+            if (glyph.texWidth_ > 0 && glyph.texHeight_ > 0 && !pendingGlyphs_.Contains(c))
+            {
+                if (atlas_->IsResident(glyph.page_, glyph.generation_))
+                    atlas_->MarkUsed(glyph.page_);
+                else
+                {
+                    // The page was erased, or there was no room: hide the glyph until it has been rasterized again
+                    if (glyph.page_ != M_MAX_UNSIGNED)
+                    {
+                        glyph.page_ = M_MAX_UNSIGNED;
+                        ++revision_;
+                    }
+                    // After a failed placement, rasterize again only once the atlas may have room
+                    HashMap<unsigned, unsigned>::ConstIterator j = unplacedGlyphs_.Find(c);
+                    if (j == unplacedGlyphs_.End() || j->second_ != atlas_->GetRevision() || atlas_->CanFreePage())
+                        RequestGlyph(c);
+                }
+            }
+            return &glyph;
+        }
+
+        // Return a blank glyph with approximate metrics until the real one is ready
+        FontGlyph& glyph = glyphMapping_[c];
+        glyph.advanceX_ = placeholderAdvance_;
+        glyph.used_ = true;
+        RequestGlyph(c);
+        return &glyph;
+    }
+
     HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Find(c);
     if (i != glyphMapping_.End())
     {
@@ -409,52 +501,10 @@ void FontFaceFreeType::BoxFilter(unsigned char* dest, size_t destSize, const uns
 
 bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
 {
-    if (!face_)
-        return false;
-
-    auto face = (FT_Face)face_;
-    FT_GlyphSlot slot = face->glyph;
-
     FontGlyph fontGlyph;
-    FT_Error error = FT_Load_Char(face, charCode, loadMode_ | FT_LOAD_RENDER);
-    if (error)
-    {
-        const char* family = face->family_name ? face->family_name : "NULL";
-        URHO3D_LOGERRORF("FT_Load_Char failed (family: %s, char code: %u)", family, charCode);
-        fontGlyph.texWidth_ = 0;
-        fontGlyph.texHeight_ = 0;
-        fontGlyph.width_ = 0;
-        fontGlyph.height_ = 0;
-        fontGlyph.offsetX_ = 0;
-        fontGlyph.offsetY_ = 0;
-        fontGlyph.advanceX_ = 0;
-        fontGlyph.page_ = 0;
-    }
-    else
-    {
-        // Note: position within texture will be filled later
-        fontGlyph.texWidth_ = slot->bitmap.width + oversampling_ - 1;
-        fontGlyph.texHeight_ = slot->bitmap.rows;
-        fontGlyph.width_ = slot->bitmap.width + oversampling_ - 1;
-        fontGlyph.height_ = slot->bitmap.rows;
-        fontGlyph.offsetX_ = slot->bitmap_left - (oversampling_ - 1) / 2.0f;
-        fontGlyph.offsetY_ = floorf(ascender_ + 0.5f) - slot->bitmap_top;
-
-        if (subpixel_ && slot->linearHoriAdvance)
-        {
-            // linearHoriAdvance is stored in 16.16 fixed point, not the usual 26.6
-            fontGlyph.advanceX_ = slot->linearHoriAdvance / 65536.0;
-        }
-        else
-        {
-            // Round to nearest pixel (only necessary when hinting is disabled)
-            fontGlyph.advanceX_ = floorf(FixedToFloat(slot->metrics.horiAdvance) + 0.5f);
-        }
-
-        fontGlyph.width_ /= oversampling_;
-        fontGlyph.offsetX_ /= oversampling_;
-        fontGlyph.advanceX_ /= oversampling_;
-    }
+    PODVector<unsigned char> data;
+    if (!RasterizeGlyph(charCode, fontGlyph, data))
+        return false;
 
     int x = 0, y = 0;
     if (fontGlyph.texWidth_ > 0 && fontGlyph.texHeight_ > 0)
@@ -485,59 +535,224 @@ bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
         fontGlyph.x_ = (short)x;
         fontGlyph.y_ = (short)y;
 
-        unsigned char* dest = nullptr;
-        unsigned pitch = 0;
         if (image)
         {
             fontGlyph.page_ = 0;
-            dest = image->GetData() + fontGlyph.y_ * image->GetWidth() + fontGlyph.x_;
-            pitch = (unsigned)image->GetWidth();
+            for (int row = 0; row < fontGlyph.texHeight_; ++row)
+            {
+                memcpy(image->GetData() + (fontGlyph.y_ + row) * image->GetWidth() + fontGlyph.x_,
+                    &data[row * fontGlyph.texWidth_], (size_t)fontGlyph.texWidth_);
+            }
         }
         else
         {
             fontGlyph.page_ = textures_.Size() - 1;
-            dest = new unsigned char[fontGlyph.texWidth_ * fontGlyph.texHeight_];
-            pitch = (unsigned)fontGlyph.texWidth_;
+            textures_.Back()->SetData(0, fontGlyph.x_, fontGlyph.y_, fontGlyph.texWidth_, fontGlyph.texHeight_, &data[0]);
         }
+    }
+    else
+    {
+        fontGlyph.x_ = 0;
+        fontGlyph.y_ = 0;
+        fontGlyph.page_ = 0;
+    }
 
-        if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
+    glyphMapping_[charCode] = fontGlyph;
+
+    return true;
+}
+
+bool FontFaceFreeType::RasterizeGlyph(unsigned charCode, FontGlyph& fontGlyph, PODVector<unsigned char>& data)
+{
+    MutexLock lock(faceMutex_);
+
+    if (!face_)
+        return false;
+
+    auto face = (FT_Face)face_;
+    FT_GlyphSlot slot = face->glyph;
+
+    fontGlyph = FontGlyph();
+    data.Clear();
+
+    FT_Error error = FT_Load_Char(face, charCode, loadMode_ | FT_LOAD_RENDER);
+    if (error)
+    {
+        const char* family = face->family_name ? face->family_name : "NULL";
+        URHO3D_LOGERRORF("FT_Load_Char failed (family: %s, char code: %u)", family, charCode);
+        return true;
+    }
+
+    fontGlyph.texWidth_ = slot->bitmap.width + oversampling_ - 1;
+    fontGlyph.texHeight_ = slot->bitmap.rows;
+    fontGlyph.width_ = slot->bitmap.width + oversampling_ - 1;
+    fontGlyph.height_ = slot->bitmap.rows;
+    fontGlyph.offsetX_ = slot->bitmap_left - (oversampling_ - 1) / 2.0f;
+    fontGlyph.offsetY_ = floorf(ascender_ + 0.5f) - slot->bitmap_top;
+
+    if (subpixel_ && slot->linearHoriAdvance)
+    {
+        // linearHoriAdvance is stored in 16.16 fixed point, not the usual 26.6
+        fontGlyph.advanceX_ = slot->linearHoriAdvance / 65536.0;
+    }
+    else
+    {
+        // Round to nearest pixel (only necessary when hinting is disabled)
+        fontGlyph.advanceX_ = floorf(FixedToFloat(slot->metrics.horiAdvance) + 0.5f);
+    }
+
+    fontGlyph.width_ /= oversampling_;
+    fontGlyph.offsetX_ /= oversampling_;
+    fontGlyph.advanceX_ /= oversampling_;
+
+    if (fontGlyph.texWidth_ <= 0 || fontGlyph.texHeight_ <= 0)
+        return true;
+
+    const unsigned pitch = (unsigned)fontGlyph.texWidth_;
+    data.Resize(pitch * fontGlyph.texHeight_);
+    memset(&data[0], 0, data.Size());
+
+    if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
+    {
+        for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
         {
-            for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
-            {
-                unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
-                unsigned char* rowDest = dest + (oversampling_ - 1)/2 + y * pitch;
+            unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
+            unsigned char* rowDest = &data[0] + (oversampling_ - 1)/2 + y * pitch;
 
-                // Don't do any oversampling, just unpack the bits directly.
-                for (unsigned x = 0; x < (unsigned)slot->bitmap.width; ++x)
-                    rowDest[x] = (unsigned char)((src[x >> 3u] & (0x80u >> (x & 7u))) ? 255 : 0);
-            }
+            // Don't do any oversampling, just unpack the bits directly.
+            for (unsigned x = 0; x < (unsigned)slot->bitmap.width; ++x)
+                rowDest[x] = (unsigned char)((src[x >> 3u] & (0x80u >> (x & 7u))) ? 255 : 0);
         }
-        else
+    }
+    else
+    {
+        for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
         {
-            for (unsigned y = 0; y < (unsigned)slot->bitmap.rows; ++y)
-            {
-                unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
-                unsigned char* rowDest = dest + y * pitch;
-                BoxFilter(rowDest, fontGlyph.texWidth_, src, slot->bitmap.width);
-            }
+            unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
+            unsigned char* rowDest = &data[0] + y * pitch;
+            BoxFilter(rowDest, fontGlyph.texWidth_, src, slot->bitmap.width);
         }
+    }
+
+    return true;
+}
+
+void FontFaceFreeType::LoadAtlasGlyph(unsigned charCode)
+{
+    FontGlyph fontGlyph;
+    PODVector<unsigned char> data;
+    if (RasterizeGlyph(charCode, fontGlyph, data))
+        StoreAtlasGlyph(charCode, fontGlyph, data);
+}
+
+void FontFaceFreeType::StoreAtlasGlyph(unsigned charCode, FontGlyph fontGlyph, const PODVector<unsigned char>& data)
+{
+    FontGlyph& destGlyph = glyphMapping_[charCode];
+    fontGlyph.used_ = destGlyph.used_;
+
+    // Including the padding added by the atlas
+    const int pageSize = atlas_->GetPageSize();
+    if (fontGlyph.texWidth_ >= pageSize || fontGlyph.texHeight_ >= pageSize)
+    {
+        // Would never fit; leave the glyph blank instead of requesting it again
+        URHO3D_LOGERRORF("FontFaceFreeType::StoreAtlasGlyph: char code %u is too large for the glyph atlas", charCode);
+        fontGlyph.texWidth_ = 0;
+        fontGlyph.texHeight_ = 0;
+    }
 
-        if (!image)
+    if (fontGlyph.texWidth_ > 0 && fontGlyph.texHeight_ > 0)
+    {
+        unsigned page;
+        int x, y;
+        if (atlas_->Allocate(fontGlyph.texWidth_, fontGlyph.texHeight_, page, x, y))
         {
-            textures_.Back()->SetData(0, fontGlyph.x_, fontGlyph.y_, fontGlyph.texWidth_, fontGlyph.texHeight_, dest);
-            delete[] dest;
+            unplacedGlyphs_.Erase(charCode);
+            fontGlyph.x_ = (short)x;
+            fontGlyph.y_ = (short)y;
+            fontGlyph.page_ = page;
+            fontGlyph.generation_ = atlas_->GetGeneration(page);
+            atlas_->SetGlyphData(page, x, y, fontGlyph.texWidth_, fontGlyph.texHeight_, &data[0]);
+            atlas_->MarkUsed(page);
+        }
+        else
+        {
+            // Every page is in use; the glyph is requested again when next drawn after a page can be erased
+            URHO3D_LOGWARNINGF("FontFaceFreeType::StoreAtlasGlyph: no room for char code %u in glyph atlas", charCode);
+            unplacedGlyphs_[charCode] = atlas_->GetRevision();
         }
     }
-    else
+
+    destGlyph = fontGlyph;
+    ++revision_;
+    UpdateAtlasTextures();
+}
+
+void FontFaceFreeType::RequestGlyph(unsigned charCode)
+{
+    auto* queue = font_->GetSubsystem<WorkQueue>();
+    if (!queue)
     {
-        fontGlyph.x_ = 0;
-        fontGlyph.y_ = 0;
-        fontGlyph.page_ = 0;
+        LoadAtlasGlyph(charCode);
+        return;
     }
 
-    glyphMapping_[charCode] = fontGlyph;
+    if (pendingGlyphs_.Contains(charCode))
+        return;
+
+    pendingGlyphs_.Insert(charCode);
+    requestedGlyphs_.Push(charCode);
+    atlas_->AddFace(this);
+}
+
+bool FontFaceFreeType::ProcessGlyphs()
+{
+    if (rasterizeItem_)
+    {
+        // Acquire pairs with the release in RasterizeGlyphsWork, so that the rasterized glyphs are visible
+        if (!rasterized_.load(std::memory_order_acquire))
+            return true;
+
+        for (unsigned i = 0; i < rasterizedGlyphs_.Size(); ++i)
+        {
+            const FontGlyphBitmap& bitmap = rasterizedGlyphs_[i];
+            pendingGlyphs_.Erase(bitmap.charCode_);
+            StoreAtlasGlyph(bitmap.charCode_, bitmap.glyph_, bitmap.data_);
+        }
+
+        rasterizedGlyphs_.Clear();
+        rasterizeItem_.Reset();
+    }
 
+    auto* queue = font_->GetSubsystem<WorkQueue>();
+    if (requestedGlyphs_.Empty() || !queue)
+        return false;
+
+    rasterizingGlyphs_.Clear();
+    rasterizingGlyphs_.Swap(requestedGlyphs_);
+
+    // Use a dedicated item so that it can be waited on after completion. Lowest priority, so that the renderer does not wait for it
+    rasterized_.store(false, std::memory_order_relaxed);
+    rasterizeItem_ = new WorkItem();
+    rasterizeItem_->workFunction_ = RasterizeGlyphsWork;
+    rasterizeItem_->aux_ = this;
+    rasterizeItem_->priority_ = 0;
+    queue->AddWorkItem(rasterizeItem_);
     return true;
 }
 
+unsigned FontFaceFreeType::GetRevision() const
+{
+    return atlas_ ? revision_ + atlas_->GetRevision() : revision_;
+}
+
+void FontFaceFreeType::UpdateAtlasTextures()
+{
+    const Vector<SharedPtr<Texture2D> >& textures = atlas_->GetTextures();
+    if (textures.Size() != textures_.Size() || atlas_->GetRevision() != atlasRevision_)
+    {
+        textures_ = textures;
+        atlasRevision_ = atlas_->GetRevision();
+    }
+}
+
 }
@@ -22,17 +22,38 @@
 
 #pragma once
 
+#include "../Container/HashSet.h"
+#include "../Core/Mutex.h"
 #include "../UI/FontFace.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 namespace Urho3D
 {
 
+class FontGlyphAtlas;
 class FreeTypeLibrary;
 class Texture2D;
+struct WorkItem;
+
+/// Glyph rasterized in the background, waiting to be placed on the glyph atlas.
+struct FontGlyphBitmap
+{
+    /// Character code.
+    unsigned charCode_{};
+    /// Glyph metrics.
+    FontGlyph glyph_;
+    /// Glyph pixels, texWidth_ * texHeight_ bytes.
+    PODVector<unsigned char> data_;
+};
 
 /// Free type font face description.
 class URHO3D_API FontFaceFreeType : public FontFace
 {
+    friend void RasterizeGlyphsWork(const WorkItem* item, unsigned threadIndex);
+
 public:
     /// Construct.
     explicit FontFaceFreeType(Font* font);
@@ -47,11 +68,30 @@ public:
     /// Return if font face uses mutable glyphs.
     bool HasMutableGlyphs() const override { return hasMutableGlyph_; }
 
+    /// Return revision of glyph metrics and placement, including glyphs erased from the shared glyph atlas.
+    unsigned GetRevision() const override;
+
+    /// Place glyphs rasterized in the background on the shared glyph atlas and start rasterizing newly requested glyphs. Return false when no work is left. Called by the glyph atlas.
+    bool ProcessGlyphs();
+
+    /// Return whether glyphs are placed on the shared glyph atlas.
+    bool UsesGlyphAtlas() const { return atlas_.NotNull(); }
+
 private:
     /// Setup next texture.
     bool SetupNextTexture(int textureWidth, int textureHeight);
     /// Load char glyph.
     bool LoadCharGlyph(unsigned charCode, Image* image = nullptr);
+    /// Rasterize a glyph into a tightly packed buffer. Return false if the FreeType face is not available. Safe to call from worker threads.
+    bool RasterizeGlyph(unsigned charCode, FontGlyph& fontGlyph, PODVector<unsigned char>& data);
+    /// Rasterize a glyph immediately and place it on the shared glyph atlas.
+    void LoadAtlasGlyph(unsigned charCode);
+    /// Place a rasterized glyph on the shared glyph atlas.
+    void StoreAtlasGlyph(unsigned charCode, FontGlyph fontGlyph, const PODVector<unsigned char>& data);
+    /// Queue a glyph for background rasterization, or rasterize it immediately if there is no work queue.
+    void RequestGlyph(unsigned charCode);
+    /// Refresh the texture list from the shared glyph atlas.
+    void UpdateAtlasTextures();
     /// Smooth one row of a horizontally oversampled glyph image.
     void BoxFilter(unsigned char* dest, size_t destSize, const unsigned char* src, size_t srcSize);
 
@@ -71,6 +111,32 @@ private:
     bool hasMutableGlyph_{};
     /// Glyph area allocator.
     AreaAllocator allocator_;
+    /// Shared glyph atlas. Non-null when mutable glyphs are in use.
+    SharedPtr<FontGlyphAtlas> atlas_;
+    /// Glyph atlas revision the texture list was refreshed on.
+    unsigned atlasRevision_{};
+    /// Horizontal advance of glyphs still being rasterized.
+    float placeholderAdvance_{};
+    /// Glyphs requested or being rasterized.
+    HashSet<unsigned> pendingGlyphs_;
+    /// Glyphs that found no room on the glyph atlas, and the atlas revision at the time.
+    HashMap<unsigned, unsigned> unplacedGlyphs_;
+    /// Glyphs waiting for the next background rasterization.
+    PODVector<unsigned> requestedGlyphs_;
+    /// Glyphs being rasterized in the background.
+    PODVector<unsigned> rasterizingGlyphs_;
+    /// Results of the background rasterization.
+    Vector<FontGlyphBitmap> rasterizedGlyphs_;
+    /// Background rasterization work item.
+    SharedPtr<WorkItem> rasterizeItem_;
+    /// Whether the background rasterization has finished. Set with release semantics after the results are written.
+    std::atomic<bool> rasterized_{};
+    /// Mutex for waiting on the background rasterization.
+    std::mutex rasterizeMutex_;
+    /// Condition signaled when the background rasterization finishes.
+    std::condition_variable rasterizeCondition_;
+    /// Mutex for the FreeType face.
+    Mutex faceMutex_;
 };
 
 }
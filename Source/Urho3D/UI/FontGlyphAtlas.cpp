@@ -0,0 +1,220 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Texture2D.h"
+#include "../IO/Log.h"
+#include "../Resource/Image.h"
+#include "../UI/Font.h"
+#include "../UI/FontFaceFreeType.h"
+#include "../UI/FontGlyphAtlas.h"
+#include "../UI/UI.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned DEFAULT_MAX_ATLAS_PAGES = 4;
+
+FontGlyphAtlas::FontGlyphAtlas(Context* context) :
+    Object(context),
+    maxPages_(DEFAULT_MAX_ATLAS_PAGES)
+{
+}
+
+FontGlyphAtlas::~FontGlyphAtlas() = default;
+
+void FontGlyphAtlas::Update()
+{
+    ++frameNumber_;
+
+    // Drop all glyphs if the device lost the texture contents; faces will rasterize them again on demand
+    for (unsigned i = 0; i < textures_.Size(); ++i)
+    {
+        if (textures_[i]->IsDataLost())
+        {
+            Clear();
+            break;
+        }
+    }
+
+    for (unsigned i = 0; i < faces_.Size();)
+    {
+        if (faces_[i]->ProcessGlyphs())
+            ++i;
+        else
+            faces_.Erase(i);
+    }
+}
+
+void FontGlyphAtlas::Clear()
+{
+    pages_.Clear();
+    textures_.Clear();
+    ++revision_;
+}
+
+void FontGlyphAtlas::SetMaxPages(unsigned maxPages)
+{
+    maxPages_ = Max(maxPages, 1U);
+    if (pages_.Size() > maxPages_)
+        Clear();
+}
+
+bool FontGlyphAtlas::Allocate(int width, int height, unsigned& page, int& x, int& y)
+{
+    // Leave one pixel of padding to the right and bottom so that bilinear filtering does not bleed between glyphs
+    ++width;
+    ++height;
+
+    for (unsigned i = 0; i < pages_.Size(); ++i)
+    {
+        if (pages_[i].allocator_.Allocate(width, height, x, y))
+        {
+            page = i;
+            return true;
+        }
+    }
+
+    if (pages_.Size() < maxPages_)
+    {
+        page = pages_.Size();
+        pages_.Resize(page + 1);
+        textures_.Resize(page + 1);
+        if (!SetupPage(page))
+        {
+            pages_.Resize(page);
+            textures_.Resize(page);
+            return false;
+        }
+        return pages_[page].allocator_.Allocate(width, height, x, y);
+    }
+
+    // All pages are full: erase the least recently used page, unless it was drawn from on this or the previous frame
+    unsigned oldest = M_MAX_UNSIGNED;
+    for (unsigned i = 0; i < pages_.Size(); ++i)
+    {
+        if (pages_[i].lastUsed_ + 1 < frameNumber_ && (oldest == M_MAX_UNSIGNED || pages_[i].lastUsed_ < pages_[oldest].lastUsed_))
+            oldest = i;
+    }
+    if (oldest == M_MAX_UNSIGNED || !SetupPage(oldest))
+        return false;
+
+    ++revision_;
+    page = oldest;
+    return pages_[page].allocator_.Allocate(width, height, x, y);
+}
+
+bool FontGlyphAtlas::CanFreePage() const
+{
+    if (pages_.Size() < maxPages_)
+        return true;
+
+    // Same condition as erasing a page in Allocate()
+    for (unsigned i = 0; i < pages_.Size(); ++i)
+    {
+        if (pages_[i].lastUsed_ + 1 < frameNumber_)
+            return true;
+    }
+
+    return false;
+}
+
+int FontGlyphAtlas::GetPageSize() const
+{
+    auto* ui = GetSubsystem<UI>();
+    return ui ? ui->GetMaxFontTextureSize() : FONT_TEXTURE_MIN_SIZE;
+}
+
+void FontGlyphAtlas::SetGlyphData(unsigned page, int x, int y, int width, int height, const unsigned char* data)
+{
+    if (page < textures_.Size())
+        textures_[page]->SetData(0, x, y, width, height, data);
+}
+
+void FontGlyphAtlas::MarkUsed(unsigned page)
+{
+    if (page < pages_.Size())
+        pages_[page].lastUsed_ = frameNumber_;
+}
+
+void FontGlyphAtlas::MarkUsed(Texture* texture)
+{
+    // Concurrent calls only ever store the current frame number
+    for (unsigned i = 0; i < textures_.Size(); ++i)
+    {
+        if (textures_[i].Get() == texture)
+        {
+            pages_[i].lastUsed_ = frameNumber_;
+            break;
+        }
+    }
+}
+
+void FontGlyphAtlas::AddFace(FontFaceFreeType* face)
+{
+    if (!faces_.Contains(face))
+        faces_.Push(face);
+}
+
+void FontGlyphAtlas::RemoveFace(FontFaceFreeType* face)
+{
+    faces_.Remove(face);
+}
+
+bool FontGlyphAtlas::SetupPage(unsigned page)
+{
+    const int size = GetPageSize();
+
+    SharedPtr<Image> image(new Image(context_));
+    image->SetSize(size, size, 1);
+    memset(image->GetData(), 0, (size_t)size * size);
+
+    SharedPtr<Texture2D>& texture = textures_[page];
+    if (!texture || texture->GetWidth() != size)
+    {
+        texture = new Texture2D(context_);
+        texture->SetMipsToSkip(QUALITY_LOW, 0); // No quality reduction
+        texture->SetNumLevels(1); // No mipmaps
+        texture->SetAddressMode(COORD_U, ADDRESS_BORDER);
+        texture->SetAddressMode(COORD_V, ADDRESS_BORDER);
+        texture->SetBorderColor(Color(0.0f, 0.0f, 0.0f, 0.0f));
+    }
+    if (!texture->SetData(image, true))
+    {
+        URHO3D_LOGERRORF("Could not create %dx%d glyph atlas page", size, size);
+        texture.Reset();
+        return false;
+    }
+
+    FontGlyphAtlasPage& atlasPage = pages_[page];
+    atlasPage.allocator_.Reset(size, size, 0, 0);
+    atlasPage.lastUsed_ = frameNumber_;
+    atlasPage.generation_ = ++nextGeneration_;
+    return true;
+}
+
+}
@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Math/AreaAllocator.h"
+
+namespace Urho3D
+{
+
+class FontFaceFreeType;
+class Texture;
+class Texture2D;
+
+/// Texture page of the shared glyph atlas.
+struct FontGlyphAtlasPage
+{
+    /// Glyph area allocator.
+    AreaAllocator allocator_;
+    /// Frame number the page was last drawn from.
+    unsigned lastUsed_{};
+    /// Generation, changed whenever the page is erased. Glyphs placed on an earlier generation are no longer resident.
+    unsigned generation_{};
+};
+
+/// Glyph texture atlas shared by all FreeType font faces and sizes when mutable glyphs are in use. Pages are erased in least recently used order when full.
+class URHO3D_API FontGlyphAtlas : public Object
+{
+    URHO3D_OBJECT(FontGlyphAtlas, Object);
+
+public:
+    /// Construct.
+    explicit FontGlyphAtlas(Context* context);
+    /// Destruct.
+    ~FontGlyphAtlas() override;
+
+    /// Advance the frame counter and place glyphs rasterized in the background. Called by the UI subsystem once per frame.
+    void Update();
+    /// Erase all pages and release the textures.
+    void Clear();
+    /// Set maximum number of texture pages. Default 4.
+    void SetMaxPages(unsigned maxPages);
+
+    /// Allocate space for a glyph, erasing the least recently used page if necessary. Return true if successful.
+    bool Allocate(int width, int height, unsigned& page, int& x, int& y);
+    /// Copy glyph pixels into a page.
+    void SetGlyphData(unsigned page, int x, int y, int width, int height, const unsigned char* data);
+    /// Mark a page as drawn from on the current frame.
+    void MarkUsed(unsigned page);
+    /// Mark the page of a texture as drawn from on the current frame. May be called from worker threads.
+    void MarkUsed(Texture* texture);
+    /// Register a face with pending background rasterization.
+    void AddFace(FontFaceFreeType* face);
+    /// Unregister a face.
+    void RemoveFace(FontFaceFreeType* face);
+
+    /// Return whether a glyph placed on a page generation is still resident.
+    bool IsResident(unsigned page, unsigned generation) const { return page < pages_.Size() && pages_[page].generation_ == generation; }
+
+    /// Return whether Allocate() could make room for a glyph that did not fit before, by adding a page or erasing the least recently used one.
+    bool CanFreePage() const;
+    /// Return size of the texture pages.
+    int GetPageSize() const;
+
+    /// Return current generation of a page.
+    unsigned GetGeneration(unsigned page) const { return page < pages_.Size() ? pages_[page].generation_ : 0; }
+
+    /// Return revision, incremented whenever glyphs are erased.
+    unsigned GetRevision() const { return revision_; }
+
+    /// Return texture pages.
+    const Vector<SharedPtr<Texture2D> >& GetTextures() const { return textures_; }
+
+    /// Return maximum number of texture pages.
+    unsigned GetMaxPages() const { return maxPages_; }
+
+    /// Return frame number.
+    unsigned GetFrameNumber() const { return frameNumber_; }
+
+private:
+    /// Create or erase the texture of a page.
+    bool SetupPage(unsigned page);
+
+    /// Pages.
+    Vector<FontGlyphAtlasPage> pages_;
+    /// Page textures.
+    Vector<SharedPtr<Texture2D> > textures_;
+    /// Faces with pending glyphs.
+    PODVector<FontFaceFreeType*> faces_;
+    /// Maximum number of pages.
+    unsigned maxPages_;
+    /// Frame number.
+    unsigned frameNumber_{};
+    /// Next page generation.
+    unsigned nextGeneration_{};
+    /// Revision.
+    unsigned revision_{};
+};
+
+}
@@ -44,7 +44,7 @@ static const char* highlightModes[] =
     nullptr
 };
 
-static const StringHash expandedHash("Expanded");
+static const StringHash expandedHash = "Expanded"_sh;
 
 extern const char* UI_CATEGORY;
 
@@ -58,7 +58,7 @@ void SetItemExpanded(UIElement* item, bool enable)
     item->SetVar(expandedHash, enable);
 }
 
-static const StringHash hierarchyParentHash("HierarchyParent");
+static const StringHash hierarchyParentHash = "HierarchyParent"_sh;
 
 bool GetItemHierarchyParent(UIElement* item)
 {
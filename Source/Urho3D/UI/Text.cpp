@@ -59,6 +59,7 @@ Text::Text(Context* context) :
     wordWrap_(false),
     autoLocalizable_(false),
     charLocationsDirty_(true),
+    fontFaceRevision_(0),
     selectionStart_(0),
     selectionLength_(0),
     textEffect_(TE_NONE),
@@ -132,8 +133,19 @@ void Text::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData,
     // If face uses mutable glyphs mechanism, reacquire glyphs before rendering to make sure they are in the texture
     else if (face->HasMutableGlyphs())
     {
-        for (unsigned i = 0; i < printText_.Size(); ++i)
-            face->GetGlyph(printText_[i]);
+        if (layout_)
+        {
+            const PODVector<unsigned>& printText = layout_->printText_;
+            for (unsigned i = 0; i < printText.Size(); ++i)
+                face->GetGlyph(printText[i]);
+        }
+
+        // Lay out again if glyphs have been rasterized or erased since
+        if (face->GetRevision() != fontFaceRevision_)
+        {
+            UpdateText();
+            UpdateCharLocations();
+        }
     }
 
     // Hovering and/or whole selection batch
@@ -413,7 +425,7 @@ void Text::SetEffectDepthBias(float bias)
 
 float Text::GetRowWidth(unsigned index) const
 {
-    return index < rowWidths_.Size() ? rowWidths_[index] : 0;
+    return layout_ && index < layout_->rowWidths_.Size() ? layout_->rowWidths_[index] : 0;
 }
 
 Vector2 Text::GetCharPosition(unsigned index)
@@ -440,6 +452,11 @@ Vector2 Text::GetCharSize(unsigned index)
     return charLocations_[index].size_;
 }
 
+bool Text::IsGlyphDataDirty() const
+{
+    return fontFace_ && fontFace_->HasMutableGlyphs() && fontFace_->GetRevision() != fontFaceRevision_;
+}
+
 void Text::SetFontAttr(const ResourceRef& value)
 {
     auto* cache = GetSubsystem<ResourceCache>();
@@ -486,8 +503,7 @@ bool Text::FilterImplicitAttributes(XMLElement& dest) const
 
 void Text::UpdateText(bool onResize)
 {
-    rowWidths_.Clear();
-    printText_.Clear();
+    layout_.Reset();
 
     if (font_)
     {
@@ -497,182 +513,206 @@ void Text::UpdateText(bool onResize)
 
         rowHeight_ = face->GetRowHeight();
 
-        int width = 0;
-        int height = 0;
-        int rowWidth = 0;
+        // Reuse the layout of identical text with the same face and wrap width, e.g. in list rows
+        int wrapWidth = wordWrap_ ? GetWidth() : -1;
+        layout_ = face->GetTextLayout(unicodeText_, wrapWidth);
+        if (!layout_)
+        {
+            layout_ = new TextLayout();
+            BuildLayout(face, wrapWidth, *layout_);
+            face->AddTextLayout(layout_, wrapWidth);
+        }
+
         auto rowHeight = RoundToInt(rowSpacing_ * rowHeight_);
+        int width = layout_->width_;
+        int height = layout_->rowWidths_.Size() * rowHeight;
+
+        // Set at least one row height even if text is empty
+        if (!height)
+            height = rowHeight;
 
-        // First see if the text must be split up
-        if (!wordWrap_)
+        // Set minimum and current size according to the text size, but respect fixed width if set
+        if (!IsFixedWidth())
         {
-            printText_ = unicodeText_;
-            printToText_.Resize(printText_.Size());
-            for (unsigned i = 0; i < printText_.Size(); ++i)
-                printToText_[i] = i;
+            if (wordWrap_)
+                SetMinWidth(0);
+            else
+            {
+                SetMinWidth(width);
+                SetWidth(width);
+            }
         }
-        else
+        SetFixedHeight(height);
+
+        charLocationsDirty_ = true;
+    }
+    else
+    {
+        // No font, nothing to render
+        pageGlyphLocations_.Clear();
+    }
+
+    // If wordwrap is on, parent may need layout update to correct for overshoot in size. However, do not do this when the
+    // update is a response to resize, as that could cause infinite recursion
+    if (wordWrap_ && !onResize)
+    {
+        UIElement* parent = GetParent();
+        if (parent && parent->GetLayoutMode() != LM_FREE)
+            parent->UpdateLayout();
+    }
+}
+
+void Text::BuildLayout(FontFace* face, int wrapWidth, TextLayout& layout) const
+{
+    layout.face_ = face;
+    layout.text_ = unicodeText_;
+    PODVector<unsigned>& printText = layout.printText_;
+    PODVector<unsigned>& printToText = layout.printToText_;
+    int rowWidth = 0;
+
+    // First see if the text must be split up
+    if (wrapWidth < 0)
+    {
+        printText = unicodeText_;
+        printToText.Resize(printText.Size());
+        for (unsigned i = 0; i < printText.Size(); ++i)
+            printToText[i] = i;
+    }
+    else
+    {
+        int maxWidth = wrapWidth;
+        unsigned nextBreak = 0;
+        unsigned lineStart = 0;
+
+        for (unsigned i = 0; i < unicodeText_.Size(); ++i)
         {
-            int maxWidth = GetWidth();
-            unsigned nextBreak = 0;
-            unsigned lineStart = 0;
-            printToText_.Clear();
+            unsigned j;
+            unsigned c = unicodeText_[i];
 
-            for (unsigned i = 0; i < unicodeText_.Size(); ++i)
+            if (c != '\n')
             {
-                unsigned j;
-                unsigned c = unicodeText_[i];
+                bool ok = true;
 
-                if (c != '\n')
+                if (nextBreak <= i)
                 {
-                    bool ok = true;
-
-                    if (nextBreak <= i)
+                    int futureRowWidth = rowWidth;
+                    for (j = i; j < unicodeText_.Size(); ++j)
                     {
-                        int futureRowWidth = rowWidth;
-                        for (j = i; j < unicodeText_.Size(); ++j)
+                        unsigned d = unicodeText_[j];
+                        if (d == ' ' || d == '\n')
                         {
-                            unsigned d = unicodeText_[j];
-                            if (d == ' ' || d == '\n')
-                            {
-                                nextBreak = j;
-                                break;
-                            }
-                            const FontGlyph* glyph = face->GetGlyph(d);
-                            if (glyph)
-                            {
-                                futureRowWidth += glyph->advanceX_;
-                                if (j < unicodeText_.Size() - 1)
-                                    futureRowWidth += face->GetKerning(d, unicodeText_[j + 1]);
-                            }
-                            if (d == '-' && futureRowWidth <= maxWidth)
-                            {
-                                nextBreak = j + 1;
-                                break;
-                            }
-                            if (futureRowWidth > maxWidth)
-                            {
-                                ok = false;
-                                break;
-                            }
+                            nextBreak = j;
+                            break;
                         }
-                    }
-
-                    if (!ok)
-                    {
-                        // If did not find any breaks on the line, copy until j, or at least 1 char, to prevent infinite loop
-                        if (nextBreak == lineStart)
+                        const FontGlyph* glyph = face->GetGlyph(d);
+                        if (glyph)
                         {
-                            while (i < j)
-                            {
-                                printText_.Push(unicodeText_[i]);
-                                printToText_.Push(i);
-                                ++i;
-                            }
+                            futureRowWidth += glyph->advanceX_;
+                            if (j < unicodeText_.Size() - 1)
+                                futureRowWidth += face->GetKerning(d, unicodeText_[j + 1]);
                         }
-                        // Eliminate spaces that have been copied before the forced break
-                        while (printText_.Size() && printText_.Back() == ' ')
+                        if (d == '-' && futureRowWidth <= maxWidth)
                         {
-                            printText_.Pop();
-                            printToText_.Pop();
+                            nextBreak = j + 1;
+                            break;
+                        }
+                        if (futureRowWidth > maxWidth)
+                        {
+                            ok = false;
+                            break;
                         }
-                        printText_.Push('\n');
-                        printToText_.Push(Min(i, unicodeText_.Size() - 1));
-                        rowWidth = 0;
-                        nextBreak = lineStart = i;
                     }
+                }
 
-                    if (i < unicodeText_.Size())
+                if (!ok)
+                {
+                    // If did not find any breaks on the line, copy until j, or at least 1 char, to prevent infinite loop
+                    if (nextBreak == lineStart)
                     {
-                        // When copying a space, position is allowed to be over row width
-                        c = unicodeText_[i];
-                        const FontGlyph* glyph = face->GetGlyph(c);
-                        if (glyph)
-                        {
-                            rowWidth += glyph->advanceX_;
-                            if (i < unicodeText_.Size() - 1)
-                                rowWidth += face->GetKerning(c, unicodeText_[i + 1]);
-                        }
-                        if (rowWidth <= maxWidth)
+                        while (i < j)
                         {
-                            printText_.Push(c);
-                            printToText_.Push(i);
+                            printText.Push(unicodeText_[i]);
+                            printToText.Push(i);
+                            ++i;
                         }
                     }
-                }
-                else
-                {
-                    printText_.Push('\n');
-                    printToText_.Push(Min(i, unicodeText_.Size() - 1));
+                    // Eliminate spaces that have been copied before the forced break
+                    while (printText.Size() && printText.Back() == ' ')
+                    {
+                        printText.Pop();
+                        printToText.Pop();
+                    }
+                    printText.Push('\n');
+                    printToText.Push(Min(i, unicodeText_.Size() - 1));
                     rowWidth = 0;
                     nextBreak = lineStart = i;
                 }
-            }
-        }
-
-        rowWidth = 0;
 
-        for (unsigned i = 0; i < printText_.Size(); ++i)
-        {
-            unsigned c = printText_[i];
-
-            if (c != '\n')
-            {
-                const FontGlyph* glyph = face->GetGlyph(c);
-                if (glyph)
+                if (i < unicodeText_.Size())
                 {
-                    rowWidth += glyph->advanceX_;
-                    if (i < printText_.Size() - 1)
-                        rowWidth += face->GetKerning(c, printText_[i + 1]);
+                    // When copying a space, position is allowed to be over row width
+                    c = unicodeText_[i];
+                    const FontGlyph* glyph = face->GetGlyph(c);
+                    if (glyph)
+                    {
+                        rowWidth += glyph->advanceX_;
+                        if (i < unicodeText_.Size() - 1)
+                            rowWidth += face->GetKerning(c, unicodeText_[i + 1]);
+                    }
+                    if (rowWidth <= maxWidth)
+                    {
+                        printText.Push(c);
+                        printToText.Push(i);
+                    }
                 }
             }
             else
             {
-                width = Max(width, rowWidth);
-                height += rowHeight;
-                rowWidths_.Push(rowWidth);
+                printText.Push('\n');
+                printToText.Push(Min(i, unicodeText_.Size() - 1));
                 rowWidth = 0;
+                nextBreak = lineStart = i;
             }
         }
+    }
 
-        if (rowWidth)
-        {
-            width = Max(width, rowWidth);
-            height += rowHeight;
-            rowWidths_.Push(rowWidth);
-        }
+    // Store glyphs and kerning for positioning the characters, and measure the rows
+    layout.glyphs_.Resize(printText.Size());
+    layout.kerning_.Resize(printText.Size());
+    rowWidth = 0;
 
-        // Set at least one row height even if text is empty
-        if (!height)
-            height = rowHeight;
+    for (unsigned i = 0; i < printText.Size(); ++i)
+    {
+        unsigned c = printText[i];
+        const FontGlyph* glyph = nullptr;
+        float kerning = 0.0f;
 
-        // Set minimum and current size according to the text size, but respect fixed width if set
-        if (!IsFixedWidth())
+        if (c != '\n')
         {
-            if (wordWrap_)
-                SetMinWidth(0);
-            else
+            glyph = face->GetGlyph(c);
+            if (glyph)
             {
-                SetMinWidth(width);
-                SetWidth(width);
+                if (i < printText.Size() - 1)
+                    kerning = face->GetKerning(c, printText[i + 1]);
+                rowWidth += glyph->advanceX_;
+                rowWidth += kerning;
             }
         }
-        SetFixedHeight(height);
+        else
+        {
+            layout.width_ = Max(layout.width_, rowWidth);
+            layout.rowWidths_.Push(rowWidth);
+            rowWidth = 0;
+        }
 
-        charLocationsDirty_ = true;
-    }
-    else
-    {
-        // No font, nothing to render
-        pageGlyphLocations_.Clear();
+        layout.glyphs_[i] = glyph;
+        layout.kerning_[i] = kerning;
     }
 
-    // If wordwrap is on, parent may need layout update to correct for overshoot in size. However, do not do this when the
-    // update is a response to resize, as that could cause infinite recursion
-    if (wordWrap_ && !onResize)
+    if (rowWidth)
     {
-        UIElement* parent = GetParent();
-        if (parent && parent->GetLayoutMode() != LM_FREE)
-            parent->UpdateLayout();
+        layout.width_ = Max(layout.width_, rowWidth);
+        layout.rowWidths_.Push(rowWidth);
     }
 }
 
@@ -684,6 +724,14 @@ void Text::UpdateCharLocations()
         return;
     fontFace_ = face;
 
+    // The layout refers to glyphs of the face it was built with, so lay out again if the face has been recreated
+    if (!layout_ || layout_->face_ != face)
+        UpdateText(true);
+    if (!layout_)
+        return;
+    const PODVector<unsigned>& printText = layout_->printText_;
+    const PODVector<unsigned>& printToText = layout_->printToText_;
+
     auto rowHeight = RoundToInt(rowSpacing_ * rowHeight_);
 
     // Store position & size of each character, and locations per texture page
@@ -700,15 +748,15 @@ void Text::UpdateCharLocations()
     float x = Round(GetRowStartPosition(rowIndex) + offset.x_);
     float y = Round(offset.y_);
 
-    for (unsigned i = 0; i < printText_.Size(); ++i)
+    for (unsigned i = 0; i < printText.Size(); ++i)
     {
         CharLocation loc;
         loc.position_ = Vector2(x, y);
 
-        unsigned c = printText_[i];
+        unsigned c = printText[i];
         if (c != '\n')
         {
-            const FontGlyph* glyph = face->GetGlyph(c);
+            const FontGlyph* glyph = layout_->glyphs_[i];
             loc.size_ = Vector2(glyph ? glyph->advanceX_ : 0, rowHeight_);
             if (glyph)
             {
@@ -716,8 +764,8 @@ void Text::UpdateCharLocations()
                 if (glyph->page_ < pageGlyphLocations_.Size())
                     pageGlyphLocations_[glyph->page_].Push(GlyphLocation(x, y, glyph));
                 x += glyph->advanceX_;
-                if (i < printText_.Size() - 1)
-                    x += face->GetKerning(c, printText_[i + 1]);
+                if (i < printText.Size() - 1)
+                    x += layout_->kerning_[i];
             }
         }
         else
@@ -727,18 +775,19 @@ void Text::UpdateCharLocations()
             y += rowHeight;
         }
 
-        if (lastFilled > printToText_[i])
-            lastFilled = printToText_[i];
+        if (lastFilled > printToText[i])
+            lastFilled = printToText[i];
 
         // Fill gaps in case characters were skipped from printing
-        for (unsigned j = lastFilled; j <= printToText_[i]; ++j)
+        for (unsigned j = lastFilled; j <= printToText[i]; ++j)
             charLocations_[j] = loc;
-        lastFilled = printToText_[i] + 1;
+        lastFilled = printToText[i] + 1;
     }
     // Store the ending position
     charLocations_[numChars].position_ = Vector2(x, y);
     charLocations_[numChars].size_ = Vector2::ZERO;
 
+    fontFaceRevision_ = face->GetRevision();
     charLocationsDirty_ = false;
 }
 
@@ -764,8 +813,8 @@ int Text::GetRowStartPosition(unsigned rowIndex) const
 {
     float rowWidth = 0;
 
-    if (rowIndex < rowWidths_.Size())
-        rowWidth = rowWidths_[rowIndex];
+    if (layout_ && rowIndex < layout_->rowWidths_.Size())
+        rowWidth = layout_->rowWidths_[rowIndex];
 
     int ret = GetIndentWidth();
 
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../UI/FontFace.h"
 #include "../UI/UISelectable.h"
 
 namespace Urho3D
@@ -30,8 +31,6 @@ namespace Urho3D
 static const float DEFAULT_FONT_SIZE = 12;
 
 class Font;
-class FontFace;
-struct FontGlyph;
 
 /// Text effect.
 enum TextEffect
@@ -170,7 +169,7 @@ public:
     float GetRowHeight() const { return rowHeight_; }
 
     /// Return number of rows.
-    unsigned GetNumRows() const { return rowWidths_.Size(); }
+    unsigned GetNumRows() const { return layout_ ? layout_->rowWidths_.Size() : 0; }
 
     /// Return number of characters.
     unsigned GetNumChars() const { return unicodeText_.Size(); }
@@ -181,6 +180,8 @@ public:
     Vector2 GetCharPosition(unsigned index);
     /// Return size of character by index.
     Vector2 GetCharSize(unsigned index);
+    /// Return whether glyphs of the font face have changed since the text was laid out, e.g. when glyphs rasterized in the background become available.
+    bool IsGlyphDataDirty() const;
 
     /// Set text effect Z bias. Zero by default, adjusted only in 3D mode.
     void SetEffectDepthBias(float bias);
@@ -202,6 +203,8 @@ protected:
     bool FilterImplicitAttributes(XMLElement& dest) const override;
     /// Update text when text, font or spacing changed.
     void UpdateText(bool onResize = false);
+    /// Word wrap the text and measure its rows with a font face.
+    void BuildLayout(FontFace* face, int wrapWidth, TextLayout& layout) const;
     /// Update cached character locations after text update, or when text alignment or indent has changed.
     void UpdateCharLocations();
     /// Validate text selection to be within the text.
@@ -229,6 +232,8 @@ protected:
     bool wordWrap_;
     /// Char positions dirty flag.
     bool charLocationsDirty_;
+    /// Font face glyph revision the char positions were calculated with.
+    unsigned fontFaceRevision_;
     /// Selection start.
     unsigned selectionStart_;
     /// Selection length.
@@ -249,12 +254,8 @@ protected:
     float rowHeight_;
     /// Text as Unicode characters.
     PODVector<unsigned> unicodeText_;
-    /// Text modified into printed form.
-    PODVector<unsigned> printText_;
-    /// Mapping of printed form back to original char indices.
-    PODVector<unsigned> printToText_;
-    /// Row widths.
-    PODVector<float> rowWidths_;
+    /// Text layout, shared with other text elements through the font face's layout cache.
+    SharedPtr<TextLayout> layout_;
     /// Glyph locations per each texture in the font.
     Vector<PODVector<GlyphLocation> > pageGlyphLocations_;
     /// Cached locations of each character in the text.
@@ -33,8 +33,11 @@
 #include "../Resource/ResourceCache.h"
 #include "../Scene/Node.h"
 #include "../UI/Font.h"
+#include "../UI/FontFace.h"
+#include "../UI/FontGlyphAtlas.h"
 #include "../UI/Text.h"
 #include "../UI/Text3D.h"
+#include "../UI/UI.h"
 
 namespace Urho3D
 {
@@ -133,6 +136,20 @@ void Text3D::UpdateBatches(const FrameInfo& frame)
             break;
         }
     }
+
+    // With mutable glyphs, keep the atlas pages in use from being erased and rebuild once background glyphs are ready
+    if (text_.IsGlyphDataDirty())
+        fontDataLost_ = true;
+    else if (text_.fontFace_ && text_.fontFace_->HasMutableGlyphs())
+    {
+        auto* ui = GetSubsystem<UI>();
+        if (ui)
+        {
+            FontGlyphAtlas* atlas = ui->GetFontGlyphAtlas();
+            for (unsigned i = 0; i < uiBatches_.Size(); ++i)
+                atlas->MarkUsed(uiBatches_[i].texture_);
+        }
+    }
 }
 
 void Text3D::UpdateGeometry(const FrameInfo& frame)
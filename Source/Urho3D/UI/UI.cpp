@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/MemoryStats.h"
 #include "../Core/Profiler.h"
 #include "../Container/Sort.h"
 #include "../Graphics/Graphics.h"
@@ -46,6 +47,7 @@
 #include "../UI/DropDownList.h"
 #include "../UI/FileSelector.h"
 #include "../UI/Font.h"
+#include "../UI/FontGlyphAtlas.h"
 #include "../UI/LineEdit.h"
 #include "../UI/ListView.h"
 #include "../UI/MessageBox.h"
@@ -115,6 +117,7 @@ UI::UI(Context* context) :
     useScreenKeyboard_(false),
 #endif
     useMutableGlyphs_(false),
+    fontGlyphAtlas_(new FontGlyphAtlas(context)),
     forceAutoHint_(false),
     fontHintLevel_(FONT_HINT_LEVEL_NORMAL),
     fontSubpixelThreshold_(12),
@@ -312,10 +315,15 @@ void UI::Clear()
 
 void UI::Update(float timeStep)
 {
+    URHO3D_MEMORY_TAG(MEMTAG_UI);
+
     assert(rootElement_ && rootModalElement_);
 
     URHO3D_PROFILE("UpdateUI");
 
+    // Place glyphs rasterized in the background before any text is laid out this frame
+    fontGlyphAtlas_->Update();
+
     // Expire hovers
     for (HashMap<WeakPtr<UIElement>, bool>::Iterator i = hoveredElements_.Begin(); i != hoveredElements_.End(); ++i)
         i->second_ = false;
@@ -417,6 +425,8 @@ void UI::Update(float timeStep)
 
 void UI::RenderUpdate()
 {
+    URHO3D_MEMORY_TAG(MEMTAG_UI);
+
     assert(rootElement_ && rootModalElement_ && graphics_);
 
     URHO3D_PROFILE("GetUIBatches");
@@ -487,6 +497,7 @@ void UI::RenderUpdate()
 void UI::Render(bool renderUICommand)
 {
     URHO3D_PROFILE("RenderUI");
+    URHO3D_MEMORY_TAG(MEMTAG_UI);
 
     // If the OS cursor is visible, apply its shape now if changed
     if (!renderUICommand)
@@ -1283,6 +1294,8 @@ void UI::ReleaseFontFaces()
 
     for (unsigned i = 0; i < fonts.Size(); ++i)
         fonts[i]->ReleaseFaces();
+
+    fontGlyphAtlas_->Clear();
 }
 
 void UI::ProcessHover(const IntVector2& windowCursorPos, int buttons, int qualifiers, Cursor* cursor)
@@ -44,6 +44,7 @@ enum FontHintLevel
 };
 
 class Cursor;
+class FontGlyphAtlas;
 class Graphics;
 class ResourceCache;
 class Timer;
@@ -108,7 +109,7 @@ public:
     void SetUseSystemClipboard(bool enable);
     /// Set whether to show the on-screen keyboard (if supported) when a %LineEdit is focused. Default true on mobile devices.
     void SetUseScreenKeyboard(bool enable);
-    /// Set whether to use mutable (eraseable) glyphs to ensure a font face never expands to more than one texture. Default false.
+    /// Set whether to use mutable (eraseable) glyphs. When enabled, FreeType fonts of all sizes share a glyph atlas with a limited number of pages, glyphs are rasterized in the background when first needed and least recently used pages are erased when full. Default false.
     void SetUseMutableGlyphs(bool enable);
     /// Set whether to force font autohinting instead of using FreeType's TTF bytecode interpreter.
     void SetForceAutoHint(bool enable);
@@ -193,6 +194,9 @@ public:
     /// Return whether is using mutable (eraseable) glyphs for fonts.
     bool GetUseMutableGlyphs() const { return useMutableGlyphs_; }
 
+    /// Return the glyph atlas shared by FreeType fonts when mutable glyphs are in use.
+    FontGlyphAtlas* GetFontGlyphAtlas() const { return fontGlyphAtlas_; }
+
     /// Return whether is using forced autohinting.
     bool GetForceAutoHint() const { return forceAutoHint_; }
 
@@ -395,6 +399,8 @@ private:
     bool useScreenKeyboard_;
     /// Flag for using mutable (erasable) font glyphs.
     bool useMutableGlyphs_;
+    /// Glyph atlas shared by FreeType fonts.
+    SharedPtr<FontGlyphAtlas> fontGlyphAtlas_;
     /// Flag for forcing FreeType auto hinting.
     bool forceAutoHint_;
     /// FreeType hinting level (default is FONT_HINT_LEVEL_NORMAL).
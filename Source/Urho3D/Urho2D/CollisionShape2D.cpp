@@ -28,6 +28,7 @@
 #include "../Scene/Scene.h"
 #include "../Urho2D/CollisionShape2D.h"
 #include "../Urho2D/PhysicsUtils2D.h"
+#include "../Urho2D/PhysicsWorld2D.h"
 #include "../Urho2D/RigidBody2D.h"
 
 #include "../DebugNew.h"
@@ -86,7 +87,10 @@ void CollisionShape2D::SetTrigger(bool trigger)
     fixtureDef_.isSensor = trigger;
 
     if (fixture_)
+    {
+        WaitForStep();
         fixture_->SetSensor(trigger);
+    }
 
     MarkNetworkUpdate();
 }
@@ -99,7 +103,10 @@ void CollisionShape2D::SetCategoryBits(int categoryBits)
     fixtureDef_.filter.categoryBits = (uint16)categoryBits;
 
     if (fixture_)
+    {
+        WaitForStep();
         fixture_->SetFilterData(fixtureDef_.filter);
+    }
 
     MarkNetworkUpdate();
 }
@@ -112,7 +119,10 @@ void CollisionShape2D::SetMaskBits(int maskBits)
     fixtureDef_.filter.maskBits = (uint16)maskBits;
 
     if (fixture_)
+    {
+        WaitForStep();
         fixture_->SetFilterData(fixtureDef_.filter);
+    }
 
     MarkNetworkUpdate();
 }
@@ -125,7 +135,10 @@ void CollisionShape2D::SetGroupIndex(int groupIndex)
     fixtureDef_.filter.groupIndex = (int16)groupIndex;
 
     if (fixture_)
+    {
+        WaitForStep();
         fixture_->SetFilterData(fixtureDef_.filter);
+    }
 
     MarkNetworkUpdate();
 }
@@ -139,6 +152,8 @@ void CollisionShape2D::SetDensity(float density)
 
     if (fixture_)
     {
+        WaitForStep();
+
         // This will not automatically adjust the mass of the body
         fixture_->SetDensity(density);
 
@@ -158,6 +173,8 @@ void CollisionShape2D::SetFriction(float friction)
 
     if (fixture_)
     {
+        WaitForStep();
+
         // This will not change the friction of existing contacts
         fixture_->SetFriction(friction);
 
@@ -184,6 +201,8 @@ void CollisionShape2D::SetRestitution(float restitution)
 
     if (fixture_)
     {
+        WaitForStep();
+
         // This will not change the restitution of existing contacts
         fixture_->SetRestitution(restitution);
 
@@ -223,6 +242,8 @@ void CollisionShape2D::CreateFixture()
     // Chain shape must have atleast two vertices before creating fixture
     if (fixtureDef_.shape->m_type != b2Shape::e_chain || static_cast<const b2ChainShape*>(fixtureDef_.shape)->m_count >= 2)
     {
+        WaitForStep();
+
         b2MassData massData;
         body->GetMassData(&massData);
         fixture_ = body->CreateFixture(&fixtureDef_);
@@ -244,6 +265,14 @@ void CollisionShape2D::ReleaseFixture()
     if (!body)
         return;
 
+    // The fixture may be in use by an asynchronous simulation step, and its contacts may be waiting to be sent
+    PhysicsWorld2D* physicsWorld = rigidBody_->GetPhysicsWorld();
+    if (physicsWorld)
+    {
+        physicsWorld->WaitForStep();
+        physicsWorld->RemoveAsyncContacts(this);
+    }
+
     b2MassData massData;
     body->GetMassData(&massData);
     body->DestroyFixture(fixture_);
@@ -285,6 +314,13 @@ Vector2 CollisionShape2D::GetMassCenter() const
     return ToVector2(massData.center);
 }
 
+void CollisionShape2D::WaitForStep()
+{
+    PhysicsWorld2D* physicsWorld = rigidBody_ ? rigidBody_->GetPhysicsWorld() : nullptr;
+    if (physicsWorld)
+        physicsWorld->WaitForStep();
+}
+
 void CollisionShape2D::OnNodeSet(Node* node)
 {
     Component::OnNodeSet(node);
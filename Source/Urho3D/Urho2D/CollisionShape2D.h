@@ -105,6 +105,8 @@ protected:
     void OnMarkedDirty(Node* node) override;
     /// Apply Node world scale.
     virtual void ApplyNodeWorldScale() = 0;
+    /// Wait for an asynchronous 2D physics step that may be using the fixture.
+    void WaitForStep();
 
     /// Rigid body.
     WeakPtr<RigidBody2D> rigidBody_;
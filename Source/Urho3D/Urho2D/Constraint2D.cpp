@@ -84,6 +84,9 @@ void Constraint2D::CreateJoint()
     if (joint_)
         return;
 
+    // Initializing the joint def may read the body transforms, which an asynchronous simulation step may be updating
+    WaitForStep();
+
     b2JointDef* jointDef = GetJointDef();
     if (jointDef)
     {
@@ -110,7 +113,11 @@ void Constraint2D::ReleaseJoint()
         otherBody_->RemoveConstraint2D(this);
 
     if (physicsWorld_)
+    {
+        // The joint may be in use by an asynchronous simulation step
+        physicsWorld_->WaitForStep();
         physicsWorld_->GetWorld()->DestroyJoint(joint_);
+    }
 
     joint_ = nullptr;
 }
@@ -177,6 +184,12 @@ void Constraint2D::InitializeJointDef(b2JointDef* jointDef)
     jointDef->collideConnected = collideConnected_;
 }
 
+void Constraint2D::WaitForStep()
+{
+    if (physicsWorld_)
+        physicsWorld_->WaitForStep();
+}
+
 void Constraint2D::RecreateJoint()
 {
     if (attachedConstraint_)
@@ -87,6 +87,8 @@ protected:
     void RecreateJoint();
     /// Initialize joint def.
     void InitializeJointDef(b2JointDef* jointDef);
+    /// Wait for an asynchronous 2D physics step that may be using the joint.
+    void WaitForStep();
     /// Mark other body node ID dirty.
     void MarkOtherBodyNodeIDDirty() { otherBodyNodeIDDirty_ = true; }
 
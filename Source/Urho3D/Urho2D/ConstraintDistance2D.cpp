@@ -87,7 +87,10 @@ void ConstraintDistance2D::SetFrequencyHz(float frequencyHz)
     jointDef_.frequencyHz = frequencyHz;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2DistanceJoint*>(joint_)->SetFrequency(frequencyHz);
+    }
     else
         RecreateJoint();
 
@@ -102,7 +105,10 @@ void ConstraintDistance2D::SetDampingRatio(float dampingRatio)
     jointDef_.dampingRatio = dampingRatio;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2DistanceJoint*>(joint_)->SetDampingRatio(dampingRatio);
+    }
     else
         RecreateJoint();
 
@@ -117,7 +123,10 @@ void ConstraintDistance2D::SetLength(float length)
     jointDef_.length = length;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2DistanceJoint*>(joint_)->SetLength(length);
+    }
     else
         RecreateJoint();
 
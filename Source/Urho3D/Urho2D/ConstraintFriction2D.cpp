@@ -73,7 +73,10 @@ void ConstraintFriction2D::SetMaxForce(float maxForce)
     jointDef_.maxForce = maxForce;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2FrictionJoint*>(joint_)->SetMaxForce(maxForce);
+    }
     else
         RecreateJoint();
 
@@ -89,7 +92,10 @@ void ConstraintFriction2D::SetMaxTorque(float maxTorque)
     jointDef_.maxTorque = maxTorque;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2FrictionJoint*>(joint_)->SetMaxTorque(maxTorque);
+    }
     else
         RecreateJoint();
 
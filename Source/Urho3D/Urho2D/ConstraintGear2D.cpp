@@ -93,7 +93,10 @@ void ConstraintGear2D::SetRatio(float ratio)
     jointDef_.ratio = ratio;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2GearJoint*>(joint_)->SetRatio(ratio);
+    }
     else
         RecreateJoint();
 
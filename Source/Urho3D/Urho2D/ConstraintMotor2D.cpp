@@ -64,7 +64,10 @@ void ConstraintMotor2D::SetLinearOffset(const Vector2& linearOffset)
     linearOffset_ = linearOffset;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2MotorJoint*>(joint_)->SetLinearOffset(ToB2Vec2(linearOffset));
+    }
     else
         RecreateJoint();
 
@@ -79,7 +82,10 @@ void ConstraintMotor2D::SetAngularOffset(float angularOffset)
     jointDef_.angularOffset = angularOffset;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2MotorJoint*>(joint_)->SetAngularOffset(angularOffset);
+    }
     else
         RecreateJoint();
 
@@ -94,7 +100,10 @@ void ConstraintMotor2D::SetMaxForce(float maxForce)
     jointDef_.maxForce = maxForce;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2MotorJoint*>(joint_)->SetMaxForce(maxForce);
+    }
     else
         RecreateJoint();
 
@@ -109,7 +118,10 @@ void ConstraintMotor2D::SetMaxTorque(float maxTorque)
     jointDef_.maxTorque = maxTorque;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2MotorJoint*>(joint_)->SetMaxTorque(maxTorque);
+    }
     else
         RecreateJoint();
 
@@ -124,7 +136,10 @@ void ConstraintMotor2D::SetCorrectionFactor(float correctionFactor)
     jointDef_.correctionFactor = correctionFactor;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2MotorJoint*>(joint_)->SetCorrectionFactor(correctionFactor);
+    }
     else
         RecreateJoint();
 
@@ -62,7 +62,10 @@ void ConstraintMouse2D::SetTarget(const Vector2& target)
     target_ = target;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2MouseJoint*>(joint_)->SetTarget(ToB2Vec2(target));
+    }
     else
         RecreateJoint();
 
@@ -77,7 +80,10 @@ void ConstraintMouse2D::SetMaxForce(float maxForce)
     jointDef_.maxForce = maxForce;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2MouseJoint*>(joint_)->SetMaxForce(maxForce);
+    }
     else
         RecreateJoint();
 
@@ -92,7 +98,10 @@ void ConstraintMouse2D::SetFrequencyHz(float frequencyHz)
     jointDef_.frequencyHz = frequencyHz;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2MouseJoint*>(joint_)->SetFrequency(frequencyHz);
+    }
     else
         RecreateJoint();
 
@@ -107,7 +116,10 @@ void ConstraintMouse2D::SetDampingRatio(float dampingRatio)
     jointDef_.dampingRatio = dampingRatio;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2MouseJoint*>(joint_)->SetDampingRatio(dampingRatio);
+    }
     else
         RecreateJoint();
 
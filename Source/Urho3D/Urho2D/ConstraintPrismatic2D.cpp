@@ -89,7 +89,10 @@ void ConstraintPrismatic2D::SetEnableLimit(bool enableLimit)
     jointDef_.enableLimit = enableLimit;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2PrismaticJoint*>(joint_)->EnableLimit(enableLimit);
+    }
     else
         RecreateJoint();
 
@@ -104,7 +107,10 @@ void ConstraintPrismatic2D::SetLowerTranslation(float lowerTranslation)
     jointDef_.lowerTranslation = lowerTranslation;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2PrismaticJoint*>(joint_)->SetLimits(lowerTranslation, jointDef_.upperTranslation);
+    }
     else
         RecreateJoint();
 
@@ -119,7 +125,10 @@ void ConstraintPrismatic2D::SetUpperTranslation(float upperTranslation)
     jointDef_.upperTranslation = upperTranslation;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2PrismaticJoint*>(joint_)->SetLimits(jointDef_.lowerTranslation, upperTranslation);
+    }
     else
         RecreateJoint();
 
@@ -134,7 +143,10 @@ void ConstraintPrismatic2D::SetEnableMotor(bool enableMotor)
     jointDef_.enableMotor = enableMotor;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2PrismaticJoint*>(joint_)->EnableMotor(enableMotor);
+    }
     else
         RecreateJoint();
 
@@ -149,7 +161,10 @@ void ConstraintPrismatic2D::SetMaxMotorForce(float maxMotorForce)
     jointDef_.maxMotorForce = maxMotorForce;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2PrismaticJoint*>(joint_)->SetMaxMotorForce(maxMotorForce);
+    }
     else
         RecreateJoint();
 
@@ -164,7 +179,10 @@ void ConstraintPrismatic2D::SetMotorSpeed(float motorSpeed)
     jointDef_.motorSpeed = motorSpeed;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2PrismaticJoint*>(joint_)->SetMotorSpeed(motorSpeed);
+    }
     else
         RecreateJoint();
 
@@ -76,7 +76,10 @@ void ConstraintRevolute2D::SetEnableLimit(bool enableLimit)
     jointDef_.enableLimit = enableLimit;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2RevoluteJoint*>(joint_)->EnableLimit(enableLimit);
+    }
     else
         RecreateJoint();
 
@@ -91,7 +94,10 @@ void ConstraintRevolute2D::SetLowerAngle(float lowerAngle)
     jointDef_.lowerAngle = lowerAngle;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2RevoluteJoint*>(joint_)->SetLimits(lowerAngle, jointDef_.upperAngle);
+    }
     else
         RecreateJoint();
 
@@ -106,7 +112,10 @@ void ConstraintRevolute2D::SetUpperAngle(float upperAngle)
     jointDef_.upperAngle = upperAngle;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2RevoluteJoint*>(joint_)->SetLimits(jointDef_.lowerAngle, upperAngle);
+    }
     else
         RecreateJoint();
 
@@ -121,7 +130,10 @@ void ConstraintRevolute2D::SetEnableMotor(bool enableMotor)
     jointDef_.enableMotor = enableMotor;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2RevoluteJoint*>(joint_)->EnableMotor(enableMotor);
+    }
     else
         RecreateJoint();
 
@@ -136,7 +148,10 @@ void ConstraintRevolute2D::SetMotorSpeed(float motorSpeed)
     jointDef_.motorSpeed = motorSpeed;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2RevoluteJoint*>(joint_)->SetMotorSpeed(motorSpeed);
+    }
     else
         RecreateJoint();
 
@@ -151,7 +166,10 @@ void ConstraintRevolute2D::SetMaxMotorTorque(float maxMotorTorque)
     jointDef_.maxMotorTorque = maxMotorTorque;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2RevoluteJoint*>(joint_)->SetMaxMotorTorque(maxMotorTorque);
+    }
     else
         RecreateJoint();
 
@@ -86,7 +86,10 @@ void ConstraintRope2D::SetMaxLength(float maxLength)
     jointDef_.maxLength = maxLength;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2RopeJoint*>(joint_)->SetMaxLength(maxLength);
+    }
     else
         RecreateJoint();
 
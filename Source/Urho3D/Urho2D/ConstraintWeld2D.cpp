@@ -72,7 +72,10 @@ void ConstraintWeld2D::SetFrequencyHz(float frequencyHz)
     jointDef_.frequencyHz = frequencyHz;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2WeldJoint*>(joint_)->SetFrequency(frequencyHz);
+    }
     else
         RecreateJoint();
 
@@ -87,7 +90,10 @@ void ConstraintWeld2D::SetDampingRatio(float dampingRatio)
     jointDef_.dampingRatio = dampingRatio;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2WeldJoint*>(joint_)->SetDampingRatio(dampingRatio);
+    }
     else
         RecreateJoint();
 
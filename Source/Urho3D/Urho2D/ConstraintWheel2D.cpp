@@ -89,7 +89,10 @@ void ConstraintWheel2D::SetEnableMotor(bool enableMotor)
     jointDef_.enableMotor = enableMotor;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2WheelJoint*>(joint_)->EnableMotor(enableMotor);
+    }
     else
         RecreateJoint();
 
@@ -104,7 +107,10 @@ void ConstraintWheel2D::SetMaxMotorTorque(float maxMotorTorque)
     jointDef_.maxMotorTorque = maxMotorTorque;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2WheelJoint*>(joint_)->SetMaxMotorTorque(maxMotorTorque);
+    }
     else
         RecreateJoint();
 
@@ -119,7 +125,10 @@ void ConstraintWheel2D::SetMotorSpeed(float motorSpeed)
     jointDef_.motorSpeed = motorSpeed;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2WheelJoint*>(joint_)->SetMotorSpeed(motorSpeed);
+    }
     else
         RecreateJoint();
 
@@ -134,7 +143,10 @@ void ConstraintWheel2D::SetFrequencyHz(float frequencyHz)
     jointDef_.frequencyHz = frequencyHz;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2WheelJoint*>(joint_)->SetSpringFrequencyHz(frequencyHz);
+    }
     else
         RecreateJoint();
 
@@ -149,7 +161,10 @@ void ConstraintWheel2D::SetDampingRatio(float dampingRatio)
     jointDef_.dampingRatio = dampingRatio;
 
     if (joint_)
+    {
+        WaitForStep();
         static_cast<b2WheelJoint*>(joint_)->SetSpringDampingRatio(dampingRatio);
+    }
     else
         RecreateJoint();
 
@@ -23,7 +23,11 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
@@ -46,6 +50,13 @@ static const Vector2 DEFAULT_GRAVITY(0.0f, -9.81f);
 static const int DEFAULT_VELOCITY_ITERATIONS = 8;
 static const int DEFAULT_POSITION_ITERATIONS = 3;
 
+void Physics2DStepWork(const WorkItem* item, unsigned /*threadIndex*/)
+{
+    auto* physicsWorld = reinterpret_cast<PhysicsWorld2D*>(item->aux_);
+    physicsWorld->world_->Step(physicsWorld->asyncTimeStep_, physicsWorld->velocityIterations_, physicsWorld->positionIterations_);
+    physicsWorld->asyncStepCompleted_.store(true, std::memory_order_release);
+}
+
 PhysicsWorld2D::PhysicsWorld2D(Context* context) :
     Component(context),
     gravity_(DEFAULT_GRAVITY),
@@ -65,6 +76,11 @@ PhysicsWorld2D::PhysicsWorld2D(Context* context) :
 
 PhysicsWorld2D::~PhysicsWorld2D()
 {
+    // Do not leave the simulation running in a worker thread. Its results are discarded, as the scene may be partially destroyed
+    if (simulatingAsync_)
+        JoinAsyncStep();
+    asyncContacts_.Clear();
+
     for (unsigned i = 0; i < rigidBodies_.Size(); ++i)
         if (rigidBodies_[i])
             rigidBodies_[i]->ReleaseBody();
@@ -89,6 +105,7 @@ void PhysicsWorld2D::RegisterObject(Context* context)
         AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Position Iterations", GetPositionIterations, SetPositionIterations, int, DEFAULT_POSITION_ITERATIONS,
         AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Async Step", GetAsyncStep, SetAsyncStep, bool, false, AM_FILE);
 }
 
 void PhysicsWorld2D::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -97,6 +114,8 @@ void PhysicsWorld2D::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     {
         URHO3D_PROFILE("Physics2DDrawDebug");
 
+        WaitForStep();
+
         debugRenderer_ = debug;
         debugDepthTest_ = depthTest;
         world_->DrawDebugData();
@@ -115,7 +134,10 @@ void PhysicsWorld2D::BeginContact(b2Contact* contact)
     if (!fixtureA || !fixtureB)
         return;
 
-    beginContactInfos_.Push(ContactInfo(contact));
+    if (simulatingAsync_)
+        asyncContacts_.Push(AsyncContact(contact, ASYNC_CONTACT_BEGIN));
+    else
+        beginContactInfos_.Push(ContactInfo(contact));
 }
 
 void PhysicsWorld2D::EndContact(b2Contact* contact)
@@ -128,7 +150,10 @@ void PhysicsWorld2D::EndContact(b2Contact* contact)
     if (!fixtureA || !fixtureB)
         return;
 
-    endContactInfos_.Push(ContactInfo(contact));
+    if (simulatingAsync_)
+        asyncContacts_.Push(AsyncContact(contact, ASYNC_CONTACT_END));
+    else
+        endContactInfos_.Push(ContactInfo(contact));
 }
 
 void PhysicsWorld2D::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
@@ -138,12 +163,22 @@ void PhysicsWorld2D::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
     if (!fixtureA || !fixtureB)
         return;
 
-    ContactInfo contactInfo(contact);
+    // The events can not be sent from a worker thread, so they will be sent after the step and can not disable the contact
+    if (simulatingAsync_)
+    {
+        asyncContacts_.Push(AsyncContact(contact, ASYNC_CONTACT_UPDATE));
+        return;
+    }
+
+    contact->SetEnabled(SendUpdateContactEvents(ContactInfo(contact), contact->IsEnabled()));
+}
 
+bool PhysicsWorld2D::SendUpdateContactEvents(const ContactInfo& contactInfo, bool enabled)
+{
     // Send global event
     VariantMap& eventData = GetEventDataMap();
     eventData[PhysicsUpdateContact2D::P_WORLD] = this;
-    eventData[PhysicsUpdateContact2D::P_ENABLED] = contact->IsEnabled();
+    eventData[PhysicsUpdateContact2D::P_ENABLED] = enabled;
 
     eventData[PhysicsUpdateContact2D::P_BODYA] = contactInfo.bodyA_.Get();
     eventData[PhysicsUpdateContact2D::P_BODYB] = contactInfo.bodyB_.Get();
@@ -154,11 +189,11 @@ void PhysicsWorld2D::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
     eventData[PhysicsUpdateContact2D::P_SHAPEB] = contactInfo.shapeB_.Get();
 
     SendEvent(E_PHYSICSUPDATECONTACT2D, eventData);
-    contact->SetEnabled(eventData[PhysicsUpdateContact2D::P_ENABLED].GetBool());
+    enabled = eventData[PhysicsUpdateContact2D::P_ENABLED].GetBool();
     eventData.Clear();
 
     // Send node event
-    eventData[NodeUpdateContact2D::P_ENABLED] = contact->IsEnabled();
+    eventData[NodeUpdateContact2D::P_ENABLED] = enabled;
     eventData[NodeUpdateContact2D::P_CONTACTS] = contactInfo.Serialize(contacts_);
 
     if (contactInfo.nodeA_)
@@ -183,7 +218,7 @@ void PhysicsWorld2D::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
         contactInfo.nodeB_->SendEvent(E_NODEUPDATECONTACT2D, eventData);
     }
 
-    contact->SetEnabled(eventData[NodeUpdateContact2D::P_ENABLED].GetBool());
+    return eventData[NodeUpdateContact2D::P_ENABLED].GetBool();
 }
 
 void PhysicsWorld2D::DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color)
@@ -280,6 +315,9 @@ void PhysicsWorld2D::Update(float timeStep)
 {
     URHO3D_PROFILE("UpdatePhysics2D");
 
+    WaitForStep();
+    SendAsyncStepEvents();
+
     using namespace PhysicsPreStep;
 
     VariantMap& eventData = GetEventDataMap();
@@ -291,12 +329,24 @@ void PhysicsWorld2D::Update(float timeStep)
     world_->Step(timeStep, velocityIterations_, positionIterations_);
     physicsStepping_ = false;
 
+    ApplyWorldTransforms();
+
+    SendBeginContactEvents();
+    SendEndContactEvents();
+
+    using namespace PhysicsPostStep;
+    SendEvent(E_PHYSICSPOSTSTEP, eventData);
+}
+
+void PhysicsWorld2D::ApplyWorldTransforms(RigidBody2D* movedBody)
+{
     // Apply world transforms. Unparented transforms first
     for (unsigned i = 0; i < rigidBodies_.Size();)
     {
         if (rigidBodies_[i])
         {
-            rigidBodies_[i]->ApplyWorldTransform();
+            if (rigidBodies_[i] != movedBody)
+                rigidBodies_[i]->ApplyWorldTransform();
             ++i;
         }
         else
@@ -324,12 +374,6 @@ void PhysicsWorld2D::Update(float timeStep)
                 ++i;
         }
     }
-
-    SendBeginContactEvents();
-    SendEndContactEvents();
-
-    using namespace PhysicsPostStep;
-    SendEvent(E_PHYSICSPOSTSTEP, eventData);
 }
 
 void PhysicsWorld2D::DrawDebugGeometry()
@@ -344,6 +388,31 @@ void PhysicsWorld2D::SetUpdateEnabled(bool enable)
     updateEnabled_ = enable;
 }
 
+void PhysicsWorld2D::SetAsyncStep(bool enable)
+{
+    if (enable == asyncStep_)
+        return;
+
+    asyncStep_ = enable;
+
+    if (enable)
+    {
+        SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(PhysicsWorld2D, HandlePostUpdate));
+        SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(PhysicsWorld2D, HandleEndFrame));
+    }
+    else
+    {
+        // Finish any step in progress so that its results are not lost
+        if (asyncStepQueued_)
+            StartAsyncStep();
+        WaitForStep();
+        SendAsyncStepEvents();
+
+        UnsubscribeFromEvent(E_POSTUPDATE);
+        UnsubscribeFromEvent(E_ENDFRAME);
+    }
+}
+
 void PhysicsWorld2D::SetDrawShape(bool drawShape)
 {
     if (drawShape)
@@ -387,21 +456,25 @@ void PhysicsWorld2D::SetDrawCenterOfMass(bool drawCenterOfMass)
 
 void PhysicsWorld2D::SetAllowSleeping(bool enable)
 {
+    WaitForStep();
     world_->SetAllowSleeping(enable);
 }
 
 void PhysicsWorld2D::SetWarmStarting(bool enable)
 {
+    WaitForStep();
     world_->SetWarmStarting(enable);
 }
 
 void PhysicsWorld2D::SetContinuousPhysics(bool enable)
 {
+    WaitForStep();
     world_->SetContinuousPhysics(enable);
 }
 
 void PhysicsWorld2D::SetSubStepping(bool enable)
 {
+    WaitForStep();
     world_->SetSubStepping(enable);
 }
 
@@ -409,21 +482,25 @@ void PhysicsWorld2D::SetGravity(const Vector2& gravity)
 {
     gravity_ = gravity;
 
+    WaitForStep();
     world_->SetGravity(ToB2Vec2(gravity_));
 }
 
 void PhysicsWorld2D::SetAutoClearForces(bool enable)
 {
+    WaitForStep();
     world_->SetAutoClearForces(enable);
 }
 
 void PhysicsWorld2D::SetVelocityIterations(int velocityIterations)
 {
+    WaitForStep();
     velocityIterations_ = velocityIterations;
 }
 
 void PhysicsWorld2D::SetPositionIterations(int positionIterations)
 {
+    WaitForStep();
     positionIterations_ = positionIterations;
 }
 
@@ -453,6 +530,19 @@ void PhysicsWorld2D::AddDelayedWorldTransform(const DelayedWorldTransform2D& tra
     delayedWorldTransforms_[transform.rigidBody_] = transform;
 }
 
+void PhysicsWorld2D::RemoveAsyncContacts(Component* component)
+{
+    for (unsigned i = 0; i < asyncContacts_.Size();)
+    {
+        const AsyncContact& contact = asyncContacts_[i];
+        if (contact.bodyA_ == component || contact.bodyB_ == component || contact.shapeA_ == component ||
+            contact.shapeB_ == component)
+            asyncContacts_.Erase(i);
+        else
+            ++i;
+    }
+}
+
 // Ray cast call back class.
 class RayCastCallback : public b2RayCastCallback
 {
@@ -499,6 +589,8 @@ void PhysicsWorld2D::Raycast(PODVector<PhysicsRaycastResult2D>& results, const V
 {
     results.Clear();
 
+    WaitForStep();
+
     RayCastCallback callback(results, startPoint, collisionMask);
     world_->RayCast(&callback, ToB2Vec2(startPoint), ToB2Vec2(endPoint));
 }
@@ -556,6 +648,8 @@ void PhysicsWorld2D::RaycastSingle(PhysicsRaycastResult2D& result, const Vector2
 {
     result.body_ = nullptr;
 
+    WaitForStep();
+
     SingleRayCastCallback callback(result, startPoint, collisionMask);
     world_->RayCast(&callback, ToB2Vec2(startPoint), ToB2Vec2(endPoint));
 }
@@ -612,6 +706,7 @@ RigidBody2D* PhysicsWorld2D::GetRigidBody(const Vector2& point, unsigned collisi
     b2Aabb.lowerBound = ToB2Vec2(point - delta);
     b2Aabb.upperBound = ToB2Vec2(point + delta);
 
+    WaitForStep();
     world_->QueryAABB(&callback, b2Aabb);
     return callback.GetRigidBody();
 }
@@ -674,6 +769,7 @@ void PhysicsWorld2D::GetRigidBodies(PODVector<RigidBody2D*>& results, const Rect
     b2Aabb.lowerBound = ToB2Vec2(aabb.min_ - delta);
     b2Aabb.upperBound = ToB2Vec2(aabb.max_ + delta);
 
+    WaitForStep();
     world_->QueryAABB(&callback, b2Aabb);
 }
 
@@ -708,7 +804,12 @@ void PhysicsWorld2D::OnSceneSet(Scene* scene)
     if (scene)
         SubscribeToEvent(scene, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(PhysicsWorld2D, HandleSceneSubsystemUpdate));
     else
+    {
+        // The scene is going away, so do not leave the simulation running
+        WaitForStep();
+        asyncStepQueued_ = false;
         UnsubscribeFromEvent(E_SCENESUBSYSTEMUPDATE);
+    }
 }
 
 void PhysicsWorld2D::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData)
@@ -717,7 +818,149 @@ void PhysicsWorld2D::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap
         return;
 
     using namespace SceneSubsystemUpdate;
-    Update(eventData[P_TIMESTEP].GetFloat());
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+    if (asyncStep_ && CanStepAsync())
+        QueueAsyncStep(timeStep);
+    else
+        Update(timeStep);
+}
+
+void PhysicsWorld2D::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    // All update logic has run, so the simulation can proceed while the frame is rendered
+    if (asyncStepQueued_)
+        StartAsyncStep();
+}
+
+void PhysicsWorld2D::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    // Defined synchronization point: the scene nodes receive the simulated transforms before the next frame's update
+    WaitForStep();
+    SendAsyncStepEvents();
+}
+
+bool PhysicsWorld2D::CanStepAsync() const
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    return queue && queue->GetNumThreads() && Thread::IsMainThread();
+}
+
+void PhysicsWorld2D::QueueAsyncStep(float timeStep)
+{
+    // Finish the previous step first if there was no frame in between, for example when the scene is updated manually
+    if (asyncStepQueued_)
+        StartAsyncStep();
+    WaitForStep();
+    SendAsyncStepEvents();
+
+    // Send the pre-step event now, so that the update logic reacting to it runs in the main thread as usual
+    using namespace PhysicsPreStep;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_WORLD] = this;
+    eventData[P_TIMESTEP] = timeStep;
+    SendEvent(E_PHYSICSPRESTEP, eventData);
+
+    asyncTimeStep_ = timeStep;
+    asyncStepQueued_ = true;
+}
+
+void PhysicsWorld2D::StartAsyncStep()
+{
+    URHO3D_PROFILE("StartPhysics2DStep");
+
+    asyncStepQueued_ = false;
+
+    asyncContacts_.Clear();
+    physicsStepping_ = true;
+    simulatingAsync_ = true;
+
+    // Use a dedicated item so that it can be waited on. Prioritize it over background work, but below the items that the
+    // renderer completes in the main thread, so that rendering does not wait for the simulation
+    auto* queue = GetSubsystem<WorkQueue>();
+    asyncStepCompleted_.store(false, std::memory_order_relaxed);
+    stepItem_ = new WorkItem();
+    stepItem_->workFunction_ = Physics2DStepWork;
+    stepItem_->aux_ = this;
+    stepItem_->priority_ = M_MAX_UNSIGNED - 1;
+    queue->AddWorkItem(stepItem_);
+}
+
+void PhysicsWorld2D::JoinAsyncStep()
+{
+    URHO3D_PROFILE("WaitForPhysics2DStep");
+
+    // The work item's own completed flag is not ordered with the simulation results, so use the step's acquire flag instead
+    if (!asyncStepCompleted_.load(std::memory_order_acquire))
+    {
+        // If no worker thread has picked up the step yet, simulate in this thread rather than wait
+        auto* queue = GetSubsystem<WorkQueue>();
+        if (queue && queue->RemoveWorkItem(stepItem_))
+            Physics2DStepWork(stepItem_, 0);
+        else
+        {
+            while (!asyncStepCompleted_.load(std::memory_order_acquire))
+                Time::Sleep(0);
+        }
+    }
+
+    stepItem_.Reset();
+    physicsStepping_ = false;
+    simulatingAsync_ = false;
+}
+
+void PhysicsWorld2D::CompleteStep(RigidBody2D* movedBody)
+{
+    JoinAsyncStep();
+
+    // The Box2D bodies hold the simulated transforms while the scene nodes still have the previous ones. Apply them in one
+    // pass now that the scene nodes can be accessed. A body whose node was moved during the step keeps the new node
+    // transform, as it would after a synchronous step
+    ApplyWorldTransforms(movedBody);
+
+    asyncStepEventsPending_ = true;
+}
+
+void PhysicsWorld2D::SendAsyncStepEvents()
+{
+    if (!asyncStepEventsPending_)
+        return;
+
+    asyncStepEventsPending_ = false;
+
+    // Reference the components and nodes of all contacts before sending any event, as the event handlers may remove them
+    for (PODVector<AsyncContact>::ConstIterator i = asyncContacts_.Begin(); i != asyncContacts_.End(); ++i)
+    {
+        switch (i->type_)
+        {
+        case ASYNC_CONTACT_BEGIN:
+            beginContactInfos_.Push(ContactInfo(*i));
+            break;
+
+        case ASYNC_CONTACT_END:
+            endContactInfos_.Push(ContactInfo(*i));
+            break;
+
+        case ASYNC_CONTACT_UPDATE:
+            updateContactInfos_.Push(ContactInfo(*i));
+            break;
+        }
+    }
+    asyncContacts_.Clear();
+
+    for (unsigned i = 0; i < updateContactInfos_.Size(); ++i)
+        SendUpdateContactEvents(updateContactInfos_[i], updateContactInfos_[i].enabled_);
+    updateContactInfos_.Clear();
+
+    SendBeginContactEvents();
+    SendEndContactEvents();
+
+    using namespace PhysicsPostStep;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_WORLD] = this;
+    eventData[P_TIMESTEP] = asyncTimeStep_;
+    SendEvent(E_PHYSICSPOSTSTEP, eventData);
 }
 
 void PhysicsWorld2D::SendBeginContactEvents()
@@ -822,8 +1065,48 @@ void PhysicsWorld2D::SendEndContactEvents()
     endContactInfos_.Clear();
 }
 
+PhysicsWorld2D::AsyncContact::AsyncContact(b2Contact* contact, AsyncContactType type) :
+    type_(type),
+    enabled_(contact->IsEnabled())
+{
+    b2Fixture* fixtureA = contact->GetFixtureA();
+    b2Fixture* fixtureB = contact->GetFixtureB();
+    bodyA_ = (RigidBody2D*)(fixtureA->GetBody()->GetUserData());
+    bodyB_ = (RigidBody2D*)(fixtureB->GetBody()->GetUserData());
+    shapeA_ = (CollisionShape2D*)fixtureA->GetUserData();
+    shapeB_ = (CollisionShape2D*)fixtureB->GetUserData();
+
+    b2WorldManifold worldManifold;
+    contact->GetWorldManifold(&worldManifold);
+    numPoints_ = contact->GetManifold()->pointCount;
+    worldNormal_ = Vector2(worldManifold.normal.x, worldManifold.normal.y);
+    for (int i = 0; i < numPoints_; ++i)
+    {
+        worldPositions_[i] = Vector2(worldManifold.points[i].x, worldManifold.points[i].y);
+        separations_[i] = worldManifold.separations[i];
+    }
+}
+
 PhysicsWorld2D::ContactInfo::ContactInfo() = default;
 
+PhysicsWorld2D::ContactInfo::ContactInfo(const AsyncContact& contact) :
+    bodyA_(contact.bodyA_),
+    bodyB_(contact.bodyB_),
+    nodeA_(contact.bodyA_->GetNode()),
+    nodeB_(contact.bodyB_->GetNode()),
+    shapeA_(contact.shapeA_),
+    shapeB_(contact.shapeB_),
+    numPoints_(contact.numPoints_),
+    worldNormal_(contact.worldNormal_),
+    enabled_(contact.enabled_)
+{
+    for (int i = 0; i < numPoints_; ++i)
+    {
+        worldPositions_[i] = contact.worldPositions_[i];
+        separations_[i] = contact.separations_[i];
+    }
+}
+
 PhysicsWorld2D::ContactInfo::ContactInfo(b2Contact* contact)
 {
     b2Fixture* fixtureA = contact->GetFixtureA();
@@ -27,6 +27,8 @@
 
 #include <Box2D/Box2D.h>
 
+#include <atomic>
+
 namespace Urho3D
 {
 
@@ -34,6 +36,8 @@ class Camera;
 class CollisionShape2D;
 class RigidBody2D;
 
+struct WorkItem;
+
 /// 2D Physics raycast hit.
 struct URHO3D_API PhysicsRaycastResult2D
 {
@@ -71,6 +75,8 @@ class URHO3D_API PhysicsWorld2D : public Component, public b2ContactListener, pu
 {
     URHO3D_OBJECT(PhysicsWorld2D, Component);
 
+    friend void Physics2DStepWork(const WorkItem* item, unsigned threadIndex);
+
 public:
     /// Construct.
     explicit PhysicsWorld2D(Context* context);
@@ -112,6 +118,8 @@ public:
     void DrawDebugGeometry();
     /// Enable or disable automatic physics simulation during scene update. Enabled by default.
     void SetUpdateEnabled(bool enable);
+    /// Set whether to step the simulation in a worker thread while the frame is rendered. The simulated transforms are applied to the scene nodes at the end of the frame, and the post-step and contact events are sent then. Requires worker threads, otherwise the simulation is stepped during the scene update as usual. Disabled by default.
+    void SetAsyncStep(bool enable);
     /// Set draw shape.
     void SetDrawShape(bool drawShape);
     /// Set draw joint.
@@ -161,6 +169,9 @@ public:
     /// Return whether physics world will automatically simulate during scene update.
     bool IsUpdateEnabled() const { return updateEnabled_; }
 
+    /// Return whether the simulation is stepped in a worker thread while the frame is rendered.
+    bool GetAsyncStep() const { return asyncStep_; }
+
     /// Return draw shape.
     bool GetDrawShape() const { return (m_drawFlags & e_shapeBit) != 0; }
 
@@ -205,12 +216,43 @@ public:
     /// Return whether node dirtying should be disregarded.
     bool IsApplyingTransforms() const { return applyingTransforms_; }
 
+    /// Return whether an asynchronous simulation step is in progress.
+    bool IsSimulatingAsync() const { return simulatingAsync_; }
+
+    /// Wait for an asynchronous simulation step to finish and apply the simulated transforms. Called by the 2D physics components before they access Box2D objects. A rigid body whose node was moved in the meantime keeps the node transform.
+    void WaitForStep(RigidBody2D* movedBody = nullptr)
+    {
+        if (simulatingAsync_)
+            CompleteStep(movedBody);
+    }
+
+    /// Remove the contacts of a rigid body or collision shape from the events of a completed asynchronous step not yet sent. Called when its Box2D body or fixture is released.
+    void RemoveAsyncContacts(Component* component);
+
 protected:
     /// Handle scene being assigned.
     void OnSceneSet(Scene* scene) override;
 
     /// Handle the scene subsystem update event, step simulation here.
     void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the post-update event, start a queued asynchronous step here.
+    void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the frame end event, apply the results of an asynchronous step here.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+    /// Apply the simulated transforms to the scene nodes, except for a rigid body whose node was moved.
+    void ApplyWorldTransforms(RigidBody2D* movedBody = nullptr);
+    /// Return whether the simulation can be stepped in a worker thread.
+    bool CanStepAsync() const;
+    /// Send the pre-step event and queue an asynchronous step to be started after the update.
+    void QueueAsyncStep(float timeStep);
+    /// Start a queued asynchronous step in a worker thread.
+    void StartAsyncStep();
+    /// Wait for an asynchronous step to finish without applying its results.
+    void JoinAsyncStep();
+    /// Wait for an asynchronous step to finish and apply the simulated transforms.
+    void CompleteStep(RigidBody2D* movedBody);
+    /// Send the contact and post-step events of a completed asynchronous step.
+    void SendAsyncStepEvents();
     /// Send begin contact events.
     void SendBeginContactEvents();
     /// Send end contact events.
@@ -238,11 +280,61 @@ protected:
     bool physicsStepping_{};
     /// Applying transforms.
     bool applyingTransforms_{};
+    /// Asynchronous stepping flag.
+    bool asyncStep_{};
+    /// Asynchronous step queued to be started after the update.
+    bool asyncStepQueued_{};
+    /// Asynchronous step in progress flag.
+    bool simulatingAsync_{};
+    /// Contact and post-step events of a completed asynchronous step not yet sent.
+    bool asyncStepEventsPending_{};
+    /// Timestep of the queued or last asynchronous step.
+    float asyncTimeStep_{};
+    /// Work item of an asynchronous step in progress.
+    SharedPtr<WorkItem> stepItem_;
+    /// Asynchronous step finished flag. Set with release semantics by the stepping thread, so that reading it true makes the simulation results visible.
+    std::atomic<bool> asyncStepCompleted_{};
     /// Rigid bodies.
     Vector<WeakPtr<RigidBody2D> > rigidBodies_;
     /// Delayed (parented) world transform assignments.
     HashMap<RigidBody2D*, DelayedWorldTransform2D> delayedWorldTransforms_;
 
+    /// Contact event type recorded during an asynchronous step.
+    enum AsyncContactType
+    {
+        ASYNC_CONTACT_BEGIN = 0,
+        ASYNC_CONTACT_END,
+        ASYNC_CONTACT_UPDATE
+    };
+
+    /// Contact recorded during an asynchronous step. Refers to the components by raw pointers, as reference counts must not be modified outside the main thread.
+    struct AsyncContact
+    {
+        /// Construct from a Box2D contact.
+        AsyncContact(b2Contact* contact, AsyncContactType type);
+
+        /// Contact event type.
+        AsyncContactType type_;
+        /// Contact enabled flag after the update.
+        bool enabled_;
+        /// Rigid body A.
+        RigidBody2D* bodyA_;
+        /// Rigid body B.
+        RigidBody2D* bodyB_;
+        /// Shape A.
+        CollisionShape2D* shapeA_;
+        /// Shape B.
+        CollisionShape2D* shapeB_;
+        /// Number of contact points.
+        int numPoints_;
+        /// Contact normal in world space.
+        Vector2 worldNormal_;
+        /// Contact positions in world space.
+        Vector2 worldPositions_[b2_maxManifoldPoints];
+        /// Contact overlap values.
+        float separations_[b2_maxManifoldPoints];
+    };
+
     /// Contact info.
     struct ContactInfo
     {
@@ -250,6 +342,8 @@ protected:
         ContactInfo();
         /// Construct.
         explicit ContactInfo(b2Contact* contact);
+        /// Construct from a contact recorded during an asynchronous step.
+        explicit ContactInfo(const AsyncContact& contact);
         /// Write contact info to buffer.
         const PODVector<unsigned char>& Serialize(VectorBuffer& buffer) const;
 
@@ -273,11 +367,21 @@ protected:
         Vector2 worldPositions_[b2_maxManifoldPoints];
         /// Contact overlap values.
         float separations_[b2_maxManifoldPoints]{};
+        /// Contact enabled flag, for an update contact of an asynchronous step.
+        bool enabled_{true};
     };
+
+    /// Send update contact events and return whether the contact remains enabled.
+    bool SendUpdateContactEvents(const ContactInfo& contactInfo, bool enabled);
+
     /// Begin contact infos.
     Vector<ContactInfo> beginContactInfos_;
     /// End contact infos.
     Vector<ContactInfo> endContactInfos_;
+    /// Update contact infos of an asynchronous step.
+    Vector<ContactInfo> updateContactInfos_;
+    /// Contacts recorded during an asynchronous step, in the order reported by Box2D.
+    PODVector<AsyncContact> asyncContacts_;
     /// Temporary buffer with contact data.
     VectorBuffer contacts_;
 };
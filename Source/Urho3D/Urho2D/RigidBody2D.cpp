@@ -97,7 +97,10 @@ void RigidBody2D::OnSetEnabled()
     bodyDef_.active = enabled;
 
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetActive(enabled);
+    }
 
     MarkNetworkUpdate();
 }
@@ -107,6 +110,7 @@ void RigidBody2D::SetBodyType(BodyType2D type)
     auto bodyType = (b2BodyType)type;
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->SetType(bodyType);
         // Mass data was reset to keep it legal (e.g. static body should have mass 0.)
         // If not using fixture mass, reassign our mass data now
@@ -133,7 +137,10 @@ void RigidBody2D::SetMass(float mass)
     massData_.mass = mass;
 
     if (!useFixtureMass_ && body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetMassData(&massData_);
+    }
 
     MarkNetworkUpdate();
 }
@@ -147,7 +154,10 @@ void RigidBody2D::SetInertia(float inertia)
     massData_.I = inertia;
 
     if (!useFixtureMass_ && body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetMassData(&massData_);
+    }
 
     MarkNetworkUpdate();
 }
@@ -161,7 +171,10 @@ void RigidBody2D::SetMassCenter(const Vector2& center)
     massData_.center = b2Center;
 
     if (!useFixtureMass_ && body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetMassData(&massData_);
+    }
 
     MarkNetworkUpdate();
 }
@@ -175,6 +188,7 @@ void RigidBody2D::SetUseFixtureMass(bool useFixtureMass)
 
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         if (useFixtureMass_)
             body_->ResetMassData();
         else
@@ -187,7 +201,10 @@ void RigidBody2D::SetUseFixtureMass(bool useFixtureMass)
 void RigidBody2D::SetLinearDamping(float linearDamping)
 {
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetLinearDamping(linearDamping);
+    }
     else
     {
         if (bodyDef_.linearDamping == linearDamping)
@@ -202,7 +219,10 @@ void RigidBody2D::SetLinearDamping(float linearDamping)
 void RigidBody2D::SetAngularDamping(float angularDamping)
 {
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetAngularDamping(angularDamping);
+    }
     else
     {
         if (bodyDef_.angularDamping == angularDamping)
@@ -217,7 +237,10 @@ void RigidBody2D::SetAngularDamping(float angularDamping)
 void RigidBody2D::SetAllowSleep(bool allowSleep)
 {
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetSleepingAllowed(allowSleep);
+    }
     else
     {
         if (bodyDef_.allowSleep == allowSleep)
@@ -233,6 +256,7 @@ void RigidBody2D::SetFixedRotation(bool fixedRotation)
 {
     if (body_)
     {
+        physicsWorld_->WaitForStep();
         body_->SetFixedRotation(fixedRotation);
         // Mass data was reset to keep it legal (e.g. non-rotating body should have inertia 0.)
         // If not using fixture mass, reassign our mass data now
@@ -253,7 +277,10 @@ void RigidBody2D::SetFixedRotation(bool fixedRotation)
 void RigidBody2D::SetBullet(bool bullet)
 {
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetBullet(bullet);
+    }
     else
     {
         if (bodyDef_.bullet == bullet)
@@ -268,7 +295,10 @@ void RigidBody2D::SetBullet(bool bullet)
 void RigidBody2D::SetGravityScale(float gravityScale)
 {
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetGravityScale(gravityScale);
+    }
     else
     {
         if (bodyDef_.gravityScale == gravityScale)
@@ -283,7 +313,10 @@ void RigidBody2D::SetGravityScale(float gravityScale)
 void RigidBody2D::SetAwake(bool awake)
 {
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetAwake(awake);
+    }
     else
     {
         if (bodyDef_.awake == awake)
@@ -299,7 +332,10 @@ void RigidBody2D::SetLinearVelocity(const Vector2& linearVelocity)
 {
     b2Vec2 b2linearVelocity = ToB2Vec2(linearVelocity);
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetLinearVelocity(b2linearVelocity);
+    }
     else
     {
         if (bodyDef_.linearVelocity == b2linearVelocity)
@@ -314,7 +350,10 @@ void RigidBody2D::SetLinearVelocity(const Vector2& linearVelocity)
 void RigidBody2D::SetAngularVelocity(float angularVelocity)
 {
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->SetAngularVelocity(angularVelocity);
+    }
     else
     {
         if (bodyDef_.angularVelocity == angularVelocity)
@@ -329,37 +368,55 @@ void RigidBody2D::SetAngularVelocity(float angularVelocity)
 void RigidBody2D::ApplyForce(const Vector2& force, const Vector2& point, bool wake)
 {
     if (body_ && force != Vector2::ZERO)
+    {
+        physicsWorld_->WaitForStep();
         body_->ApplyForce(ToB2Vec2(force), ToB2Vec2(point), wake);
+    }
 }
 
 void RigidBody2D::ApplyForceToCenter(const Vector2& force, bool wake)
 {
     if (body_ && force != Vector2::ZERO)
+    {
+        physicsWorld_->WaitForStep();
         body_->ApplyForceToCenter(ToB2Vec2(force), wake);
+    }
 }
 
 void RigidBody2D::ApplyTorque(float torque, bool wake)
 {
     if (body_ && torque != 0)
+    {
+        physicsWorld_->WaitForStep();
         body_->ApplyTorque(torque, wake);
+    }
 }
 
 void RigidBody2D::ApplyLinearImpulse(const Vector2& impulse, const Vector2& point, bool wake)
 {
     if (body_ && impulse != Vector2::ZERO)
+    {
+        physicsWorld_->WaitForStep();
         body_->ApplyLinearImpulse(ToB2Vec2(impulse), ToB2Vec2(point), wake);
+    }
 }
 
 void RigidBody2D::ApplyLinearImpulseToCenter(const Vector2& impulse, bool wake)
 {
     if (body_ && impulse != Vector2::ZERO)
+    {
+        physicsWorld_->WaitForStep();
         body_->ApplyLinearImpulseToCenter(ToB2Vec2(impulse), wake);
+    }
 }
 
 void RigidBody2D::ApplyAngularImpulse(float impulse, bool wake)
 {
     if (body_)
+    {
+        physicsWorld_->WaitForStep();
         body_->ApplyAngularImpulse(impulse, wake);
+    }
 }
 
 void RigidBody2D::CreateBody()
@@ -373,6 +430,7 @@ void RigidBody2D::CreateBody()
     bodyDef_.position = ToB2Vec2(node_->GetWorldPosition());
     bodyDef_.angle = node_->GetWorldRotation().RollAngle() * M_DEGTORAD;
 
+    physicsWorld_->WaitForStep();
     body_ = physicsWorld_->GetWorld()->CreateBody(&bodyDef_);
     body_->SetUserData(this);
 
@@ -400,6 +458,10 @@ void RigidBody2D::ReleaseBody()
     if (!physicsWorld_ || !physicsWorld_->GetWorld())
         return;
 
+    // The body may be in use by an asynchronous simulation step, and its contacts may be waiting to be sent
+    physicsWorld_->WaitForStep();
+    physicsWorld_->RemoveAsyncContacts(this);
+
     // Make a copy for iteration
     Vector<WeakPtr<Constraint2D> > constraints = constraints_;
     for (unsigned i = 0; i < constraints.Size(); ++i)
@@ -532,17 +594,29 @@ Vector2 RigidBody2D::GetMassCenter() const
 
 bool RigidBody2D::IsAwake() const
 {
-    return body_ ? body_->IsAwake() : bodyDef_.awake;
+    if (!body_)
+        return bodyDef_.awake;
+
+    physicsWorld_->WaitForStep();
+    return body_->IsAwake();
 }
 
 Vector2 RigidBody2D::GetLinearVelocity() const
 {
-    return ToVector2(body_ ? body_->GetLinearVelocity() : bodyDef_.linearVelocity);
+    if (!body_)
+        return ToVector2(bodyDef_.linearVelocity);
+
+    physicsWorld_->WaitForStep();
+    return ToVector2(body_->GetLinearVelocity());
 }
 
 float RigidBody2D::GetAngularVelocity() const
 {
-    return body_ ? body_->GetAngularVelocity() : bodyDef_.angularVelocity;
+    if (!body_)
+        return bodyDef_.angularVelocity;
+
+    physicsWorld_->WaitForStep();
+    return body_->GetAngularVelocity();
 }
 
 void RigidBody2D::OnNodeSet(Node* node)
@@ -605,8 +679,12 @@ void RigidBody2D::OnMarkedDirty(Node* node)
     {
         bodyDef_.position = newPosition;
         bodyDef_.angle = newAngle;
+        return;
     }
-    else if (newPosition != body_->GetPosition() || newAngle != body_->GetAngle())
+
+    // A node moved during an asynchronous step keeps the new transform
+    physicsWorld_->WaitForStep(this);
+    if (newPosition != body_->GetPosition() || newAngle != body_->GetAngle())
         body_->SetTransform(newPosition, newAngle);
 }
 
@@ -157,6 +157,9 @@ public:
     /// Return Box2D body.
     b2Body* GetBody() const { return body_; }
 
+    /// Return the 2D physics world.
+    PhysicsWorld2D* GetPhysicsWorld() const { return physicsWorld_; }
+
 private:
     /// Handle node being assigned.
     void OnNodeSet(Node* node) override;